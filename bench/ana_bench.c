@@ -0,0 +1,539 @@
+/***********************************************************************
+*                                                                      *
+* File:     ana_bench.c                                                *
+* Contents: Benchmark suite for all libassp analyses.                  *
+*                                                                      *
+* Usage:    ana_bench [-s seconds] [-r sampFreq] [-n repeats]          *
+*                     [-a ana[,ana...]] [-p push[,push...]] [file...]  *
+*                                                                      *
+* Each analysis is run directly through its 'computeXXX' function in   *
+* memory-to-memory mode (audio files: file-to-memory) over a grid of   *
+* window size, frame shift, order and spectral resolution settings.    *
+* Starting from the defaults of an analysis, the settings it actually  *
+* uses are varied one at a time.                                       *
+* Without file arguments a synthetic signal (harmonic complex with a   *
+* gliding F0, formant-like resonances, noise and pauses) is analysed   *
+* at 8, 16, 44.1 and 48 kHz, or only at the rate given with -r.        *
+* Every case runs in a child process so that its peak resident memory  *
+* can be reported: 'base_kb' is the resident size when the case starts *
+* (mainly the input signal), 'peak_kb' the maximum while it ran.       *
+* With -p nothing is timed; instead, for each analysis with push mode  *
+* (anaStreamOpen/Push/Flush), the signal is pushed in blocks of the    *
+* given sizes and the frames are compared with those of 'computeXXX'   *
+* in memory (audio files are loaded into memory first).                *
+* Each result line is printed as key=value pairs.                      *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>        /* fork() */
+#include <sys/resource.h>  /* getrusage() */
+#include <sys/wait.h>      /* waitpid() */
+
+#include <miscdefs.h>  /* TRUE FALSE */
+#include <asspmess.h>  /* getAsspMsg() */
+#include <asspana.h>   /* AOPTS, ACF FMT MHS LP RMS ZCR prototypes */
+#include <asspfio.h>   /* asspFOpen() asspFClose() */
+#include <dataobj.h>   /* DOBJ */
+#include <ksv.h>       /* KSV prototypes */
+#include <spectra.h>   /* SPECT prototypes */
+#include <filter.h>    /* FILT prototypes */
+#include <diff.h>      /* DIFF prototypes */
+
+#define DEF_SECONDS  10.0
+#define DEF_REPEATS  3
+#define NUM_HARMS    20
+
+/*
+ * which of the grid settings an analysis uses
+ */
+#define USE_SIZE  0x01
+#define USE_SHIFT 0x02
+#define USE_ORDER 0x04
+#define USE_RES   0x08
+
+typedef int   (setProc)(AOPTS *aoPtr);
+typedef DOBJ *(compProc)(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *outDOp);
+
+typedef struct {
+  char     *name;
+  setProc  *setDefaults;
+  compProc *compute;
+  int       uses;
+  ANAcreateFunc create;  /* for push mode or NULL */
+} ANA;
+
+typedef struct {
+  char  *name;
+  double msSize;   /* 0: keep default */
+  double msShift;
+  int    order;
+  double resolution;
+} SETTING;
+
+static double rates[] = {8000.0, 16000.0, 44100.0, 48000.0};
+#define NUM_RATES (int)(sizeof(rates) / sizeof(rates[0]))
+
+static SETTING grid[] = {
+  {"default",  0.0,  0.0,  0,  0.0},
+  {"size10",  10.0,  0.0,  0,  0.0},
+  {"size40",  40.0,  0.0,  0,  0.0},
+  {"shift2",   0.0,  2.5,  0,  0.0},
+  {"shift10",  0.0, 10.0,  0,  0.0},
+  {"order8",   0.0,  0.0,  8,  0.0},
+  {"order32",  0.0,  0.0, 32,  0.0},
+  {"res20",    0.0,  0.0,  0, 20.0},
+  {"res80",    0.0,  0.0,  0, 80.0},
+};
+#define NUM_SETTINGS (int)(sizeof(grid) / sizeof(grid[0]))
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9);
+}
+
+/*
+ * option setters for the spectrum types and the filters
+ */
+static int setSpectType(AOPTS *aoPtr, char *type, setProc *setType)
+{
+  if(setSPECTdefaults(aoPtr) < 0)
+    return(-1);
+  strcpy(aoPtr->type, type);
+  return(setType(aoPtr));
+}
+
+static int setDFT(AOPTS *aoPtr)
+{
+  return(setSpectType(aoPtr, "DFT", setDFTdefaults));
+}
+
+static int setLPS(AOPTS *aoPtr)
+{
+  return(setSpectType(aoPtr, "LPS", setLPSdefaults));
+}
+
+static int setCSS(AOPTS *aoPtr)
+{
+  return(setSpectType(aoPtr, "CSS", setCSSdefaults));
+}
+
+static int setCEP(AOPTS *aoPtr)
+{
+  return(setSpectType(aoPtr, "CEP", setCEPdefaults));
+}
+
+static int setFIR(AOPTS *aoPtr)
+{
+  if(setFILTdefaults(aoPtr) < 0)
+    return(-1);
+  aoPtr->lpCutOff = 1000.0;
+  return(0);
+}
+
+static int setIIR(AOPTS *aoPtr)
+{
+  if(setFIR(aoPtr) < 0)
+    return(-1);
+  aoPtr->options |= FILT_OPT_USE_IIR;
+  return(0);
+}
+
+/*
+ * wrappers for the analyses without the common 'computeXXX' signature
+ */
+static DOBJ *compKSV(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *outDOp)
+{
+  return(computeKSV(smpDOp, aoPtr, outDOp, NULL));
+}
+
+static DOBJ *compFilter(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *outDOp)
+{
+  DOBJ *filtDOp;
+
+  if((filtDOp=createFilter(smpDOp, aoPtr)) == NULL)
+    return(NULL);
+  outDOp = filterSignal(smpDOp, filtDOp, outDOp);
+  destroyFilter(filtDOp);
+  return(outDOp);
+}
+
+static ANA anas[] = {
+  {"acf",  setACFdefaults, computeACF,   USE_SIZE | USE_SHIFT | USE_ORDER,
+   createACF},
+  {"rms",  setRMSdefaults, computeRMS,   USE_SIZE | USE_SHIFT, createRMS},
+  {"zcr",  setZCRdefaults, computeZCR,   USE_SIZE | USE_SHIFT, createZCR},
+  {"dft",  setDFT,         computeSPECT, USE_RES | USE_SHIFT, createSPECT},
+  {"lps",  setLPS,         computeSPECT, USE_SIZE | USE_SHIFT | USE_ORDER,
+   createSPECT},
+  {"css",  setCSS,         computeSPECT, USE_RES | USE_SHIFT | USE_ORDER,
+   createSPECT},
+  {"cep",  setCEP,         computeSPECT, USE_RES | USE_SHIFT, createSPECT},
+  {"lp",   setLPdefaults,  computeLP,    USE_SIZE | USE_SHIFT | USE_ORDER,
+   createLP},
+  {"fmt",  setFMTdefaults, computeFMT,   USE_SHIFT, createFMT},
+  {"ksv",  setKSVdefaults, compKSV,      USE_SHIFT, NULL}, /* ksv_bench */
+  {"mhs",  setMHSdefaults, computeMHS,   USE_SHIFT, createMHS},
+  {"fir",  setFIR,         compFilter,   0, NULL},
+  {"iir",  setIIR,         compFilter,   0, NULL},
+  {"diff", setDiffDefaults, diffSignal,  0, NULL},
+};
+#define NUM_ANAS (int)(sizeof(anas) / sizeof(anas[0]))
+
+/*
+ * create an in-memory 16-bit audio object holding a voiced signal with
+ * formant-like resonances, background noise and pauses
+ */
+static DOBJ *testSignal(double seconds, double sampFreq)
+{
+  long     n, numSmps;
+  int      h;
+  double   t, f0, phi, val, y1, y2, a1, a2, r;
+  int16_t *sPtr;
+  DOBJ    *dop;
+  DDESC   *dd;
+
+  numSmps = (long)(seconds * sampFreq);
+  if((dop=allocDObj()) == NULL)
+    return(NULL);
+  dop->fileFormat = FF_RAW;
+  dop->fileData = FDF_BIN;
+  SETENDIAN(dop->fileEndian);
+  dop->sampFreq = sampFreq;
+  dop->frameDur = 1;
+  dd = &(dop->ddl);
+  dd->type = DT_SMP;
+  dd->format = DF_INT16;
+  dd->coding = DC_PCM;
+  dd->numBits = 16;
+  dd->numFields = 1;
+  setRecordSize(dop);
+  if(allocDataBuf(dop, numSmps) == NULL) {
+    freeDObj(dop);
+    return(NULL);
+  }
+  sPtr = (int16_t *)dop->dataBuffer;
+  srand(12345);
+  r = exp(-M_PI * 100.0 / sampFreq);            /* resonance at 700 Hz */
+  a1 = 2.0 * r * cos(2.0 * M_PI * 700.0 / sampFreq);
+  a2 = -r * r;
+  phi = y1 = y2 = 0.0;
+  for(n = 0; n < numSmps; n++) {
+    t = (double)n / sampFreq;
+    val = 0.0;
+    if(fmod(t, 2.0) < 1.6) {
+      f0 = 150.0 + 60.0 * sin(2.0 * M_PI * 0.4 * t);
+      phi += 2.0 * M_PI * f0 / sampFreq;
+      for(h = 1; h <= NUM_HARMS; h++) {
+	if(h * f0 < sampFreq / 2.0)
+	  val += sin(h * phi) / (double)h;
+      }
+    }
+    val = (1.0 - a1 - a2) * val + a1 * y1 + a2 * y2;
+    y2 = y1;
+    y1 = val;
+    val += 0.02 * (2.0 * (double)rand() / (double)RAND_MAX - 1.0);
+    sPtr[n] = (int16_t)(8000.0 * val);
+  }
+  dop->bufStartRec = 0;
+  dop->bufNumRecs = numSmps;
+  dop->startRecord = 0;
+  dop->numRecords = numSmps;
+  return(dop);
+}
+
+/*
+ * set up the options for analysis "ana" with setting "set"; returns
+ * FALSE if the setting does not apply to the analysis
+ */
+static int setOptions(ANA *ana, SETTING *set, AOPTS *aoPtr)
+{
+  if((set->msSize > 0.0 && !(ana->uses & USE_SIZE)) ||
+     (set->msShift > 0.0 && !(ana->uses & USE_SHIFT)) ||
+     (set->order > 0 && !(ana->uses & USE_ORDER)) ||
+     (set->resolution > 0.0 && !(ana->uses & USE_RES)))
+    return(FALSE);
+  ana->setDefaults(aoPtr);
+  if(set->msSize > 0.0)
+    aoPtr->msSize = set->msSize;
+  if(set->msShift > 0.0)
+    aoPtr->msShift = set->msShift;
+  if(set->order > 0)
+    aoPtr->order = set->order;
+  if(set->resolution > 0.0)
+    aoPtr->resolution = set->resolution;
+  return(TRUE);
+}
+
+/*
+ * run one case "repeats" times and report the fastest run; called in
+ * the child process
+ */
+static int bench(const char *label, DOBJ *smpDOp, ANA *ana, SETTING *set,
+		 int repeats)
+{
+  int    r;
+  long   numFrames=0, numSmps, baseKB;
+  double t0, t, best=-1.0;
+  AOPTS  opts;
+  DOBJ  *outDOp;
+  struct rusage ru;
+
+  getrusage(RUSAGE_SELF, &ru);
+  baseKB = ru.ru_maxrss;
+  for(r = 0; r < repeats; r++) {
+    setOptions(ana, set, &opts);
+    t0 = now();
+    outDOp = ana->compute(smpDOp, &opts, NULL);
+    t = now() - t0;
+    if(outDOp == NULL) {
+      fprintf(stderr, "%s %s %s: %s\n", label, ana->name, set->name,
+	      getAsspMsg(asspMsgNum));
+      return(-1);
+    }
+    numFrames = outDOp->bufNumRecs;
+    freeDObj(outDOp);
+    if(best < 0.0 || t < best)
+      best = t;
+  }
+  getrusage(RUSAGE_SELF, &ru);
+  numSmps = smpDOp->numRecords;
+  printf("bench=%s input=%s sampFreq=%.0f setting=%s size_ms=%g"
+	 " shift_ms=%g order=%d res_hz=%g samples=%ld frames=%ld sec=%.6f"
+	 " frames_per_s=%.1f ns_per_sample=%.2f base_kb=%ld peak_kb=%ld\n",
+	 ana->name, label, smpDOp->sampFreq, set->name, opts.msSize,
+	 opts.msShift, opts.order, opts.resolution, numSmps, numFrames, best,
+	 (double)numFrames / best, best * 1.0e9 / (double)numSmps,
+	 baseKB, (long)ru.ru_maxrss);
+  fflush(stdout);
+  return(0);
+}
+
+/*
+ * check whether "name" is an item of the comma-separated list "select"
+ * (all analyses if NULL)
+ */
+static int selected(const char *select, const char *name)
+{
+  size_t len;
+
+  if(select == NULL)
+    return(TRUE);
+  len = strlen(name);
+  while(*select != EOS) {
+    if(strncmp(select, name, len) == 0 &&
+       (select[len] == ',' || select[len] == EOS))
+      return(TRUE);
+    if((select=strchr(select, ',')) == NULL)
+      break;
+    select++;
+  }
+  return(FALSE);
+}
+
+/*
+ * push the signal in blocks of "pushSize" samples through the push-mode
+ * analysis and compare the frames with those of the batch analysis
+ */
+static int streamCheck(const char *label, DOBJ *smpDOp, ANA *ana,
+		       long pushSize)
+{
+  long     pos, n, r, i, fn, numFrames=0, numDiff=0;
+  AOPTS    opts;
+  DOBJ    *refDOp;
+  ASTREAM *sp;
+
+  ana->setDefaults(&opts);
+  if((refDOp=ana->compute(smpDOp, &opts, NULL)) == NULL) {
+    fprintf(stderr, "%s %s: %s\n", label, ana->name, getAsspMsg(asspMsgNum));
+    return(-1);
+  }
+  ana->setDefaults(&opts);
+  if((sp=anaStreamOpen(smpDOp, &opts, ana->create, ana->compute)) == NULL) {
+    fprintf(stderr, "%s %s: %s\n", label, ana->name, getAsspMsg(asspMsgNum));
+    freeDObj(refDOp);
+    return(-1);
+  }
+  for(pos = 0; pos <= smpDOp->bufNumRecs; pos += n) {
+    n = smpDOp->bufNumRecs - pos;
+    if(n > pushSize)
+      n = pushSize;
+    if(n > 0)
+      r = anaStreamPush(sp, (char *)smpDOp->dataBuffer +
+			pos * smpDOp->recordSize, n);
+    else
+      r = anaStreamFlush(sp);
+    if(r < 0) {
+      fprintf(stderr, "%s %s push=%ld: %s\n", label, ana->name, pushSize,
+	      getAsspMsg(asspMsgNum));
+      anaStreamClose(sp);
+      freeDObj(refDOp);
+      return(-1);
+    }
+    for(i = 0; i < r; i++) {
+      fn = sp->anaDOp->bufStartRec + i - refDOp->bufStartRec;
+      if(fn < 0 || fn >= refDOp->bufNumRecs ||
+	 sp->anaDOp->recordSize != refDOp->recordSize ||
+	 memcmp((char *)sp->anaDOp->dataBuffer + i * sp->anaDOp->recordSize,
+		(char *)refDOp->dataBuffer + fn * refDOp->recordSize,
+		refDOp->recordSize) != 0)
+	numDiff++;
+    }
+    numFrames += r;
+    if(n == 0)
+      break;
+  }
+  printf("check=stream ana=%s input=%s sampFreq=%.0f push=%ld frames=%ld"
+	 " ref_frames=%ld differing=%ld identical=%s\n", ana->name, label,
+	 smpDOp->sampFreq, pushSize, numFrames, refDOp->bufNumRecs, numDiff,
+	 (numFrames == refDOp->bufNumRecs && numDiff == 0) ? "yes" : "no");
+  fflush(stdout);
+  n = (numFrames == refDOp->bufNumRecs && numDiff == 0) ? 0 : -1;
+  anaStreamClose(sp);
+  freeDObj(refDOp);
+  return((int)n);
+}
+
+/*
+ * run the push-mode check for all selected analyses and push sizes in
+ * the comma-separated list "pushList"
+ */
+static int streamAll(const char *label, DOBJ *smpDOp, char *select,
+		     char *pushList)
+{
+  int   a, err=0;
+  long  pushSize;
+  char *cPtr;
+
+  for(a = 0; a < NUM_ANAS; a++) {
+    if(anas[a].create == NULL || !selected(select, anas[a].name))
+      continue;
+    for(cPtr = pushList; cPtr != NULL && *cPtr != EOS; ) {
+      pushSize = strtol(cPtr, &cPtr, 10);
+      if(pushSize < 1) {
+	fprintf(stderr, "invalid push size\n");
+	return(-1);
+      }
+      if(streamCheck(label, smpDOp, &anas[a], pushSize) < 0)
+	err = -1;
+      if(*cPtr == ',')
+	cPtr++;
+      else
+	break;
+    }
+  }
+  return(err);
+}
+
+/*
+ * run all selected cases on one input, each in its own child process
+ */
+static int benchAll(const char *label, DOBJ *smpDOp, char *select,
+		    int repeats)
+{
+  int   a, s, status, err=0;
+  pid_t pid;
+  AOPTS opts;
+
+  for(a = 0; a < NUM_ANAS; a++) {
+    if(!selected(select, anas[a].name))
+      continue;
+    for(s = 0; s < NUM_SETTINGS; s++) {
+      if(!setOptions(&anas[a], &grid[s], &opts))
+	continue;
+      fflush(stdout);
+      if((pid=fork()) < 0) {
+	perror("fork");
+	return(-1);
+      }
+      if(pid == 0)
+	_exit(bench(label, smpDOp, &anas[a], &grid[s], repeats) < 0 ? 1 : 0);
+      if(waitpid(pid, &status, 0) < 0 ||
+	 !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	err = -1;
+    }
+  }
+  return(err);
+}
+
+int main(int argc, char *argv[])
+{
+  int    i, r, repeats=DEF_REPEATS, err=0;
+  double seconds=DEF_SECONDS, sampFreq=0.0, freq;
+  char  *select=NULL, *pushList=NULL;
+  DOBJ  *dop;
+
+  for(i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if(strcmp(argv[i], "-s") == 0 && i+1 < argc)
+      seconds = atof(argv[++i]);
+    else if(strcmp(argv[i], "-r") == 0 && i+1 < argc)
+      sampFreq = freq = atof(argv[++i]);
+    else if(strcmp(argv[i], "-n") == 0 && i+1 < argc)
+      repeats = atoi(argv[++i]);
+    else if(strcmp(argv[i], "-a") == 0 && i+1 < argc)
+      select = argv[++i];
+    else if(strcmp(argv[i], "-p") == 0 && i+1 < argc)
+      pushList = argv[++i];
+    else {
+      fprintf(stderr, "usage: %s [-s seconds] [-r sampFreq] [-n repeats]"
+	      " [-a ana[,ana...]] [-p push[,push...]] [file...]\n", argv[0]);
+      fprintf(stderr, "analyses:");
+      for(r = 0; r < NUM_ANAS; r++)
+	fprintf(stderr, " %s", anas[r].name);
+      fprintf(stderr, "\n");
+      return(1);
+    }
+  }
+  if(i >= argc) {
+    for(r = 0; r < NUM_RATES; r++) {
+      if(sampFreq <= 0.0)
+	freq = rates[r];
+      if((dop=testSignal(seconds, freq)) == NULL) {
+	fprintf(stderr, "%s\n", getAsspMsg(asspMsgNum));
+	return(1);
+      }
+      if(pushList != NULL) {
+	if(streamAll("synthetic", dop, select, pushList) < 0)
+	  err = -1;
+      }
+      else if(benchAll("synthetic", dop, select, repeats) < 0)
+	err = -1;
+      freeDObj(dop);
+      if(sampFreq > 0.0)
+	break;
+    }
+  }
+  for( ; i < argc; i++) {
+    if((dop=asspFOpen(argv[i], AFO_READ, NULL)) == NULL) {
+      fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+      return(1);
+    }
+    if(pushList != NULL) {             /* push mode needs the samples */
+      if(allocDataBuf(dop, dop->numRecords) == NULL) {
+	fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+	asspFClose(dop, AFC_FREE);
+	return(1);
+      }
+      dop->bufStartRec = dop->startRecord;
+      if(asspFFill(dop) < 0 || dop->bufNumRecs != dop->numRecords) {
+	fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+	asspFClose(dop, AFC_FREE);
+	return(1);
+      }
+      if(streamAll(argv[i], dop, select, pushList) < 0)
+	err = -1;
+    }
+    else if(benchAll(argv[i], dop, select, repeats) < 0)
+      err = -1;
+    asspFClose(dop, AFC_FREE);
+  }
+  return(err < 0 ? 1 : 0);
+}
@@ -0,0 +1,256 @@
+/***********************************************************************
+*                                                                      *
+* File:     fmt_bench.c                                                *
+* Contents: Micro-benchmark for the root solvers of the formant        *
+*           analysis (forest).                                         *
+*                                                                      *
+* Usage:    fmt_bench [-s seconds] [-r sampFreq] [-n repeats]          *
+*                     [-o order] [file...]                             *
+*                                                                      *
+* Without file arguments a synthetic vowel-like signal is analysed: a  *
+* pulse train with gliding F0 filtered by four resonators with moving  *
+* formants, interrupted by short pauses. Audio files given as          *
+* arguments are analysed file-to-memory. With -o the LP order is fixed *
+* (the number of formants is then at most half the order).             *
+* The analysis is timed with Bairstow's method (default), with the     *
+* Aberth-Ehrlich solver in Bairstow-compatible PQ order and with the   *
+* Aberth-Ehrlich solver in sorted PQ order. For the latter two, the    *
+* number of frames that differ from the Bairstow results and the       *
+* largest difference in Hz are reported as well.                       *
+* Each result line is printed as whitespace-separated key=value pairs. *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include <miscdefs.h>  /* TRUE FALSE */
+#include <asspmess.h>  /* getAsspMsg() */
+#include <asspana.h>   /* AOPTS, FMT prototypes */
+#include <asspfio.h>   /* asspFOpen() asspFClose() */
+#include <dataobj.h>   /* DOBJ */
+
+#define DEF_SECONDS  60.0
+#define DEF_SAMPFREQ 16000.0
+#define DEF_REPEATS  3
+#define NUM_RES      4
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9);
+}
+
+/*
+ * create an in-memory 16-bit audio object holding a vowel-like signal
+ * with 1.5 s voiced stretches separated by 0.3 s pauses
+ */
+static DOBJ *vowelSignal(double seconds, double sampFreq)
+{
+  long     n, numSmps;
+  int      k;
+  double   t, f0, phi, x, a1, a2, r, F[NUM_RES];
+  double   B[NUM_RES] = {80.0, 100.0, 150.0, 200.0};
+  double   y1[NUM_RES] = {0.0}, y2[NUM_RES] = {0.0};
+  int16_t *sPtr;
+  DOBJ    *dop;
+  DDESC   *dd;
+
+  numSmps = (long)(seconds * sampFreq);
+  if((dop=allocDObj()) == NULL)
+    return(NULL);
+  dop->fileFormat = FF_RAW;
+  dop->fileData = FDF_BIN;
+  SETENDIAN(dop->fileEndian);
+  dop->sampFreq = sampFreq;
+  dop->frameDur = 1;
+  dd = &(dop->ddl);
+  dd->type = DT_SMP;
+  dd->format = DF_INT16;
+  dd->coding = DC_PCM;
+  dd->numBits = 16;
+  dd->numFields = 1;
+  setRecordSize(dop);
+  if(allocDataBuf(dop, numSmps) == NULL) {
+    freeDObj(dop);
+    return(NULL);
+  }
+  sPtr = (int16_t *)dop->dataBuffer;
+  srand(4711);
+  phi = 0.0;
+  for(n = 0; n < numSmps; n++) {
+    t = (double)n / sampFreq;
+    F[0] = 550.0 + 200.0 * sin(2.0 * M_PI * 0.7 * t);
+    F[1] = 1500.0 + 500.0 * sin(2.0 * M_PI * 0.45 * t);
+    F[2] = 2500.0 + 150.0 * sin(2.0 * M_PI * 0.3 * t);
+    F[3] = 3500.0;
+    x = 0.0;
+    if(fmod(t, 1.8) < 1.5) {
+      f0 = 120.0 + 20.0 * sin(2.0 * M_PI * 0.5 * t);
+      phi += f0 / sampFreq;
+      if(phi >= 1.0) {                             /* glottal pulse */
+	phi -= 1.0;
+	x = 1.0;
+      }
+    }
+    x += 0.001 * (2.0 * (double)rand() / (double)RAND_MAX - 1.0);
+    for(k = 0; k < NUM_RES; k++) {               /* cascade of poles */
+      r = exp(-M_PI * B[k] / sampFreq);
+      a1 = 2.0 * r * cos(2.0 * M_PI * F[k] / sampFreq);
+      a2 = -r * r;
+      x = (1.0 - a1 - a2) * x + a1 * y1[k] + a2 * y2[k];
+      y2[k] = y1[k];
+      y1[k] = x;
+    }
+    sPtr[n] = (int16_t)(8000.0 * x);
+  }
+  dop->bufStartRec = 0;
+  dop->bufNumRecs = numSmps;
+  dop->startRecord = 0;
+  dop->numRecords = numSmps;
+  return(dop);
+}
+
+/*
+ * run the analysis with root solver option "solver" "repeats" times;
+ * returns the fastest time and the results of the last run
+ */
+static double run(DOBJ *smpDOp, long solver, int order, int repeats,
+		  DOBJ **fmtDOp)
+{
+  int    r;
+  double t0, t, best=-1.0;
+  AOPTS  opts;
+
+  *fmtDOp = NULL;
+  for(r = 0; r < repeats; r++) {
+    if(*fmtDOp != NULL)
+      freeDObj(*fmtDOp);
+    setFMTdefaults(&opts);
+    opts.options |= solver;
+    if(order > 0) {
+      opts.options |= FMT_OPT_LPO_FIXED;
+      opts.order = order;
+      if(opts.numFormants > order / 2)
+	opts.numFormants = order / 2;
+    }
+    t0 = now();
+    *fmtDOp = computeFMT(smpDOp, &opts, NULL);
+    t = now() - t0;
+    if(*fmtDOp == NULL)
+      return(-1.0);
+    if(best < 0.0 || t < best)
+      best = t;
+  }
+  return(best);
+}
+
+/*
+ * time all solvers and compare their results with those of Bairstow
+ */
+static int bench(const char *label, DOBJ *smpDOp, int order, int repeats)
+{
+  static const struct {
+    const char *name;
+    long        option;
+  } solvers[] = {
+    {"bairstow", 0},
+    {"aberth", FMT_OPT_ROOTS_AE},
+    {"aberth_sorted", FMT_OPT_ROOTS_AE | FMT_OPT_AE_SORTED},
+  };
+  int      s, d, diff, maxDiff;
+  long     n, numFrames, numDiff, numVals;
+  double   t;
+  int16_t *ref, *res;
+  DOBJ    *refDOp=NULL, *fmtDOp;
+
+  for(s = 0; s < (int)(sizeof(solvers) / sizeof(solvers[0])); s++) {
+    t = run(smpDOp, solvers[s].option, order, repeats, &fmtDOp);
+    if(t < 0.0) {
+      fprintf(stderr, "%s: %s\n", label, getAsspMsg(asspMsgNum));
+      if(refDOp != NULL)
+	freeDObj(refDOp);
+      return(-1);
+    }
+    numFrames = fmtDOp->bufNumRecs;
+    printf("bench=fmt solver=%s input=%s sampFreq=%.0f order=%d"
+	   " samples=%ld frames=%ld sec=%.6f frames_per_s=%.1f"
+	   " ns_per_sample=%.2f", solvers[s].name, label, smpDOp->sampFreq,
+	   order, smpDOp->numRecords,
+	   numFrames, t, (double)numFrames / t,
+	   t * 1.0e9 / (double)smpDOp->numRecords);
+    if(refDOp == NULL) {
+      printf("\n");
+      refDOp = fmtDOp;
+      continue;
+    }
+    /* default output records hold only 16-bit frequencies/bandwidths */
+    numVals = fmtDOp->recordSize / sizeof(int16_t);
+    ref = (int16_t *)refDOp->dataBuffer;
+    res = (int16_t *)fmtDOp->dataBuffer;
+    numDiff = 0;
+    maxDiff = 0;
+    for(n = 0; n < numFrames; n++) {
+      diff = FALSE;
+      for(d = 0; d < numVals; d++, ref++, res++) {
+	if(*res != *ref) {
+	  diff = TRUE;
+	  if(abs(*res - *ref) > maxDiff)
+	    maxDiff = abs(*res - *ref);
+	}
+      }
+      if(diff)
+	numDiff++;
+    }
+    printf(" differing_frames=%ld max_diff_hz=%d\n", numDiff, maxDiff);
+    freeDObj(fmtDOp);
+  }
+  freeDObj(refDOp);
+  return(0);
+}
+
+int main(int argc, char *argv[])
+{
+  int    i, repeats=DEF_REPEATS, order=0, err=0;
+  double seconds=DEF_SECONDS, sampFreq=DEF_SAMPFREQ;
+  DOBJ  *dop;
+
+  for(i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if(strcmp(argv[i], "-s") == 0 && i+1 < argc)
+      seconds = atof(argv[++i]);
+    else if(strcmp(argv[i], "-r") == 0 && i+1 < argc)
+      sampFreq = atof(argv[++i]);
+    else if(strcmp(argv[i], "-n") == 0 && i+1 < argc)
+      repeats = atoi(argv[++i]);
+    else if(strcmp(argv[i], "-o") == 0 && i+1 < argc)
+      order = atoi(argv[++i]);
+    else {
+      fprintf(stderr, "usage: %s [-s seconds] [-r sampFreq] [-n repeats]"
+	      " [-o order] [file...]\n", argv[0]);
+      return(1);
+    }
+  }
+  if(i >= argc) {
+    if((dop=vowelSignal(seconds, sampFreq)) == NULL) {
+      fprintf(stderr, "%s\n", getAsspMsg(asspMsgNum));
+      return(1);
+    }
+    err = bench("synthetic", dop, order, repeats);
+    freeDObj(dop);
+  }
+  for( ; i < argc && err == 0; i++) {
+    if((dop=asspFOpen(argv[i], AFO_READ, NULL)) == NULL) {
+      fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+      return(1);
+    }
+    err = bench(argv[i], dop, order, repeats);
+    asspFClose(dop, AFC_FREE);
+  }
+  return(err < 0 ? 1 : 0);
+}
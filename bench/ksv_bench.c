@@ -0,0 +1,290 @@
+/***********************************************************************
+*                                                                      *
+* File:     ksv_bench.c                                                *
+* Contents: Micro-benchmark for the KSV pitch analysis on long, noisy  *
+*           recordings.                                                *
+*                                                                      *
+* Usage:    ksv_bench [-s seconds] [-r sampFreq] [-n repeats]          *
+*                     [-v noiseLevel] [-p pushSize] [file...]          *
+*                                                                      *
+* Without file arguments a synthetic signal is analysed: a gliding     *
+* harmonic complex buried in white noise, interrupted by stretches of  *
+* pure noise. The noise produces dense extrema and many short-lived    *
+* period chains, which stresses the extrema, twin and ring buffers.    *
+* Audio files given as arguments are analysed file-to-memory; with -p  *
+* they are loaded into memory first.                                   *
+* Besides the timing, the peak usage of the internal buffers is        *
+* reported. With -p the push-mode analysis (ksvInit/ksvPush/ksvFinish) *
+* is timed as well, feeding blocks of "pushSize" samples, and its      *
+* output is compared with that of the batch analysis.                  *
+* Each result line is printed as key=value pairs.                      *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include <miscdefs.h>  /* TRUE FALSE */
+#include <asspmess.h>  /* getAsspMsg() */
+#include <asspana.h>   /* AOPTS */
+#include <asspfio.h>   /* asspFOpen() asspFClose() */
+#include <dataobj.h>   /* DOBJ */
+#include <ksv.h>       /* KSV prototypes, ksvUsage */
+
+#define DEF_SECONDS  600.0
+#define DEF_SAMPFREQ 16000.0
+#define DEF_REPEATS  3
+#define DEF_NOISE    0.5
+#define NUM_HARMS    20
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9);
+}
+
+/*
+ * create an in-memory 16-bit audio object holding a noisy signal with
+ * alternating voiced (1.5 s) and noise-only (0.5 s) stretches
+ */
+static DOBJ *noisySignal(double seconds, double sampFreq, double noise)
+{
+  long     n, numSmps;
+  int      h;
+  double   t, f0, phi, val;
+  int16_t *sPtr;
+  DOBJ    *dop;
+  DDESC   *dd;
+
+  numSmps = (long)(seconds * sampFreq);
+  if((dop=allocDObj()) == NULL)
+    return(NULL);
+  dop->fileFormat = FF_RAW;
+  dop->fileData = FDF_BIN;
+  SETENDIAN(dop->fileEndian);
+  dop->sampFreq = sampFreq;
+  dop->frameDur = 1;
+  dd = &(dop->ddl);
+  dd->type = DT_SMP;
+  dd->format = DF_INT16;
+  dd->coding = DC_PCM;
+  dd->numBits = 16;
+  dd->numFields = 1;
+  setRecordSize(dop);
+  if(allocDataBuf(dop, numSmps) == NULL) {
+    freeDObj(dop);
+    return(NULL);
+  }
+  sPtr = (int16_t *)dop->dataBuffer;
+  srand(12345);
+  phi = 0.0;
+  for(n = 0; n < numSmps; n++) {
+    t = (double)n / sampFreq;
+    val = noise * (2.0 * (double)rand() / (double)RAND_MAX - 1.0);
+    if(fmod(t, 2.0) < 1.5) {
+      f0 = 150.0 + 60.0 * sin(2.0 * M_PI * 0.4 * t);
+      phi += 2.0 * M_PI * f0 / sampFreq;
+      for(h = 1; h <= NUM_HARMS; h++) {
+	if(h * f0 < sampFreq / 2.0)
+	  val += sin(h * phi) / (double)h;
+      }
+    }
+    sPtr[n] = (int16_t)(6000.0 * val);
+  }
+  dop->bufStartRec = 0;
+  dop->bufNumRecs = numSmps;
+  dop->startRecord = 0;
+  dop->numRecords = numSmps;
+  return(dop);
+}
+
+/*
+ * run the push-mode analysis on an in-memory signal; returns the
+ * duration, stores the F0 values in "f0" (at most "maxFrames") and
+ * the largest number of frames returned by one push in "maxOut"
+ */
+static double stream(DOBJ *smpDOp, long pushSize, float *f0,
+		     long maxFrames, long *numFrames, long *maxOut)
+{
+  long   pos, n, r, i;
+  double t0;
+  AOPTS  opts;
+  DOBJ  *f0DOp;
+
+  setKSVdefaults(&opts);
+  t0 = now();
+  if((f0DOp=ksvInit(smpDOp, &opts, NULL)) == NULL)
+    return(-1.0);
+  *numFrames = *maxOut = 0;
+  for(pos = 0; pos <= smpDOp->bufNumRecs; pos += n) {
+    n = smpDOp->bufNumRecs - pos;
+    if(n > pushSize)
+      n = pushSize;
+    if(n > 0)
+      r = ksvPush((char *)smpDOp->dataBuffer + pos * smpDOp->recordSize,
+		  n);
+    else
+      r = ksvFinish();
+    if(r < 0) {
+      freeDObj(f0DOp);
+      return(-1.0);
+    }
+    for(i = 0; i < r; i++) {
+      if(f0DOp->bufStartRec + i < maxFrames)
+	f0[f0DOp->bufStartRec + i] = ((float *)f0DOp->dataBuffer)[i];
+    }
+    *numFrames += r;
+    if(r > *maxOut)
+      *maxOut = r;
+    if(n == 0)
+      break;
+  }
+  t0 = now() - t0;
+  freeDObj(f0DOp);
+  return(t0);
+}
+
+/*
+ * run the analysis "repeats" times and report the fastest run
+ */
+static int bench(const char *label, DOBJ *smpDOp, int repeats, long pushSize)
+{
+  int    r;
+  long   numFrames=0, numVoiced=0, n;
+  double t0, t, best=-1.0;
+  long   numStream, maxOut, numDiff;
+  float *fPtr, *ref=NULL, *f0=NULL;
+  AOPTS  opts;
+  DOBJ  *f0DOp;
+
+  initKSVusage();
+  for(r = 0; r < repeats; r++) {
+    setKSVdefaults(&opts);
+    t0 = now();
+    f0DOp = computeKSV(smpDOp, &opts, NULL, NULL);
+    t = now() - t0;
+    if(f0DOp == NULL) {
+      fprintf(stderr, "%s: %s\n", label, getAsspMsg(asspMsgNum));
+      free(ref);
+      free(f0);
+      return(-1);
+    }
+    numFrames = f0DOp->bufNumRecs;
+    fPtr = (float *)f0DOp->dataBuffer;
+    for(numVoiced = n = 0; n < numFrames; n++)
+      if(fPtr[n] > 0.0)
+	numVoiced++;
+    if(pushSize > 0 && ref == NULL) {
+      ref = (float *)malloc(numFrames * sizeof(float));
+      f0 = (float *)calloc(numFrames, sizeof(float));
+      if(ref == NULL || f0 == NULL) {
+	fprintf(stderr, "%s: out of memory\n", label);
+	freeDObj(f0DOp);
+	free(ref);
+	free(f0);
+	return(-1);
+      }
+      memcpy(ref, fPtr, numFrames * sizeof(float));
+    }
+    freeDObj(f0DOp);
+    if(best < 0.0 || t < best)
+      best = t;
+  }
+  printf("bench=ksv input=%s sampFreq=%.0f samples=%ld frames=%ld"
+	 " voiced=%ld sec=%.6f frames_per_s=%.1f ns_per_sample=%.2f\n",
+	 label, smpDOp->sampFreq, smpDOp->numRecords, numFrames, numVoiced,
+	 best, (double)numFrames / best,
+	 best * 1.0e9 / (double)smpDOp->numRecords);
+  printf("usage=ksv input=%s extrema=%d/%d twins=%d/%d ring=%ld/%ld"
+	 " grown=%ld\n", label,
+	 ksvUsage.maxExtrema, ksvUsage.extrSize,
+	 ksvUsage.maxTwins, ksvUsage.twinSize,
+	 ksvUsage.maxRing, ksvUsage.ringSize, ksvUsage.numGrown);
+  if(pushSize > 0) {
+    best = -1.0;
+    for(r = 0; r < repeats; r++) {
+      t = stream(smpDOp, pushSize, f0, numFrames, &numStream, &maxOut);
+      if(t < 0.0) {
+	fprintf(stderr, "%s: %s\n", label, getAsspMsg(asspMsgNum));
+	free(ref);
+	free(f0);
+	return(-1);
+      }
+      if(best < 0.0 || t < best)
+	best = t;
+    }
+    for(numDiff = n = 0; n < numFrames; n++)
+      if(f0[n] != ref[n])
+	numDiff++;
+    printf("bench=ksv_push input=%s push=%ld frames=%ld sec=%.6f"
+	   " ns_per_sample=%.2f max_out_frames=%ld identical=%s\n",
+	   label, pushSize, numStream, best,
+	   best * 1.0e9 / (double)smpDOp->numRecords, maxOut,
+	   (numStream == numFrames && numDiff == 0) ? "yes" : "no");
+  }
+  free(ref);
+  free(f0);
+  return(0);
+}
+
+int main(int argc, char *argv[])
+{
+  int    i, repeats=DEF_REPEATS, err=0;
+  long   pushSize=0;
+  double seconds=DEF_SECONDS, sampFreq=DEF_SAMPFREQ, noise=DEF_NOISE;
+  DOBJ  *dop;
+
+  for(i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if(strcmp(argv[i], "-s") == 0 && i+1 < argc)
+      seconds = atof(argv[++i]);
+    else if(strcmp(argv[i], "-r") == 0 && i+1 < argc)
+      sampFreq = atof(argv[++i]);
+    else if(strcmp(argv[i], "-n") == 0 && i+1 < argc)
+      repeats = atoi(argv[++i]);
+    else if(strcmp(argv[i], "-v") == 0 && i+1 < argc)
+      noise = atof(argv[++i]);
+    else if(strcmp(argv[i], "-p") == 0 && i+1 < argc)
+      pushSize = atol(argv[++i]);
+    else {
+      fprintf(stderr, "usage: %s [-s seconds] [-r sampFreq] [-n repeats]"
+	      " [-v noiseLevel] [-p pushSize] [file...]\n", argv[0]);
+      return(1);
+    }
+  }
+  if(i >= argc) {
+    if((dop=noisySignal(seconds, sampFreq, noise)) == NULL) {
+      fprintf(stderr, "%s\n", getAsspMsg(asspMsgNum));
+      return(1);
+    }
+    err = bench("synthetic", dop, repeats, pushSize);
+    freeDObj(dop);
+  }
+  for( ; i < argc && err == 0; i++) {
+    if((dop=asspFOpen(argv[i], AFO_READ, NULL)) == NULL) {
+      fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+      return(1);
+    }
+    if(pushSize > 0) {                 /* push mode needs the samples */
+      if(allocDataBuf(dop, dop->numRecords) == NULL) {
+	fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+	asspFClose(dop, AFC_FREE);
+	return(1);
+      }
+      dop->bufStartRec = dop->startRecord;
+      if(asspFFill(dop) < 0 || dop->bufNumRecs != dop->numRecords) {
+	fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+	asspFClose(dop, AFC_FREE);
+	return(1);
+      }
+    }
+    err = bench(argv[i], dop, repeats, pushSize);
+    asspFClose(dop, AFC_FREE);
+  }
+  return(err < 0 ? 1 : 0);
+}
@@ -0,0 +1,176 @@
+/***********************************************************************
+*                                                                      *
+* File:     mhs_bench.c                                                *
+* Contents: Micro-benchmark for the MHS pitch analysis on dense voiced *
+*           speech.                                                    *
+*                                                                      *
+* Usage:    mhs_bench [-s seconds] [-r sampFreq] [-n repeats] [file...]*
+*                                                                      *
+* Without file arguments a synthetic, permanently voiced signal is     *
+* analysed: a harmonic complex with a gliding F0 and vibrato, mixed    *
+* with a weaker second voice so that the tracker has to maintain       *
+* several concurrent candidate tracks in every frame. Audio files      *
+* given as arguments are analysed file-to-memory.                      *
+* Each result line is printed as whitespace-separated key=value pairs. *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include <miscdefs.h>  /* TRUE FALSE */
+#include <asspmess.h>  /* getAsspMsg() */
+#include <asspana.h>   /* AOPTS, MHS prototypes */
+#include <asspfio.h>   /* asspFOpen() asspFClose() */
+#include <dataobj.h>   /* DOBJ */
+
+#define DEF_SECONDS  60.0
+#define DEF_SAMPFREQ 16000.0
+#define DEF_REPEATS  3
+#define NUM_HARMS    30
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9);
+}
+
+/*
+ * create an in-memory 16-bit audio object holding a dense voiced signal
+ */
+static DOBJ *voicedSignal(double seconds, double sampFreq)
+{
+  long     n, numSmps;
+  int      h;
+  double   t, f0a, f0b, phiA, phiB, val;
+  int16_t *sPtr;
+  DOBJ    *dop;
+  DDESC   *dd;
+
+  numSmps = (long)(seconds * sampFreq);
+  if((dop=allocDObj()) == NULL)
+    return(NULL);
+  dop->fileFormat = FF_RAW;
+  dop->fileData = FDF_BIN;
+  SETENDIAN(dop->fileEndian);
+  dop->sampFreq = sampFreq;
+  dop->frameDur = 1;
+  dd = &(dop->ddl);
+  dd->type = DT_SMP;
+  dd->format = DF_INT16;
+  dd->coding = DC_PCM;
+  dd->numBits = 16;
+  dd->numFields = 1;
+  setRecordSize(dop);
+  if(allocDataBuf(dop, numSmps) == NULL) {
+    freeDObj(dop);
+    return(NULL);
+  }
+  sPtr = (int16_t *)dop->dataBuffer;
+  phiA = phiB = 0.0;
+  for(n = 0; n < numSmps; n++) {
+    t = (double)n / sampFreq;
+    /* main voice gliding between 90 and 250 Hz with 5 Hz vibrato */
+    f0a = 170.0 + 80.0 * sin(2.0 * M_PI * 0.3 * t)
+                + 4.0 * sin(2.0 * M_PI * 5.0 * t);
+    /* competing voice roughly a fifth apart, 12 dB weaker */
+    f0b = 1.5 * f0a + 20.0 * sin(2.0 * M_PI * 0.7 * t);
+    phiA += 2.0 * M_PI * f0a / sampFreq;
+    phiB += 2.0 * M_PI * f0b / sampFreq;
+    val = 0.0;
+    for(h = 1; h <= NUM_HARMS; h++) {
+      if(h * f0a < sampFreq / 2.0)
+	val += sin(h * phiA) / (double)h;
+      if(h * f0b < sampFreq / 2.0)
+	val += 0.25 * sin(h * phiB) / (double)h;
+    }
+    sPtr[n] = (int16_t)(4000.0 * val);
+  }
+  dop->bufStartRec = 0;
+  dop->bufNumRecs = numSmps;
+  dop->startRecord = 0;
+  dop->numRecords = numSmps;
+  return(dop);
+}
+
+/*
+ * run the analysis "repeats" times and report the fastest run
+ */
+static int bench(const char *label, DOBJ *smpDOp, int repeats)
+{
+  int    r;
+  long   numFrames=0, numVoiced=0, n;
+  double t0, t, best=-1.0;
+  float *fPtr;
+  AOPTS  opts;
+  DOBJ  *pitDOp;
+
+  for(r = 0; r < repeats; r++) {
+    setMHSdefaults(&opts);
+    t0 = now();
+    pitDOp = computeMHS(smpDOp, &opts, NULL);
+    t = now() - t0;
+    if(pitDOp == NULL) {
+      fprintf(stderr, "%s: %s\n", label, getAsspMsg(asspMsgNum));
+      return(-1);
+    }
+    numFrames = pitDOp->bufNumRecs;
+    fPtr = (float *)pitDOp->dataBuffer;
+    for(numVoiced = n = 0; n < numFrames; n++)
+      if(fPtr[n] > 0.0)
+	numVoiced++;
+    freeDObj(pitDOp);
+    if(best < 0.0 || t < best)
+      best = t;
+  }
+  printf("bench=mhs input=%s sampFreq=%.0f samples=%ld frames=%ld"
+	 " voiced=%ld sec=%.6f frames_per_s=%.1f ns_per_sample=%.2f\n",
+	 label, smpDOp->sampFreq, smpDOp->numRecords, numFrames, numVoiced,
+	 best, (double)numFrames / best,
+	 best * 1.0e9 / (double)smpDOp->numRecords);
+  return(0);
+}
+
+int main(int argc, char *argv[])
+{
+  int    i, repeats=DEF_REPEATS, err=0;
+  double seconds=DEF_SECONDS, sampFreq=DEF_SAMPFREQ;
+  DOBJ  *dop;
+
+  for(i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if(strcmp(argv[i], "-s") == 0 && i+1 < argc)
+      seconds = atof(argv[++i]);
+    else if(strcmp(argv[i], "-r") == 0 && i+1 < argc)
+      sampFreq = atof(argv[++i]);
+    else if(strcmp(argv[i], "-n") == 0 && i+1 < argc)
+      repeats = atoi(argv[++i]);
+    else {
+      fprintf(stderr, "usage: %s [-s seconds] [-r sampFreq] [-n repeats]"
+	      " [file...]\n", argv[0]);
+      return(1);
+    }
+  }
+  if(i >= argc) {
+    if((dop=voicedSignal(seconds, sampFreq)) == NULL) {
+      fprintf(stderr, "%s\n", getAsspMsg(asspMsgNum));
+      return(1);
+    }
+    err = bench("synthetic", dop, repeats);
+    freeDObj(dop);
+  }
+  for( ; i < argc && err == 0; i++) {
+    if((dop=asspFOpen(argv[i], AFO_READ, NULL)) == NULL) {
+      fprintf(stderr, "%s: %s\n", argv[i], getAsspMsg(asspMsgNum));
+      return(1);
+    }
+    err = bench(argv[i], dop, repeats);
+    asspFClose(dop, AFC_FREE);
+  }
+  return(err < 0 ? 1 : 0);
+}
@@ -41,11 +41,12 @@
 #include <asspmess.h>  /* error message handler */
 #include <assptime.h>  /* standard conversion macros */
 #include <asspana.h>   /* AOPTS anaTiming() (includes acf.h) */
-#include <asspdsp.h>   /* makeWF() freeWF() mulSigWF() getACF() */
+#include <asspdsp.h>   /* getWF() freeWF() mulWinI16() getACF() */
 #include <asspfio.h>   /* asspFFlush() */
-#include <dataobj.h>   /* DOBJ getSmpCaps() getSmpFrame() */
+#include <dataobj.h>   /* DOBJ getSmpCaps() getSmpFrame() getSmpView() */
 #include <headers.h>   /* KDTAB */
 #include <aucheck.h>   /* checkSound() */
+#include <asspprof.h>  /* PROF_... */
 
 /*
  * prototypes of private functions
@@ -154,6 +155,8 @@ DOBJ *createACF(DOBJ *smpDOp, AOPTS *aoPtr)
   gd->channel = aoPtr->channel;
   gd->accuracy = aoPtr->accuracy;
   gd->frame = NULL;
+  gd->i16Frame = NULL;
+  gd->smpCache = NULL;
   gd->wfc = NULL;
   gd->acf = NULL;
   gd->gainCorr = 1.0;
@@ -240,11 +243,12 @@ DOC*/
 
 DOBJ *computeACF(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *acfDOp)
 {
-  int     FILE_IN, FILE_OUT, CREATED;
+  int     FILE_IN, FILE_OUT, CREATED, I16_IN;
   int     err, m, order;
-  long    fn, frameSize, frameShift;
-  double  R0;
+  long    fn, n, frameSize, frameShift;
+  double  R0, *sPtr;
   ACF_GD *gd;
+  PROF_DECL(t)
 
   if(smpDOp == NULL || (aoPtr == NULL && acfDOp == NULL)) {
     setAsspMsg(AEB_BAD_ARGS, "computeACF");
@@ -324,18 +328,51 @@ DOBJ *computeACF(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *acfDOp)
     if(allocBufs(gd, frameShift) < 0)
       return(NULL);
   }
+  I16_IN = (smpDOp->ddl.format == DF_INT16);
+  if(!I16_IN) {
+    if(gd->smpCache == NULL) {
+      gd->smpCache = allocSmpCache(smpDOp, frameSize, frameShift, 0, 0,\
+				   ACF_PFORMAT);
+      if(gd->smpCache == NULL) {
+	if(CREATED)
+	  freeDObj(acfDOp);
+	return(NULL);
+      }
+    }
+    else
+      gd->smpCache->bufNumRecs = 0;       /* input may have changed */
+  }
   /* loop over frames */
+  PROF_START(t);
   for(err = 0, fn = gd->begFrameNr; fn < gd->endFrameNr; fn++) {
-    if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
-			gd->channel, gd->frame, ACF_PFORMAT)) < 0) {
-      break;
+    if(I16_IN) {     /* convert and window 16-bit samples in one pass */
+      if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
+			  gd->channel, gd->i16Frame, DF_INT16)) < 0) {
+	break;
+      }
+      PROF_LAP(t, PRF_FRAME);
+      mulWinI16(gd->i16Frame, gd->wfc, gd->frame, frameSize);
+      sPtr = gd->frame;
+    }
+    else {                          /* view on the converted samples */
+      sPtr = (double *)getSmpView(smpDOp, fn, frameSize, frameShift,\
+				  0, 0, gd->channel, gd->smpCache);
+      if(sPtr == NULL) {
+	err = -1;
+	break;
+      }
+      PROF_LAP(t, PRF_FRAME);
+      if(gd->winFunc > WF_RECTANGLE) {
+	for(n = 0; n < frameSize; n++)
+	  gd->frame[n] = sPtr[n] * gd->wfc[n];
+	sPtr = gd->frame;
+      }
     }
-    if(gd->winFunc > WF_RECTANGLE)
-      mulSigWF(gd->frame, gd->wfc, frameSize);
+    PROF_LAP(t, PRF_WINDOW);
     if(gd->options & ACF_OPT_MEAN)
-      getMeanACF(gd->frame, gd->acf, frameSize, order);
+      getMeanACF(sPtr, gd->acf, frameSize, order);
     else
-      getACF(gd->frame, gd->acf, frameSize, order);
+      getACF(sPtr, gd->acf, frameSize, order);
     if(gd->options & ACF_OPT_NORM) {
       R0 = gd->acf[0];
       gd->acf[0] = 1.0;
@@ -352,7 +389,10 @@ DOBJ *computeACF(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *acfDOp)
       for(m = 0; m <= order; m++)
 	gd->acf[m] /= (gd->gainCorr);
     }
+    PROF_LAP(t, PRF_TRANSFORM);
     if((err=storeACF(gd->acf, fn, acfDOp)) < 0) break;
+    PROF_LAP(t, PRF_STORE);
+    PROF_COUNT(PRC_FRAMES, 1);
   }       /* END LOOP OVER FRAMES */
   if(err >= 0 && FILE_OUT)
     err = asspFFlush(acfDOp, gd->writeOpts);
@@ -508,6 +548,8 @@ LOCAL int allocBufs(ACF_GD *gd, long frameShift)
   int wFlags;
 
   gd->frame = gd->wfc = gd->acf = NULL;
+  gd->i16Frame = NULL;
+  gd->smpCache = NULL;
   if(gd->winFunc > WF_RECTANGLE) {
     /* because of the relationship between the autocorrelation and */
     /* the power spectrum, we use the 'proper' periodic window */
@@ -515,7 +557,7 @@ LOCAL int allocBufs(ACF_GD *gd, long frameShift)
     if((ODD(gd->frameSize) && EVEN(frameShift)) ||
        (EVEN(gd->frameSize) && ODD(frameShift)) )
       wFlags = WF_ASYMMETRIC; /* align window centre and frame centre */
-    gd->wfc = makeWF(gd->winFunc, gd->frameSize, wFlags);
+    gd->wfc = getWF(gd->winFunc, gd->frameSize, wFlags);
     if(gd->wfc == NULL) {
       setAsspMsg(AEG_ERR_MEM, "ACF: allocBufs");
       return(-1);
@@ -525,8 +567,9 @@ LOCAL int allocBufs(ACF_GD *gd, long frameShift)
   else /* gd->wfc already NULL; */
     gd->gainCorr = 1.0;
   gd->frame = (double *)calloc((size_t)gd->frameSize, sizeof(double));
+  gd->i16Frame = (int16_t *)calloc((size_t)gd->frameSize, sizeof(int16_t));
   gd->acf = (double *)calloc((size_t)(gd->order + 1), sizeof(double));
-  if(gd->frame == NULL || gd->acf == NULL) {
+  if(gd->frame == NULL || gd->i16Frame == NULL || gd->acf == NULL) {
     freeBufs(gd);
     setAsspMsg(AEG_ERR_MEM, "ACF: allocBufs");
     return(-1);
@@ -543,9 +586,13 @@ LOCAL void freeBufs(ACF_GD *gd)
     if(gd->frame != NULL)
       free((void *)(gd->frame));
     freeWF(gd->wfc);
+    if(gd->i16Frame != NULL)
+      free((void *)(gd->i16Frame));
+    gd->smpCache = freeDObj(gd->smpCache);
     if(gd->acf != NULL)
       free((void *)(gd->acf));
     gd->frame = gd->wfc = gd->acf = NULL;
+    gd->i16Frame = NULL;
     gd->gainCorr = 1.0;
   }
   return;
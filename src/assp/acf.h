@@ -124,6 +124,8 @@ typedef struct ACF_analysis_parameters {
   int     order;      /* analysis order */
   wfunc_e winFunc;    /* type number of window function */
   double *frame;      /* frame buffer (allocated) */
+  int16_t *i16Frame;  /* frame buffer for 16-bit samples (allocated) */
+  DOBJ   *smpCache;   /* converted samples for getSmpView() (allocated) */
   double *wfc;        /* window function coefficients (allocated) */
   double *acf;        /* autocorrelation coefficients (allocated) */
   double  gainCorr;   /* correction for gain of window function */
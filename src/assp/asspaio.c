@@ -0,0 +1,574 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     asspaio.c                                                  *
+* Contents: Asynchronous file I/O of data objects: a background thread *
+*           writes full data buffers while the caller fills a second   *
+*           one (double buffering) or reads ahead the records that     *
+*           will be loaded next.                                       *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>      /* FILE fseek() fread() fwrite() fflush() */
+#include <stdlib.h>     /* malloc() calloc() free() */
+#include <string.h>     /* memcpy() memset() strcpy() */
+#include <pthread.h>    /* pthread_create() pthread_cond_wait() */
+
+#include <miscdefs.h>   /* TRUE FALSE LOCAL */
+#include <asspmess.h>   /* message codes; reference to globals */
+#include <asspendian.h> /* ENDIAN MSB DIFFENDIAN() */
+#include <dataobj.h>    /* DOBJ FDF_BIN swapRecords() */
+#include <asspaio.h>
+#include <blockio.h>    /* blkSeek() blkRead() blkWrite() */
+#include <flacdec.h>    /* flacSeek() flacRead() */
+#include <asspprof.h>   /* PROF_COUNT() */
+
+/*
+ * state of the background thread of a data object (item 'aio')
+ */
+typedef struct assp_aio {
+  pthread_t       tid;
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;    /* signals changes of 'pending' and 'quit' */
+  DOBJ   *dop;             /* the thread only uses items that are fixed */
+  int     reader;          /* reads ahead (TRUE) or writes (FALSE) */
+  int     pending;         /* a read or write is waiting or under way */
+  int     quit;            /* thread should terminate */
+  void   *buffer;          /* writer: buffer handed over for writing */
+                           /* reader: buffer with records read ahead */
+  size_t  bufBytes;        /* its size */
+  long    startRec;        /* absolute number of first record */
+  long    numRecords;      /* number of records to write/read */
+  long    numRead;         /* reader: number of valid records */
+  long    lastRec;         /* reader: first record of previous load */
+  void   *spare;           /* writer: cleared buffer for next handover */
+  size_t  spareBytes;
+  short   msgNum;          /* writer: message state of failed write */
+  char    message[MAX_MSG_LEN+1];
+} AIO_STATE;
+
+/*
+ * prototypes of private functions
+ */
+LOCAL int   startThread(DOBJ *dop, int reader);
+LOCAL void *ioThread(void *arg);
+LOCAL int   writeBuffer(AIO_STATE *aio);
+LOCAL void  readAhead(AIO_STATE *aio);
+
+/*DOC
+
+Function 'aioStartWriter'
+
+Starts a background thread for writing the data buffer of the data
+object pointed to by "dop" which must have been opened for writing
+binary data (see asspFOpen() with mode AFO_WRITE|AFO_ASYNC).
+asspFFlush() will then hand a full buffer over to that thread (see
+aioWrite()) and return immediately with an empty, cleared buffer so
+that the caller can continue to fill the data object while the
+previous records are swapped, written and cleared in the background.
+Returns 0 upon success and -1 upon error.
+
+Note:
+ - While a write is pending, the file may only be accessed via
+   asspFFlush(), asspFClose() or aioSync().
+ - Errors in the background are reported by the next call to
+   aioWrite() or aioSync(), e.g. from asspFFlush() or asspFClose().
+
+DOC*/
+
+int aioStartWriter(DOBJ *dop)
+{
+  if(dop == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "aioStartWriter");
+    return(-1);
+  }
+  if(dop->fp == NULL || dop->fileData != FDF_BIN || dop->aio != NULL) {
+    setAsspMsg(AEB_BAD_CALL, "aioStartWriter");
+    return(-1);
+  }
+  return(startThread(dop, FALSE));
+}
+
+/*DOC
+
+Function 'aioStartReader'
+
+Starts a background thread for reading ahead from the file referred to
+by the data object pointed to by "dop" which must have been opened for
+reading binary data (see asspFOpen() with mode AFO_READ|AFO_ASYNC).
+Each time asspFLoad() has loaded records into a data buffer, the thread
+reads the records which will presumably be loaded next (assuming the
+same distance between consecutive loads) and converts them to the
+system's byte order. If the next load indeed requests these records,
+asspFLoad() only has to copy them (see aioFetch()).
+Returns 0 upon success and -1 upon error.
+
+Note:
+ - The file should only be accessed via asspFLoad() and the functions
+   which use it (asspFFill(), recordIndex(), frameIndex(),
+   getSmpFrame(), getSmpPtr()); asspFSeek() and asspFTell() wait for
+   a pending read.
+
+DOC*/
+
+int aioStartReader(DOBJ *dop)
+{
+  if(dop == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "aioStartReader");
+    return(-1);
+  }
+  if(dop->fp == NULL || dop->fileData != FDF_BIN ||\
+     dop->recordSize < 1 || dop->aio != NULL) {
+    setAsspMsg(AEB_BAD_CALL, "aioStartReader");
+    return(-1);
+  }
+  return(startThread(dop, TRUE));
+}
+
+/*DOC
+
+Function 'aioWrite'
+
+Hands the data buffer of the data object pointed to by "dop" over to
+its background writer (see aioStartWriter()), after waiting for the
+previous write to complete, and replaces it by a cleared buffer of the
+same size. The items 'numRecords' and 'bufStartRec' are updated as by
+asspFFlush() with option AFW_CLEAR.
+Returns the number of records handed over or -1 upon error (including
+a failure of the previous write).
+
+Note:
+ - This function is called by asspFFlush(); there should be no need
+   to call it directly.
+ - The data buffer must have been allocated with allocDataBuf().
+
+DOC*/
+
+long aioWrite(DOBJ *dop)
+{
+  long    recordNr, numRecs;
+  size_t  numBytes;
+  AIO_STATE *aio;
+
+  if(dop == NULL || dop->aio == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "aioWrite");
+    return(-1);
+  }
+  aio = (AIO_STATE *)(dop->aio);
+  if(aio->reader || dop->dataBuffer == NULL ||\
+     dop->doFreeDataBuf != (DOfreeFunc)free) {
+    setAsspMsg(AEB_BAD_CALL, "aioWrite");
+    return(-1);
+  }
+  numRecs = dop->bufNumRecs;
+  if(numRecs < 1)
+    return(0);
+  recordNr = dop->bufStartRec - dop->startRecord;
+  if(recordNr < 0) {
+    setAsspMsg(AEB_TOO_SOON, "(aioWrite)");
+    return(-1);
+  }
+  if(recordNr > dop->numRecords) {
+    setAsspMsg(AEB_TOO_LATE, "(aioWrite)");
+    return(-1);
+  }
+  numBytes = (size_t)(dop->maxBufRecs) * dop->recordSize;
+  pthread_mutex_lock(&(aio->lock));
+  while(aio->pending)
+    pthread_cond_wait(&(aio->cond), &(aio->lock));
+  if(aio->msgNum != 0) {        /* previous write failed; stay failed */
+    setAsspMsg(aio->msgNum, aio->message);
+    pthread_mutex_unlock(&(aio->lock));
+    return(-1);
+  }
+  if(aio->spare != NULL && aio->spareBytes != numBytes) {
+    free(aio->spare);
+    aio->spare = NULL;
+  }
+  if(aio->spare == NULL) {
+    aio->spare = calloc(1, numBytes);
+    if(aio->spare == NULL) {
+      pthread_mutex_unlock(&(aio->lock));
+      setAsspMsg(AEG_ERR_MEM, "(aioWrite)");
+      return(-1);
+    }
+    aio->spareBytes = numBytes;
+  }
+  aio->buffer = dop->dataBuffer;
+  aio->bufBytes = numBytes;
+  aio->startRec = dop->bufStartRec;
+  aio->numRecords = numRecs;
+  aio->pending = TRUE;
+  dop->dataBuffer = aio->spare;
+  aio->spare = NULL;
+  pthread_cond_broadcast(&(aio->cond));
+  pthread_mutex_unlock(&(aio->lock));
+  PROF_COUNT(PRC_WRITES, 1);
+  PROF_COUNT(PRC_WRITE_BYTES, numRecs * dop->recordSize);
+
+  recordNr += numRecs;
+  if(recordNr > dop->numRecords)
+    dop->numRecords = recordNr;
+  dop->bufStartRec += numRecs;
+  dop->bufNumRecs = 0;
+  dop->bufNeedsSave = FALSE;
+  return(numRecs);
+}
+
+/*DOC
+
+Function 'aioFetch'
+
+Copies "numRecords" records starting at the absolute record number
+"recordNr" from the data read ahead by the background reader of the
+data object pointed to by "dop" (see aioStartReader()) to "buffer",
+after waiting for a pending read to complete.
+Returns "numRecords" if the records were available, 0 if not (they
+then have to be read from file) and -1 upon error.
+
+Note:
+ - This function is called by asspFLoad(); there should be no need
+   to call it directly.
+
+DOC*/
+
+long aioFetch(DOBJ *dop, long recordNr, void *buffer, long numRecords)
+{
+  long   numCopy;
+  size_t recSize;
+  AIO_STATE *aio;
+
+  if(dop == NULL || buffer == NULL || numRecords < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "aioFetch");
+    return(-1);
+  }
+  aio = (AIO_STATE *)(dop->aio);
+  if(aio == NULL || !aio->reader)
+    return(aioSync(dop));                     /* read from file then */
+  recSize = dop->recordSize;
+  numCopy = 0;
+  pthread_mutex_lock(&(aio->lock));
+  while(aio->pending)
+    pthread_cond_wait(&(aio->cond), &(aio->lock));
+  if(numRecords > 0 && recordNr >= aio->startRec &&\
+     recordNr + numRecords <= aio->startRec + aio->numRead) {
+    memcpy(buffer, (char *)(aio->buffer) +\
+	   (size_t)(recordNr - aio->startRec) * recSize,\
+	   (size_t)numRecords * recSize);
+    numCopy = numRecords;
+  }
+  pthread_mutex_unlock(&(aio->lock));
+  if(numCopy > 0) {
+    PROF_COUNT(PRC_READS, 1);
+    PROF_COUNT(PRC_READ_BYTES, numCopy * recSize);
+  }
+  return(numCopy);
+}
+
+/*DOC
+
+Function 'aioPrefetch'
+
+Lets the background reader of the data object pointed to by "dop" (see
+aioStartReader()) read ahead after "numRecords" records starting at
+the absolute record number "recordNr" have been loaded. The records to
+be loaded next are assumed to lie at the same distance from this load
+as this one from the previous load, or to follow this load directly.
+As many records will be read as fit in the data buffer of "dop".
+Has no effect if the data object has no background reader.
+
+Note:
+ - This function is called by asspFLoad(); there should be no need
+   to call it directly.
+
+DOC*/
+
+void aioPrefetch(DOBJ *dop, long recordNr, long numRecords)
+{
+  long   nextRec, eofRecNr, numRead;
+  size_t numBytes;
+  AIO_STATE *aio;
+
+  if(dop == NULL || dop->aio == NULL || dop->maxBufRecs < 1)
+    return;
+  aio = (AIO_STATE *)(dop->aio);
+  if(!aio->reader)
+    return;
+  if(aio->lastRec >= 0 && recordNr > aio->lastRec)
+    nextRec = recordNr + (recordNr - aio->lastRec);
+  else
+    nextRec = recordNr + numRecords;
+  aio->lastRec = recordNr;
+  eofRecNr = dop->startRecord + dop->numRecords;
+  if(numRecords < 1 || nextRec >= eofRecNr)
+    return;
+  numRead = dop->maxBufRecs;
+  if(numRead > eofRecNr - nextRec)
+    numRead = eofRecNr - nextRec;
+  numBytes = (size_t)(dop->maxBufRecs) * dop->recordSize;
+  pthread_mutex_lock(&(aio->lock));
+  while(aio->pending)
+    pthread_cond_wait(&(aio->cond), &(aio->lock));
+  if(aio->buffer != NULL && aio->bufBytes != numBytes) {
+    free(aio->buffer);
+    aio->buffer = NULL;
+  }
+  if(aio->buffer == NULL) {
+    aio->buffer = malloc(numBytes);
+    aio->bufBytes = numBytes;
+  }
+  aio->numRead = 0;
+  if(aio->buffer != NULL) {        /* else simply don't read ahead */
+    aio->startRec = nextRec;
+    aio->numRecords = numRead;
+    aio->pending = TRUE;
+    pthread_cond_broadcast(&(aio->cond));
+  }
+  pthread_mutex_unlock(&(aio->lock));
+  return;
+}
+
+/*DOC
+
+Function 'aioSync'
+
+Waits until the background thread of the data object pointed to by
+"dop" (if any) has completed all reads or writes handed over to it.
+Returns 0 if all writes were successful and -1 otherwise.
+
+DOC*/
+
+int aioSync(DOBJ *dop)
+{
+  int err;
+  AIO_STATE *aio;
+
+  if(dop == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "aioSync");
+    return(-1);
+  }
+  if(dop->aio == NULL)
+    return(0);
+  aio = (AIO_STATE *)(dop->aio);
+  pthread_mutex_lock(&(aio->lock));
+  while(aio->pending)
+    pthread_cond_wait(&(aio->cond), &(aio->lock));
+  err = 0;
+  if(aio->msgNum != 0) {
+    setAsspMsg(aio->msgNum, aio->message);
+    err = -1;
+  }
+  pthread_mutex_unlock(&(aio->lock));
+  return(err);
+}
+
+/*DOC
+
+Function 'aioStop'
+
+Terminates the background thread of the data object pointed to by
+"dop" (if any) after it has completed all reads or writes handed over
+to it, and frees its memory. Call aioSync() first if you need to know
+whether the writes were successful.
+
+Note:
+ - This function is called by asspFClose() and clearDObj().
+
+DOC*/
+
+void aioStop(DOBJ *dop)
+{
+  AIO_STATE *aio;
+
+  if(dop == NULL || dop->aio == NULL)
+    return;
+  aio = (AIO_STATE *)(dop->aio);
+  pthread_mutex_lock(&(aio->lock));
+  aio->quit = TRUE;
+  pthread_cond_broadcast(&(aio->cond));
+  pthread_mutex_unlock(&(aio->lock));
+  pthread_join(aio->tid, NULL);
+  pthread_cond_destroy(&(aio->cond));
+  pthread_mutex_destroy(&(aio->lock));
+  if(aio->buffer != NULL)
+    free(aio->buffer);
+  if(aio->spare != NULL)
+    free(aio->spare);
+  free((void *)aio);
+  dop->aio = NULL;
+  return;
+}
+
+/***********************************************************************
+* set up the state and start the thread for "dop"                      *
+***********************************************************************/
+LOCAL int startThread(DOBJ *dop, int reader)
+{
+  AIO_STATE *aio;
+
+  aio = (AIO_STATE *)calloc(1, sizeof(AIO_STATE));
+  if(aio == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "(aioStart...)");
+    return(-1);
+  }
+  aio->dop = dop;
+  aio->reader = reader;
+  aio->pending = aio->quit = FALSE;
+  aio->buffer = aio->spare = NULL;
+  aio->numRead = 0;
+  aio->lastRec = -1;
+  aio->msgNum = 0;
+  pthread_mutex_init(&(aio->lock), NULL);
+  pthread_cond_init(&(aio->cond), NULL);
+  if(pthread_create(&(aio->tid), NULL, ioThread, (void *)aio) != 0) {
+    pthread_cond_destroy(&(aio->cond));
+    pthread_mutex_destroy(&(aio->lock));
+    free((void *)aio);
+    setAsspMsg(AEG_ERR_APPL, "aioStart...: can't create thread");
+    return(-1);
+  }
+  dop->aio = (void *)aio;
+  return(0);
+}
+
+/***********************************************************************
+* Thread function: write the buffers handed over by aioWrite() or read *
+* ahead as requested by aioPrefetch() until told to quit.              *
+***********************************************************************/
+LOCAL void *ioThread(void *arg)
+{
+  int err;
+  AIO_STATE *aio;
+
+  aio = (AIO_STATE *)arg;
+  pthread_mutex_lock(&(aio->lock));
+  while(TRUE) {
+    while(!aio->pending && !aio->quit)
+      pthread_cond_wait(&(aio->cond), &(aio->lock));
+    if(!aio->pending)                           /* quit and all done */
+      break;
+    pthread_mutex_unlock(&(aio->lock));
+    if(aio->reader) {
+      readAhead(aio);
+      pthread_mutex_lock(&(aio->lock));
+    }
+    else {
+      err = writeBuffer(aio);
+      memset(aio->buffer, 0, aio->bufBytes);     /* ready for re-use */
+      pthread_mutex_lock(&(aio->lock));
+      if(err < 0 && aio->msgNum == 0) {
+	aio->msgNum = asspMsgNum;
+	strcpy(aio->message, applMessage);
+      }
+      if(aio->spare != NULL)               /* can't be: be safe though */
+	free(aio->spare);
+      aio->spare = aio->buffer;
+      aio->spareBytes = aio->bufBytes;
+      aio->buffer = NULL;
+    }
+    aio->pending = FALSE;
+    pthread_cond_broadcast(&(aio->cond));
+  }
+  pthread_mutex_unlock(&(aio->lock));
+  return(NULL);
+}
+
+/***********************************************************************
+* swap and write the buffer handed over (cf. asspFFlush()); messages   *
+* are set in the thread's own message buffer                           *
+***********************************************************************/
+LOCAL int writeBuffer(AIO_STATE *aio)
+{
+  long     offset;
+  size_t   numWrite;
+  ENDIAN   sysEndian={MSB};
+  DOBJ    *dop;
+
+  dop = aio->dop;
+  if(DIFFENDIAN(dop->fileEndian, sysEndian)) {
+    if(swapRecords(dop, aio->buffer, aio->numRecords) < 0)
+      return(-1);
+  }
+  if(dop->blk != NULL) {       /* compressed in this thread, appended */
+    if(blkSeek(dop, aio->startRec - dop->startRecord) < 0 ||\
+       blkWrite(dop, aio->buffer, aio->numRecords) < 0)
+      return(-1);
+    return(0);
+  }
+  offset = dop->headerSize +\
+    (aio->startRec - dop->startRecord) * (long)(dop->recordSize);
+  if(fseek(dop->fp, offset, SEEK_SET) != 0) {
+    setAsspMsg(AEF_ERR_SEEK, dop->filePath);
+    return(-1);
+  }
+  clearerr(dop->fp);
+  numWrite = fwrite(aio->buffer, dop->recordSize,\
+		    (size_t)(aio->numRecords), dop->fp);
+  if((long)numWrite != aio->numRecords || ferror(dop->fp)) {
+    setAsspMsg(AEF_ERR_WRIT, dop->filePath);
+    return(-1);
+  }
+  fflush(dop->fp);
+  return(0);
+}
+
+/***********************************************************************
+* read the requested records into the read-ahead buffer and swap them; *
+* upon error nothing is available (the records will then be read       *
+* again by asspFLoad() which reports the error)                        *
+***********************************************************************/
+LOCAL void readAhead(AIO_STATE *aio)
+{
+  long     offset, numRead;
+  ENDIAN   sysEndian={MSB};
+  DOBJ    *dop;
+
+  dop = aio->dop;
+  if(dop->blk != NULL) {   /* also decompressed in this thread */
+    if(blkSeek(dop, aio->startRec - dop->startRecord) < 0)
+      return;
+    numRead = blkRead(dop, aio->buffer, aio->numRecords);
+    if(numRead < 0)
+      return;
+  }
+  else if(dop->flac != NULL) {  /* decoded in this thread */
+    if(flacSeek(dop, aio->startRec - dop->startRecord) < 0)
+      return;
+    numRead = flacRead(dop, aio->buffer, aio->numRecords);
+    if(numRead < 0)
+      return;
+  }
+  else {
+    offset = dop->headerSize +\
+      (aio->startRec - dop->startRecord) * (long)(dop->recordSize);
+    if(fseek(dop->fp, offset, SEEK_SET) != 0)
+      return;
+    clearerr(dop->fp);
+    numRead = (long)fread(aio->buffer, dop->recordSize,\
+			  (size_t)(aio->numRecords), dop->fp);
+    if(ferror(dop->fp))
+      return;
+  }
+  if(DIFFENDIAN(dop->fileEndian, sysEndian)) {
+    if(swapRecords(dop, aio->buffer, numRead) < 0)
+      return;
+  }
+  aio->numRead = numRead;
+  return;
+}
@@ -0,0 +1,52 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     asspaio.h                                                  *
+* Contents: Prototypes for the asynchronous (background thread) file   *
+*           I/O of data objects: writing and reading ahead.            *
+*                                                                      *
+***********************************************************************/
+
+#ifndef _ASSPAIO_H
+#define _ASSPAIO_H
+
+#include <dlldef.h>   /* ASSP_EXTERN */
+#include <dataobj.h>  /* DOBJ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * prototypes of functions in asspaio.c
+ */
+ASSP_EXTERN int  aioStartWriter(DOBJ *dop);
+ASSP_EXTERN int  aioStartReader(DOBJ *dop);
+ASSP_EXTERN long aioWrite(DOBJ *dop);
+ASSP_EXTERN long aioFetch(DOBJ *dop, long recordNr, void *buffer,\
+			  long numRecords);
+ASSP_EXTERN void aioPrefetch(DOBJ *dop, long recordNr, long numRecords);
+ASSP_EXTERN int  aioSync(DOBJ *dop);
+ASSP_EXTERN void aioStop(DOBJ *dop);
+
+#ifdef __cplusplus
+} /* closing brace for extern "C" */
+#endif
+
+#endif /* _ASSPAIO_H */
@@ -33,7 +33,7 @@
 
 #include <stdio.h>     /* NULL */
 #include <stdlib.h>    /* calloc() free() */
-#include <string.h>    /* memset() strcpy() strchr() */
+#include <string.h>    /* memset() memcpy() memmove() strcpy() */
 
 #include <miscdefs.h>  /* TRUE FALSE */
 #include <asspmess.h>  /* error message handler */
@@ -41,7 +41,16 @@
 #include <asspana.h>   /* AOPTS ATIME */
 #include <asspdsp.h>   /* wfunc_e wfType() wfSpecs() */
 #include <asspfio.h>   /* AFO_READ */
-#include <dataobj.h>   /* DOBJ */
+#include <dataobj.h>   /* DOBJ allocDObj() copyDObj() allocDataBuf() */
+
+/*
+ * prototypes of private functions
+ */
+LOCAL long frameBegSn(ASTREAM *sp, long frameNr);
+LOCAL int  appendSmps(ASTREAM *sp, void *samples, long numSmps);
+LOCAL long computeFrames(ASTREAM *sp, long endFrameNr);
+LOCAL long spliceFrames(DOBJ *anaDOp, DOBJ *newDOp, long numAgree,\
+			int atBegin, int atEnd, int *converged);
 
 /*DOC
 
@@ -364,3 +373,467 @@ int checkDataBufs(DOBJ *smpDOp, DOBJ *anaDOp, long frameSamples,\
   }
   return(0);
 }
+
+/*DOC
+
+Function 'anaStreamOpen'
+
+Sets up a push-mode analysis of an audio signal of unknown length, e.g. 
+samples arriving from a capture device or a decoder. "create" and 
+"compute" are the creation and computation functions of one of the 
+frame-based analyses (e.g. 'createRMS' and 'computeRMS'). 
+The audio object pointed to by "smpDOp" only serves to describe the 
+samples that will be passed to 'anaStreamPush' (sampling rate, data 
+format, number of channels); it need not contain data nor refer to a 
+file. The analysis parameters are taken from the structure pointed to 
+by "aoPtr" except for the analysis interval: the analysis always starts 
+at the first sample pushed and ends at the last one.
+Returns a pointer to the stream structure or NULL upon error. Its item 
+'anaDOp' points to the data object that receives the analysis results; 
+this object belongs to the stream and is freed by 'anaStreamClose'.
+
+Note:
+ - The results are identical to those of the computation function for 
+   the same samples held in memory. The analyses with tracking over 
+   frames (FMT, MHS) carry their tracking state from one push to the 
+   next; only one of these can be in push mode at a time.
+
+DOC*/
+
+ASTREAM *anaStreamOpen(DOBJ *smpDOp, AOPTS *aoPtr, ANAcreateFunc create,\
+		       ANAcomputeFunc compute)
+{
+  long      numRecords;
+  ASTREAM  *sp;
+  FRAME_GD *gd;
+
+  if(smpDOp == NULL || aoPtr == NULL || create == NULL || compute == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "anaStreamOpen");
+    return(NULL);
+  }
+  if(smpDOp->recordSize <= 0) {
+    setAsspMsg(AEB_BAD_CALL, "anaStreamOpen: invalid audio object");
+    return(NULL);
+  }
+  if(aoPtr->options & AOPT_USE_CTIME) {
+    setAsspMsg(AEB_BAD_CALL, "anaStreamOpen: no single-frame analysis");
+    return(NULL);
+  }
+  sp = (ASTREAM *)calloc(1, sizeof(ASTREAM));
+  if(sp == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "(anaStreamOpen)");
+    return(NULL);
+  }
+  sp->compute = compute;
+  if((sp->anaDOp=create(smpDOp, aoPtr)) == NULL) {
+    free((void *)sp);
+    return(NULL);
+  }
+  gd = (FRAME_GD *)(sp->anaDOp->generic);
+  gd->options |= AOPT_STREAM;
+  gd->begFrameNr = gd->endFrameNr = 0;
+  sp->anaDOp->startRecord = sp->anaDOp->numRecords = 0;
+  sp->frameSize = gd->frameSize;
+  sp->frameShift = sp->anaDOp->frameDur;
+  numRecords = ANA_BUF_BYTES / smpDOp->recordSize;
+  if(numRecords < sp->frameSize + 2 * ASTREAM_GUARD + sp->frameShift)
+    numRecords = sp->frameSize + 2 * ASTREAM_GUARD + sp->frameShift;
+  sp->bufDOp = allocDObj();
+  if(sp->bufDOp == NULL || copyDObj(sp->bufDOp, smpDOp) < 0 ||\
+     allocDataBuf(sp->bufDOp, numRecords) == NULL) {
+    anaStreamClose(sp);
+    return(NULL);
+  }
+  sp->bufDOp->startRecord = sp->bufDOp->numRecords = 0;
+  return(sp);
+}
+
+/*DOC
+
+Function 'anaStreamPush'
+
+Passes the next "numSmps" samples of the signal in the buffer pointed 
+to by "samples" to the push-mode analysis "sp". The samples should be 
+stored as records in the format described by the audio object given to 
+'anaStreamOpen', in native byte order. 
+All frames lying completely within the samples pushed so far will be 
+computed. The data buffer of the analysis object 'sp->anaDOp' is 
+emptied at each call; upon return it holds the newly completed frames, 
+starting at frame number 'bufStartRec'. For MHS these may lag behind 
+the input by the delay of the pitch tracking.
+Returns the number of new frames or -1 upon error. In the latter case 
+the stream can only be closed.
+
+DOC*/
+
+long anaStreamPush(ASTREAM *sp, void *samples, long numSmps)
+{
+  long endFrameNr;
+
+  if(sp == NULL || numSmps < 0 || (numSmps > 0 && samples == NULL)) {
+    setAsspMsg(AEB_BAD_ARGS, "anaStreamPush");
+    return(-1);
+  }
+  if(sp->finished) {
+    setAsspMsg(AEB_BAD_CALL, "anaStreamPush: stream already flushed");
+    return(-1);
+  }
+  sp->anaDOp->bufNumRecs = 0;          /* previous frames handed over */
+  if(numSmps == 0)
+    return(0);
+  if(appendSmps(sp, samples, numSmps) < 0)
+    return(-1);
+  endFrameNr = sp->nextFrameNr;
+  while(frameBegSn(sp, endFrameNr) + sp->frameSize + 2 * ASTREAM_GUARD\
+	<= sp->numSmps)
+    endFrameNr++;
+  return(computeFrames(sp, endFrameNr));
+}
+
+/*DOC
+
+Function 'anaStreamFlush'
+
+Terminates the push-mode analysis "sp". The analysis interval is closed 
+at the last frame of the samples pushed, as in the computation function 
+for a signal in memory: the last frames are completed with zeros. The 
+remaining frames are returned in the data buffer of the analysis object 
+as in 'anaStreamPush'. Thereafter, samples can no longer be pushed.
+Returns the number of new frames or -1 upon error.
+
+DOC*/
+
+long anaStreamFlush(ASTREAM *sp)
+{
+  if(sp == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "anaStreamFlush");
+    return(-1);
+  }
+  if(sp->finished) {
+    setAsspMsg(AEB_BAD_CALL, "anaStreamFlush: stream already flushed");
+    return(-1);
+  }
+  sp->finished = TRUE;
+  sp->anaDOp->bufNumRecs = 0;
+  ((FRAME_GD *)(sp->anaDOp->generic))->options &= ~AOPT_STREAM;
+  if(sp->numSmps <= 0)
+    return(0);
+  return(computeFrames(sp, SMPNRtoFRMNR(sp->numSmps, sp->frameShift)));
+}
+
+/*DOC
+
+Function 'anaStreamClose'
+
+Frees all memory allocated for the push-mode analysis "sp", including 
+the analysis data object. A stream that has not been flushed is 
+discarded without computing the remaining frames.
+
+DOC*/
+
+void anaStreamClose(ASTREAM *sp)
+{
+  if(sp != NULL) {
+    if(!sp->finished && sp->nextFrameNr > 0) {
+      /* let a tracking analysis release its state */
+      ((FRAME_GD *)(sp->anaDOp->generic))->options &= ~AOPT_STREAM;
+      computeFrames(sp, sp->nextFrameNr);
+    }
+    if(sp->anaDOp != NULL)
+      freeDObj(sp->anaDOp);
+    if(sp->bufDOp != NULL)
+      freeDObj(sp->bufDOp);
+    free((void *)sp);
+  }
+  return;
+}
+
+/*DOC
+
+Function 'anaUpdate'
+
+Recomputes part of an existing analysis after the audio signal has been 
+changed between "begTime" and "endTime" (in seconds), e.g. by an edit 
+that did not alter its length. "anaDOp" must refer to the output file 
+of the original analysis, opened with 'asspFOpen' in AFO_UPDATE mode. 
+"smpDOp" refers to the changed signal and "aoPtr" holds the analysis 
+parameters used originally. "create", "verify" and "compute" are the 
+creation, verification and computation functions of the analysis (e.g. 
+'createRMS', 'verifyRMS' and 'computeRMS'). 
+The verification function checks that the file is compatible with the 
+analysis parameters; in addition, the file must hold the complete 
+analysis interval of the signal. Then the frames whose window overlaps 
+the changed interval are recomputed and written over the corresponding 
+records in the file. 
+For analyses that track over frames, "context" (in seconds) should be 
+set to a positive value. The frames within that distance from the 
+changed interval are then recomputed as well but only those that 
+differ from the records in the file are written. This requires that 
+the new results join up with the existing ones: at either side, they 
+must agree over at least half the context. Otherwise the context is 
+doubled and the computation repeated, up to a complete analysis. 
+With "context" set to ANA_UPD_ALL (or any negative value) the complete 
+analysis interval is recomputed at once and again only the differing 
+frames are written.
+Returns the number of frames written or -1 upon error.
+
+Note:
+ - The analysis interval in "aoPtr" is modified during the computation 
+   but restored upon return.
+ - Without tracking (ACF, RMS, ZCR) the result is identical to that of 
+   a complete analysis. With a positive context, tracking analyses 
+   only give that result if the tracker does not carry any information 
+   through the stretches in which the results agree. The KSV tracker 
+   may carry it over any distance, so it has to use ANA_UPD_ALL.
+
+DOC*/
+
+long anaUpdate(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *anaDOp,\
+	       ANAcreateFunc create, ANAverifyFunc verify,\
+	       ANAcomputeFunc compute,\
+	       double begTime, double endTime, double context)
+{
+  int    converged;
+  long   size, head, begSn, endSn, numCtx, numWritten;
+  long   chgBegFN, chgEndFN, begFrameNr, endFrameNr;
+  double saveBeg, saveEnd;
+  ATIME  aTime;
+  DOBJ  *newDOp;
+
+  if(smpDOp == NULL || aoPtr == NULL || anaDOp == NULL || create == NULL ||\
+     verify == NULL || compute == NULL || endTime < begTime) {
+    setAsspMsg(AEB_BAD_ARGS, "anaUpdate");
+    return(-1);
+  }
+  if(anaDOp->fp == NULL || (anaDOp->openMode & AFO_UPDATE) != AFO_UPDATE ||\
+     anaDOp->fileData != FDF_BIN || anaDOp->generic != NULL) {
+    setAsspMsg(AEB_BAD_CALL, "anaUpdate");
+    return(-1);
+  }
+  if(aoPtr->options & AOPT_USE_CTIME) {
+    setAsspMsg(AEB_BAD_CALL, "anaUpdate: no single-frame analysis");
+    return(-1);
+  }
+  /* let the verification function check the file header */
+  if((newDOp=create(smpDOp, aoPtr)) == NULL)
+    return(-1);
+  anaDOp->generic = newDOp->generic;
+  anaDOp->doFreeGeneric = newDOp->doFreeGeneric;
+  newDOp->generic = NULL;
+  newDOp->doFreeGeneric = NULL;
+  freeDObj(newDOp);
+  if(verify(anaDOp, smpDOp, aoPtr) < 0)
+    return(-1);
+  if(anaTiming(smpDOp, aoPtr, &aTime) < 0)
+    return(-1);
+  if(anaDOp->startRecord != aTime.begFrameNr ||\
+     anaDOp->numRecords != aTime.endFrameNr - aTime.begFrameNr) {
+    setAsspMsg(AEG_ERR_APPL, "anaUpdate: analysis interval differs "\
+	       "from that in file");
+    return(-1);
+  }
+  /* frame N covers samples N*shift - head ... N*shift - head + size - 1 */
+  size = (aTime.frameSize > 0) ? aTime.frameSize : 0;
+  head = (size > 0) ? FRAMEHEAD(size, aTime.frameShift) : 0;
+  begSn = TIMEtoSMPNR(begTime, aTime.sampFreq) - ASTREAM_GUARD;
+  endSn = TIMEtoSMPNR(endTime, aTime.sampFreq) + ASTREAM_GUARD;
+  chgBegFN = begSn + head - size;
+  if(chgBegFN < 0)
+    chgBegFN = 0;
+  else
+    chgBegFN = chgBegFN / aTime.frameShift + 1;
+  chgEndFN = (endSn + head + aTime.frameShift - 1) / aTime.frameShift;
+  if(context < 0.0)                       /* reach both ends at once */
+    numCtx = aTime.endFrameNr - aTime.begFrameNr + 2;
+  else if(context > 0.0) {
+    numCtx = TIMEtoFRMNR(context, aTime.sampFreq, aTime.frameShift);
+    if(numCtx < 2)
+      numCtx = 2;
+  }
+  else
+    numCtx = 0;
+
+  saveBeg = aoPtr->beginTime;
+  saveEnd = aoPtr->endTime;
+  do {
+    begFrameNr = chgBegFN - numCtx;
+    if(begFrameNr < aTime.begFrameNr)
+      begFrameNr = aTime.begFrameNr;
+    endFrameNr = chgEndFN + numCtx;
+    if(endFrameNr > aTime.endFrameNr)
+      endFrameNr = aTime.endFrameNr;
+    if(begFrameNr >= endFrameNr) {
+      numWritten = 0;
+      break;
+    }
+    aoPtr->beginTime = FRMNRtoTIME(begFrameNr, aTime.sampFreq,\
+				   aTime.frameShift);
+    aoPtr->endTime = FRMNRtoTIME(endFrameNr, aTime.sampFreq,\
+				 aTime.frameShift);
+    newDOp = NULL;
+    if(verify(anaDOp, smpDOp, aoPtr) < 0 ||\
+       (newDOp=compute(smpDOp, aoPtr, NULL)) == NULL) {
+      numWritten = -1;
+      break;
+    }
+    converged = (numCtx == 0);
+    numWritten = spliceFrames(anaDOp, newDOp, numCtx / 2,\
+			      begFrameNr == aTime.begFrameNr,\
+			      endFrameNr == aTime.endFrameNr, &converged);
+    freeDObj(newDOp);
+    numCtx *= 2;
+  } while(numWritten >= 0 && !converged);
+  aoPtr->beginTime = saveBeg;
+  aoPtr->endTime = saveEnd;
+  return(numWritten);
+}
+
+/* ======================= private  functions ======================= */
+
+/***********************************************************************
+* first sample of a frame including the guard samples for head/tail    *
+***********************************************************************/
+LOCAL long frameBegSn(ASTREAM *sp, long frameNr)
+{
+  return(FRMNRtoSMPNR(frameNr, sp->frameShift)\
+	 - FRAMEHEAD(sp->frameSize, sp->frameShift) - ASTREAM_GUARD);
+}
+/***********************************************************************
+* append samples to the sliding buffer; when it is full, discard the   *
+* samples before the first frame still to be computed and enlarge the  *
+* buffer only if that does not make enough room                        *
+***********************************************************************/
+LOCAL int appendSmps(ASTREAM *sp, void *samples, long numSmps)
+{
+  long    keepSn, numKeep, numRecords;
+  size_t  recSize;
+  char   *bPtr;
+  DOBJ   *bufDOp=sp->bufDOp;
+
+  recSize = bufDOp->recordSize;
+  if(bufDOp->bufNumRecs + numSmps > bufDOp->maxBufRecs) {
+    keepSn = frameBegSn(sp, sp->nextFrameNr);
+    if(keepSn > sp->numSmps)
+      keepSn = sp->numSmps;
+    if(keepSn > bufDOp->bufStartRec) {
+      numKeep = sp->numSmps - keepSn;
+      bPtr = (char *)(bufDOp->dataBuffer);
+      memmove(bPtr, &bPtr[(keepSn - bufDOp->bufStartRec) * recSize],\
+	      (size_t)numKeep * recSize);
+      bufDOp->bufStartRec = keepSn;
+      bufDOp->bufNumRecs = numKeep;
+    }
+    if(bufDOp->bufNumRecs + numSmps > bufDOp->maxBufRecs) {
+      numRecords = 2 * bufDOp->maxBufRecs;
+      if(numRecords < bufDOp->bufNumRecs + numSmps)
+	numRecords = bufDOp->bufNumRecs + numSmps;
+      bPtr = (char *)calloc((size_t)numRecords, recSize);
+      if(bPtr == NULL) {
+	setAsspMsg(AEG_ERR_MEM, "(anaStreamPush)");
+	return(-1);
+      }
+      memcpy(bPtr, bufDOp->dataBuffer, (size_t)(bufDOp->bufNumRecs) * recSize);
+      free(bufDOp->dataBuffer);
+      bufDOp->dataBuffer = (void *)bPtr;
+      bufDOp->maxBufRecs = numRecords;
+    }
+  }
+  bPtr = (char *)(bufDOp->dataBuffer);
+  memcpy(&bPtr[bufDOp->bufNumRecs * recSize], samples,\
+	 (size_t)numSmps * recSize);
+  bufDOp->bufNumRecs += numSmps;
+  sp->numSmps += numSmps;
+  bufDOp->numRecords = sp->numSmps;
+  return(0);
+}
+/***********************************************************************
+* compute the frames up to "endFrameNr"; the output buffer must be     *
+* able to hold any frames still pending from previous calls too        *
+***********************************************************************/
+LOCAL long computeFrames(ASTREAM *sp, long endFrameNr)
+{
+  long      numFrames;
+  DOBJ     *anaDOp=sp->anaDOp;
+  FRAME_GD *gd=(FRAME_GD *)(anaDOp->generic);
+
+  if(endFrameNr <= sp->nextFrameNr &&\
+     ((gd->options & AOPT_STREAM) || sp->nextFrameNr <= 0))
+    return(0);
+  numFrames = endFrameNr - sp->outFrameNr;
+  if(numFrames < 1)
+    numFrames = 1;
+  if(anaDOp->maxBufRecs < numFrames) {
+    freeDataBuf(anaDOp);
+    if(allocDataBuf(anaDOp, numFrames) == NULL)
+      return(-1);
+  }
+  anaDOp->bufStartRec = sp->outFrameNr;
+  anaDOp->bufNumRecs = 0;
+  gd->begFrameNr = sp->nextFrameNr;
+  gd->endFrameNr = endFrameNr;
+  if(sp->compute(sp->bufDOp, NULL, anaDOp) == NULL)
+    return(-1);
+  sp->nextFrameNr = endFrameNr;
+  if(anaDOp->bufNumRecs > 0) {
+    sp->outFrameNr = anaDOp->bufStartRec + anaDOp->bufNumRecs;
+    anaDOp->numRecords = sp->outFrameNr;
+  }
+  return(anaDOp->bufNumRecs);
+}
+
+/***********************************************************************
+* write the frames in the data buffer of "newDOp" into the file of     *
+* "anaDOp"; if "converged" is FALSE, only frames differing from those  *
+* in the file are written and only if at least "numAgree" frames agree *
+* at either side (unless the frames reach the begin or end of file)    *
+***********************************************************************/
+LOCAL long spliceFrames(DOBJ *anaDOp, DOBJ *newDOp, long numAgree,\
+			int atBegin, int atEnd, int *converged)
+{
+  char  *oldPtr, *newPtr;
+  long   first, last, n, numRecs;
+  size_t recSize;
+
+  numRecs = newDOp->bufNumRecs;
+  recSize = anaDOp->recordSize;
+  if(newDOp->recordSize != recSize) {
+    setAsspMsg(AEG_ERR_BUG, "anaUpdate: record size differs from file");
+    return(-1);
+  }
+  if(anaDOp->dataBuffer != NULL)
+    freeDataBuf(anaDOp);
+  if(allocDataBuf(anaDOp, numRecs) == NULL)
+    return(-1);
+  anaDOp->bufStartRec = newDOp->bufStartRec;
+  first = 0;
+  last = numRecs;
+  if(!(*converged)) {
+    if(asspFFill(anaDOp) != numRecs)
+      return(-1);
+    oldPtr = (char *)anaDOp->dataBuffer;
+    newPtr = (char *)newDOp->dataBuffer;
+    while(first < numRecs &&\
+	  memcmp(oldPtr + first * recSize, newPtr + first * recSize,\
+		 recSize) == 0)
+      first++;
+    if(first >= numRecs) {                       /* nothing changed */
+      *converged = TRUE;
+      return(0);
+    }
+    while(memcmp(oldPtr + (last-1) * recSize, newPtr + (last-1) * recSize,\
+		 recSize) == 0)
+      last--;
+    if((first < numAgree && !atBegin) || (numRecs - last < numAgree && !atEnd))
+      return(0);                          /* try with larger context */
+    *converged = TRUE;
+  }
+  n = last - first;
+  memcpy(anaDOp->dataBuffer, (char *)newDOp->dataBuffer + first * recSize,\
+	 (size_t)n * recSize);
+  anaDOp->bufStartRec = newDOp->bufStartRec + first;
+  anaDOp->bufNumRecs = n;
+  anaDOp->bufNeedsSave = TRUE;
+  if(asspFFlush(anaDOp, AFW_CLEAR) != n)
+    return(-1);
+  return(n);
+}
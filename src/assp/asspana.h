@@ -60,7 +60,8 @@ DOC*/
 
 #define AOPT_STRLEN 31
 
-#define AOPT_RESERVED  0xFF000000 /* mask for upper byte */
+#define AOPT_RESERVED  0xFF800000 /* mask for upper byte and bit 23 */
+#define AOPT_STREAM    0x00800000 /* push mode: more frames will follow */
 #define AOPT_VERBOSE   0x01000000
 #define AOPT_BATCH     0x02000000 /* batch processing mode */
 #define AOPT_IN_DIR    0x04000000 /* store output in input directory */
@@ -70,7 +71,7 @@ DOC*/
 #define AOPT_USE_CTIME 0x40000000 /* use centre time / event analysis */
 
 typedef struct analysis_options {
-  long   options;        /* for bit flags (upper byte reserved) */
+  long   options;        /* for bit flags (upper 9 bits reserved) */
   double beginTime;      /* times in seconds */
   double endTime;
   double centreTime;     /* for single-frame/event analysis */
@@ -103,6 +104,7 @@ typedef struct analysis_options {
   int    increment;      /* increment/decrement some integral value */
   int    numLevels;      /* for sonagram */
   int    numFormants;
+  int    numFilters;     /* e.g. for filter bank analysis */
   int    precision;      /* e.g. digits precision of ASCII output */
   int    accuracy;       /* e.g. digits accuracy of ASCII output */
   char   type[AOPT_STRLEN+1];   /* hold-all */
@@ -126,12 +128,67 @@ typedef struct analysis_timing {
   long   endFrameNr;
 } ATIME;
 
+/*DOC
+
+The generic data structures of the frame-based analyses (ACF, FMT, MHS,
+LP, RMS, SPECT, ZCR) all start with the items below. This allows the
+push-mode functions to set the analysis interval without knowing the
+type of analysis.
+
+DOC*/
+
+typedef struct frame_analysis_parameters {
+  char ident[GD_MAX_ID_LEN+1]; /* identification string */
+  long options;
+  long frameSize;
+  long begFrameNr;             /* analysis interval in frames */
+  long endFrameNr;
+} FRAME_GD;
+
+/*DOC
+
+This structure holds the state of a push-mode (streaming) analysis set
+up by 'anaStreamOpen'. The samples that have been pushed are kept in a
+sliding buffer from which the analysis function reads its frames with
+'getSmpFrame', exactly as in memory-to-memory processing.
+
+DOC*/
+
+typedef DOBJ *(*ANAcreateFunc)(DOBJ *smpDOp, AOPTS *aoPtr);
+typedef DOBJ *(*ANAcomputeFunc)(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *anaDOp);
+typedef int   (*ANAverifyFunc)(DOBJ *anaDOp, DOBJ *smpDOp, AOPTS *aoPtr);
+
+#define ASTREAM_GUARD (1L) /* covers head/tail samples of all analyses */
+#define ANA_UPD_ALL (-1.0) /* 'anaUpdate' context: complete interval */
+
+typedef struct analysis_stream {
+  ANAcomputeFunc compute;
+  DOBJ *anaDOp;      /* analysis object receiving the frames */
+  DOBJ *bufDOp;      /* sliding buffer with pushed samples (allocated) */
+  long  frameSize;   /* frame size including guard samples */
+  long  frameShift;
+  long  numSmps;     /* number of samples pushed so far */
+  long  nextFrameNr; /* first frame not yet computed */
+  long  outFrameNr;  /* first frame not yet handed over */
+  int   finished;    /* TRUE after 'anaStreamFlush' */
+} ASTREAM;
+
 /*
  * Prototypes of functions in asspana.c.
  */
 ASSP_EXTERN int anaTiming(DOBJ *smpDOp, AOPTS *aoPtr, ATIME *tPtr);
 ASSP_EXTERN int checkDataBufs(DOBJ *smpDOp, DOBJ *anaDOp, long frameSamples,\
 			      long begFrameNr, long endFrameNr);
+ASSP_EXTERN ASTREAM *anaStreamOpen(DOBJ *smpDOp, AOPTS *aoPtr,\
+				   ANAcreateFunc create,\
+				   ANAcomputeFunc compute);
+ASSP_EXTERN long anaStreamPush(ASTREAM *sp, void *samples, long numSmps);
+ASSP_EXTERN long anaStreamFlush(ASTREAM *sp);
+ASSP_EXTERN void anaStreamClose(ASTREAM *sp);
+ASSP_EXTERN long anaUpdate(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *anaDOp,\
+			   ANAcreateFunc create, ANAverifyFunc verify,\
+			   ANAcomputeFunc compute,\
+			   double begTime, double endTime, double context);
 
 /*
  * Include the header files with constants, structures and prototypes 
@@ -66,6 +66,7 @@ extern "C" {
 #define RMS_MIN_AMP 0.1  /* generally well below quantization noise */
 #define RMS_MIN_SQR 0.01 /* squared value, i.e. without Root */
 #define RMS_MIN_dB -20.0 /* corresponding dB value */
+#define RMS_F_LANES 8    /* interleaved partial sums in getRMSf() */
 /* same for LP filter gain */
 #define GAIN_MIN_LIN 0.01
 #define GAIN_MIN_SQR 0.0001 /* squared value, i.e. without Root */
@@ -118,6 +119,8 @@ ASSP_EXTERN int parabola(double y1, double y2, double y3, double dx,\
 			 double *X0ptr, double *Y0ptr, double *Aptr);
 ASSP_EXTERN int bairstow(double *c, double *p, double *q, double *r,\
 			 int M, double *t, BAIRSTOW *term);
+ASSP_EXTERN int aberth(double *c, double *zr, double *zi, int M,\
+		       double *t, BAIRSTOW *term);
 ASSP_EXTERN int hasCCR(double p, double q);
 ASSP_EXTERN double besselI0(double x, double e);
 ASSP_EXTERN double bessi0(double x);
@@ -204,7 +207,11 @@ ASSP_EXTERN double *makeWF(wfunc_e type, long N, int flags);
 ASSP_EXTERN double *makeWF_A(wfunc_e type, double alpha, long N,\
                              int flags);
 ASSP_EXTERN void    mulSigWF(double *s, double *w, long N);
+ASSP_EXTERN double *getWF(wfunc_e type, long N, int flags);
+ASSP_EXTERN double *getWF_A(wfunc_e type, double alpha, long N,\
+                            int flags);
 ASSP_EXTERN void    freeWF(double *w);
+ASSP_EXTERN int     clearWFcache(void);
 ASSP_EXTERN void    listWFs(WFLIST *list, FILE *fp);
 ASSP_EXTERN double  wfCohGain(double *w, long N);
 ASSP_EXTERN double  wfIncGain(double *w, long N);
@@ -300,6 +307,7 @@ ASSP_EXTERN double IIR2filter(FILTER *fip, double sample);
  */
 ASSP_EXTERN int    fft(double *x, long N, int DIRECT);
 ASSP_EXTERN int    rfft(double *x, long N, int DIRECT);
+ASSP_EXTERN int    rfftf(float *x, long N, int DIRECT);
 ASSP_EXTERN void   rfftRe(double *c, double *r, long N);
 ASSP_EXTERN void   rfftIm(double *c, double *r, long N);
 ASSP_EXTERN void   rfftLinAmp(double *c, double *a, long N);
@@ -358,6 +366,8 @@ ASSP_EXTERN int rfc2arf(double *rfc, double *arf, int M);
 ASSP_EXTERN int rfc2lar(double *rfc, double *lar, int M);
 ASSP_EXTERN int rfc2lpc(double *rfc, double *lpc, int M);
 ASSP_EXTERN int lpc2pqp(double *lpc, double *pqp, int M, BAIRSTOW *tPtr);
+ASSP_EXTERN int lpc2pqpAE(double *lpc, double *pqp, int M, BAIRSTOW *tPtr,\
+			    int compat);
 ASSP_EXTERN int ffb2pqp(double *ffb, double *pqp, int N, double sampFreq);
 ASSP_EXTERN int pqp2rfb(double *pqp, double *rfb, int N, double sampFreq);
 ASSP_EXTERN int lpSLA(double *acf, double *lpc, double *normPtr, int M,\
@@ -389,7 +399,11 @@ ASSP_EXTERN double getNormACF(double *s, double *r, long N, int M);
 ASSP_EXTERN int    getCCF(double *a, double *b, double *c, long N, int M);
 ASSP_EXTERN int    getAMDF(double *s, double *c, long N, int minLag, int maxLag);
 ASSP_EXTERN double getZCR(double *s, long N, double sfr);
+ASSP_EXTERN double getZCRf(float *s, long N, double sfr);
+ASSP_EXTERN double getZCRI16(int16_t *s, long N, double sfr);
 ASSP_EXTERN double getRMS(double *s, long N);
+ASSP_EXTERN double getRMSf(float *s, long N);
+ASSP_EXTERN double getRMSI16(int16_t *s, double *wf, long N);
 ASSP_EXTERN double getMaxMag(double *s, long N);
 ASSP_EXTERN long   getMaxMagI16(int16_t *s, long N);
 ASSP_EXTERN double randRPDF(uint32_t *seedPtr);
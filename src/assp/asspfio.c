@@ -45,6 +45,11 @@
 #include <asspfio.h>    /* constants and prototypes */
 #include <dataobj.h>    /* data object definitions and handler */
 #include <headers.h>    /* header definitions and handler */
+#include <asspaio.h>    /* aioStartWriter() aioWrite() aioSync() */
+#include <hdrcache.h>    /* hdrCacheGet() hdrCachePut() */
+#include <blockio.h>    /* blkFree() blkSeek() blkRead() blkWrite() blkFinish() */
+#include <flacdec.h>    /* flacFree() flacSeek() flacTell() flacRead() */
+#include <asspprof.h>   /* PROF_... */
 
 
 /* OS check for printing %llu and %lli*/
@@ -122,8 +127,20 @@ A call in AFO_WRITE mode will in this case result in also writing the
 header corresponding to the specified format to the output file. Some 
 items in the object - like 'fileEndian' and 'headerSize' - may hereby be 
 adjusted. 
-Beware that not all formats have a fixed header size: it may thus not be 
-possible to change the header once data have been written to the file. 
+Beware that not all formats have a fixed header size: it may thus not be
+possible to change the header once data have been written to the file.
+
+If the header cache has been switched on (see hdrCacheSize()), a file
+opened in AFO_READ mode with 'fileFormat' undefined, which has been
+opened before and whose size and modification time did not change
+since, gets its header from the cache instead of having its format
+guessed and its header parsed again.
+
+The data of SSFF files may be stored in compressed blocks (see
+blkEnable() which has to be called before opening a file for writing).
+Such files can be read like others but not opened in update mode.
+The same holds for FLAC files, which are decoded frame by frame when
+their data are read (see flacHeader()); they can't be written.
 
 DOC*/
 
@@ -196,7 +213,16 @@ DOBJ *asspFOpen(char *filePath, int mode, DOBJ *doPtr)
       	setAsspMsg(AEF_ERR_OPEN, filePath);
       	return(NULL);
       }
-      err = getHeader(dop);
+      blkFree(dop);             /* the header tells if data are compressed */
+      flacFree(dop);
+      if(!(mode & AFO_WRITE) && dop->fileFormat <= FF_UNDEF &&\
+	 hdrCacheGet(dop) > 0)
+	err = 0;                    /* header known from an earlier open */
+      else {
+	err = getHeader(dop);
+	if(err == 0 && !(mode & AFO_WRITE))
+	  hdrCachePut(dop);
+      }
       if(err < 0) {
       	fclose(dop->fp);
       	if(dop != doPtr){
@@ -206,6 +232,29 @@ DOBJ *asspFOpen(char *filePath, int mode, DOBJ *doPtr)
       	}
       	return(NULL);
       } /* else retain warning if set */
+      if((dop->blk != NULL || dop->flac != NULL) && (mode & AFO_WRITE)) {
+	fclose(dop->fp);
+	if(dop != doPtr){
+	  freeDObj(dop);
+	} else if(CLEAR) {
+	  clearDObj(dop);
+	}
+	setAsspMsg(AEG_ERR_APPL,\
+		   "asspFOpen: can't update a file with compressed data");
+	return(NULL);
+      }
+      if((mode & AFO_ASYNC) && !(mode & AFO_WRITE) &&\
+	 dop->fileData == FDF_BIN && dop->recordSize > 0) {
+	if(aioStartReader(dop) < 0) {
+	  fclose(dop->fp);
+	  if(dop != doPtr){
+	    freeDObj(dop);
+	  } else if(CLEAR) {
+	    clearDObj(dop);
+	  }
+	  return(NULL);
+	}
+      }
     }
     else if(mode & AFO_WRITE) {                    /* create/truncate */
       if(strcmp(filePath, "stdin") == 0) {
@@ -240,12 +289,22 @@ DOBJ *asspFOpen(char *filePath, int mode, DOBJ *doPtr)
       	return(NULL);
       }
       if(dop == doPtr) {
+	if(dop->blk != NULL &&\
+	   (dop->fileFormat != FF_SSFF || blkEnable(dop, 0) < 0))
+	  blkFree(dop);              /* only SSFF data can be compressed */
       	err = putHeader(dop);
       	if(err < 0) {
       	  fclose(dop->fp);
       	  dop->fp = NULL;
       	  return(NULL);
       	} /* else retain warning if set */
+      	if((mode & AFO_ASYNC) && dop->fileData == FDF_BIN) {
+      	  if(aioStartWriter(dop) < 0) {
+      	    fclose(dop->fp);
+      	    dop->fp = NULL;
+      	    return(NULL);
+      	  }
+      	}
       }
     }
     
@@ -276,16 +335,27 @@ AFC_FREE   As AFC_CLEAR but also free the data object itself. Use
            always if the object was allocated by asspFOpen() and you do 
            not wish to retain it.
 Note that the actions are mutually exclusive.
+Pending writes are completed and block-compressed output gets its block
+index (see blkFinish()) before the file is closed.
 
 DOC*/
 
 int asspFClose(DOBJ *dop, int action)
 {
+  int err;
+
   if(dop == NULL || !(action == AFC_KEEP || action == AFC_CLEAR ||
 	              action == AFC_FREE) ) {
     setAsspMsg(AEB_BAD_ARGS, "asspFClose");
     return(-1);
   }
+  err = 0;
+  if(dop->aio != NULL) {          /* let pending writes complete first */
+    err = aioSync(dop);
+    aioStop(dop);
+  }
+  if(dop->blk != NULL && blkFinish(dop) < 0)  /* append block index */
+    err = -1;
   if(dop->fp != NULL) {
 #ifndef WRASSP
     if(dop->fp != stdout && dop->fp != stderr && dop->fp != stdin)
@@ -302,7 +372,7 @@ int asspFClose(DOBJ *dop, int action)
   else /* AFC_KEEP */
     dop->openMode = AFO_NONE;
 /*   clrAsspMsg(); leave message; may be forced to close before handling */
-  return(0);
+  return(err);
 }
 
 /*DOC
@@ -330,6 +400,8 @@ long asspFSeek(DOBJ *dop, long recordNr)
     setAsspMsg(AEB_BAD_CALL, "asspFSeek");
     return(-1);
   }
+  if(dop->aio != NULL && aioSync(dop) < 0)  /* file position is ours */
+    return(-1);
 
   recordNr -= (dop->startRecord);        /* convert to record in file */
   if(recordNr < 0) {
@@ -340,11 +412,16 @@ long asspFSeek(DOBJ *dop, long recordNr)
     setAsspMsg(AEB_TOO_LATE, "(asspFSeek)");
     return(-1);
   }
+  if(dop->blk != NULL)
+    return(blkSeek(dop, recordNr));
+  if(dop->flac != NULL)
+    return(flacSeek(dop, recordNr));
   offset = dop->headerSize + (recordNr * (long)(dop->recordSize));
   if(fseek(dop->fp, offset, SEEK_SET) != 0) {
     setAsspMsg(AEF_ERR_SEEK, dop->filePath);
     return(-1);
   }
+  PROF_COUNT(PRC_SEEKS, 1);
 /*   clrAsspMsg(); */
   return(recordNr);
 }
@@ -374,7 +451,17 @@ long asspFTell(DOBJ *dop)
     setAsspMsg(AEB_BAD_CALL, "asspFTell");
     return(-1);
   }
+  if(dop->aio != NULL && aioSync(dop) < 0)
+    return(-1);
 
+  if(dop->blk != NULL) {
+    recordNr = blkTell(dop);
+    return(recordNr < 0 ? -1 : recordNr + dop->startRecord);
+  }
+  if(dop->flac != NULL) {
+    recordNr = flacTell(dop);
+    return(recordNr < 0 ? -1 : recordNr + dop->startRecord);
+  }
   bytePos = ftell(dop->fp);
   if(bytePos < 0) {
     setAsspMsg(AEF_ERR_SEEK, dop->filePath);
@@ -407,6 +494,7 @@ DOC*/
 long asspFRead(void *buffer, long numRecords, DOBJ *dop)
 {
   size_t numRead;
+  PROF_DECL(t)
 
   if(dop == NULL || buffer == NULL || numRecords < 0) {
     setAsspMsg(AEB_BAD_ARGS, "asspFRead");
@@ -417,7 +505,18 @@ long asspFRead(void *buffer, long numRecords, DOBJ *dop)
     return(-1);
   }
 
-  if(numRecords > 0) {
+  if(numRecords > 0 && dop->blk != NULL) {
+    PROF_START(t);
+    numRecords = blkRead(dop, buffer, numRecords);
+    PROF_LAP(t, PRF_READ);
+  }
+  else if(numRecords > 0 && dop->flac != NULL) {
+    PROF_START(t);
+    numRecords = flacRead(dop, buffer, numRecords);
+    PROF_LAP(t, PRF_READ);
+  }
+  else if(numRecords > 0) {
+    PROF_START(t);
     clearerr(dop->fp);    /* because we'll have to test on these later */
     numRead = fread(buffer, dop->recordSize, (size_t)numRecords, dop->fp);
     if((numRead == 0 && feof(dop->fp)) || ferror(dop->fp)) {
@@ -425,6 +524,9 @@ long asspFRead(void *buffer, long numRecords, DOBJ *dop)
       return(-1);
     }
     numRecords = (long)numRead;
+    PROF_LAP(t, PRF_READ);
+    PROF_COUNT(PRC_READS, 1);
+    PROF_COUNT(PRC_READ_BYTES, numRead * dop->recordSize);
   }
 /*   clrAsspMsg(); */
   return(numRecords);
@@ -461,6 +563,8 @@ long asspFWrite(void *buffer, long numRecords, DOBJ *dop)
     setAsspMsg(AEB_BAD_CALL, "asspFWrite");
     return(-1);
   }
+  if(dop->blk != NULL)
+    return(blkWrite(dop, buffer, numRecords));
 
   clearerr(dop->fp);     /* because we'll have to test on these later */
   numWrite = fwrite(buffer, dop->recordSize, (size_t)numRecords, dop->fp);
@@ -470,6 +574,8 @@ long asspFWrite(void *buffer, long numRecords, DOBJ *dop)
     return(-1);
   }
   fflush(dop->fp);
+  PROF_COUNT(PRC_WRITES, 1);
+  PROF_COUNT(PRC_WRITE_BYTES, numWrite * dop->recordSize);
 /*   clrAsspMsg(); */
   return(numRecords);
 }
@@ -776,7 +882,6 @@ DOC*/
 long asspFFill(DOBJ *dop)
 {
   long   eofRecNr, numRead;
-  ENDIAN sysEndian={MSB};
 
   if(dop == NULL) {
     setAsspMsg(AEB_BAD_ARGS, "asspFFill");
@@ -801,10 +906,7 @@ long asspFFill(DOBJ *dop)
   if(numRead > (eofRecNr - dop->bufStartRec))
     numRead = eofRecNr - dop->bufStartRec;
   if(numRead > 0) {
-    if(asspFSeek(dop, dop->bufStartRec) < 0) {
-      return(-1);
-    }
-    numRead = asspFRead(dop->dataBuffer, numRead, dop);
+    numRead = asspFLoad(dop, dop->bufStartRec, dop->dataBuffer, numRead);
     if(numRead < 0) {
       dop->bufNumRecs = 0;              /* no valid records in buffer */
       return(-1);
@@ -812,8 +914,50 @@ long asspFFill(DOBJ *dop)
   }
   dop->bufNumRecs = numRead;
   dop->bufNeedsSave = FALSE;
-  if(DIFFENDIAN(dop->fileEndian, sysEndian))
-    swapDataBuf(dop);
+  return(numRead);
+}
+
+/*DOC
+
+Function 'asspFLoad'
+
+Reads "numRecords" records starting at the absolute record number 
+"recordNr" from the file referred to in the data object pointed to by 
+"dop" into "buffer" and converts them to the system's byte order. If 
+the file has been opened with the flag AFO_ASYNC, the records will be 
+taken from those read ahead in the background when possible, and the 
+records presumably needed next will be read ahead (see aioFetch() and 
+aioPrefetch()).
+Returns the number of records actually read (which may be less than 
+"numRecords" at the end of the file) or -1 upon error.
+
+NOTE: This function does not change data object items. 
+
+DOC*/
+
+long asspFLoad(DOBJ *dop, long recordNr, void *buffer, long numRecords)
+{
+  long   numRead;
+  ENDIAN sysEndian={MSB};
+
+  numRead = 0;
+  if(dop->aio != NULL) {
+    numRead = aioFetch(dop, recordNr, buffer, numRecords);
+    if(numRead < 0)
+      return(-1);
+  }
+  if(numRead == 0 && numRecords > 0) {
+    if(asspFSeek(dop, recordNr) < 0)
+      return(-1);
+    if((numRead=asspFRead(buffer, numRecords, dop)) < 0)
+      return(-1);
+    if(DIFFENDIAN(dop->fileEndian, sysEndian)) {
+      if(swapRecords(dop, buffer, numRead) < 0)
+	return(-1);
+    }
+  }
+  if(dop->aio != NULL)
+    aioPrefetch(dop, recordNr, numRead);
   return(numRead);
 }
 
@@ -844,6 +988,7 @@ long asspFFlush(DOBJ *dop, int opts)
   int    swapped;
   long   numWrite, fileRecs, endRecNr;
   ENDIAN sysEndian={MSB};
+  PROF_DECL(t)
 
   if(dop == NULL) {
     setAsspMsg(AEB_BAD_ARGS, "asspFFlush");
@@ -861,6 +1006,17 @@ long asspFFlush(DOBJ *dop, int opts)
 /*     clrAsspMsg(); */
     return(0);
   }
+  PROF_START(t);
+  if(dop->aio != NULL) {
+    if(dop->fileData == FDF_BIN && !(opts & AFW_KEEP) &&\
+       dop->doFreeDataBuf == (DOfreeFunc)free) {
+      numWrite = aioWrite(dop);       /* swap, write and clear in the */
+      PROF_LAP(t, PRF_FLUSH);         /* background; buffer exchanged */
+      return(numWrite);
+    }
+    if(aioSync(dop) < 0)
+      return(-1);
+  }
   swapped = 0;
   if(dop->fileData == FDF_BIN) {
     fileRecs = asspFSeek(dop, dop->bufStartRec);
@@ -899,6 +1055,7 @@ long asspFFlush(DOBJ *dop, int opts)
     dop->bufStartRec += numWrite;                /* update can't harm */
     clearDataBuf(dop);                         /* zeroise data buffer */
   }
+  PROF_LAP(t, PRF_FLUSH);
 /*   clrAsspMsg(); */
   return(numWrite);
 }
@@ -927,7 +1084,6 @@ long recordIndex(DOBJ *dop, long nr, long head, long tail)
   char  *rPtr;
   size_t recSize;
   long   recordNr, eofRecNr, numRead;
-  ENDIAN sysEndian={MSB};
 
   if(TRACE[0]) {
     if(dop == NULL || nr < 0 || head < 0 || tail < 0) {
@@ -963,6 +1119,7 @@ long recordIndex(DOBJ *dop, long nr, long head, long tail)
       setAsspMsg(AEF_NOT_OPEN, dop->filePath);
       return(-1);
     }
+    PROF_COUNT(PRC_REFILLS, 1);
     dop->bufStartRec = recordNr = nr - head;
     dop->bufNumRecs = 0;
     recSize = dop->recordSize;
@@ -973,18 +1130,12 @@ long recordIndex(DOBJ *dop, long nr, long head, long tail)
       (dop->bufNumRecs)++;
       recordNr++;
     }
-    if(asspFSeek(dop, recordNr) < 0)
-      return(-1);
     numRead = dop->maxBufRecs - dop->bufNumRecs;
     if(numRead > (eofRecNr - recordNr))
       numRead = eofRecNr - recordNr;
-    if((numRead=asspFRead(rPtr, numRead, dop)) < 0)
+    if((numRead=asspFLoad(dop, recordNr, rPtr, numRead)) < 0)
       return(-1);
     dop->bufNumRecs += numRead;  /* number of valid records in buffer */
-    if(DIFFENDIAN(dop->fileEndian, sysEndian)) {
-      if(swapDataBuf(dop) < 0)
-	return(-1);
-    }
     rPtr += (numRead * recSize);
     while(dop->bufNumRecs < dop->maxBufRecs && tail > 0) {
       memset(rPtr, 0, recSize);    /* pas with maximally "tail" zeros */
@@ -1028,7 +1179,6 @@ long frameIndex(DOBJ *smpDOp, long nr, long size, long shift,\
   char  *rPtr;
   size_t recSize;
   long   frameSn, begRecNr, recordNr, endRecNr, eofRecNr, numRead;
-  ENDIAN sysEndian={MSB};
 
   if(TRACE[0]) {
     if(smpDOp == NULL || nr < 0 || size < 1 ||\
@@ -1069,6 +1219,7 @@ long frameIndex(DOBJ *smpDOp, long nr, long size, long shift,\
       return(-1);
     }
     /* run a maximum load starting from the required record */
+    PROF_COUNT(PRC_REFILLS, 1);
     smpDOp->bufStartRec = recordNr = begRecNr - head;
     smpDOp->bufNumRecs = 0;             /* no valid records in buffer */
     rPtr = smpDOp->dataBuffer;
@@ -1079,18 +1230,12 @@ long frameIndex(DOBJ *smpDOp, long nr, long size, long shift,\
       recordNr++;
       (smpDOp->bufNumRecs)++;
     }
-    if(asspFSeek(smpDOp, recordNr) < 0)
-      return(-1);
     numRead = smpDOp->maxBufRecs - smpDOp->bufNumRecs; /* get maximum */
     if(numRead > (eofRecNr - recordNr))
       numRead = eofRecNr - recordNr;
-    if((numRead=asspFRead(rPtr, numRead, smpDOp)) < 0)
+    if((numRead=asspFLoad(smpDOp, recordNr, rPtr, numRead)) < 0)
       return(-1);
     smpDOp->bufNumRecs += numRead;
-    if(DIFFENDIAN(smpDOp->fileEndian, sysEndian)) {
-      if(swapDataBuf(smpDOp) < 0)
-	return(-1);
-    }
     rPtr += (numRead * recSize);
     recordNr += numRead;
     while(recordNr < endRecNr) {         /* append zeros (should have */
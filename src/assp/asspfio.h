@@ -51,6 +51,7 @@ extern "C" {
 #define AFO_UPDATE (AFO_READ + AFO_WRITE)
 /* #define AFO_CREATE (0x0004 + AFO_WRITE) */
 #define AFO_TEXT   0x0100  /* we normally set the 'b' flag in fopen() */
+#define AFO_ASYNC  0x0200  /* write or read ahead binary data in the background */
 
 /*
  * constants for 'action' in asspFClose()
@@ -80,6 +81,8 @@ ASSP_EXTERN long  asspFWrite(void *buffer, long numRecords, DOBJ *dop);
 ASSP_EXTERN long  asspFPrint(void *buffer, long startRecord, long numRecords,\
 			     DOBJ *dop, int extra);
 ASSP_EXTERN long  asspFFill(DOBJ *dop);
+ASSP_EXTERN long  asspFLoad(DOBJ *dop, long recordNr, void *buffer,\
+			     long numRecords);
 ASSP_EXTERN long  asspFFlush(DOBJ *dop, int opts);
 ASSP_EXTERN long  recordIndex(DOBJ *dop, long nr, long head, long tail);
 ASSP_EXTERN long  frameIndex(DOBJ *smpDOp, long nr, long size, long shift,\
@@ -42,8 +42,8 @@
 /*
  * global variables
  */
-short asspMsgNum = 0;
-char  applMessage[MAX_MSG_LEN + 1] = {'\0'};
+ASSP_TLS short asspMsgNum = 0;
+ASSP_TLS char  applMessage[MAX_MSG_LEN + 1] = {'\0'};
 AMREC asspMessage[] = {
 /* warnings */
   { AWG_WARN_BUG, "Programming error (please report)" },
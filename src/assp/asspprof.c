@@ -0,0 +1,136 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     asspprof.c                                                 *
+* Contents: Timers and counters for profiling the analysis stages and  *
+*           the file I/O (see asspprof.h for the instrumentation       *
+*           macros).                                                   *
+*                                                                      *
+***********************************************************************/
+
+#include <string.h>   /* memset() */
+#if defined(_WIN32) || defined(WIN32)
+#include <windows.h>  /* QueryPerformanceCounter() */
+#else
+#include <time.h>     /* clock_gettime() */
+#endif
+
+#include <asspprof.h>
+
+/*
+ * global variables
+ */
+ASSP_TLS ASSP_PROF asspProf;
+char *prfTimerName[PRF_NUM_TIMERS] = {
+  "frame", "window", "transform", "solve", "store", "flush", "read"
+};
+char *prfCounterName[PRC_NUM_COUNTERS] = {
+  "frames", "reads", "readBytes", "seeks", "refills", "writes",
+  "writeBytes"
+};
+
+/*DOC
+
+Function 'profClock'
+
+Returns the time in seconds of a monotonic high-resolution clock with
+an arbitrary origin.
+
+DOC*/
+
+double profClock(void)
+{
+#if defined(_WIN32) || defined(WIN32)
+  LARGE_INTEGER freq, count;
+
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return((double)count.QuadPart / (double)freq.QuadPart);
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9);
+#endif
+}
+
+/*DOC
+
+Function 'profLap'
+
+Adds the time elapsed since "*t" to the timer of "stage" and sets "*t"
+to the current time. Use the macro PROF_LAP rather than calling this
+function directly.
+
+DOC*/
+
+void profLap(double *t, prfTimer_e stage)
+{
+  double now;
+
+  now = profClock();
+  asspProf.sec[stage] += (now - *t);
+  asspProf.calls[stage] += 1.0;
+  *t = now;
+  return;
+}
+
+/*DOC
+
+Function 'profReset'
+
+Clears all timers and counters of the calling thread and switches the
+recording on ("active" = TRUE) or off.
+
+Note:
+ - Profiling data are kept per thread. Functions that distribute work
+   over several threads (e.g. 'computeFMTpar') add the data of their
+   worker threads to those of the calling thread.
+ - Recording only takes place if the library has been compiled with
+   ASSP_PROFILE defined.
+
+DOC*/
+
+void profReset(int active)
+{
+  memset((void *)&asspProf, 0, sizeof(ASSP_PROF));
+  asspProf.active = active;
+  return;
+}
+
+/*DOC
+
+Function 'profMerge'
+
+Adds the timers and counters in "src" to those in "dst".
+
+DOC*/
+
+void profMerge(ASSP_PROF *dst, ASSP_PROF *src)
+{
+  int i;
+
+  for(i = 0; i < PRF_NUM_TIMERS; i++) {
+    dst->sec[i] += src->sec[i];
+    dst->calls[i] += src->calls[i];
+  }
+  for(i = 0; i < PRC_NUM_COUNTERS; i++)
+    dst->count[i] += src->count[i];
+  return;
+}
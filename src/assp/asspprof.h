@@ -0,0 +1,113 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     asspprof.h                                                 *
+* Contents: Constants, structures, macros and prototypes for the       *
+*           profiling of the analysis stages and the file I/O.         *
+*                                                                      *
+***********************************************************************/
+
+#ifndef _ASSPPROF_H
+#define _ASSPPROF_H
+
+#include <dlldef.h>   /* ASSP_EXTERN ASSP_TLS */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * timed stages (may nest: 'read' is part of 'frame' if the frame has
+ * to be loaded from file, 'flush' is part of 'store')
+ */
+typedef enum {
+  PRF_FRAME,     /* getting the frame: getSmpFrame(), getSmpView() */
+  PRF_WINDOW,    /* windowing, pre-emphasis */
+  PRF_TRANSFORM, /* FFT, autocorrelation, RMS and zero-crossing kernels */
+  PRF_SOLVE,     /* LP solution, root solving, spectral post-processing */
+  PRF_STORE,     /* storing the results in the output buffer */
+  PRF_FLUSH,     /* asspFFlush() */
+  PRF_READ,      /* asspFRead() */
+  PRF_NUM_TIMERS
+} prfTimer_e;
+
+/*
+ * event counters
+ */
+typedef enum {
+  PRC_FRAMES,      /* frames analysed */
+  PRC_READS,       /* calls to asspFRead() */
+  PRC_READ_BYTES,  /* bytes read by asspFRead() */
+  PRC_SEEKS,       /* calls to asspFSeek() */
+  PRC_REFILLS,     /* input buffer (re)loads in frameIndex() etc. */
+  PRC_WRITES,      /* calls to asspFWrite() */
+  PRC_WRITE_BYTES, /* bytes written by asspFWrite() */
+  PRC_NUM_COUNTERS
+} prfCounter_e;
+
+typedef struct assp_profile {
+  int    active;                  /* recording switched on */
+  double sec[PRF_NUM_TIMERS];     /* accumulated time per stage */
+  double calls[PRF_NUM_TIMERS];   /* number of timed intervals */
+  double count[PRC_NUM_COUNTERS];
+} ASSP_PROF;
+
+/*
+ * Instrumentation macros. They are only compiled in if ASSP_PROFILE
+ * is defined and then only cost a test of 'asspProf.active' unless
+ * profiling has been switched on with 'profReset()'.
+ * A stage timer is declared with PROF_DECL(t) (no semicolon; it must
+ * be placed among the declarations) and started with PROF_START(t);
+ * PROF_LAP(t, stage) adds the time since the start or the previous lap
+ * to "stage" and restarts the timer.
+ */
+#ifdef ASSP_PROFILE
+#define PROF_DECL(t) double t=0.0;
+#define PROF_START(t) do { if(asspProf.active) t = profClock(); } while(0)
+#define PROF_LAP(t, stage) do { if(asspProf.active) profLap(&(t), stage); }\
+                           while(0)
+#define PROF_COUNT(c, n) do { if(asspProf.active)\
+                              asspProf.count[c] += (double)(n); } while(0)
+#else
+#define PROF_DECL(t)
+#define PROF_START(t)
+#define PROF_LAP(t, stage)
+#define PROF_COUNT(c, n)
+#endif
+
+/*
+ * global variables
+ */
+ASSP_EXTERN ASSP_TLS ASSP_PROF asspProf;
+ASSP_EXTERN char *prfTimerName[PRF_NUM_TIMERS];
+ASSP_EXTERN char *prfCounterName[PRC_NUM_COUNTERS];
+
+/*
+ * prototypes of functions in asspprof.c
+ */
+ASSP_EXTERN double profClock(void);
+ASSP_EXTERN void   profLap(double *t, prfTimer_e stage);
+ASSP_EXTERN void   profReset(int active);
+ASSP_EXTERN void   profMerge(ASSP_PROF *dst, ASSP_PROF *src);
+
+#ifdef __cplusplus
+} /* closing brace for extern "C" */
+#endif
+
+#endif /* _ASSPPROF_H */
@@ -365,6 +365,11 @@ long auCapsFF(fform_e fileFormat)
     auCaps |= AUC_MSB_L;
     auCaps |= AUC_CHAN_MASK;
     break;
+  case FF_FLAC: /* input only; decoded to system byte order */
+    auCaps = AUC_I8 | AUC_I16 | AUC_I32;
+    auCaps |= AUC_MSB_X;
+    auCaps |= AUC_CHAN_MASK;
+    break;
   default: /* no audio or not supported */
     auCaps = AUC_NONE;
     break;
@@ -0,0 +1,910 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     blockio.c                                                  *
+* Contents: Block-compressed storage of binary data records. The data  *
+*           are stored in blocks of consecutive records; the bytes of  *
+*           a block are shuffled (all first bytes of the records, then *
+*           all second bytes, ...) and compressed with an in-tree      *
+*           codec producing the LZ4 block format.                      *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>      /* FILE fseek() fread() fwrite() fflush() */
+#include <stdlib.h>     /* malloc() calloc() realloc() free() */
+#include <string.h>     /* memcpy() */
+#include <inttypes.h>   /* uint8_t uint32_t */
+
+#include <miscdefs.h>   /* TRUE FALSE LOCAL */
+#include <asspmess.h>   /* message codes; reference to globals */
+#include <dataobj.h>    /* DOBJ FDF_BIN */
+#include <blockio.h>
+#include <asspprof.h>   /* PROF_COUNT() */
+
+/*
+ * The data area of a file consists of blocks, each starting with a
+ * header of two 32-bit little-endian numbers: the number of records in
+ * the block and the number of data bytes following the header. If the
+ * latter has BLK_RAW_FLAG set, the records are stored as they are
+ * (compression did not pay), otherwise shuffled and compressed. The
+ * records themselves are in the byte order of the file.
+ * The blocks are followed by an index chunk, written when the file is
+ * closed (see blkFinish()):
+ * a block header with 0 records (so that it ends a scan of the blocks),
+ * then the magic BLK_IDX_MAGIC, the number of blocks (32 bits) and of
+ * records (64 bits), for each block the number of its first record and
+ * the byte offset of its header (64 bits each), and finally the offset
+ * of the chunk (64 bits) and the magic again. All numbers are little-
+ * endian. Files without (valid) index are read by scanning the blocks.
+ */
+
+/*
+ * block state of a data object (item 'blk')
+ */
+typedef struct blk_state {
+  long    blockRecs;       /* records per block when writing */
+  long    pos;             /* current record (relative to file start) */
+  long    numRecs;         /* records in the blocks of the file */
+  long    fileEnd;         /* byte offset behind the last block */
+  long    numBlocks;
+  long    maxBlocks;
+  int     idxPending;      /* blocks written after the last index */
+  long   *firstRec;        /* relative number of first record of block */
+  long   *offset;          /* byte offset of block header in file */
+  long    cacheBlock;      /* block held decoded in 'cache' or -1 */
+  long    cacheRecs;
+  uint8_t *cache;          /* decoded records of 'cacheBlock' */
+  size_t  cacheBytes;
+  uint8_t *work;           /* shuffled/compressed data */
+  size_t  workBytes;
+} BLK_STATE;
+
+/*
+ * LZ4 block format parameters
+ */
+#define LZ_HASH_BITS  12
+#define LZ_MIN_MATCH  4
+#define LZ_LAST_LITS  5    /* block ends with at least 5 literals */
+#define LZ_MF_LIMIT   12   /* no match starts in the last 12 bytes */
+#define LZ_MAX_OFFSET 65535L
+#define LZ_BOUND(n)   ((n) + (n) / 255 + 16)
+
+/*
+ * block index
+ */
+#define BLK_IDX_MAGIC "BIDX"
+#define IDX_HEAD_SIZE 16   /* magic, number of blocks and of records */
+#define IDX_ITEM_SIZE 16   /* first record and offset of a block */
+#define IDX_TAIL_SIZE 12   /* offset of the chunk and magic */
+
+/*
+ * prototypes of private functions
+ */
+LOCAL int   addBlock(BLK_STATE *blk, long firstRec, long offset);
+LOCAL long  findBlock(BLK_STATE *blk, long recordNr);
+LOCAL int   loadBlock(DOBJ *dop, BLK_STATE *blk, long blockNr);
+LOCAL int   writeIndex(DOBJ *dop, BLK_STATE *blk);
+LOCAL long  readIndex(DOBJ *dop, BLK_STATE *blk, long fileSize);
+LOCAL int   growBuf(uint8_t **buf, size_t *bufBytes, size_t numBytes);
+LOCAL void  putLE32(uint8_t *ptr, uint32_t val);
+LOCAL uint32_t getLE32(uint8_t *ptr);
+LOCAL void  putLE64(uint8_t *ptr, uint64_t val);
+LOCAL uint64_t getLE64(uint8_t *ptr);
+LOCAL void  shuffle(uint8_t *src, uint8_t *dst, long numRecs, size_t recSize);
+LOCAL void  unshuffle(uint8_t *src, uint8_t *dst, long numRecs,\
+		      size_t recSize);
+LOCAL long  lzCompress(uint8_t *src, long srcLen, uint8_t *dst, long dstCap);
+LOCAL long  lzDecompress(uint8_t *src, long srcLen, uint8_t *dst,\
+			 long dstLen);
+
+/*DOC
+
+Function 'blkEnable'
+
+Switches the data object pointed to by "dop" to block-compressed
+storage of its binary data, with "blockRecs" records per block when
+writing (if "blockRecs" is less than 1, an earlier setting is kept or
+blocks will hold about BLK_DEF_BYTES bytes). A block may hold at most
+BLK_MAX_BYTES bytes; the block headers can't describe larger ones (see
+blkWrite()). The table of blocks is
+cleared. For writing, this has to be done before the file is opened
+with asspFOpen(); the SSFF header then marks the data as compressed.
+When reading, the header parser calls this function if the header says
+so.
+The file functions asspFSeek(), asspFTell(), asspFRead() and
+asspFWrite() - and thereby asspFFill(), asspFLoad() and asspFFlush() -
+then use blkSeek(), blkTell(), blkRead() and blkWrite(). Records can
+be read in any order but only appended.
+Returns 0 upon success and -1 upon error.
+
+DOC*/
+
+int blkEnable(DOBJ *dop, long blockRecs)
+{
+  BLK_STATE *blk;
+
+  if(dop == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "blkEnable");
+    return(-1);
+  }
+  if(blockRecs > 0 && dop->recordSize > 0 &&\
+     blockRecs > BLK_MAX_BYTES / (long)(dop->recordSize)) {
+    setAsspMsg(AEG_ERR_APPL, "blkEnable: too many records per block");
+    return(-1);
+  }
+  if(dop->blk == NULL) {
+    blk = (BLK_STATE *)calloc(1, sizeof(BLK_STATE));
+    if(blk == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "blkEnable");
+      return(-1);
+    }
+    blk->cacheBlock = -1;
+    dop->blk = (void *)blk;
+  }
+  else
+    blk = (BLK_STATE *)(dop->blk);
+  if(blockRecs > 0)
+    blk->blockRecs = blockRecs;
+  blk->pos = blk->numRecs = blk->fileEnd = blk->numBlocks = 0;
+  blk->idxPending = FALSE;
+  blk->cacheBlock = -1;
+  return(0);
+}
+
+/*DOC
+
+Function 'blkFree'
+
+Returns the memory of the block state of the data object pointed to by
+"dop" (called by clearDObj()).
+
+DOC*/
+
+void blkFree(DOBJ *dop)
+{
+  BLK_STATE *blk;
+
+  if(dop == NULL || dop->blk == NULL)
+    return;
+  blk = (BLK_STATE *)(dop->blk);
+  if(blk->firstRec != NULL)
+    free((void *)(blk->firstRec));
+  if(blk->offset != NULL)
+    free((void *)(blk->offset));
+  if(blk->cache != NULL)
+    free((void *)(blk->cache));
+  if(blk->work != NULL)
+    free((void *)(blk->work));
+  free((void *)blk);
+  dop->blk = NULL;
+  return;
+}
+
+/*DOC
+
+Function 'blkScan'
+
+Builds the table of blocks of the file opened for reading in the data
+object pointed to by "dop" ('headerSize' and 'recordSize' must have
+been set). If the file ends with a valid block index (see blkWrite()),
+the table is taken from it, so that the time needed does not depend on
+the length of the file. Otherwise, the block headers following the
+file header are read one by one; an incomplete block at the end of the
+file is then ignored.
+Returns the number of records in the file or -1 upon error.
+
+DOC*/
+
+long blkScan(DOBJ *dop)
+{
+  long     offset, fileSize, numRecs, numBytes;
+  uint8_t  head[BLK_HDR_SIZE];
+  BLK_STATE *blk;
+
+  if(dop == NULL || dop->blk == NULL || dop->fp == NULL ||\
+     dop->recordSize < 1) {
+    setAsspMsg(AEB_BAD_CALL, "blkScan");
+    return(-1);
+  }
+  blk = (BLK_STATE *)(dop->blk);
+  blk->numBlocks = blk->numRecs = blk->pos = 0;
+  blk->cacheBlock = -1;
+  if(fseek(dop->fp, 0L, SEEK_END) != 0 || (fileSize=ftell(dop->fp)) < 0) {
+    setAsspMsg(AEF_ERR_SEEK, dop->filePath);
+    return(-1);
+  }
+  numRecs = readIndex(dop, blk, fileSize);
+  if(numRecs != 0)                       /* table complete or error */
+    return(numRecs);
+
+  offset = dop->headerSize;
+  while(offset + BLK_HDR_SIZE <= fileSize &&\
+	fseek(dop->fp, offset, SEEK_SET) == 0 &&\
+	fread(head, 1, BLK_HDR_SIZE, dop->fp) == BLK_HDR_SIZE) {
+    numRecs = (long)getLE32(head);
+    numBytes = (long)(getLE32(&head[4]) & ~BLK_RAW_FLAG);
+    if(numRecs < 1 ||                 /* block index or garbage */
+       offset + BLK_HDR_SIZE + numBytes > fileSize)  /* incomplete */
+      break;
+    if(addBlock(blk, blk->numRecs, offset) < 0)
+      return(-1);
+    blk->numRecs += numRecs;
+    offset += BLK_HDR_SIZE + numBytes;
+  }
+  if(ferror(dop->fp)) {
+    setAsspMsg(AEF_ERR_READ, dop->filePath);
+    return(-1);
+  }
+  clearerr(dop->fp);
+  blk->fileEnd = offset;
+  return(blk->numRecs);
+}
+
+/*DOC
+
+Function 'blkSeek'
+
+Sets the current record of the block-compressed data object pointed to
+by "dop" to "recordNr" (counted from the start of the file, as in
+asspFSeek() after subtracting 'startRecord').
+Returns "recordNr" or -1 upon error.
+
+DOC*/
+
+long blkSeek(DOBJ *dop, long recordNr)
+{
+  if(dop == NULL || dop->blk == NULL || recordNr < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "blkSeek");
+    return(-1);
+  }
+  ((BLK_STATE *)(dop->blk))->pos = recordNr;
+  PROF_COUNT(PRC_SEEKS, 1);
+  return(recordNr);
+}
+
+/*DOC
+
+Function 'blkTell'
+
+Returns the current record of the block-compressed data object pointed
+to by "dop" (counted from the start of the file) or -1 upon error.
+
+DOC*/
+
+long blkTell(DOBJ *dop)
+{
+  if(dop == NULL || dop->blk == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "blkTell");
+    return(-1);
+  }
+  return(((BLK_STATE *)(dop->blk))->pos);
+}
+
+/*DOC
+
+Function 'blkRead'
+
+Reads "numRecords" records from the current record onwards of the
+block-compressed data object pointed to by "dop" into "buffer" and
+advances the current record. The records are in the byte order of the
+file. Only the blocks needed are decompressed; the last one is kept.
+Returns the number of records read (which may be less than requested
+at the end of the file) or -1 upon error.
+
+DOC*/
+
+long blkRead(DOBJ *dop, void *buffer, long numRecords)
+{
+  long    blockNr, numCopy, numDone, first;
+  size_t  recSize;
+  uint8_t *dst;
+  BLK_STATE *blk;
+
+  if(dop == NULL || dop->blk == NULL || buffer == NULL || numRecords < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "blkRead");
+    return(-1);
+  }
+  blk = (BLK_STATE *)(dop->blk);
+  if(numRecords > 0 && blk->pos >= blk->numRecs) {
+    setAsspMsg(AEF_ERR_READ, dop->filePath);
+    return(-1);
+  }
+  recSize = dop->recordSize;
+  dst = (uint8_t *)buffer;
+  numDone = 0;
+  while(numDone < numRecords && blk->pos < blk->numRecs) {
+    blockNr = findBlock(blk, blk->pos);
+    if(loadBlock(dop, blk, blockNr) < 0)
+      return(-1);
+    first = blk->pos - blk->firstRec[blockNr];
+    numCopy = blk->cacheRecs - first;
+    if(numCopy > numRecords - numDone)
+      numCopy = numRecords - numDone;
+    memcpy(dst, blk->cache + (size_t)first * recSize,\
+	   (size_t)numCopy * recSize);
+    dst += (size_t)numCopy * recSize;
+    numDone += numCopy;
+    blk->pos += numCopy;
+  }
+  return(numDone);
+}
+
+/*DOC
+
+Function 'blkWrite'
+
+Appends "numRecords" records from "buffer" (in the byte order of the
+file) to the block-compressed data object pointed to by "dop". The
+current record must be the end of the data. The records are split into
+blocks which are compressed and written. The index of the blocks is
+only written by blkFinish(); until then, the file can be read by
+scanning the blocks (see blkScan()).
+Returns "numRecords" or -1 upon error.
+
+DOC*/
+
+long blkWrite(DOBJ *dop, void *buffer, long numRecords)
+{
+  long     numDone, numRecs, numBytes, blockRecs;
+  size_t   recSize, rawBytes;
+  uint32_t flags;
+  uint8_t  head[BLK_HDR_SIZE], *src, *packed;
+  BLK_STATE *blk;
+
+  if(dop == NULL || dop->blk == NULL || buffer == NULL || numRecords < 0 ||\
+     dop->recordSize < 1) {
+    setAsspMsg(AEB_BAD_ARGS, "blkWrite");
+    return(-1);
+  }
+  blk = (BLK_STATE *)(dop->blk);
+  if(blk->pos != blk->numRecs) {
+    setAsspMsg(AEG_ERR_APPL,\
+	       "compressed data can only be appended to the file");
+    return(-1);
+  }
+  recSize = dop->recordSize;
+  blockRecs = blk->blockRecs;
+  if(blockRecs < 1) {
+    blockRecs = BLK_DEF_BYTES / (long)recSize;
+    if(blockRecs < 1)
+      blockRecs = 1;
+  }
+  if(blockRecs > BLK_MAX_BYTES / (long)recSize) {
+    setAsspMsg(AEG_ERR_APPL, "blkWrite: too many records per block");
+    return(-1);
+  }
+  rawBytes = (size_t)blockRecs * recSize;
+  if(growBuf(&(blk->work), &(blk->workBytes),\
+	     rawBytes + LZ_BOUND(rawBytes)) < 0) {
+    setAsspMsg(AEG_ERR_MEM, "blkWrite");
+    return(-1);
+  }
+  if(blk->fileEnd < dop->headerSize)
+    blk->fileEnd = dop->headerSize;
+  if(fseek(dop->fp, blk->fileEnd, SEEK_SET) != 0) {
+    setAsspMsg(AEF_ERR_SEEK, dop->filePath);
+    return(-1);
+  }
+  clearerr(dop->fp);
+  src = (uint8_t *)buffer;
+  packed = blk->work + rawBytes;
+  for(numDone = 0; numDone < numRecords; numDone += numRecs) {
+    numRecs = numRecords - numDone;
+    if(numRecs > blockRecs)
+      numRecs = blockRecs;
+    rawBytes = (size_t)numRecs * recSize;
+    shuffle(src, blk->work, numRecs, recSize);
+    numBytes = lzCompress(blk->work, (long)rawBytes, packed,\
+			  LZ_BOUND((long)rawBytes));
+    if(numBytes < 0 || numBytes >= (long)rawBytes) {
+      numBytes = (long)rawBytes;              /* store uncompressed */
+      flags = BLK_RAW_FLAG;
+    }
+    else
+      flags = 0;
+    putLE32(head, (uint32_t)numRecs);
+    putLE32(&head[4], (uint32_t)numBytes | flags);
+    if(fwrite(head, 1, BLK_HDR_SIZE, dop->fp) != BLK_HDR_SIZE ||\
+       fwrite(flags ? src : packed, 1, (size_t)numBytes, dop->fp) !=\
+       (size_t)numBytes) {
+      setAsspMsg(AEF_ERR_WRIT, dop->filePath);
+      return(-1);
+    }
+    if(addBlock(blk, blk->numRecs, blk->fileEnd) < 0)
+      return(-1);
+    blk->fileEnd += BLK_HDR_SIZE + numBytes;
+    blk->numRecs += numRecs;
+    blk->pos += numRecs;
+    src += rawBytes;
+    PROF_COUNT(PRC_WRITES, 1);
+    PROF_COUNT(PRC_WRITE_BYTES, BLK_HDR_SIZE + numBytes);
+  }
+  if(numRecords > 0)
+    blk->idxPending = TRUE;
+  fflush(dop->fp);
+  if(ferror(dop->fp)) {
+    setAsspMsg(AEF_ERR_WRIT, dop->filePath);
+    return(-1);
+  }
+  return(numRecords);
+}
+
+/*DOC
+
+Function 'blkFinish'
+
+Writes the index of all blocks behind the last block of the block-
+compressed file opened for writing in the data object pointed to by
+"dop", so that the file can be opened without reading all block headers
+(see blkScan()). This is done once by asspFClose() rather than after
+each write, which would make the number of bytes written grow with the
+square of the number of blocks. Does nothing if no blocks have been
+written since the last call.
+Returns 0 upon success and -1 upon error.
+
+DOC*/
+
+int blkFinish(DOBJ *dop)
+{
+  BLK_STATE *blk;
+
+  if(dop == NULL || dop->blk == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "blkFinish");
+    return(-1);
+  }
+  blk = (BLK_STATE *)(dop->blk);
+  if(!blk->idxPending || dop->fp == NULL)
+    return(0);
+  blk->idxPending = FALSE;
+  if(fseek(dop->fp, blk->fileEnd, SEEK_SET) != 0) {
+    setAsspMsg(AEF_ERR_SEEK, dop->filePath);
+    return(-1);
+  }
+  if(writeIndex(dop, blk) < 0)
+    return(-1);
+  if(fflush(dop->fp) != 0) {
+    setAsspMsg(AEF_ERR_WRIT, dop->filePath);
+    return(-1);
+  }
+  return(0);
+}
+
+/***********************************************************************
+* append a block to the table                                          *
+***********************************************************************/
+LOCAL int addBlock(BLK_STATE *blk, long firstRec, long offset)
+{
+  long  n, *lPtr;
+
+  if(blk->numBlocks >= blk->maxBlocks) {
+    n = (blk->maxBlocks > 0) ? 2 * blk->maxBlocks : 64;
+    lPtr = (long *)realloc(blk->firstRec, (size_t)n * sizeof(long));
+    if(lPtr == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "blockio");
+      return(-1);
+    }
+    blk->firstRec = lPtr;
+    lPtr = (long *)realloc(blk->offset, (size_t)n * sizeof(long));
+    if(lPtr == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "blockio");
+      return(-1);
+    }
+    blk->offset = lPtr;
+    blk->maxBlocks = n;
+  }
+  blk->firstRec[blk->numBlocks] = firstRec;
+  blk->offset[blk->numBlocks] = offset;
+  blk->numBlocks++;
+  return(0);
+}
+
+/***********************************************************************
+* binary search for the block containing "recordNr"                    *
+***********************************************************************/
+LOCAL long findBlock(BLK_STATE *blk, long recordNr)
+{
+  long lo, hi, mid;
+
+  if(blk->cacheBlock >= 0 && recordNr >= blk->firstRec[blk->cacheBlock] &&\
+     recordNr < blk->firstRec[blk->cacheBlock] + blk->cacheRecs)
+    return(blk->cacheBlock);
+  lo = 0;
+  hi = blk->numBlocks - 1;
+  while(lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    if(blk->firstRec[mid] <= recordNr)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return(lo);
+}
+
+/***********************************************************************
+* read and decode a block into the cache                               *
+***********************************************************************/
+LOCAL int loadBlock(DOBJ *dop, BLK_STATE *blk, long blockNr)
+{
+  long     numRecs, numBytes;
+  size_t   rawBytes;
+  uint32_t flags;
+  uint8_t  head[BLK_HDR_SIZE];
+
+  if(blockNr == blk->cacheBlock)
+    return(0);
+  blk->cacheBlock = -1;
+  if(fseek(dop->fp, blk->offset[blockNr], SEEK_SET) != 0) {
+    setAsspMsg(AEF_ERR_SEEK, dop->filePath);
+    return(-1);
+  }
+  if(fread(head, 1, BLK_HDR_SIZE, dop->fp) != BLK_HDR_SIZE) {
+    setAsspMsg(AEF_ERR_READ, dop->filePath);
+    return(-1);
+  }
+  numRecs = (long)getLE32(head);
+  flags = getLE32(&head[4]);
+  numBytes = (long)(flags & ~BLK_RAW_FLAG);
+  if(numRecs != ((blockNr + 1 < blk->numBlocks) ?\
+		 blk->firstRec[blockNr + 1] : blk->numRecs) -\
+     blk->firstRec[blockNr]) {                /* table doesn't match */
+    setAsspMsg(AEF_ERR_FORM, dop->filePath);
+    return(-1);
+  }
+  rawBytes = (size_t)numRecs * dop->recordSize;
+  if(growBuf(&(blk->cache), &(blk->cacheBytes), rawBytes) < 0 ||\
+     growBuf(&(blk->work), &(blk->workBytes), (size_t)numBytes + rawBytes)\
+     < 0) {
+    setAsspMsg(AEG_ERR_MEM, "blockio");
+    return(-1);
+  }
+  if(fread(blk->work, 1, (size_t)numBytes, dop->fp) != (size_t)numBytes) {
+    setAsspMsg(AEF_ERR_READ, dop->filePath);
+    return(-1);
+  }
+  PROF_COUNT(PRC_READS, 1);
+  PROF_COUNT(PRC_READ_BYTES, BLK_HDR_SIZE + numBytes);
+  if(flags & BLK_RAW_FLAG) {
+    if((size_t)numBytes != rawBytes) {
+      setAsspMsg(AEF_ERR_FORM, dop->filePath);
+      return(-1);
+    }
+    memcpy(blk->cache, blk->work, rawBytes);
+  }
+  else {
+    if(lzDecompress(blk->work, numBytes, blk->work + numBytes,\
+		    (long)rawBytes) != (long)rawBytes) {
+      setAsspMsg(AEF_ERR_FORM, dop->filePath);
+      return(-1);
+    }
+    unshuffle(blk->work + numBytes, blk->cache, numRecs, dop->recordSize);
+  }
+  blk->cacheBlock = blockNr;
+  blk->cacheRecs = numRecs;
+  return(0);
+}
+
+/***********************************************************************
+* write the index chunk behind the last block (the file pointer must   *
+* be positioned there)                                                 *
+***********************************************************************/
+LOCAL int writeIndex(DOBJ *dop, BLK_STATE *blk)
+{
+  long     n;
+  size_t   numBytes;
+  uint8_t *ptr;
+
+  numBytes = IDX_HEAD_SIZE + (size_t)(blk->numBlocks) * IDX_ITEM_SIZE +\
+    IDX_TAIL_SIZE;
+  if(growBuf(&(blk->work), &(blk->workBytes), BLK_HDR_SIZE + numBytes)\
+     < 0) {
+    setAsspMsg(AEG_ERR_MEM, "blockio");
+    return(-1);
+  }
+  ptr = blk->work;
+  putLE32(ptr, 0);                                   /* no records */
+  putLE32(ptr + 4, (uint32_t)numBytes);
+  ptr += BLK_HDR_SIZE;
+  memcpy(ptr, BLK_IDX_MAGIC, 4);
+  putLE32(ptr + 4, (uint32_t)(blk->numBlocks));
+  putLE64(ptr + 8, (uint64_t)(blk->numRecs));
+  ptr += IDX_HEAD_SIZE;
+  for(n = 0; n < blk->numBlocks; n++) {
+    putLE64(ptr, (uint64_t)(blk->firstRec[n]));
+    putLE64(ptr + 8, (uint64_t)(blk->offset[n]));
+    ptr += IDX_ITEM_SIZE;
+  }
+  putLE64(ptr, (uint64_t)(blk->fileEnd));
+  memcpy(ptr + 8, BLK_IDX_MAGIC, 4);
+  if(fwrite(blk->work, 1, BLK_HDR_SIZE + numBytes, dop->fp) !=\
+     BLK_HDR_SIZE + numBytes) {
+    setAsspMsg(AEF_ERR_WRIT, dop->filePath);
+    return(-1);
+  }
+  PROF_COUNT(PRC_WRITE_BYTES, BLK_HDR_SIZE + numBytes);
+  return(0);
+}
+
+/***********************************************************************
+* take the table of blocks from the index chunk at the end of the file *
+* returns the number of records, 0 if there is no consistent index     *
+* (the blocks then have to be scanned) or -1 upon error                *
+***********************************************************************/
+LOCAL long readIndex(DOBJ *dop, BLK_STATE *blk, long fileSize)
+{
+  long     offset, numBlocks, numRecs, n, firstRec, blkOffs;
+  size_t   numBytes;
+  uint8_t  tail[IDX_TAIL_SIZE], *ptr;
+
+  if(fileSize < dop->headerSize + BLK_HDR_SIZE + IDX_HEAD_SIZE +\
+     IDX_TAIL_SIZE)
+    return(0);
+  if(fseek(dop->fp, fileSize - IDX_TAIL_SIZE, SEEK_SET) != 0 ||\
+     fread(tail, 1, IDX_TAIL_SIZE, dop->fp) != IDX_TAIL_SIZE) {
+    clearerr(dop->fp);
+    return(0);
+  }
+  offset = (long)getLE64(tail);
+  if(memcmp(tail + 8, BLK_IDX_MAGIC, 4) != 0 ||\
+     offset < dop->headerSize || offset >= fileSize)
+    return(0);
+  numBytes = (size_t)(fileSize - offset);
+  if(growBuf(&(blk->work), &(blk->workBytes), numBytes) < 0) {
+    setAsspMsg(AEG_ERR_MEM, "blockio");
+    return(-1);
+  }
+  if(fseek(dop->fp, offset, SEEK_SET) != 0 ||\
+     fread(blk->work, 1, numBytes, dop->fp) != numBytes) {
+    clearerr(dop->fp);
+    return(0);
+  }
+  ptr = blk->work;
+  numBlocks = (long)getLE32(ptr + BLK_HDR_SIZE + 4);
+  numRecs = (long)getLE64(ptr + BLK_HDR_SIZE + 8);
+  if(getLE32(ptr) != 0 ||\
+     getLE32(ptr + 4) != (uint32_t)(numBytes - BLK_HDR_SIZE) ||\
+     memcmp(ptr + BLK_HDR_SIZE, BLK_IDX_MAGIC, 4) != 0 ||\
+     numBytes != BLK_HDR_SIZE + IDX_HEAD_SIZE +\
+     (size_t)numBlocks * IDX_ITEM_SIZE + IDX_TAIL_SIZE || numBlocks < 1)
+    return(0);
+  ptr += BLK_HDR_SIZE + IDX_HEAD_SIZE;
+  for(n = 0; n < numBlocks; n++) {
+    firstRec = (long)getLE64(ptr);
+    blkOffs = (long)getLE64(ptr + 8);
+    ptr += IDX_ITEM_SIZE;
+    if((n == 0 && (firstRec != 0 || blkOffs != dop->headerSize)) ||\
+       (n > 0 && (firstRec <= blk->firstRec[n - 1] ||\
+		  blkOffs <= blk->offset[n - 1])) ||\
+       firstRec >= numRecs || blkOffs >= offset) {
+      blk->numBlocks = 0;                        /* inconsistent */
+      return(0);
+    }
+    if(addBlock(blk, firstRec, blkOffs) < 0)
+      return(-1);
+  }
+  blk->numRecs = numRecs;
+  blk->fileEnd = offset;
+  return(numRecs);
+}
+
+/***********************************************************************
+* make sure a buffer holds at least "numBytes" bytes                   *
+***********************************************************************/
+LOCAL int growBuf(uint8_t **buf, size_t *bufBytes, size_t numBytes)
+{
+  uint8_t *ptr;
+
+  if(*buf != NULL && *bufBytes >= numBytes)
+    return(0);
+  ptr = (uint8_t *)realloc(*buf, numBytes > 0 ? numBytes : 1);
+  if(ptr == NULL)
+    return(-1);
+  *buf = ptr;
+  *bufBytes = numBytes;
+  return(0);
+}
+
+LOCAL void putLE32(uint8_t *ptr, uint32_t val)
+{
+  ptr[0] = (uint8_t)(val & 0xFF);
+  ptr[1] = (uint8_t)((val >> 8) & 0xFF);
+  ptr[2] = (uint8_t)((val >> 16) & 0xFF);
+  ptr[3] = (uint8_t)((val >> 24) & 0xFF);
+  return;
+}
+
+LOCAL uint32_t getLE32(uint8_t *ptr)
+{
+  return((uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) |\
+	 ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24));
+}
+
+LOCAL void putLE64(uint8_t *ptr, uint64_t val)
+{
+  putLE32(ptr, (uint32_t)(val & 0xFFFFFFFFUL));
+  putLE32(ptr + 4, (uint32_t)(val >> 32));
+  return;
+}
+
+LOCAL uint64_t getLE64(uint8_t *ptr)
+{
+  return((uint64_t)getLE32(ptr) | ((uint64_t)getLE32(ptr + 4) << 32));
+}
+
+/***********************************************************************
+* transpose the bytes of "numRecs" records: byte j of record i goes to *
+* position j * numRecs + i                                             *
+***********************************************************************/
+LOCAL void shuffle(uint8_t *src, uint8_t *dst, long numRecs, size_t recSize)
+{
+  long   i;
+  size_t j;
+
+  for(i = 0; i < numRecs; i++) {
+    for(j = 0; j < recSize; j++)
+      dst[j * (size_t)numRecs + (size_t)i] = *(src++);
+  }
+  return;
+}
+
+LOCAL void unshuffle(uint8_t *src, uint8_t *dst, long numRecs,\
+		     size_t recSize)
+{
+  long   i;
+  size_t j;
+
+  for(i = 0; i < numRecs; i++) {
+    for(j = 0; j < recSize; j++)
+      *(dst++) = src[j * (size_t)numRecs + (size_t)i];
+  }
+  return;
+}
+
+/***********************************************************************
+* compress "srcLen" bytes into the LZ4 block format (greedy parsing    *
+* with a hash table of 4-byte sequences); returns the number of bytes  *
+* in "dst" or -1 if they would exceed "dstCap"                         *
+***********************************************************************/
+LOCAL long lzCompress(uint8_t *src, long srcLen, uint8_t *dst, long dstCap)
+{
+  long     table[1 << LZ_HASH_BITS];
+  long     ip, anchor, ref, op, litLen, matchLen, n, matchLimit;
+  uint32_t seq, hash;
+  uint8_t *token;
+
+  for(n = 0; n < (1 << LZ_HASH_BITS); n++)
+    table[n] = -1;
+  ip = anchor = op = 0;
+  matchLimit = srcLen - LZ_LAST_LITS;
+  while(ip + LZ_MF_LIMIT <= srcLen) {
+    memcpy(&seq, src + ip, 4);
+    hash = (seq * 2654435761U) >> (32 - LZ_HASH_BITS);
+    ref = table[hash];
+    table[hash] = ip;
+    if(ref < 0 || ip - ref > LZ_MAX_OFFSET ||\
+       memcmp(src + ref, src + ip, 4) != 0) {
+      ip++;
+      continue;
+    }
+    matchLen = LZ_MIN_MATCH;
+    while(ip + matchLen < matchLimit &&\
+	  src[ref + matchLen] == src[ip + matchLen])
+      matchLen++;
+    litLen = ip - anchor;
+    if(op + 1 + litLen / 255 + 1 + litLen + 2 +\
+       (matchLen - LZ_MIN_MATCH) / 255 + 1 > dstCap)
+      return(-1);
+    token = dst + op++;
+    if(litLen >= 15) {
+      *token = (uint8_t)(15 << 4);
+      for(n = litLen - 15; n >= 255; n -= 255)
+	dst[op++] = 255;
+      dst[op++] = (uint8_t)n;
+    }
+    else
+      *token = (uint8_t)(litLen << 4);
+    memcpy(dst + op, src + anchor, (size_t)litLen);
+    op += litLen;
+    dst[op++] = (uint8_t)((ip - ref) & 0xFF);
+    dst[op++] = (uint8_t)(((ip - ref) >> 8) & 0xFF);
+    n = matchLen - LZ_MIN_MATCH;
+    if(n >= 15) {
+      *token |= 15;
+      for(n -= 15; n >= 255; n -= 255)
+	dst[op++] = 255;
+      dst[op++] = (uint8_t)n;
+    }
+    else
+      *token |= (uint8_t)n;
+    ip += matchLen;
+    anchor = ip;
+  }
+  litLen = srcLen - anchor;                         /* last literals */
+  if(op + 1 + litLen / 255 + 1 + litLen > dstCap)
+    return(-1);
+  token = dst + op++;
+  if(litLen >= 15) {
+    *token = (uint8_t)(15 << 4);
+    for(n = litLen - 15; n >= 255; n -= 255)
+      dst[op++] = 255;
+    dst[op++] = (uint8_t)n;
+  }
+  else
+    *token = (uint8_t)(litLen << 4);
+  memcpy(dst + op, src + anchor, (size_t)litLen);
+  op += litLen;
+  return(op);
+}
+
+/***********************************************************************
+* decompress an LZ4 block; returns the number of bytes written to      *
+* "dst" or -1 if the data are corrupt                                  *
+***********************************************************************/
+LOCAL long lzDecompress(uint8_t *src, long srcLen, uint8_t *dst,\
+			long dstLen)
+{
+  long    ip, op, litLen, matchLen, offset, n;
+  uint8_t token, b;
+
+  ip = op = 0;
+  while(ip < srcLen) {
+    token = src[ip++];
+    litLen = (long)(token >> 4);
+    if(litLen == 15) {
+      do {
+	if(ip >= srcLen)
+	  return(-1);
+	b = src[ip++];
+	litLen += (long)b;
+      } while(b == 255);
+    }
+    if(ip + litLen > srcLen || op + litLen > dstLen)
+      return(-1);
+    memcpy(dst + op, src + ip, (size_t)litLen);
+    ip += litLen;
+    op += litLen;
+    if(ip >= srcLen)                     /* last sequence: no match */
+      break;
+    if(ip + 2 > srcLen)
+      return(-1);
+    offset = (long)src[ip] | ((long)src[ip + 1] << 8);
+    ip += 2;
+    if(offset == 0 || offset > op)
+      return(-1);
+    matchLen = (long)(token & 15);
+    if(matchLen == 15) {
+      do {
+	if(ip >= srcLen)
+	  return(-1);
+	b = src[ip++];
+	matchLen += (long)b;
+      } while(b == 255);
+    }
+    matchLen += LZ_MIN_MATCH;
+    if(op + matchLen > dstLen)
+      return(-1);
+    if(offset >= matchLen)
+      memcpy(dst + op, dst + op - offset, (size_t)matchLen);
+    else {
+      for(n = 0; n < matchLen; n++)            /* overlapping copy */
+	dst[op + n] = dst[op - offset + n];
+    }
+    op += matchLen;
+  }
+  return(op);
+}
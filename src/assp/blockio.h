@@ -0,0 +1,63 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     blockio.h                                                  *
+* Contents: Constants and prototypes for the block-compressed storage  *
+*           of binary data records (SSFF extension).                   *
+*                                                                      *
+***********************************************************************/
+
+#ifndef _BLOCKIO_H
+#define _BLOCKIO_H
+
+#include <dlldef.h>   /* ASSP_EXTERN */
+#include <dataobj.h>  /* DOBJ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * SSFF header line announcing block-compressed data
+ */
+#define BLK_SSFF_ID    "Compression"
+#define BLK_CODEC_NAME "SHUFFLE_LZ4"
+
+#define BLK_HDR_SIZE   8        /* bytes in header of each block */
+#define BLK_RAW_FLAG   0x80000000UL /* block stored without compression */
+#define BLK_DEF_BYTES  65536L   /* default uncompressed size of a block */
+#define BLK_MAX_BYTES  0x20000000L /* maximum uncompressed size (512 MiB) */
+
+/*
+ * prototypes of functions in blockio.c
+ */
+ASSP_EXTERN int  blkEnable(DOBJ *dop, long blockRecs);
+ASSP_EXTERN void blkFree(DOBJ *dop);
+ASSP_EXTERN long blkScan(DOBJ *dop);
+ASSP_EXTERN long blkSeek(DOBJ *dop, long recordNr);
+ASSP_EXTERN long blkTell(DOBJ *dop);
+ASSP_EXTERN long blkRead(DOBJ *dop, void *buffer, long numRecords);
+ASSP_EXTERN long blkWrite(DOBJ *dop, void *buffer, long numRecords);
+ASSP_EXTERN int  blkFinish(DOBJ *dop);
+
+#ifdef __cplusplus
+} /* closing brace for extern "C" */
+#endif
+
+#endif /* _BLOCKIO_H */
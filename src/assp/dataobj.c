@@ -47,6 +47,10 @@
 #include <dataobj.h>    /* DOBJ DDESC dform_e */
 #include <aucheck.h>    /* AUC_... */
 #include <auconv.h>     /* int24_to_int32() */
+#include <asspaio.h>    /* aioStop() */
+#include <blockio.h>    /* blkFree() */
+#include <flacdec.h>    /* flacFree() */
+#include <asspprof.h>   /* PROF_COUNT() */
 
 
 /*DOC
@@ -97,10 +101,13 @@ DOC*/
 void clearDObj(DOBJ *dop)
 {
   if(dop != NULL) {
+    aioStop(dop);
     freeDDList(dop);
     freeMeta(dop);
     freeGeneric(dop);
     freeDataBuf(dop);
+    blkFree(dop);
+    flacFree(dop);
     initDObj(dop);                              /* now zero all items */
   }
   return;
@@ -189,6 +196,9 @@ void initDObj(DOBJ *dop)
     dop->bufNumRecs = 0;
     dop->bufNeedsSave = FALSE;
     dop->userData = NULL;
+    dop->aio = NULL;
+    dop->blk = NULL;
+    dop->flac = NULL;
   }
   return;
 }
@@ -256,7 +266,7 @@ int copyDObj(DOBJ *dst, DOBJ *src)
     return(-1);
   }
   nextG = (src->meta).next;
-  while(next != NULL) {
+  while(nextG != NULL) {
     genVar = addTSSFF_Generic(dst);
     if(genVar == NULL) {
       clearDObj(dst);
@@ -942,12 +952,6 @@ DOC*/
 
 int swapDataBuf(DOBJ *dop)
 {
-  register uint8_t *rPtr;
-  register size_t   len;
-  register long     n, num;
-  size_t   N;
-  int      size;
-
   if(TRACE[0]) {
     if(dop == NULL) {
       setAsspMsg(AEB_BAD_ARGS, "swapDataBuf");
@@ -958,15 +962,38 @@ int swapDataBuf(DOBJ *dop)
       return(-1);
     }
   }
-  if(dop->dataBuffer == NULL || dop->bufNumRecs < 1 || dop->recordSize < 2)
+  return(swapRecords(dop, dop->dataBuffer, dop->bufNumRecs));
+}
+
+/*DOC
+
+Swaps "numRecords" records in "buffer" which are described by the data 
+descriptor(s) of the data object pointed to by "dop".
+Returns 1 if data successfully swapped, 0 if swapping was not necessary 
+and -1 upon error
+
+Note:
+ - This function only reads the data descriptors of "dop"; it may be 
+   called from a thread other than the one using the data object.
+
+DOC*/
+
+int swapRecords(DOBJ *dop, void *buffer, long numRecords)
+{
+  register uint8_t *rPtr;
+  register size_t   len;
+  register long     n;
+  size_t   N;
+  int      size;
+
+  if(buffer == NULL || numRecords < 1 || dop->recordSize < 2)
     return(0);                                   /* got nothing to do */
   if((size=blockSwap(dop, &N)) < 0)
     return(-1);
-  rPtr = (uint8_t *)(dop->dataBuffer);
+  rPtr = (uint8_t *)buffer;
   if(size < 1) { /* can't swap 'en bloc' */
-    num = dop->bufNumRecs;
     len = dop->recordSize;
-    for(n = 0; n < num; n++) {
+    for(n = 0; n < numRecords; n++) {
       if(swapRecord(dop, rPtr) < 0)
 	return(-1);
       rPtr += len;                      /* set pointer to next record */
@@ -974,7 +1001,7 @@ int swapDataBuf(DOBJ *dop)
     return(1);
   }
   if(size > 1) {
-    memswab(rPtr, rPtr, (size_t)size, N * (size_t)(dop->bufNumRecs));
+    memswab(rPtr, rPtr, (size_t)size, N * (size_t)numRecords);
     return(1);
   }
   return(0); /* size == 1, needs no swapping */
@@ -1818,6 +1845,9 @@ long getSmpCaps(dform_e format)
   long auCaps;
 
   switch(format) {
+  case DF_INT16:
+    auCaps = (0L) | AUC_I16;
+    break;
   case DF_INT32:
     auCaps = (0L) | AUC_I16 | AUC_I24 | AUC_I32;
     break;
@@ -1862,6 +1892,11 @@ Note:
    denormalize them.
  - The function 'getSmpCaps' shows which "format" supports which audio 
    encodings.
+ - With "format" DF_INT16 the samples of 16-bit audio are copied
+   without conversion, e.g. for the kernels in dsputils.c which
+   process them directly.
+ - For sequential, overlapping frames 'getSmpView' avoids converting 
+   and copying the samples of each frame again.
 
 DOC*/
 
@@ -1871,7 +1906,8 @@ int getSmpFrame(DOBJ *smpDOp, long nr, long size, long shift, long head,\
   register size_t   recSize, numChans;
   register long     n, numCopy;
   register uint8_t *u8Ptr;
-  int32_t *lPtr;      /* destination pointers for copy */
+  int16_t *sPtr;      /* destination pointers for copy */
+  int32_t *lPtr;
   float   *fPtr;
   double  *dPtr;
   int16_t *i16Ptr;    /* source pointers for input buffer */
@@ -1884,7 +1920,6 @@ int getSmpFrame(DOBJ *smpDOp, long nr, long size, long shift, long head,\
   long   absBegSn, absEndSn, bufBegSn, bufEndSn;
   long   begSn, endSn, frameSn, numRead;
   DDESC *dd;
-  ENDIAN sysEndian={MSB};
 
   if(TRACE[0]) {
     if(smpDOp == NULL || nr < 0 || size < 1 || shift < 1 ||
@@ -1937,6 +1972,9 @@ int getSmpFrame(DOBJ *smpDOp, long nr, long size, long shift, long head,\
       return(-1);
     }
     switch(format) {
+    case DF_INT16:
+      dstSize = sizeof(int16_t);
+      break;
     case DF_INT32:
       dstSize = sizeof(int32_t);
       break;
@@ -1969,21 +2007,17 @@ int getSmpFrame(DOBJ *smpDOp, long nr, long size, long shift, long head,\
 	return(-1);
       }
       /* reload the data buffer; optimized for sequential access */
+      PROF_COUNT(PRC_REFILLS, 1);
       smpDOp->bufStartRec = begSn;       /* start as late as possible */
-      if(asspFSeek(smpDOp, begSn) < 0)
-	return(-1);
       numRead = smpDOp->maxBufRecs;        /* get as much as possible */
       if(begSn + numRead > absEndSn) {
 	/* NOT CHECKED in asspFRead !! (there may be trailing chunks) */
 	numRead = absEndSn - begSn;
       }
-      if((numRead=asspFRead(smpDOp->dataBuffer, numRead, smpDOp)) < 0)
+      numRead = asspFLoad(smpDOp, begSn, smpDOp->dataBuffer, numRead);
+      if(numRead < 0)
 	return(-1);
       smpDOp->bufNumRecs = numRead;
-      if(DIFFENDIAN(smpDOp->fileEndian, sysEndian)) {
-	if(swapDataBuf(smpDOp) < 0)
-	  return(-1);
-      }
       bufBegSn = begSn;
       bufEndSn = bufBegSn + numRead;
     }
@@ -1998,6 +2032,22 @@ int getSmpFrame(DOBJ *smpDOp, long nr, long size, long shift, long head,\
       offset += ((channel-1) * smpSize);
     u8Ptr = (uint8_t *)(smpDOp->dataBuffer) + offset;
     switch(format) {
+    case DF_INT16:                    /* raw copy of 16-bit samples */
+      sPtr = (int16_t *)frame;
+      if(dd->format != DF_INT16) {
+	setAsspMsg(AED_NOHANDLE, "(getSmpFrame)");
+	return(-1);
+      }
+      i16Ptr = (int16_t *)u8Ptr;
+      if(numChans == 1)
+	memcpy((void *)sPtr, (void *)i16Ptr, numCopy * sizeof(int16_t));
+      else {
+	for(n = 0; n < numCopy; n++) {
+	  *(sPtr++) = *i16Ptr;
+	  i16Ptr += numChans;
+	}
+      }
+      break;
     case DF_INT32:
       lPtr = (int32_t *)frame;
       switch(dd->format) {
@@ -2169,7 +2219,6 @@ void *getSmpPtr(DOBJ *smpDOp, long smpNr, long head, long tail,\
   long     absBegSn, absEndSn, reqBegSn, reqEndSn;
   long     bufBegSn, bufEndSn, copyBegSn, copyEndSn, numRead, numZeros;
   DDESC   *idd, *odd;
-  ENDIAN   sysEndian={MSB};
 
   if(TRACE[0]) {
     if(smpDOp == NULL || smpNr < 0 || head < 0 || tail < 0 ||
@@ -2257,21 +2306,17 @@ void *getSmpPtr(DOBJ *smpDOp, long smpNr, long head, long tail,\
 	  setAsspMsg(AEB_BUF_SPACE, "getSmpPtr: input buffer");
 	  return(NULL);
 	}
+	PROF_COUNT(PRC_REFILLS, 1);
 	smpDOp->bufStartRec = copyBegSn; /* start as late as possible */
-	if(asspFSeek(smpDOp, copyBegSn) < 0)
-	  return(NULL);
 	numRead = smpDOp->maxBufRecs;      /* get as much as possible */
 	if(copyBegSn + numRead > absEndSn) {
 	/* NOT CHECKED in asspFRead !! (there may be trailing chunks) */
 	  numRead = absEndSn - copyBegSn;
 	}
-	if((numRead=asspFRead(smpDOp->dataBuffer, numRead, smpDOp)) < 0)
+	numRead = asspFLoad(smpDOp, copyBegSn, smpDOp->dataBuffer, numRead);
+	if(numRead < 0)
 	  return(NULL);
 	smpDOp->bufNumRecs = numRead;
-	if(DIFFENDIAN(smpDOp->fileEndian, sysEndian)) {
-	  if(swapDataBuf(smpDOp) < 0)
-	    return(NULL);
-	}
       }
     }
     /* check whether requested range would still fit the work buffer */
@@ -2441,3 +2486,126 @@ void *getSmpPtr(DOBJ *smpDOp, long smpNr, long head, long tail,\
   dstPtr = (uint8_t *)(workDOp->dataBuffer) + offset;
   return((void *)dstPtr);
 }
+
+/*DOC
+
+Function 'allocSmpCache'
+
+Allocates a work object for 'getSmpView' which caches the samples of 
+one channel of the audio object pointed to by "smpDOp", converted to 
+the format given by "format". The data buffer of the work object holds 
+SMP_CACHE_FRAMES frames as specified by "size", "shift", "head" and 
+"tail" (see 'getSmpFrame'); each sample is thus converted only once for 
+that many overlapping frames.
+The function returns a pointer to the work object or NULL upon error. 
+The object should be returned with 'freeDObj'.
+
+Note:
+ - The cache is not part of "smpDOp" because audio objects in memory 
+   may be shared by concurrent analyses (see 'computeFMTpar') which 
+   would then have to synchronize their access to it. 
+
+DOC*/
+
+DOBJ *allocSmpCache(DOBJ *smpDOp, long size, long shift, long head,\
+		    long tail, dform_e format)
+{
+  long   numSmps;
+  DOBJ  *cacheDOp;
+  DDESC *dd;
+
+  if(smpDOp == NULL || size < 1 || shift < 1 || head < 0 || tail < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "allocSmpCache");
+    return(NULL);
+  }
+  if(format != DF_INT32 && format != DF_REAL32 && format != DF_REAL64) {
+    setAsspMsg(AEB_BAD_ARGS, "allocSmpCache (invalid target format)");
+    return(NULL);
+  }
+  if((cacheDOp=allocDObj()) == NULL)
+    return(NULL);
+  cacheDOp->sampFreq = smpDOp->sampFreq;
+  cacheDOp->frameDur = 1;
+  dd = &(cacheDOp->ddl);
+  dd->type = DT_SMP;
+  dd->format = format;
+  dd->coding = DC_PCM;
+  dd->numFields = 1;
+  switch(format) {
+  case DF_INT32:
+  case DF_REAL32:
+    dd->numBits = 32;
+    break;
+  default:
+    dd->numBits = 64;
+    break;
+  }
+  setRecordSize(cacheDOp);
+  numSmps = head + size + tail + (SMP_CACHE_FRAMES - 1) * shift;
+  if(allocDataBuf(cacheDOp, numSmps) == NULL)
+    return(freeDObj(cacheDOp));
+  return(cacheDOp);
+}
+
+/*DOC
+
+Function 'getSmpView'
+
+Returns a pointer to the samples of the frame specified by "nr", 
+"size", "shift", "head", "tail" and "channel" exactly as 'getSmpFrame' 
+would copy them, but without copying: the pointer refers to the data 
+buffer of the work object pointed to by "cacheDOp", which has to be set 
+up by 'allocSmpCache' with the same frame parameters. The samples are 
+converted to the format of the work object when the cache advances, so 
+for sequential frames only about "shift" samples per frame need to be 
+transferred.
+The function returns NULL upon error.
+
+Note:
+ - The samples in the view MUST NOT be modified because they are 
+   shared by the overlapping frames.
+ - The view is only valid until the next call with the same work 
+   object.
+ - A work object should only be used for one audio object and one 
+   channel. If the contents of the data buffer of "smpDOp" may have 
+   changed, the cache should be invalidated by setting 'bufNumRecs' of 
+   the work object to zero.
+
+DOC*/
+
+void *getSmpView(DOBJ *smpDOp, long nr, long size, long shift, long head,\
+		 long tail, int channel, DOBJ *cacheDOp)
+{
+  long     frameSn, begSn, endSn, absBegSn, before, after;
+  uint8_t *ptr;
+
+  if(smpDOp == NULL || cacheDOp == NULL || nr < 0 || size < 1 ||
+     shift < 1 || head < 0 || tail < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "getSmpView");
+    return(NULL);
+  }
+  frameSn = FRMNRtoSMPNR(nr, shift);
+  begSn = frameSn - FRAMEHEAD(size, shift) - head;
+  endSn = begSn + head + size + tail;
+  if(endSn - begSn > cacheDOp->maxBufRecs) {
+    setAsspMsg(AEB_BUF_SPACE, "getSmpView: work buffer");
+    return(NULL);
+  }
+  /* 'getSmpPtr' appends to the cache; it can't bridge a gap */
+  if(begSn > cacheDOp->bufStartRec + cacheDOp->bufNumRecs)
+    cacheDOp->bufNumRecs = 0;
+  /* the reference sample must be in the input range */
+  if(smpDOp->fp != NULL)
+    absBegSn = smpDOp->startRecord;
+  else
+    absBegSn = smpDOp->bufStartRec;
+  if(frameSn < absBegSn && frameSn + shift > absBegSn)
+    frameSn = absBegSn;
+  before = frameSn - begSn;
+  after = endSn - frameSn - 1;
+  ptr = (uint8_t *)getSmpPtr(smpDOp, frameSn, before, after, channel,\
+			     cacheDOp);
+  if(ptr == NULL)
+    return(NULL);
+  return((void *)(ptr - before * cacheDOp->recordSize));
+}
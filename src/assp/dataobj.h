@@ -82,6 +82,7 @@ typedef enum fileFormat {
   FF_XLABEL    ,     /* ESPS xlabel */
   FF_YORK      ,     /* University of York (Klatt'80 parameters) */
   FF_UWM       ,     /* University of Wisconsin at Madison (microbeam data) */
+  FF_FLAC      ,     /* Free Lossless Audio Codec (input only) */
   NUM_FILE_FORMATS
 } fform_e;
 
@@ -327,6 +328,9 @@ typedef struct dataObject {
                        /* functions only do the most obvious/harmless */
   /* still needed: int8_t locked, DOBJ *refDObj & LINK *depDObjs */
   void    *userData;    /* let the user store something at his/her own risk*/
+  void    *aio;         /* background writer (see asspaio.c) (ALLOCATED) */
+  void    *blk;         /* block compression (see blockio.c) (ALLOCATED) */
+  void    *flac;        /* FLAC decoder (see flacdec.c) (ALLOCATED) */
 } DOBJ;
 
 /*
@@ -334,6 +338,11 @@ typedef struct dataObject {
  * this is the suggested maximum length of that string
  */
 #define GD_MAX_ID_LEN 31
+
+/*
+ * number of overlapping frames held in the sample cache of 'getSmpView'
+ */
+#define SMP_CACHE_FRAMES 64
  
 /*
  * prototypes of functions in dataobj.c
@@ -366,6 +375,7 @@ ASSP_EXTERN void  *allocDataBuf(DOBJ *dop, long numRecords);
 ASSP_EXTERN void   clearDataBuf(DOBJ *dop);
 ASSP_EXTERN void   freeDataBuf(DOBJ *dop);
 ASSP_EXTERN int    swapDataBuf(DOBJ *dop);
+ASSP_EXTERN int    swapRecords(DOBJ *dop, void *buffer, long numRecords);
 ASSP_EXTERN int    swapRecord(DOBJ *dop, void *record);
 ASSP_EXTERN int    blockSwap(DOBJ *dop, size_t *numUnits);
 ASSP_EXTERN long   mapRecord(DOBJ *dst, DOBJ *src, long recordNr);
@@ -375,6 +385,11 @@ ASSP_EXTERN int    getSmpFrame(DOBJ *smpDOp, long nr, long size, long shift,\
 			       dform_e format);
 ASSP_EXTERN void  *getSmpPtr(DOBJ *smpDOp, long smpNr, long head, long tail,\
 			     int channel, DOBJ *workDOp);
+ASSP_EXTERN DOBJ  *allocSmpCache(DOBJ *smpDOp, long size, long shift,\
+				 long head, long tail, dform_e format);
+ASSP_EXTERN void  *getSmpView(DOBJ *smpDOp, long nr, long size, long shift,\
+			      long head, long tail, int channel,\
+			      DOBJ *cacheDOp);
 
 #ifdef __cplusplus
 } /* closing brace for extern "C" */
@@ -125,6 +125,8 @@ DOBJ *createDiff(DOBJ *inpDOp, AOPTS *aoPtr)
     freeDObj(dop);
     return(NULL);
   }
+  if(dop->fileFormat == FF_FLAC)         /* can't be written: use WAVE */
+    dop->fileFormat = FF_WAVE;
   if(dop->ddl.numFields > DIFF_O_CHANS) {
     dop->ddl.numFields = DIFF_O_CHANS;
     setRecordSize(dop);                   /* needs to be recalculated */
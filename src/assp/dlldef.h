@@ -37,4 +37,15 @@
 #define ASSP_EXTERN extern
 #endif
 
+/*
+ * storage class for state of which each thread needs its own copy
+ */
+#if defined(_MSC_VER)
+#define ASSP_TLS __declspec(thread)
+#elif defined(__GNUC__)
+#define ASSP_TLS __thread
+#else
+#define ASSP_TLS _Thread_local
+#endif
+
 #endif /*_ASSP_DLLDEF*/
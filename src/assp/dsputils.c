@@ -494,6 +494,132 @@ double getZCR(register double *s, register long N, double sfr)
 
 /*DOC
 
+Function 'getZCRf'
+
+Single-precision version of 'getZCR'.
+
+Arguments:
+ s[N]   array with signal values
+ N      number of signal values
+ sfr    sampling rate of signal
+
+Returns:
+ average zero-crossing rate in Hz
+ -1 when invalid function argument
+
+DOC*/
+
+double getZCRf(register float *s, register long N, double sfr)
+{
+  register int  POS;
+  register long n, numZX;
+  float  first, last, prev;
+  double avrPeriod, zxRate;
+
+  if(s == NULL || N < 1 || sfr <= 0.0)
+    return(-1.0);
+  numZX = 0;
+  first = last = -1.0F;
+  POS = (*s >= 0.0F) ? TRUE : FALSE;
+  prev = *s;
+  s++;
+  for(n = 1; n < N; n++, s++) {
+    if(*s >= 0.0F) {
+      if(!POS) {
+	POS = TRUE;
+	numZX++;
+	last = (float)n - *s / (*s - prev);
+	if(first < 0.0F)
+	  first = last;
+      }
+    }
+    else {
+      if(POS) {
+	POS = FALSE;
+	numZX++;
+	last = (float)n + *s / (prev - *s);
+	if(first < 0.0F)
+	  first = last;
+      }
+    }
+    prev = *s;
+  }
+  if(numZX > 2) {
+    avrPeriod = 2.0 * (double)(last - first) / (double)(numZX - 1);
+    zxRate = PERIODtoFREQ(avrPeriod, sfr);
+  }
+  else
+    zxRate = 0.0;
+  return(zxRate);
+}
+
+/*DOC
+
+Function 'getZCRI16'
+
+Version of 'getZCR' for signal values in 16-bit integer. The crossings 
+are detected on the integer values; the result is identical to that of 
+'getZCR' for the converted signal.
+
+Arguments:
+ s[N]   array with signal values
+ N      number of signal values
+ sfr    sampling rate of signal
+
+Returns:
+ average zero-crossing rate in Hz
+ -1 when invalid function argument
+
+DOC*/
+
+double getZCRI16(register int16_t *s, register long N, double sfr)
+{
+  register int  POS;
+  register long n, numZX;
+  double first, last, prev, val;
+  double avrPeriod, zxRate;
+
+  if(s == NULL || N < 1 || sfr <= 0.0)
+    return(-1.0);
+  numZX = 0;
+  first = last = -1.0;
+  POS = (*s >= 0) ? TRUE : FALSE;
+  prev = (double)(*s);
+  s++;
+  for(n = 1; n < N; n++, s++) {
+    if(*s >= 0) {
+      if(!POS) {
+	POS = TRUE;
+	numZX++;
+	val = (double)(*s);
+	last = (double)n - val / (val - prev);
+	if(first < 0.0)
+	  first = last;
+      }
+    }
+    else {
+      if(POS) {
+	POS = FALSE;
+	numZX++;
+	val = (double)(*s);
+	last = (double)n + val / (prev - val);
+	if(first < 0.0)
+	  first = last;
+      }
+    }
+    prev = (double)(*s);
+  }
+  if(numZX > 2) {
+    avrPeriod = 2.0 * (last - first) / (double)(numZX - 1);
+    zxRate = PERIODtoFREQ(avrPeriod, sfr);
+  }
+  else
+    zxRate = 0.0;
+  return(zxRate);
+}
+
+/*DOC
+
 Function `getRMS'
 
 Calculates the Root Mean Square (effective) amplitude of the signal 
@@ -525,6 +651,93 @@ double getRMS(register double *s, register long N)
 
 /*DOC
 
+Function 'getRMSf'
+
+Single-precision version of 'getRMS'. The squares are summed in 
+RMS_F_LANES interleaved partial sums so that the loop can be vectorized 
+without changing the result.
+
+Arguments:
+ s[N]   array with signal values
+ N      number of signal values
+
+Returns:
+ RMS amplitude (linear)
+ -1 when invalid function argument
+
+DOC*/
+
+double getRMSf(register float *s, register long N)
+{
+  register long n;
+  int   k;
+  float sum[RMS_F_LANES];
+
+  if(s == NULL || N < 0)
+    return(-1.0);
+  if(N == 0)
+    return(0.0);
+  for(k = 0; k < RMS_F_LANES; k++)
+    sum[k] = 0.0F;
+  for(n = 0; n + RMS_F_LANES <= N; n += RMS_F_LANES) {
+    for(k = 0; k < RMS_F_LANES; k++)
+      sum[k] += (s[n+k] * s[n+k]);
+  }
+  for(k = 0; n < N; n++, k++)
+    sum[k] += (s[n] * s[n]);
+  for(k = 1; k < RMS_F_LANES; k++)
+    sum[0] += sum[k];
+  return(sqrt((double)sum[0] / (double)N));
+}
+
+/*DOC
+
+Function 'getRMSI16'
+
+Calculates the RMS amplitude of signal values in 16-bit integer after 
+multiplying them with a window function, without an intermediate frame 
+in double precision. The result is identical to that of 'getRMS' for 
+the converted and windowed signal. If a NULL pointer is passed for the 
+window coefficients the signal will not be windowed.
+
+Arguments:
+ s[N]   array with signal values
+ wf[N]  array with coefficients of window function
+ N      number of signal values
+
+Returns:
+ RMS amplitude (linear)
+ -1 when invalid function argument
+
+DOC*/
+
+double getRMSI16(register int16_t *s, register double *wf, register long N)
+{
+  register long n;
+  double val, sum;
+
+  if(s == NULL || N < 0)
+    return(-1.0);
+  if(N == 0)
+    return(0.0);
+  sum = 0.0;
+  if(wf != NULL) {
+    for(n = 0; n < N; n++) {
+      val = wf[n] * (double)s[n];
+      sum += (val * val);
+    }
+  }
+  else {
+    for(n = 0; n < N; n++) {
+      val = (double)s[n];
+      sum += (val * val);
+    }
+  }
+  return(sqrt(sum/(double)N));
+}
+
+/*DOC
+
 Function `getMaxMag'
 
 Determines the maximum magnitude in an array of signal values.
@@ -35,6 +35,7 @@
 ***********************************************************************/
 /* $Id: fft.c,v 1.2 2008/01/07 09:58:21 mtms Exp $ */
 
+#include <stdlib.h>   /* malloc() free() */
 #include <math.h>     /* sin() cos() atan2() fabs() hypot() log10() */
 
 #include <asspdsp.h>  /* MIN_NFFT PI TWO_PI TINY... */
@@ -316,6 +317,186 @@ int rfft(register double *x, long N, int DIRECT)
 
 /*DOC
 
+Function 'rfftf'
+
+Single-precision version of 'rfft' for bulk computations such as 
+sonagrams. Input/output format, length normalization and return 
+values are identical to those of 'rfft'. Instead of the trigonometric 
+recurrences, the twiddle factors and the bit-reversed indices are 
+computed once in double precision and kept in tables which are 
+reallocated whenever "N" changes; passing 0 for DIRECT releases them.
+
+Returns:
+  0 if OK
+ -1 if N less than 4 or not a power of 2 or if the tables could not 
+    be allocated
+
+DOC*/
+
+int rfftf(register float *x, long N, int DIRECT)
+{
+  static   long oldN = 0;             /* for automatic initialization */
+  static   long M;
+  static   long *bitRev = NULL;   /* bit-reversed indices for N/2 FFT */
+  static   float *twHN = NULL;     /* cos & sin(k*2PI/(N/2)), k < N/4 */
+  static   float *twN;                  /* cos & sin(i*2PI/N), i < N/4 */
+  static   float factor;
+  register long i, j, k, l, m;                           /* for speed */
+  long   HN, pm, pm_1, pM_1_m, QN;
+  float  cr, ci, keep;
+  float  vr, vi, wr, wi;
+
+  if(DIRECT == 0 || N < MIN_NFFT) {                          /* reset */
+    if(twHN != NULL)
+      free((void *)twHN);
+    if(bitRev != NULL)
+      free((void *)bitRev);
+    twHN = NULL;
+    bitRev = NULL;
+    oldN = 0;
+    if(DIRECT == 0)
+      return(0);
+    return(-1);
+  }
+  HN = N >> 1;  /* N / 2 */
+  QN = HN >> 1; /* N / 4 hence MIN_NFFT */
+  if(oldN != N) {                         /* automatic initialization */
+    for(m = 0, i = N; i > 1; i >>= 1)               /* get power of 2 */
+      m++;
+    i = 1 << m;                       /* recalculate number of points */
+    if(N != i)                                    /* NOT a power of 2 */
+      return(-1);
+    rfftf(NULL, 0, 0);                          /* release old tables */
+    twHN = (float *)malloc((size_t)N * sizeof(float));
+    bitRev = (long *)malloc((size_t)HN * sizeof(long));
+    if(twHN == NULL || bitRev == NULL) {
+      rfftf(NULL, 0, 0);
+      return(-1);
+    }
+    twN = &twHN[HN];
+    for(i = 0; i < QN; i++) {
+      twHN[i] = (float)cos(TWO_PI * (double)i / (double)HN);
+      twHN[QN+i] = (float)sin(TWO_PI * (double)i / (double)HN);
+      twN[i] = (float)cos(TWO_PI * (double)i / (double)N);
+      twN[QN+i] = (float)sin(TWO_PI * (double)i / (double)N);
+    }
+    M = m;
+    for(i = 0; i < HN; i++) {
+      for(j = i, k = 1, l = 0; k < M; k++) {
+	l = (l << 1) + (j & 1);                          /* bit shuffle */
+	j >>= 1;
+      }
+      bitRev[i] = l;
+    }
+    factor = (float)(2.0 / (double)N);
+    oldN = N;
+  }
+  if(DIRECT < 0) { /* INVERSE TRANSFORM */
+    keep  = x[1];           /* use symmetry properties to get coeff's */
+    x[1]  = x[0] - x[N-1];   /*     for complex IFFT with half length */
+    x[0] += x[N-1];
+    for(i = 1; i < QN; i++) {
+      j = i << 1;
+      k = N - j;
+      cr = twN[i];                                    /* cos(i*2PI/N) */
+      ci = twN[QN+i];                                 /* sin(i*2PI/N) */
+      vr = 0.5F * (ci*(keep-x[k-1]) - cr*(x[j]+x[k]));
+      vi = 0.5F * (cr*(keep-x[k-1]) + ci*(x[j]+x[k]));
+      wr = 0.5F * (keep + x[k-1]);
+      wi = 0.5F * (x[j] - x[k]);
+      keep = x[j+1];
+      x[j]   = wr - vr;
+      x[j+1] = vi - wi;
+      x[k]   = vr + wr;
+      x[k+1] = vi + wi;
+    }
+    x[HN+1] = x[HN];
+    x[HN]   = keep;
+  }
+/*-- N/2-points FFT --------------------------------------------------*/
+  for(i = 0; i < HN; i++) {
+    l = bitRev[i];
+    if(i <= l) {
+      j = i << 1;
+      k = l << 1;
+      vr = x[j];
+      vi = x[j+1];
+      if(DIRECT > 0) { /* length normalization in FORWARD transform ! */
+	x[j]   = x[k] * factor;
+	x[j+1] = x[k+1] * factor;
+	x[k]   = vr * factor;
+	x[k+1] = vi * factor;
+      }
+      else {
+	x[j]   = x[k];
+	x[j+1] = x[k+1];
+	x[k]   = vr;
+	x[k+1] = vi;
+      }
+    }
+  }
+  pM_1_m = HN;                                  /* init for 2^(M-1-m) */
+  pm_1 = 1;                                       /* init for 2^(m-1) */
+  for(m = 1; m < M; m++) {
+    pM_1_m >>= 1;                                        /* 2^(M-1-m) */
+    pm = pm_1 << 1;                                            /* 2^m */
+    for(i = 0; i < HN; i += pm) {            /* j=0 case outside loop */
+      k = i << 1;
+      l = k + pm;
+      vr = x[l];
+      vi = x[l+1];
+      x[l]    = x[k] - vr;
+      x[l+1]  = x[k+1] - vi;
+      x[k]   += vr;
+      x[k+1] += vi;
+    }
+    for(j = 1; j < pm_1; j++) {
+      cr = twHN[j * pM_1_m];                        /* cos(j*2PI/2^m) */
+      ci = twHN[QN + j * pM_1_m];
+      if(DIRECT > 0)
+	ci = -ci;                                   /* -/+ sin(j*2PI/2^m) */
+      for(i = 0; i < HN; i += pm) {
+	k = (i+j) << 1;
+	l = k + pm;
+	vr = x[l]*cr - x[l+1]*ci;
+	vi = x[l]*ci + x[l+1]*cr;
+	x[l]    = x[k] - vr;
+	x[l+1]  = x[k+1] - vi;
+	x[k]   += vr;
+	x[k+1] += vi;
+      }
+    }
+    pm_1 = pm;
+  }
+/*-- End of FFT ------------------------------------------------------*/
+  if(DIRECT > 0) { /* FORWARD TRANSFORM */
+    keep = x[N-1];               /* use symmetry properties to double */
+    x[N-1] = 0.5F * (x[0] - x[1]); /*   the number of Fourier coeff's */
+    x[0]   = 0.5F * (x[0] + x[1]);
+    for(i = 1; i < QN; i++) {
+      j = i << 1;
+      k = N - j;
+      cr = twN[i];                                    /* cos(i*2PI/N) */
+      ci = -twN[QN+i];                               /* -sin(i*2PI/N) */
+      vr = 0.5F * (ci*(x[j]-x[k]) + cr*(x[j+1]+keep));
+      vi = 0.5F * (cr*(x[j]-x[k]) - ci*(x[j+1]+keep));
+      wr = 0.5F * (x[j] + x[k]);
+      wi = 0.5F * (x[j+1] - keep);
+      keep   = x[k-1];
+      x[j-1] = vr + wr;
+      x[j]   = vi - wi;
+      x[k-1] = wr - vr;
+      x[k]   = vi + wi;
+    }
+    x[HN-1] = x[HN];
+    x[HN]   = keep;
+  }
+
+  return(0);
+}
+
+/*DOC
+
 Function 'rfftRe'
 
 Extracts real part of the output of the rfft() function in FORWARD mode.
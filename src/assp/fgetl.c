@@ -36,6 +36,7 @@
 #include <stdio.h>      /* FILE EOF */
 
 #include <misc.h>       /* prototype */
+#include <dlldef.h>     /* ASSP_TLS */
 
 #define EOL_LF 0x0A     /* line feed / new line */
 #define EOL_CR 0x0D     /* carriage return */
@@ -57,14 +58,15 @@ which will normally contain the End-Of-Line code encountered.
 The string will be empty when "fp" refers to 'stdin' or when End-Of-File 
 has been reached (even when the function does not return EOF).
 Its first character will equal EOF when the length of the line exceeds 
-"size" -1. The string is static memory; its contents should therefore be 
-evaluated/copied before another call to "fgetl" modifies them.
+"size" -1. The string is static memory (one per thread); its contents
+should therefore be evaluated/copied before another call to "fgetl" in
+the same thread modifies them.
 
 DOC*/
 
 int fgetl(char *buffer, int size, FILE *fp, char **eolPtr)
 {
-  static char eolStr[4];
+  static ASSP_TLS char eolStr[4];
   int i, cnt, chr, nxt;
 
   for(i = 0; i < 4; i++)
@@ -403,6 +403,8 @@ DOBJ *filterSignal(DOBJ *inpDOp, DOBJ *filtDOp, DOBJ *outDOp)
       freeDObj(outDOp);
       return(NULL);
     }
+    if(outDOp->fileFormat == FF_FLAC)      /* can't be written: use WAVE */
+      outDOp->fileFormat = FF_WAVE;
     if(outDOp->ddl.numFields > FILT_O_CHANS) {
       outDOp->ddl.numFields = FILT_O_CHANS;
       setRecordSize(outDOp);                 /* needs be recalculated */
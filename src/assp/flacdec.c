@@ -0,0 +1,1128 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     flacdec.c                                                  *
+* Contents: Decoding of FLAC files (Free Lossless Audio Codec) as      *
+*           input of the analyses. The frames are decoded on demand,   *
+*           so that only the part of the file which is requested has   *
+*           to be read and decoded.                                    *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>      /* FILE fseek() ftell() fread() */
+#include <stdlib.h>     /* malloc() calloc() realloc() free() */
+#include <string.h>     /* strncmp() strdup() */
+#include <inttypes.h>   /* int32_t uint32_t int64_t uint64_t */
+
+#include <miscdefs.h>   /* TRUE FALSE LOCAL */
+#include <asspendian.h> /* SETENDIAN() */
+#include <asspmess.h>   /* message codes; reference to globals */
+#include <dataobj.h>    /* DOBJ DDESC FF_FLAC */
+#include <flacdec.h>
+#include <asspprof.h>   /* PROF_COUNT() */
+
+/*
+ * A FLAC file consists of the magic FLAC_MAGIC, metadata blocks of
+ * which STREAMINFO (sample rate, number of channels and bits, total
+ * number of samples) comes first and SEEKTABLE (sample numbers and byte
+ * offsets of some frames) is optional, and a sequence of frames each of
+ * which holds a block of samples of all channels. Each frame starts with
+ * a sync code and a header giving the number of its first sample (or
+ * of the frame), protected by a CRC-8; the whole frame is protected by
+ * a CRC-16. This allows to find the frame holding a given sample by
+ * bisection over the byte offsets when the seek table is missing or too
+ * coarse.
+ * The samples are returned in system byte order and as signed integers
+ * of 8, 16 or 32 bits; 24-bit data are returned in 32 bits (not scaled).
+ */
+
+#define FLAC_STREAMINFO  0      /* metadata block types */
+#define FLAC_SEEKTABLE   3
+#define FLAC_META_BAD    127
+#define STREAMINFO_SIZE  34
+#define SEEKPOINT_SIZE   18
+#define FLAC_LEFT_SIDE   8      /* channel assignments with side channel */
+#define FLAC_SIDE_RIGHT  9
+#define FLAC_MID_SIDE    10
+#define FLAC_SYNC        0x7FFC /* sync code and reserved bit (15 bits) */
+#define FLAC_MAX_FIXED   4
+#define FLAC_MAX_LPC     32
+#define FLAC_WIN_BYTES   65536L /* read ahead in file window */
+#define FLAC_FRAME_BYTES 16384L /* assumed frame size if not specified */
+#define FLAC_SCAN_BYTES  32768L /* bisection stops below this span */
+#define FLAC_NEAR_BLOCKS 8L     /* decode on rather than seek */
+                                /*   (defaults, see flacSearchLimits()) */
+
+#define FRM_OK     0            /* results of frame parsing */
+#define FRM_BAD   -1            /* not a (valid) frame */
+#define FRM_SHORT -2            /* frame extends beyond available data */
+
+/*
+ * decoder state of a data object (item 'flac')
+ */
+typedef struct flac_state {
+  long    fileSize;
+  long    firstFrame;      /* byte offset of first frame */
+  long    minBlock;        /* samples per frame (per channel) */
+  long    maxBlock;
+  long    maxFrame;        /* bytes per frame or 0 if unknown */
+  long    sampleRate;
+  int     channels;
+  int     bps;             /* bits per sample */
+  long    numSamples;      /* samples per channel in file */
+  long    numPoints;       /* seek table */
+  long   *pointSmp;        /*   number of first sample of frame */
+  long   *pointOffs;       /*   byte offset of frame in file */
+  long    pos;             /* current sample */
+  uint8_t *win;            /* window in file */
+  size_t  winBytes;
+  long    winOffs;
+  long    winLen;
+  int32_t *smp;            /* decoded frame, 'maxBlock' per channel */
+  long    frameStart;      /* number of first sample or -1 */
+  long    frameLen;
+  long    frameOffs;       /* byte offset of the frame */
+  long    nextOffs;        /* byte offset of the following frame */
+} FLAC_STATE;
+
+typedef struct bit_reader {
+  uint8_t *buf;
+  size_t  numBits;
+  size_t  bitPos;
+  int     overrun;         /* tried to read beyond 'numBits' */
+} BIT_READER;
+
+typedef struct frame_head {
+  long    blockSize;
+  int     chanAssign;
+  long    firstSmp;
+} FRAME_HEAD;
+
+/*
+ * CRC-8 (polynomial 0x07) and CRC-16 (polynomial 0x8005) per nibble
+ */
+LOCAL const uint8_t crc8Tab[16] = {
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+  0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+LOCAL const uint16_t crc16Tab[16] = {
+  0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
+  0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022
+};
+
+/*
+ * predictor coefficients of the fixed subframes
+ */
+LOCAL const int32_t fixedCoef[FLAC_MAX_FIXED + 1][FLAC_MAX_FIXED] = {
+  {0, 0, 0, 0}, {1, 0, 0, 0}, {2, -1, 0, 0}, {3, -3, 1, 0}, {4, -6, 4, -1}
+};
+
+LOCAL long scanBytes = FLAC_SCAN_BYTES;
+LOCAL long nearBlocks = FLAC_NEAR_BLOCKS;
+
+/*
+ * prototypes of private functions
+ */
+LOCAL int   readMeta(DOBJ *dop, FLAC_STATE *fs);
+LOCAL long  countSamples(DOBJ *dop, FLAC_STATE *fs);
+LOCAL long  loadWindow(DOBJ *dop, FLAC_STATE *fs, long offset, long need);
+LOCAL int   seekFrame(DOBJ *dop, FLAC_STATE *fs, long smpNr);
+LOCAL int   decodeOn(DOBJ *dop, FLAC_STATE *fs, long offset, long smpNr);
+LOCAL int   syncFrame(DOBJ *dop, FLAC_STATE *fs, long from, long to);
+LOCAL int   decodeFrame(DOBJ *dop, FLAC_STATE *fs, long offset);
+LOCAL int   parseFrame(BIT_READER *br, FLAC_STATE *fs, FRAME_HEAD *fh);
+LOCAL int   parseFrameHead(BIT_READER *br, FLAC_STATE *fs, FRAME_HEAD *fh);
+LOCAL int   decodeSubframe(BIT_READER *br, int32_t *out, long blockSize,\
+			   int bps);
+LOCAL int   decodeResidual(BIT_READER *br, int32_t *out, long blockSize,\
+			   int order);
+LOCAL void  predict(int32_t *out, long blockSize, const int32_t *coef,\
+		    int order, int shift);
+LOCAL uint32_t getBits(BIT_READER *br, int numBits);
+LOCAL int32_t  getSBits(BIT_READER *br, int numBits);
+LOCAL uint32_t getUnary(BIT_READER *br);
+LOCAL int   getUTF8(BIT_READER *br, uint64_t *val);
+LOCAL unsigned crc8(uint8_t *ptr, size_t numBytes);
+LOCAL unsigned crc16(uint8_t *ptr, size_t numBytes);
+
+/*DOC
+
+Function 'flacHeader'
+
+Decodes the metadata of the FLAC file opened for reading in the data
+object pointed to by "dop" and fills out the items of the object as for
+a single audio track. The decoder state is stored in the object (item
+'flac'); the file functions asspFSeek(), asspFTell() and asspFRead() -
+and thereby asspFFill() and asspFLoad() - then use flacSeek(),
+flacTell() and flacRead(). If the file does not give its number of
+samples, all frames are decoded once to count them.
+Returns 0 upon success and -1 upon error.
+
+DOC*/
+
+int flacHeader(DOBJ *dop)
+{
+  FLAC_STATE *fs;
+  DDESC *dd;
+
+  if(dop == NULL || dop->fp == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "flacHeader");
+    return(-1);
+  }
+  flacFree(dop);
+  fs = (FLAC_STATE *)calloc(1, sizeof(FLAC_STATE));
+  if(fs == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "flacHeader");
+    return(-1);
+  }
+  fs->frameStart = -1;
+  dop->flac = (void *)fs;
+  if(fseek(dop->fp, 0L, SEEK_END) != 0 ||\
+     (fs->fileSize=ftell(dop->fp)) < 0) {
+    setAsspMsg(AEF_ERR_SEEK, dop->filePath);
+    flacFree(dop);
+    return(-1);
+  }
+  if(readMeta(dop, fs) < 0) {
+    flacFree(dop);
+    return(-1);
+  }
+  fs->smp = (int32_t *)malloc((size_t)(fs->maxBlock) *\
+			      (size_t)(fs->channels) * sizeof(int32_t));
+  if(fs->smp == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "flacHeader");
+    flacFree(dop);
+    return(-1);
+  }
+/*
+ * complete DOBJ and DDESC
+ */
+  dop->fileFormat = FF_FLAC;
+  dop->fileData = FDF_BIN;
+  SETENDIAN(dop->fileEndian);             /* decoded in system order */
+  dop->headerSize = fs->firstFrame;
+  dop->sampFreq = (double)(fs->sampleRate);
+  dop->frameDur = 1;
+  dop->startRecord = 0;
+  freeDDList(dop);
+  dd = &(dop->ddl);
+  dd->ident = strdup("audio");
+  dd->type = DT_SMP;
+  dd->coding = DC_PCM;
+  dd->numFields = (size_t)(fs->channels);
+  if(fs->bps <= 8) {
+    dd->format = DF_INT8;
+    dd->numBits = 8;
+  }
+  else if(fs->bps <= 16) {
+    dd->format = DF_INT16;
+    dd->numBits = 16;
+  }
+  else {
+    dd->format = DF_INT32;
+    dd->numBits = (fs->bps <= 24) ? 24 : 32;
+  }
+  setRecordSize(dop);
+  if(fs->numSamples <= 0) {                       /* i.e. unspecified */
+    fs->numSamples = countSamples(dop, fs);
+    if(fs->numSamples < 0) {
+      flacFree(dop);
+      return(-1);
+    }
+  }
+  dop->numRecords = fs->numSamples;
+  setStart_Time(dop);
+  return(0);
+}
+
+/*DOC
+
+Function 'flacFree'
+
+Returns the memory of the FLAC decoder state of the data object pointed
+to by "dop" (called by clearDObj()).
+
+DOC*/
+
+void flacFree(DOBJ *dop)
+{
+  FLAC_STATE *fs;
+
+  if(dop == NULL || dop->flac == NULL)
+    return;
+  fs = (FLAC_STATE *)(dop->flac);
+  if(fs->pointSmp != NULL)
+    free((void *)(fs->pointSmp));
+  if(fs->pointOffs != NULL)
+    free((void *)(fs->pointOffs));
+  if(fs->win != NULL)
+    free((void *)(fs->win));
+  if(fs->smp != NULL)
+    free((void *)(fs->smp));
+  free((void *)fs);
+  dop->flac = NULL;
+  return;
+}
+
+/*DOC
+
+Function 'flacSeek'
+
+Sets the current sample of the FLAC data object pointed to by "dop" to
+"recordNr" (counted from the start of the file, as in asspFSeek() after
+subtracting 'startRecord'). Nothing is decoded yet.
+Returns "recordNr" or -1 upon error.
+
+DOC*/
+
+long flacSeek(DOBJ *dop, long recordNr)
+{
+  if(dop == NULL || dop->flac == NULL || recordNr < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "flacSeek");
+    return(-1);
+  }
+  ((FLAC_STATE *)(dop->flac))->pos = recordNr;
+  PROF_COUNT(PRC_SEEKS, 1);
+  return(recordNr);
+}
+
+/*DOC
+
+Function 'flacTell'
+
+Returns the current sample of the FLAC data object pointed to by "dop"
+(counted from the start of the file) or -1 upon error.
+
+DOC*/
+
+long flacTell(DOBJ *dop)
+{
+  if(dop == NULL || dop->flac == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "flacTell");
+    return(-1);
+  }
+  return(((FLAC_STATE *)(dop->flac))->pos);
+}
+
+/*DOC
+
+Function 'flacRead'
+
+Decodes "numRecords" records (samples of all channels) from the current
+sample onwards of the FLAC data object pointed to by "dop" into
+"buffer" and advances the current sample. Only the frames needed are
+read and decoded; the frame holding the current sample is found via
+the seek table of the file and/or by bisection, the last one decoded is
+kept.
+Returns the number of records read (which may be less than requested
+at the end of the file) or -1 upon error.
+
+DOC*/
+
+long flacRead(DOBJ *dop, void *buffer, long numRecords)
+{
+  long    numDone, numCopy, first, i, n;
+  int     ch, numChan;
+  int32_t *src;
+  FLAC_STATE *fs;
+
+  if(dop == NULL || dop->flac == NULL || buffer == NULL ||\
+     numRecords < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "flacRead");
+    return(-1);
+  }
+  fs = (FLAC_STATE *)(dop->flac);
+  if(numRecords > 0 && fs->pos >= fs->numSamples) {
+    setAsspMsg(AEF_ERR_READ, dop->filePath);
+    return(-1);
+  }
+  numChan = fs->channels;
+  numDone = 0;
+  while(numDone < numRecords && fs->pos < fs->numSamples) {
+    if(seekFrame(dop, fs, fs->pos) < 0)
+      return(-1);
+    first = fs->pos - fs->frameStart;
+    numCopy = fs->frameLen - first;
+    if(numCopy > numRecords - numDone)
+      numCopy = numRecords - numDone;
+    if(numCopy > fs->numSamples - fs->pos)
+      numCopy = fs->numSamples - fs->pos;
+    for(ch = 0; ch < numChan; ch++) {
+      src = fs->smp + (size_t)ch * (size_t)(fs->maxBlock) + first;
+      n = numDone * numChan + ch;
+      switch(dop->ddl.format) {
+      case DF_INT8:
+	for(i = 0; i < numCopy; i++, n += numChan)
+	  ((int8_t *)buffer)[n] = (int8_t)src[i];
+	break;
+      case DF_INT16:
+	for(i = 0; i < numCopy; i++, n += numChan)
+	  ((int16_t *)buffer)[n] = (int16_t)src[i];
+	break;
+      default:
+	for(i = 0; i < numCopy; i++, n += numChan)
+	  ((int32_t *)buffer)[n] = src[i];
+	break;
+      }
+    }
+    numDone += numCopy;
+    fs->pos += numCopy;
+  }
+  return(numDone);
+}
+
+/*DOC
+
+Function 'flacSearchLimits'
+
+Sets the limits of the search for the frame holding a sample: the file
+is bisected down to a span of "numBytes" bytes and frames are decoded
+on rather than searched for if the sample lies less than "numBlocks"
+blocks ahead. Negative values restore the defaults FLAC_SCAN_BYTES and
+FLAC_NEAR_BLOCKS. This is meant for tests, which can thus run the
+bisection on short files; the limits should not be changed while FLAC
+files are being read.
+
+DOC*/
+
+void flacSearchLimits(long numBytes, long numBlocks)
+{
+  scanBytes = (numBytes < 0) ? FLAC_SCAN_BYTES : numBytes;
+  if(scanBytes < 1)
+    scanBytes = 1;
+  nearBlocks = (numBlocks < 0) ? FLAC_NEAR_BLOCKS : numBlocks;
+  return;
+}
+
+/***********************************************************************
+* read the metadata blocks (skipping an ID3v2 tag in front)            *
+***********************************************************************/
+LOCAL int readMeta(DOBJ *dop, FLAC_STATE *fs)
+{
+  uint8_t  buf[STREAMINFO_SIZE];
+  int      last, type, haveInfo;
+  long     offset, length, n, i;
+  uint64_t smpNr, offs;
+  size_t   numBytes;
+
+  rewind(dop->fp);
+  offset = 0;
+  numBytes = fread(buf, 1, ID3_HDR_SIZE, dop->fp);
+  if(numBytes == ID3_HDR_SIZE && strncmp((char *)buf, ID3_MAGIC, 3) == 0) {
+    offset = ID3_HDR_SIZE + (((long)(buf[6] & 0x7F) << 21) |\
+			     ((long)(buf[7] & 0x7F) << 14) |\
+			     ((long)(buf[8] & 0x7F) << 7) |\
+			     (long)(buf[9] & 0x7F));
+    if(buf[5] & 0x10)                            /* footer present */
+      offset += ID3_HDR_SIZE;
+  }
+  if(fseek(dop->fp, offset, SEEK_SET) != 0 ||\
+     fread(buf, 1, 4, dop->fp) != 4 ||\
+     strncmp((char *)buf, FLAC_MAGIC, 4) != 0) {
+    asspMsgNum = AEF_ERR_FORM;
+    snprintf(applMessage, sizeof(applMessage), "(not FLAC) in file %s",\
+	     dop->filePath);
+    return(-1);
+  }
+  offset += 4;
+  haveInfo = FALSE;
+  for(last = FALSE; !last; offset += length) {
+    if(fseek(dop->fp, offset, SEEK_SET) != 0 ||\
+       fread(buf, 1, 4, dop->fp) != 4)
+      break;
+    last = (buf[0] & 0x80) != 0;
+    type = buf[0] & 0x7F;
+    length = ((long)buf[1] << 16) | ((long)buf[2] << 8) | (long)buf[3];
+    offset += 4;
+    if(type == FLAC_META_BAD || (!haveInfo && type != FLAC_STREAMINFO))
+      break;
+    if(type == FLAC_STREAMINFO) {
+      if(haveInfo || length < STREAMINFO_SIZE ||\
+	 fread(buf, 1, STREAMINFO_SIZE, dop->fp) != STREAMINFO_SIZE)
+	break;
+      fs->minBlock = ((long)buf[0] << 8) | (long)buf[1];
+      fs->maxBlock = ((long)buf[2] << 8) | (long)buf[3];
+      fs->maxFrame = ((long)buf[7] << 16) | ((long)buf[8] << 8) |\
+	(long)buf[9];
+      fs->sampleRate = ((long)buf[10] << 12) | ((long)buf[11] << 4) |\
+	((long)buf[12] >> 4);
+      fs->channels = ((buf[12] >> 1) & 0x07) + 1;
+      fs->bps = (((buf[12] & 0x01) << 4) | (buf[13] >> 4)) + 1;
+      fs->numSamples = (long)(((uint64_t)(buf[13] & 0x0F) << 32) |\
+			      ((uint64_t)buf[14] << 24) |\
+			      ((uint64_t)buf[15] << 16) |\
+			      ((uint64_t)buf[16] << 8) | (uint64_t)buf[17]);
+      if(fs->maxBlock < 1 || fs->minBlock > fs->maxBlock ||\
+	 fs->sampleRate < 1 || fs->bps < 4)
+	break;
+      haveInfo = TRUE;
+    }
+    else if(type == FLAC_SEEKTABLE && fs->numPoints == 0) {
+      n = length / SEEKPOINT_SIZE;
+      if(n < 1)
+	continue;
+      fs->pointSmp = (long *)malloc((size_t)n * sizeof(long));
+      fs->pointOffs = (long *)malloc((size_t)n * sizeof(long));
+      if(fs->pointSmp == NULL || fs->pointOffs == NULL) {
+	setAsspMsg(AEG_ERR_MEM, "flacHeader");
+	return(-1);
+      }
+      for(i = 0; i < n; i++) {
+	if(fread(buf, 1, SEEKPOINT_SIZE, dop->fp) != SEEKPOINT_SIZE)
+	  break;
+	smpNr = offs = 0;
+	for(numBytes = 0; numBytes < 8; numBytes++) {
+	  smpNr = (smpNr << 8) | (uint64_t)buf[numBytes];
+	  offs = (offs << 8) | (uint64_t)buf[8 + numBytes];
+	}
+	if(smpNr == UINT64_C(0xFFFFFFFFFFFFFFFF))      /* placeholder */
+	  break;
+	if((fs->numPoints > 0 &&\
+	    (long)smpNr <= fs->pointSmp[fs->numPoints - 1]) ||\
+	   offs >= (uint64_t)(fs->fileSize))          /* ignore point */
+	  continue;
+	fs->pointSmp[fs->numPoints] = (long)smpNr;
+	fs->pointOffs[fs->numPoints] = (long)offs;  /* from first frame */
+	fs->numPoints++;
+      }
+    }
+  }
+  if(!haveInfo || !last || offset > fs->fileSize) {
+    asspMsgNum = AEF_BAD_HEAD;
+    snprintf(applMessage, sizeof(applMessage), "(FLAC format) in file %s",\
+	     dop->filePath);
+    return(-1);
+  }
+  fs->firstFrame = offset;
+  for(i = 0; i < fs->numPoints; i++)
+    fs->pointOffs[i] += offset;
+  while(fs->numPoints > 0 &&\
+	fs->pointOffs[fs->numPoints - 1] >= fs->fileSize)
+    fs->numPoints--;
+  return(0);
+}
+
+/***********************************************************************
+* count the samples by decoding all frames; returns number of samples  *
+* per channel or -1 upon error                                         *
+***********************************************************************/
+LOCAL long countSamples(DOBJ *dop, FLAC_STATE *fs)
+{
+  long offset, numSmp;
+  int  found;
+
+  numSmp = 0;
+  for(offset = fs->firstFrame; offset < fs->fileSize;\
+      offset = fs->nextOffs) {
+    found = decodeFrame(dop, fs, offset);
+    if(found < 0)
+      return(-1);
+    if(found == 0)              /* truncated file or trailing garbage */
+      break;
+    numSmp = fs->frameStart + fs->frameLen;
+  }
+  return(numSmp);
+}
+
+/***********************************************************************
+* make at least "need" bytes from "offset" onwards available in the    *
+* file window (fewer at the end of the file); returns the number of    *
+* bytes available from "offset" onwards or -1 upon error               *
+***********************************************************************/
+LOCAL long loadWindow(DOBJ *dop, FLAC_STATE *fs, long offset, long need)
+{
+  size_t numBytes;
+  void  *ptr;
+
+  if(offset >= fs->fileSize)
+    return(0);
+  if(offset >= fs->winOffs && offset < fs->winOffs + fs->winLen &&\
+     (offset + need <= fs->winOffs + fs->winLen ||\
+      fs->winOffs + fs->winLen >= fs->fileSize))
+    return(fs->winOffs + fs->winLen - offset);
+  numBytes = (size_t)need + FLAC_WIN_BYTES;
+  if(numBytes > fs->winBytes) {
+    ptr = realloc((void *)(fs->win), numBytes);
+    if(ptr == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "flacdec");
+      return(-1);
+    }
+    fs->win = (uint8_t *)ptr;
+    fs->winBytes = numBytes;
+  }
+  fs->winLen = 0;
+  if(fseek(dop->fp, offset, SEEK_SET) != 0) {
+    setAsspMsg(AEF_ERR_SEEK, dop->filePath);
+    return(-1);
+  }
+  clearerr(dop->fp);
+  numBytes = fread(fs->win, 1, fs->winBytes, dop->fp);
+  if(ferror(dop->fp)) {
+    setAsspMsg(AEF_ERR_READ, dop->filePath);
+    return(-1);
+  }
+  fs->winOffs = offset;
+  fs->winLen = (long)numBytes;
+  PROF_COUNT(PRC_READS, 1);
+  PROF_COUNT(PRC_READ_BYTES, numBytes);
+  return(fs->winLen);
+}
+
+/***********************************************************************
+* decode the frame holding sample "smpNr"; returns 0 or -1 upon error  *
+***********************************************************************/
+LOCAL int seekFrame(DOBJ *dop, FLAC_STATE *fs, long smpNr)
+{
+  long lo, loSmp, hi, mid, k, l, h;
+  int  found;
+
+  if(fs->frameStart >= 0) {
+    if(smpNr >= fs->frameStart && smpNr < fs->frameStart + fs->frameLen)
+      return(0);
+    if(smpNr >= fs->frameStart + fs->frameLen &&\
+       smpNr < fs->frameStart + fs->frameLen +\
+       nearBlocks * fs->maxBlock)
+      return(decodeOn(dop, fs, fs->nextOffs, smpNr));
+  }
+  lo = fs->firstFrame;
+  loSmp = 0;
+  hi = fs->fileSize;
+  if(fs->numPoints > 0 && smpNr >= fs->pointSmp[0]) {
+    l = 0;                                 /* last point <= smpNr */
+    h = fs->numPoints - 1;
+    while(l < h) {
+      k = (l + h + 1) / 2;
+      if(fs->pointSmp[k] <= smpNr)
+	l = k;
+      else
+	h = k - 1;
+    }
+    lo = fs->pointOffs[l];
+    loSmp = fs->pointSmp[l];
+    if(l + 1 < fs->numPoints)
+      hi = fs->pointOffs[l + 1];
+  }
+  else if(fs->numPoints > 0)
+    hi = fs->pointOffs[0];
+  if(smpNr - loSmp < nearBlocks * fs->maxBlock)
+    hi = lo;                                  /* no need to bisect */
+  while(hi - lo > scanBytes) {
+    mid = lo + (hi - lo) / 2;
+    found = syncFrame(dop, fs, mid, hi);
+    if(found < 0)
+      return(-1);
+    if(found == 0 || fs->frameStart > smpNr)
+      hi = mid;
+    else if(smpNr < fs->frameStart + fs->frameLen)
+      return(0);
+    else
+      lo = fs->frameOffs;
+  }
+  return(decodeOn(dop, fs, lo, smpNr));
+}
+
+/***********************************************************************
+* decode the frames from "offset" onwards up to the one holding sample *
+* "smpNr"; returns 0 or -1 upon error                                  *
+***********************************************************************/
+LOCAL int decodeOn(DOBJ *dop, FLAC_STATE *fs, long offset, long smpNr)
+{
+  int found;
+
+  for(;;) {
+    if(fs->frameStart < 0 || fs->frameOffs != offset) {
+      found = decodeFrame(dop, fs, offset);
+      if(found < 0)
+	return(-1);
+      if(found == 0 || smpNr < fs->frameStart) {
+	setAsspMsg(AEF_ERR_FORM, dop->filePath);
+	return(-1);
+      }
+    }
+    if(smpNr < fs->frameStart + fs->frameLen)
+      return(0);
+    offset = fs->nextOffs;
+    if(offset >= fs->fileSize) {
+      setAsspMsg(AEF_ERR_EOF, dop->filePath);
+      return(-1);
+    }
+  }
+}
+
+/***********************************************************************
+* decode the first valid frame starting in the byte range [from, to);  *
+* returns 1 if found, 0 if not or -1 upon error                        *
+***********************************************************************/
+LOCAL int syncFrame(DOBJ *dop, FLAC_STATE *fs, long from, long to)
+{
+  long     offset, avail, i;
+  int      found;
+  uint8_t *ptr;
+
+  offset = from;
+  while(offset < to) {
+    avail = loadWindow(dop, fs, offset, 2);
+    if(avail < 0)
+      return(-1);
+    if(avail < 2)
+      return(0);
+    ptr = fs->win + (offset - fs->winOffs);
+    for(i = 0; i + 1 < avail && offset + i < to; i++)
+      if(ptr[i] == 0xFF && (ptr[i+1] & 0xFE) == 0xF8)
+	break;
+    if(i + 1 >= avail || offset + i >= to) {
+      offset += i;
+      continue;
+    }
+    found = decodeFrame(dop, fs, offset + i);
+    if(found != 0)
+      return(found);
+    offset += i + 1;
+  }
+  return(0);
+}
+
+/***********************************************************************
+* decode the frame at byte "offset" into the frame buffer; returns 1   *
+* upon success, 0 if there is no (complete, valid) frame or -1 upon    *
+* error                                                                *
+***********************************************************************/
+LOCAL int decodeFrame(DOBJ *dop, FLAC_STATE *fs, long offset)
+{
+  long       need, avail, limit;
+  int        err;
+  BIT_READER br;
+  FRAME_HEAD fh;
+
+  if(fs->maxFrame > 0)
+    limit = fs->maxFrame;
+  else                        /* verbatim subframes plus some headers */
+    limit = 64 + (long)(fs->channels) *\
+      ((fs->maxBlock * (long)(fs->bps + 1) + 7) / 8 + 8);
+  need = (limit < FLAC_FRAME_BYTES) ? limit : FLAC_FRAME_BYTES;
+  fs->frameStart = -1;                        /* buffer will be used */
+  for(;;) {
+    avail = loadWindow(dop, fs, offset, need);
+    if(avail < 0)
+      return(-1);
+    br.buf = fs->win + (offset - fs->winOffs);
+    br.numBits = (size_t)avail * 8;
+    br.bitPos = 0;
+    br.overrun = FALSE;
+    err = parseFrame(&br, fs, &fh);
+    if(err == FRM_OK)
+      break;
+    if(err == FRM_BAD || avail < need || avail >= limit ||\
+       offset + avail >= fs->fileSize)
+      return(0);
+    need = 2 * avail;                        /* frame may be longer */
+    if(need > limit)
+      need = limit;
+  }
+  fs->frameStart = fh.firstSmp;
+  fs->frameLen = fh.blockSize;
+  fs->frameOffs = offset;
+  fs->nextOffs = offset + (long)(br.bitPos / 8);
+  return(1);
+}
+
+/***********************************************************************
+* parse a frame into the frame buffer; returns FRM_...                 *
+***********************************************************************/
+LOCAL int parseFrame(BIT_READER *br, FLAC_STATE *fs, FRAME_HEAD *fh)
+{
+  int     ch, bps, err;
+  long    i, n;
+  int64_t mid, side;
+  int32_t *left, *right;
+
+  err = parseFrameHead(br, fs, fh);
+  if(err != FRM_OK)
+    return(err);
+  n = fh->blockSize;
+  for(ch = 0; ch < fs->channels; ch++) {
+    bps = fs->bps;
+    if((fh->chanAssign == FLAC_LEFT_SIDE && ch == 1) ||\
+       (fh->chanAssign == FLAC_SIDE_RIGHT && ch == 0) ||\
+       (fh->chanAssign == FLAC_MID_SIDE && ch == 1))
+      bps++;                                       /* side channel */
+    if(bps > 32)
+      return(FRM_BAD);
+    err = decodeSubframe(br, fs->smp + (size_t)ch * (size_t)(fs->maxBlock),\
+			 n, bps);
+    if(err != FRM_OK)
+      return(err);
+  }
+  br->bitPos = (br->bitPos + 7) & ~(size_t)7;          /* zero padding */
+  if(br->bitPos + 16 > br->numBits)
+    return(FRM_SHORT);
+  if(crc16(br->buf, br->bitPos / 8) != getBits(br, 16))
+    return(FRM_BAD);
+
+  left = fs->smp;
+  right = fs->smp + fs->maxBlock;
+  switch(fh->chanAssign) {
+  case FLAC_LEFT_SIDE:
+    for(i = 0; i < n; i++)
+      right[i] = (int32_t)((int64_t)left[i] - right[i]);
+    break;
+  case FLAC_SIDE_RIGHT:
+    for(i = 0; i < n; i++)
+      left[i] = (int32_t)((int64_t)left[i] + right[i]);
+    break;
+  case FLAC_MID_SIDE:
+    for(i = 0; i < n; i++) {
+      side = right[i];
+      mid = ((int64_t)left[i] * 2) | (side & 1);
+      left[i] = (int32_t)((mid + side) / 2);
+      right[i] = (int32_t)((mid - side) / 2);
+    }
+    break;
+  default:
+    break;
+  }
+  return(FRM_OK);
+}
+
+/***********************************************************************
+* parse a frame header and check it against the stream info; returns   *
+* FRM_...                                                              *
+***********************************************************************/
+LOCAL int parseFrameHead(BIT_READER *br, FLAC_STATE *fs, FRAME_HEAD *fh)
+{
+  uint32_t varBlock, bsCode, srCode, chCode, ssCode;
+  uint64_t number;
+  int      channels, bps;
+
+  if(getBits(br, 15) != FLAC_SYNC)
+    return(br->overrun ? FRM_SHORT : FRM_BAD);
+  varBlock = getBits(br, 1);
+  bsCode = getBits(br, 4);
+  srCode = getBits(br, 4);
+  chCode = getBits(br, 4);
+  ssCode = getBits(br, 3);
+  if(getBits(br, 1) != 0 || bsCode == 0 || srCode == 15 ||\
+     chCode > FLAC_MID_SIDE || ssCode == 3 || getUTF8(br, &number) < 0)
+    return(br->overrun ? FRM_SHORT : FRM_BAD);
+  if(bsCode == 1)
+    fh->blockSize = 192;
+  else if(bsCode <= 5)
+    fh->blockSize = 576L << (bsCode - 2);
+  else if(bsCode == 6)
+    fh->blockSize = (long)getBits(br, 8) + 1;
+  else if(bsCode == 7)
+    fh->blockSize = (long)getBits(br, 16) + 1;
+  else
+    fh->blockSize = 256L << (bsCode - 8);
+  if(srCode == 12)
+    getBits(br, 8);              /* sample rate taken from stream info */
+  else if(srCode == 13 || srCode == 14)
+    getBits(br, 16);
+  if(br->overrun)
+    return(FRM_SHORT);
+  if(crc8(br->buf, br->bitPos / 8) != getBits(br, 8))
+    return(br->overrun ? FRM_SHORT : FRM_BAD);
+
+  fh->chanAssign = (int)chCode;
+  channels = (chCode < FLAC_LEFT_SIDE) ? (int)chCode + 1 : 2;
+  switch(ssCode) {
+  case 0:
+    bps = fs->bps;
+    break;
+  case 1:
+    bps = 8;
+    break;
+  case 2:
+    bps = 12;
+    break;
+  case 4:
+    bps = 16;
+    break;
+  case 5:
+    bps = 20;
+    break;
+  case 6:
+    bps = 24;
+    break;
+  default:
+    bps = 32;
+    break;
+  }
+  if(channels != fs->channels || bps != fs->bps ||\
+     fh->blockSize > fs->maxBlock)
+    return(FRM_BAD);
+  if(varBlock)
+    fh->firstSmp = (long)number;
+  else if(fs->minBlock == fs->maxBlock)
+    fh->firstSmp = (long)number * fs->maxBlock;
+  else
+    fh->firstSmp = (long)number * fh->blockSize;
+  if(fs->numSamples > 0 && fh->firstSmp >= fs->numSamples)
+    return(FRM_BAD);
+  return(FRM_OK);
+}
+
+/***********************************************************************
+* decode a subframe of "blockSize" samples with "bps" bits into "out"; *
+* returns FRM_...                                                      *
+***********************************************************************/
+LOCAL int decodeSubframe(BIT_READER *br, int32_t *out, long blockSize,\
+			 int bps)
+{
+  uint32_t type, wasted;
+  int32_t  val, coef[FLAC_MAX_LPC];
+  int      order, precision, shift, err, i;
+  long     n;
+
+  if(getBits(br, 1) != 0)
+    return(br->overrun ? FRM_SHORT : FRM_BAD);
+  type = getBits(br, 6);
+  wasted = 0;
+  if(getBits(br, 1) != 0) {
+    wasted = getUnary(br) + 1;
+    if(wasted >= (uint32_t)bps)
+      return(br->overrun ? FRM_SHORT : FRM_BAD);
+    bps -= (int)wasted;
+  }
+  if(type == 0) {                                         /* CONSTANT */
+    val = getSBits(br, bps);
+    for(n = 0; n < blockSize; n++)
+      out[n] = val;
+  }
+  else if(type == 1) {                                    /* VERBATIM */
+    for(n = 0; n < blockSize && !(br->overrun); n++)
+      out[n] = getSBits(br, bps);
+  }
+  else if(type >= 8 && type <= 8 + FLAC_MAX_FIXED) {         /* FIXED */
+    order = (int)type - 8;
+    if(order > blockSize)
+      return(FRM_BAD);
+    for(i = 0; i < order; i++)
+      out[i] = getSBits(br, bps);
+    err = decodeResidual(br, out, blockSize, order);
+    if(err != FRM_OK)
+      return(err);
+    predict(out, blockSize, fixedCoef[order], order, 0);
+  }
+  else if(type >= 32) {                                        /* LPC */
+    order = (int)type - 31;
+    if(order > blockSize)
+      return(FRM_BAD);
+    for(i = 0; i < order; i++)
+      out[i] = getSBits(br, bps);
+    precision = (int)getBits(br, 4) + 1;
+    shift = (int)getSBits(br, 5);
+    if(precision > 15 || shift < 0)
+      return(br->overrun ? FRM_SHORT : FRM_BAD);
+    for(i = 0; i < order; i++)
+      coef[i] = getSBits(br, precision);
+    err = decodeResidual(br, out, blockSize, order);
+    if(err != FRM_OK)
+      return(err);
+    predict(out, blockSize, coef, order, shift);
+  }
+  else
+    return(FRM_BAD);                                      /* reserved */
+  if(br->overrun)
+    return(FRM_SHORT);
+  if(wasted > 0)
+    for(n = 0; n < blockSize; n++)
+      out[n] = (int32_t)((uint32_t)out[n] << wasted);
+  return(FRM_OK);
+}
+
+/***********************************************************************
+* decode the Rice-coded residual of a subframe into "out" behind the   *
+* "order" warm-up samples; returns FRM_...                             *
+***********************************************************************/
+LOCAL int decodeResidual(BIT_READER *br, int32_t *out, long blockSize,\
+			 int order)
+{
+  uint32_t method, partOrder, param, escape, rawBits, u;
+  long     partLen, part, numParts, n, end;
+  int      paramBits;
+
+  method = getBits(br, 2);
+  if(method > 1)
+    return(br->overrun ? FRM_SHORT : FRM_BAD);
+  paramBits = (method == 0) ? 4 : 5;
+  escape = (1U << paramBits) - 1;
+  partOrder = getBits(br, 4);
+  numParts = 1L << partOrder;
+  partLen = blockSize >> partOrder;
+  if(partLen * numParts != blockSize || partLen < order)
+    return(br->overrun ? FRM_SHORT : FRM_BAD);
+  n = order;
+  for(part = 0; part < numParts; part++) {
+    end = (part + 1) * partLen;
+    param = getBits(br, paramBits);
+    if(param == escape) {                         /* unencoded values */
+      rawBits = getBits(br, 5);
+      for(; n < end; n++)
+	out[n] = (rawBits > 0) ? getSBits(br, (int)rawBits) : 0;
+    }
+    else {
+      for(; n < end; n++) {
+	u = (getUnary(br) << param) | getBits(br, (int)param);
+	out[n] = (int32_t)((u >> 1) ^ (~(u & 1) + 1));
+      }
+    }
+    if(br->overrun)
+      return(FRM_SHORT);
+  }
+  return(FRM_OK);
+}
+
+/***********************************************************************
+* add the prediction to the residual in "out" behind the warm-up       *
+* samples                                                              *
+***********************************************************************/
+LOCAL void predict(int32_t *out, long blockSize, const int32_t *coef,\
+		   int order, int shift)
+{
+  long    n;
+  int     i;
+  int64_t sum;
+
+  for(n = order; n < blockSize; n++) {
+    sum = 0;
+    for(i = 0; i < order; i++)
+      sum += (int64_t)coef[i] * (int64_t)out[n - 1 - i];
+    out[n] = (int32_t)(out[n] + (sum >> shift));
+  }
+  return;
+}
+
+/***********************************************************************
+* bit reader (MSB first); reading beyond the end returns zeros and     *
+* sets the overrun flag                                                *
+***********************************************************************/
+LOCAL uint32_t getBits(BIT_READER *br, int numBits)
+{
+  uint32_t val;
+  int      left, take;
+
+  if(br->bitPos + (size_t)numBits > br->numBits) {
+    br->overrun = TRUE;
+    br->bitPos = br->numBits;
+    return(0);
+  }
+  val = 0;
+  while(numBits > 0) {
+    left = 8 - (int)(br->bitPos & 7);
+    take = (numBits < left) ? numBits : left;
+    val = (val << take) |\
+      ((uint32_t)(br->buf[br->bitPos >> 3] >> (left - take)) &\
+       ((1U << take) - 1));
+    numBits -= take;
+    br->bitPos += (size_t)take;
+  }
+  return(val);
+}
+
+LOCAL int32_t getSBits(BIT_READER *br, int numBits)
+{
+  uint32_t val;
+
+  if(numBits < 1)
+    return(0);
+  val = getBits(br, numBits);
+  if(numBits < 32 && (val & (1U << (numBits - 1))))
+    return((int32_t)((int64_t)val - ((int64_t)1 << numBits)));
+  return((int32_t)val);
+}
+
+LOCAL uint32_t getUnary(BIT_READER *br)
+{
+  uint32_t count;
+  unsigned byte;
+
+  count = 0;
+  while(br->bitPos < br->numBits) {
+    byte = ((unsigned)(br->buf[br->bitPos >> 3]) << (br->bitPos & 7))\
+      & 0xFF;
+    if(byte != 0) {
+      while(!(byte & 0x80)) {
+	byte <<= 1;
+	count++;
+	br->bitPos++;
+      }
+      br->bitPos++;                              /* the terminating 1 */
+      return(count);
+    }
+    count += 8 - (uint32_t)(br->bitPos & 7);
+    br->bitPos = (br->bitPos | 7) + 1;
+  }
+  br->overrun = TRUE;
+  return(0);
+}
+
+/***********************************************************************
+* read a frame or sample number coded like UTF-8 (up to 36 bits)       *
+***********************************************************************/
+LOCAL int getUTF8(BIT_READER *br, uint64_t *val)
+{
+  uint32_t byte, mask;
+  int      numBytes, i;
+
+  byte = getBits(br, 8);
+  if(!(byte & 0x80)) {
+    *val = byte;
+    return(0);
+  }
+  if(byte == 0xFF || (byte & 0xC0) == 0x80)
+    return(-1);
+  for(numBytes = 0, mask = 0x80; byte & mask; mask >>= 1)
+    numBytes++;
+  *val = byte & (mask - 1);
+  for(i = 1; i < numBytes; i++) {
+    byte = getBits(br, 8);
+    if((byte & 0xC0) != 0x80)
+      return(-1);
+    *val = (*val << 6) | (byte & 0x3F);
+  }
+  return(0);
+}
+
+/***********************************************************************
+* CRCs of frame header and frame                                       *
+***********************************************************************/
+LOCAL unsigned crc8(uint8_t *ptr, size_t numBytes)
+{
+  unsigned crc=0;
+
+  while(numBytes-- > 0) {
+    crc = ((crc << 4) & 0xFF) ^ crc8Tab[(crc >> 4) ^ (*ptr >> 4)];
+    crc = ((crc << 4) & 0xFF) ^ crc8Tab[(crc >> 4) ^ (*ptr & 0x0F)];
+    ptr++;
+  }
+  return(crc);
+}
+
+LOCAL unsigned crc16(uint8_t *ptr, size_t numBytes)
+{
+  unsigned crc=0;
+
+  while(numBytes-- > 0) {
+    crc = ((crc << 4) & 0xFFFF) ^ crc16Tab[(crc >> 12) ^ (*ptr >> 4)];
+    crc = ((crc << 4) & 0xFFFF) ^ crc16Tab[(crc >> 12) ^ (*ptr & 0x0F)];
+    ptr++;
+  }
+  return(crc);
+}
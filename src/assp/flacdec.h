@@ -0,0 +1,53 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     flacdec.h                                                  *
+* Contents: Constants and prototypes for decoding FLAC files.          *
+*                                                                      *
+***********************************************************************/
+
+#ifndef _FLACDEC_H
+#define _FLACDEC_H
+
+#include <dlldef.h>   /* ASSP_EXTERN */
+#include <dataobj.h>  /* DOBJ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLAC_MAGIC     "fLaC"
+#define ID3_MAGIC      "ID3"    /* tag which may precede FLAC_MAGIC */
+#define ID3_HDR_SIZE   10
+
+/*
+ * prototypes of functions in flacdec.c
+ */
+ASSP_EXTERN int  flacHeader(DOBJ *dop);
+ASSP_EXTERN void flacFree(DOBJ *dop);
+ASSP_EXTERN long flacSeek(DOBJ *dop, long recordNr);
+ASSP_EXTERN long flacTell(DOBJ *dop);
+ASSP_EXTERN long flacRead(DOBJ *dop, void *buffer, long numRecords);
+ASSP_EXTERN void flacSearchLimits(long numBytes, long numBlocks);
+
+#ifdef __cplusplus
+} /* closing brace for extern "C" */
+#endif
+
+#endif /* _FLACDEC_H */
@@ -41,6 +41,7 @@
 #include <inttypes.h> /* int8_t int16_t */
 #include <math.h>     /* fabs() log10() exp() pow() */
 #include <float.h>    /* DBL_EPSILON */
+#include <pthread.h>  /* pthread_create() pthread_mutex_lock() */
 
 #include <miscdefs.h> /* TRUE FALSE LOCAL NATIVE_EOL PI TWO_PI */
 #include <misc.h>     /* strxcmp() STAT and statistical functions */
@@ -53,6 +54,7 @@
 #include <dataobj.h>  /* DOBJ getSmpCaps() getSmpFrame() */
 #include <headers.h>  /* KDTAB */
 #include <aucheck.h>  /* checkSound() */
+#include <asspprof.h> /* PROF_... */
 
 /*
  * export variables
@@ -62,16 +64,17 @@ unsigned long totFMTfiles, totFMTframes, totFMTsilent, totFMTfail;
 
 /*
  * local global variables and arrays
+ * (one copy per thread so that 'computeFMTpar' can run analyses in parallel)
  */
-LOCAL char trgepFormat[64], fpbFormat[32];
+LOCAL ASSP_TLS char trgepFormat[64], fpbFormat[32];
 
-LOCAL double *rmsBuf=NULL; /* buffer for RMS calculation (allocated) */
-LOCAL double *frame=NULL;  /* frame buffer incl. leading sample (allocated) */
-LOCAL double *wfc=NULL;    /* window function coefficients (allocated) */
-LOCAL double  wfGain=1.0;  /* gain of window function (linear) */
+LOCAL ASSP_TLS double *rmsBuf=NULL; /* buffer for RMS calculation (alloc.) */
+LOCAL ASSP_TLS double *frame=NULL;  /* frame buffer incl. leading sample */
+LOCAL ASSP_TLS double *wfc=NULL;    /* window function coefficients */
+LOCAL ASSP_TLS double  wfGain=1.0;  /* gain of window function (linear) */
 
 /* fixed size arrays */
-LOCAL double refFreq[MAXFORMANTS];
+LOCAL ASSP_TLS double refFreq[MAXFORMANTS];
 typedef struct formant_limits {
   double min;  /* absolute lowest frequency */
   double pLo;  /* lowest frequency of non-overlapping range */
@@ -79,7 +82,7 @@ typedef struct formant_limits {
   double pHi;  /* highest frequency of non-overlapping range */
   double max;  /* absolute highest frequency */
 } FMTLIMS;
-LOCAL FMTLIMS limits[FMT_MAX_BUF];
+LOCAL ASSP_TLS FMTLIMS limits[FMT_MAX_BUF];
 
 typedef struct formant_data {
   double RMS;               /* RMS amplitude (dB) */
@@ -92,21 +95,49 @@ typedef struct formant_data {
   int8_t slot[FMT_MAX_BUF]; /* formant slot (count starts at 0) */
   int8_t lock[FMT_MAX_BUF]; /* indicator: formant number fixed */
 } FMTDATA;
-LOCAL FMTDATA sortBuf;
+LOCAL ASSP_TLS FMTDATA sortBuf;
 /* LOCAL long sortBufBfn, sortBufEfn; */ /* no tracking over time yet */
 
 typedef struct dynamic_programming_values {
   double pc[FMT_MAX_BUF]; /* (conditional) probabilities R = Fn */
   int    bt[FMT_MAX_BUF]; /* back trace */
 } FMT_DP;
-LOCAL FMT_DP dp[FMT_MAX_BUF];
+LOCAL ASSP_TLS FMT_DP dp[FMT_MAX_BUF];
 
 /* #define TP_FACTOR 0.75 */  /* factor for transition probabilities */
 /* #define TP_FACTOR sqrt(0.5) */    /* NEW in R2.0 */
 #define TP_FACTOR 0.5         /* NEW in R2.0 */
-LOCAL double tp[FMT_MAX_BUF]; /* transition probabilities */
-
-LOCAL BAIRSTOW term;          /* termination criteria for bairstow() */
+LOCAL ASSP_TLS double tp[FMT_MAX_BUF]; /* transition probabilities */
+
+LOCAL ASSP_TLS BAIRSTOW term; /* termination criteria for bairstow() */
+
+/* root tracking state kept between calls in push mode */
+LOCAL ASSP_TLS DOBJ  *trackDOp=NULL;   /* object of which tracking continues */
+LOCAL ASSP_TLS int    trackResetPQ;
+LOCAL ASSP_TLS double trackPQP[MAXFORMANTS*2];
+
+/* administration of the concurrent analysis in computeFMTpar() */
+typedef struct formant_segment {
+  long   begFrameNr;     /* analysis interval of segment */
+  long   endFrameNr;
+  DOBJ  *segDOp;         /* results (memory object) */
+  short  msgNum;         /* message state after analysis */
+  char   message[MAX_MSG_LEN+1];
+} FMT_SEG;
+
+typedef struct formant_job {
+  DOBJ    *smpDOp;       /* input object of the caller */
+  AOPTS   *aoPtr;        /* analysis options of the caller */
+  double   sampFreq;
+  long     frameShift;
+  FMT_SEG *seg;
+  long     numSegs;
+  long     nextSeg;      /* next segment to be analysed */
+  int      failed;       /* stop taking segments */
+  int      profActive;   /* profiling switched on by the caller */
+  ASSP_PROF prof;        /* profiling data of the workers */
+  pthread_mutex_t lock;
+} FMT_JOB;
 
 /*
  * prototypes of private functions
@@ -116,7 +147,11 @@ LOCAL int  setPreEmph(FMT_GD *gd, AOPTS *aoPtr, double sampFreq);
 LOCAL int  setGlobals(DOBJ *dop);
 LOCAL void freeGlobals(void);
 LOCAL void setRefTables(double F1);
+LOCAL void frameLevel(double *sPtr, long frameSize, wfunc_e winFunc,\
+		      FMTDATA *fPtr);
 LOCAL void nomFData(FMTDATA *fPtr, int N);
+LOCAL int  storeRecords(DOBJ *segDOp, DOBJ *dop);
+LOCAL void *fmtWorker(void *arg);
 LOCAL void pqStart(double *freq, double *pqp, int N, double sampFreq);
 LOCAL int  sortPQ(double *pqp, int N);
 LOCAL int  classFmt(long frameNr, FMTDATA *fPtr, int numFmt, DOBJ *dop);
@@ -451,6 +486,9 @@ Note:
    done).
    If there are incompatibilities it will probably be easiest just to 
    destroy the data object and let this function create a new one.
+ - If the option AOPT_STREAM is set in the generic data structure of 
+   "fmtDOp", the root tracking continues in the next call for the same 
+   object with "aoPtr" a NULL-pointer (see 'anaStreamOpen').
 
 DOC*/
 
@@ -465,6 +503,7 @@ DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp)
   double  pqp[MAXFORMANTS*2], ffb[MAXFORMANTS*2];
   double  pf[MAXFORMANTS];
   FMT_GD *gd;
+  PROF_DECL(t)
 
   if(smpDOp == NULL || (aoPtr == NULL && fmtDOp == NULL)) {
     setAsspMsg(AEB_BAD_ARGS, "computeFMT");
@@ -561,7 +600,14 @@ DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp)
 #endif
   /* loop over frames */
   clrAsspMsg();
-  RESET_PQ = TRUE;
+  if(aoPtr == NULL && fmtDOp == trackDOp) {   /* continue push mode */
+    RESET_PQ = trackResetPQ;
+    memcpy(pqp, trackPQP, sizeof(pqp));
+  }
+  else
+    RESET_PQ = TRUE;
+  trackDOp = NULL;
+  PROF_START(t);
   for(fn = gd->begFrameNr; fn < gd->endFrameNr; fn++) {
     err = 0;
     PF_VALID = FALSE;
@@ -571,24 +617,8 @@ DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp)
       err = -1;
       break;
     }
-    dPtr = &frame[head];
-    for(i = 0; i < frameSize; i++)
-      rmsBuf[i] = *(dPtr++);
-    if(gd->winFunc > WF_RECTANGLE)
-      mulSigWF(rmsBuf, wfc, frameSize);
-    getACF(rmsBuf, atc, frameSize, 1);
-    if(atc[0] <= 0.0) {
-      sortBuf.RMS = RMS_MIN_dB;
-      sortBuf.LP1 = 0.0;
-    }
-    else {
-      sortBuf.RMS = sqrt(atc[0]/(double)frameSize) / wfGain;
-      if(sortBuf.RMS <= RMS_MIN_AMP) /* bottom clip for dB conversion */
-	sortBuf.RMS = RMS_MIN_dB;
-      else
-	sortBuf.RMS = LINtodB(sortBuf.RMS);
-      sortBuf.LP1 = -atc[1]/atc[0];
-    }
+    PROF_LAP(t, PRF_FRAME);
+    frameLevel(&frame[head], frameSize, gd->winFunc, &sortBuf);
     if(sortBuf.RMS < gd->rmsSil) {                 /* below threshold */
       if(TRACE['s'])
 	totFMTsilent++;
@@ -609,7 +639,9 @@ DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp)
       preEmphasis(dPtr, gd->preEmph, frame[0], frameSize);
       if(gd->winFunc > WF_RECTANGLE)
 	mulSigWF(dPtr, wfc, frameSize);
+      PROF_LAP(t, PRF_WINDOW);                /* incl. RMS of frame */
       getACF(dPtr, atc, frameSize, gd->lpOrder);
+      PROF_LAP(t, PRF_TRANSFORM);
       if(!USE_DURBIN) {
 	if((i=lpSLA(atc, lpc, &(sortBuf.gain), gd->lpOrder, pf,\
 		    sampFreq)) < 0) {
@@ -709,7 +741,11 @@ DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp)
 	    m++;
 	}
 	for(n = 0; n < m; n++) {
-	  i = lpc2pqp(lpc, pqp, gd->lpOrder, &term);
+	  if(gd->options & FMT_OPT_ROOTS_AE)
+	    i = lpc2pqpAE(lpc, pqp, gd->lpOrder, &term,\
+			  !(gd->options & FMT_OPT_AE_SORTED));
+	  else
+	    i = lpc2pqp(lpc, pqp, gd->lpOrder, &term);
 	  if(i >= 0 || n >= m-1)
 	    break;
 	  /* re-initialze PQ pairs and try again */
@@ -772,12 +808,20 @@ DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp)
 	}
       }
     }
+    PROF_LAP(t, PRF_SOLVE);       /* LP, root solving and classifying */
     if(err < 0)
       break;
     if((err=storeFMT(&sortBuf, fn, fmtDOp)) < 0)
       break;
+    PROF_LAP(t, PRF_STORE);
+    PROF_COUNT(PRC_FRAMES, 1);
   } /* END loop over frames */
   freeGlobals();
+  if(err >= 0 && (gd->options & AOPT_STREAM)) {
+    trackDOp = fmtDOp;          /* more frames will follow in next call */
+    trackResetPQ = RESET_PQ;
+    memcpy(trackPQP, pqp, sizeof(pqp));
+  }
   if(err >= 0 && FILE_OUT)
     err = asspFFlush(fmtDOp, gd->writeOpts);
   if(err < 0) {
@@ -792,6 +836,229 @@ DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp)
 
 /*DOC
 
+Function 'splitFMT'
+
+Determines the frames at which the analysis interval of the formant 
+data object pointed to by "fmtDOp" may be split into segments that can 
+be analysed independently of each other. These are frames which 
+'computeFMT' considers silent: there the root tracking is reset anyway 
+(there is no tracking over time in the classification) so that the 
+analysis of a segment starting at such a frame yields exactly the same 
+results as the analysis of the whole interval.
+The interval is divided into at most "maxSegs" segments of roughly equal 
+length, each one starting at the first silent frame after the nominal 
+boundary. The first frame number of each segment is returned in the 
+array "segBeg" which must have space for "maxSegs" items; the first 
+segment always starts at the begin of the analysis interval.
+Both "smpDOp" and "fmtDOp" must have been set up by 'computeFMT' (e.g. 
+using the option AOPT_INIT_ONLY).
+Returns the number of segments (at least 1) or -1 upon error.
+
+Note:
+ - Only the RMS amplitude of the frames is computed. The search stops 
+   at the first silent frame after a nominal boundary so that it will 
+   usually only take a small fraction of the analysis time. Only in the 
+   worst case of a signal without any pauses all frames are evaluated.
+
+DOC*/
+
+long splitFMT(DOBJ *smpDOp, DOBJ *fmtDOp, long *segBeg, long maxSegs)
+{
+  long    fn, numFrames, segLen, numSegs;
+  double  rmsSil;
+  FMT_GD *gd;
+  FMTDATA level;
+
+  if(smpDOp == NULL || fmtDOp == NULL || fmtDOp->generic == NULL ||\
+     segBeg == NULL || maxSegs < 1) {
+    setAsspMsg(AEB_BAD_ARGS, "splitFMT");
+    return(-1);
+  }
+  gd = (FMT_GD *)(fmtDOp->generic);
+  segBeg[0] = gd->begFrameNr;
+  numSegs = 1;
+  numFrames = gd->endFrameNr - gd->begFrameNr;
+  segLen = (numFrames + maxSegs - 1) / maxSegs;
+  if(segLen < FMT_MIN_SEG_FRAMES)
+    segLen = FMT_MIN_SEG_FRAMES;
+  if(numFrames < 2 * segLen)
+    return(numSegs);                       /* not worth the trouble */
+  rmsSil = gd->rmsSil;          /* same bottom clip as in computeFMT() */
+  if(rmsSil < RMS_MIN_dB + 3.0)
+    rmsSil = RMS_MIN_dB + 3.0;
+  if(setGlobals(fmtDOp) < 0)
+    return(-1);
+  for(fn = gd->begFrameNr + segLen;\
+      fn < gd->endFrameNr && numSegs < maxSegs; fn++) {
+    if(getSmpFrame(smpDOp, fn, gd->frameSize, fmtDOp->frameDur, 1, 0,\
+		   gd->channel, (void *)frame, FMT_PFORMAT) < 0) {
+      freeGlobals();
+      return(-1);
+    }
+    frameLevel(&frame[1], gd->frameSize, gd->winFunc, &level);
+    if(level.RMS < rmsSil) {
+      segBeg[numSegs++] = fn;
+      fn += (segLen - 1);         /* skip to the next nominal boundary */
+    }
+  }
+  freeGlobals();
+  return(numSegs);
+}
+
+/*DOC
+
+Function 'computeFMTpar'
+
+Performs the same formant estimation as 'computeFMT' but splits the 
+analysis interval at silent frames (see 'splitFMT') and analyses the 
+resulting segments concurrently using up to "numThreads" threads. The 
+results are identical to those of 'computeFMT'. Arguments and return 
+value are as for 'computeFMT', except that "aoPtr" may not be a NULL-
+pointer.
+If the input object refers to a file, each thread opens the file 
+anew; audio data in memory are shared by the threads. The results of 
+the segments are kept in memory and are copied in order to the data 
+buffer of "fmtDOp" or written to file by the calling thread.
+If "numThreads" is less than 2, in push mode, for single-frame 
+analysis, with statistics tracing or if the interval can not be split 
+this function simply calls 'computeFMT'.
+
+Note:
+ - Warnings are reported as by 'computeFMT' (the last one encountered 
+   in the analysis interval).
+
+DOC*/
+
+DOBJ *computeFMTpar(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp, int numThreads)
+{
+  int       CREATED, err;
+  long      n, numSegs, *segBeg;
+  pthread_t *tid;
+  FMT_GD   *gd, *segGD;
+  FMT_SEG  *seg;
+  FMT_JOB   job;
+
+  if(smpDOp == NULL || aoPtr == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "computeFMTpar");
+    return(NULL);
+  }
+  if(numThreads < 2 || TRACE['s'] ||\
+     (aoPtr->options & (AOPT_INIT_ONLY | AOPT_USE_CTIME | AOPT_STREAM)))
+    return(computeFMT(smpDOp, aoPtr, fmtDOp));
+  if(smpDOp->fp == NULL &&\
+     (smpDOp->dataBuffer == NULL || smpDOp->bufNumRecs <= 0)) {
+    setAsspMsg(AED_NO_DATA, "(computeFMTpar)");
+    return(NULL);
+  }
+  /* let computeFMT() set up the objects and buffers */
+  CREATED = (fmtDOp == NULL);
+  aoPtr->options |= AOPT_INIT_ONLY;
+  fmtDOp = computeFMT(smpDOp, aoPtr, fmtDOp);
+  aoPtr->options &= ~AOPT_INIT_ONLY;
+  if(fmtDOp == NULL)
+    return(NULL);
+  gd = (FMT_GD *)(fmtDOp->generic);
+  n = (long)numThreads * FMT_SEGS_PER_THREAD;
+  if((segBeg=(long *)calloc((size_t)n, sizeof(long))) == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "(computeFMTpar)");
+    if(CREATED)
+      freeDObj(fmtDOp);
+    return(NULL);
+  }
+  numSegs = splitFMT(smpDOp, fmtDOp, segBeg, n);
+  if(numSegs < 2) {
+    free((void *)segBeg);
+    if(numSegs == 1 && computeFMT(smpDOp, NULL, fmtDOp) != NULL)
+      return(fmtDOp);
+    if(CREATED)
+      freeDObj(fmtDOp);
+    return(NULL);
+  }
+  job.smpDOp = smpDOp;
+  job.aoPtr = aoPtr;
+  job.sampFreq = fmtDOp->sampFreq;
+  job.frameShift = fmtDOp->frameDur;
+  job.numSegs = numSegs;
+  job.nextSeg = 0;
+  job.failed = FALSE;
+  job.profActive = asspProf.active;
+  memset((void *)&(job.prof), 0, sizeof(ASSP_PROF));
+  job.seg = (FMT_SEG *)calloc((size_t)numSegs, sizeof(FMT_SEG));
+  if(numThreads > numSegs)
+    numThreads = (int)numSegs;
+  tid = (pthread_t *)calloc((size_t)numThreads, sizeof(pthread_t));
+  if(job.seg == NULL || tid == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "(computeFMTpar)");
+    free((void *)segBeg);
+    if(job.seg != NULL)
+      free((void *)job.seg);
+    if(tid != NULL)
+      free((void *)tid);
+    if(CREATED)
+      freeDObj(fmtDOp);
+    return(NULL);
+  }
+  for(n = 0; n < numSegs; n++) {
+    job.seg[n].begFrameNr = segBeg[n];
+    if(n < numSegs - 1)
+      job.seg[n].endFrameNr = segBeg[n+1];
+    else
+      job.seg[n].endFrameNr = gd->endFrameNr;
+  }
+  free((void *)segBeg);
+  pthread_mutex_init(&(job.lock), NULL);
+  for(n = 0; n < numThreads; n++) {
+    if(pthread_create(&tid[n], NULL, fmtWorker, (void *)&job) != 0)
+      break;
+  }
+  numThreads = (int)n;
+  if(numThreads == 0)                    /* do the work ourselves then */
+    fmtWorker((void *)&job);
+  for(n = 0; n < numThreads; n++)
+    pthread_join(tid[n], NULL);
+  pthread_mutex_destroy(&(job.lock));
+  profMerge(&asspProf, &(job.prof));
+  free((void *)tid);
+  /* collect the results in order */
+  err = 0;
+  clrAsspMsg();
+  for(n = 0; n < numSegs; n++) {
+    seg = &(job.seg[n]);
+    if(seg->segDOp == NULL) {         /* the first one that has failed */
+      setAsspMsg(seg->msgNum, seg->message);
+      err = -1;
+      break;
+    }
+    segGD = (FMT_GD *)(seg->segDOp->generic);
+    if(segGD->begFrameNr != seg->begFrameNr ||\
+       segGD->endFrameNr != seg->endFrameNr ||\
+       seg->segDOp->recordSize != fmtDOp->recordSize) {
+      setAsspMsg(AEG_ERR_BUG, "computeFMTpar: segment mismatch");
+      err = -1;
+      break;
+    }
+    if((err=storeRecords(seg->segDOp, fmtDOp)) < 0)
+      break;
+    if(seg->msgNum != 0)                      /* keep the last warning */
+      setAsspMsg(seg->msgNum, seg->message);
+  }
+  for(n = 0; n < numSegs; n++) {
+    if(job.seg[n].segDOp != NULL)
+      freeDObj(job.seg[n].segDOp);
+  }
+  free((void *)job.seg);
+  if(err >= 0 && fmtDOp->fp != NULL)
+    err = asspFFlush(fmtDOp, gd->writeOpts);
+  if(err < 0) {
+    if(CREATED)
+      freeDObj(fmtDOp);
+    return(NULL);
+  }
+  return(fmtDOp);
+}
+
+/*DOC
+
 Function 'freeFMT_GD'
 
 Returns all memory allocated for the generic data in an FMT data object.
@@ -920,7 +1187,7 @@ LOCAL int setGlobals(DOBJ *dop)
     if((ODD(frameSize) && EVEN(frameShift)) ||
        (EVEN(frameSize) && ODD(frameShift)) )
       wFlags = WF_ASYMMETRIC;       /* align window and frame centres */
-    wfc = makeWF(gd->winFunc, frameSize, wFlags);
+    wfc = getWF(gd->winFunc, frameSize, wFlags);
     if(wfc == NULL) {
       setAsspMsg(AEG_ERR_MEM, "(FMT: setGlobals)");
       return(-1);
@@ -1105,6 +1372,35 @@ LOCAL void nomFData(FMTDATA *fPtr, int N)
   return;
 }
 /***********************************************************************
+* Compute RMS amplitude (dB) and 1st order LP coefficient of the frame *
+* starting at "sPtr"; this also decides whether the frame is silent.   *
+***********************************************************************/
+LOCAL void frameLevel(double *sPtr, long frameSize, wfunc_e winFunc,\
+		      FMTDATA *fPtr)
+{
+  long   i;
+  double atc[2];
+
+  for(i = 0; i < frameSize; i++)
+    rmsBuf[i] = *(sPtr++);
+  if(winFunc > WF_RECTANGLE)
+    mulSigWF(rmsBuf, wfc, frameSize);
+  getACF(rmsBuf, atc, frameSize, 1);
+  if(atc[0] <= 0.0) {
+    fPtr->RMS = RMS_MIN_dB;
+    fPtr->LP1 = 0.0;
+  }
+  else {
+    fPtr->RMS = sqrt(atc[0]/(double)frameSize) / wfGain;
+    if(fPtr->RMS <= RMS_MIN_AMP)   /* bottom clip for dB conversion */
+      fPtr->RMS = RMS_MIN_dB;
+    else
+      fPtr->RMS = LINtodB(fPtr->RMS);
+    fPtr->LP1 = -atc[1]/atc[0];
+  }
+  return;
+}
+/***********************************************************************
 * Estimate PQ start values for bairstow() from a set of frequencies.   *
 ***********************************************************************/
 LOCAL void pqStart(double *freq, double *pqp, int N, double sampFreq)
@@ -1790,6 +2086,98 @@ LOCAL int storeFMT(FMTDATA *fPtr, long frameNr, DOBJ *dop)
   return(0);
 }
 /***********************************************************************
+* Thread function of computeFMTpar(): analyse segments until none are  *
+* left or one has failed.                                              *
+***********************************************************************/
+LOCAL void *fmtWorker(void *arg)
+{
+  AOPTS    opts;
+  DOBJ    *inpDOp;
+  FMT_SEG *seg;
+  FMT_JOB *job;
+  ASSP_PROF saved;
+
+  job = (FMT_JOB *)arg;
+  saved = asspProf;    /* may be the calling thread (no workers started) */
+  profReset(job->profActive);
+  inpDOp = NULL;
+  if(job->smpDOp->fp == NULL)          /* audio data in memory: share */
+    inpDOp = job->smpDOp;
+  while(TRUE) {
+    pthread_mutex_lock(&(job->lock));
+    seg = NULL;
+    if(!job->failed && job->nextSeg < job->numSegs)
+      seg = &(job->seg[job->nextSeg++]);
+    pthread_mutex_unlock(&(job->lock));
+    if(seg == NULL)
+      break;
+    if(inpDOp == NULL)     /* need own file position and input buffer */
+      inpDOp = asspFOpen(job->smpDOp->filePath, AFO_READ, NULL);
+    if(inpDOp != NULL) {
+      opts = *(job->aoPtr);
+      opts.beginTime = FRMNRtoTIME(seg->begFrameNr, job->sampFreq,\
+				   job->frameShift);
+      opts.endTime = FRMNRtoTIME(seg->endFrameNr, job->sampFreq,\
+				 job->frameShift);
+      seg->segDOp = computeFMT(inpDOp, &opts, NULL);
+    }
+    seg->msgNum = asspMsgNum;
+    strcpy(seg->message, applMessage);
+    if(seg->segDOp == NULL) {
+      pthread_mutex_lock(&(job->lock));
+      job->failed = TRUE;
+      pthread_mutex_unlock(&(job->lock));
+      break;
+    }
+  }
+  if(inpDOp != NULL && inpDOp != job->smpDOp)
+    asspFClose(inpDOp, AFC_FREE);
+  pthread_mutex_lock(&(job->lock));
+  profMerge(&(job->prof), &asspProf);
+  pthread_mutex_unlock(&(job->lock));
+  asspProf = saved;
+  return(NULL);
+}
+/***********************************************************************
+* Copy the records in the memory object "segDOp" to the output object  *
+* "dop" (cf. storeFMT()).                                              *
+***********************************************************************/
+LOCAL int storeRecords(DOBJ *segDOp, DOBJ *dop)
+{
+  long    fn, endFn, ndx, numRecs;
+  FMT_GD *gd;
+
+  gd = (FMT_GD *)(dop->generic);
+  fn = segDOp->bufStartRec;
+  endFn = fn + segDOp->bufNumRecs;
+  while(fn < endFn) {
+    if(dop->bufNumRecs <= 0) {
+      dop->bufNumRecs = 0;
+      dop->bufStartRec = fn;
+    }
+    else if(fn >= (dop->bufStartRec + dop->maxBufRecs)) {
+      if(dop->fp == NULL) {
+	setAsspMsg(AEG_ERR_BUG, "computeFMTpar: buffer overflow");
+	return(-1);
+      }
+      if(asspFFlush(dop, gd->writeOpts) < 0)
+	return(-1);
+      continue;
+    }
+    ndx = fn - dop->bufStartRec;
+    numRecs = MIN(endFn - fn, dop->maxBufRecs - ndx);
+    memcpy((char *)dop->dataBuffer + ndx * dop->recordSize,\
+	   (char *)segDOp->dataBuffer +\
+	   (fn - segDOp->bufStartRec) * segDOp->recordSize,\
+	   (size_t)(numRecs * dop->recordSize));
+    if(ndx + numRecs > dop->bufNumRecs)
+      dop->bufNumRecs = ndx + numRecs;
+    dop->bufNeedsSave = TRUE;
+    fn += numRecs;
+  }
+  return(0);
+}
+/***********************************************************************
 * Print raw analysis data to trace output stream.                      *
 ***********************************************************************/
 LOCAL int printRaw(FMTDATA *fPtr, long frameNr, int numFMT, DOBJ *dop)
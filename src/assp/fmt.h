@@ -114,6 +114,9 @@ extern "C" {
 #define FMT_OPT_PE_FIXED  0x00000001 /* pre-emphasis fixed */
 #define FMT_OPT_LPO_FIXED 0x00000004 /* LP order fixed */
 #define FMT_OPT_INS_ESTS  0x00000008 /* insert estimates */
+#define FMT_OPT_ROOTS_AE  0x00000010 /* Aberth-Ehrlich root solver */
+#define FMT_OPT_AE_SORTED 0x00000020 /* with sorted rather than */
+                                     /* Bairstow-compatible PQ order */
 
 /* NOT-options for evaluation purposes only */
 #define FMT_NOT_SORT_PQ   0x00010000
@@ -142,6 +145,12 @@ extern "C" {
 #define FMT_O_CHANS (1)       /* maximum number of output channels */
 #define FMT_PFORMAT DF_REAL64 /* processing format */
 
+/*
+ * parameters for the concurrent analysis of segments ('computeFMTpar')
+ */
+#define FMT_SEGS_PER_THREAD 4   /* segments per thread for load balance */
+#define FMT_MIN_SEG_FRAMES  200 /* minimum number of frames per segment */
+
 /*
  * generic data structure for holding converted analysis parameters
  * Note: - Parameters like 'sampFreq' and 'frameShift' are in the 
@@ -174,6 +183,10 @@ ASSP_EXTERN int   setFMTgenderDefaults(AOPTS *aoPtr, char gender);
 ASSP_EXTERN int   setFMTdefaults(AOPTS *aoPtr);
 ASSP_EXTERN DOBJ *createFMT(DOBJ *smpDOp, AOPTS *aoPtr);
 ASSP_EXTERN DOBJ *computeFMT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp);
+ASSP_EXTERN long  splitFMT(DOBJ *smpDOp, DOBJ *fmtDOp, long *segBeg,\
+			   long maxSegs);
+ASSP_EXTERN DOBJ *computeFMTpar(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *fmtDOp,\
+				int numThreads);
 ASSP_EXTERN void  freeFMT_GD(void *ptr);
 ASSP_EXTERN void  initFMTstats(void);
 ASSP_EXTERN void  freeFMTstats(void);
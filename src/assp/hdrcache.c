@@ -0,0 +1,311 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     hdrcache.c                                                 *
+* Contents: In-process cache of parsed file headers. Opening a file    *
+*           which is in the cache skips guessing its format and        *
+*           parsing its header (see asspFOpen()).                      *
+*                                                                      *
+***********************************************************************/
+
+#include <stdio.h>      /* FILE fileno() fseek() */
+#include <stdlib.h>     /* calloc() free() */
+#include <string.h>     /* strcmp() strdup() */
+#include <sys/types.h>
+#include <sys/stat.h>   /* fstat() */
+#include <pthread.h>    /* pthread_mutex_lock() */
+
+#include <miscdefs.h>   /* TRUE FALSE LOCAL */
+#include <asspmess.h>   /* message codes; reference to globals */
+#include <dataobj.h>    /* DOBJ FDF_BIN copyDObj() clearDObj() */
+#include <hdrcache.h>
+
+/*
+ * cache entry: the header items and descriptors of the data object
+ * after getHeader() and the identity of the file
+ */
+typedef struct hdr_entry {
+  char  *path;             /* file path as passed to asspFOpen() */
+  off_t  size;             /* file size and */
+  time_t mtime;            /* modification time when header was read */
+  long   mtimeNs;          /*   nanoseconds thereof (0 if not known) */
+  DOBJ   hdr;              /* no file pointer, path or data buffer */
+} HDR_ENTRY;
+
+/*
+ * prototypes of private functions
+ */
+LOCAL int   enabled(void);
+LOCAL int   fileIdent(DOBJ *dop, off_t *size, time_t *mtime, long *nsec);
+LOCAL long  slotIndex(char *path);
+LOCAL void  freeEntry(HDR_ENTRY *entry);
+
+/*
+ * the cache is a direct-mapped table indexed by a hash of the path;
+ * a new entry replaces the one in its slot
+ */
+LOCAL pthread_mutex_t hdrLock = PTHREAD_MUTEX_INITIALIZER;
+LOCAL HDR_ENTRY **hdrTable = NULL;
+LOCAL long hdrTableSize = 0;
+
+/*DOC
+
+Function 'hdrCacheSize'
+
+Sets the number of slots in the header cache to "numEntries", removing
+all entries. A value of 0 disables the cache (the default) and frees
+its memory; if "numEntries" equals the current size, the cache is left
+as it is.
+Returns 0 upon success and -1 upon error.
+
+DOC*/
+
+int hdrCacheSize(long numEntries)
+{
+  long i;
+  HDR_ENTRY **table=NULL;
+
+  if(numEntries < 0) {
+    setAsspMsg(AEB_BAD_ARGS, "hdrCacheSize");
+    return(-1);
+  }
+  pthread_mutex_lock(&hdrLock);
+  if(numEntries == hdrTableSize) {
+    pthread_mutex_unlock(&hdrLock);
+    return(0);
+  }
+  if(numEntries > 0) {
+    table = (HDR_ENTRY **)calloc((size_t)numEntries, sizeof(HDR_ENTRY *));
+    if(table == NULL) {
+      pthread_mutex_unlock(&hdrLock);
+      setAsspMsg(AEG_ERR_MEM, "hdrCacheSize");
+      return(-1);
+    }
+  }
+  if(hdrTable != NULL) {
+    for(i = 0; i < hdrTableSize; i++)
+      freeEntry(hdrTable[i]);
+    free((void *)hdrTable);
+  }
+  hdrTable = table;
+  hdrTableSize = numEntries;
+  pthread_mutex_unlock(&hdrLock);
+  return(0);
+}
+
+/*DOC
+
+Function 'hdrCacheEntries'
+
+Returns the number of headers held in the cache.
+
+DOC*/
+
+long hdrCacheEntries(void)
+{
+  long i, n;
+
+  n = 0;
+  pthread_mutex_lock(&hdrLock);
+  for(i = 0; i < hdrTableSize; i++) {
+    if(hdrTable[i] != NULL)
+      n++;
+  }
+  pthread_mutex_unlock(&hdrLock);
+  return(n);
+}
+
+/*DOC
+
+Function 'hdrCacheGet'
+
+Looks up the header of the file opened for reading in the data object
+pointed to by "dop". If the cache holds the header of a file with the
+same path, size and modification time, the header items and data
+descriptors are copied into the data object as getHeader() would have
+set them and the file is positioned at the start of the data.
+Returns 1 if the header was found, 0 otherwise (also if the cache is
+disabled).
+
+DOC*/
+
+int hdrCacheGet(DOBJ *dop)
+{
+  char  *savePath;
+  int    saveMode, found;
+  FILE  *saveFile;
+  off_t  size;
+  time_t mtime;
+  long   nsec;
+  HDR_ENTRY *entry;
+
+  if(dop == NULL || dop->fp == NULL || dop->filePath == NULL ||\
+     !enabled())
+    return(0);
+  if(fileIdent(dop, &size, &mtime, &nsec) < 0)
+    return(0);
+  saveFile = dop->fp;
+  savePath = dop->filePath;
+  saveMode = dop->openMode;
+  found = FALSE;
+  pthread_mutex_lock(&hdrLock);
+  if(hdrTableSize > 0) {
+    entry = hdrTable[slotIndex(savePath)];
+    if(entry != NULL && entry->size == size && entry->mtime == mtime &&\
+       entry->mtimeNs == nsec && strcmp(entry->path, savePath) == 0) {
+      if(copyDObj(dop, &(entry->hdr)) >= 0)
+	found = TRUE;
+      else
+	clrAsspMsg();                       /* just parse the header */
+    }
+  }
+  pthread_mutex_unlock(&hdrLock);
+  dop->fp = saveFile;
+  dop->filePath = savePath;
+  dop->openMode = saveMode;
+  if(found && fseek(dop->fp, dop->headerSize, SEEK_SET) != 0) {
+    clearDObj(dop);
+    dop->fp = saveFile;
+    dop->filePath = savePath;
+    dop->openMode = saveMode;
+    found = FALSE;
+  }
+  return(found);
+}
+
+/*DOC
+
+Function 'hdrCachePut'
+
+Stores the header of the file opened for reading in the data object
+pointed to by "dop" in the cache. This should be called directly after
+a successful getHeader(). Headers of text files, of files with generic
+data (e.g. labels), compressed data or FLAC files and headers which
+raised a warning are not cached.
+
+DOC*/
+
+void hdrCachePut(DOBJ *dop)
+{
+  off_t  size;
+  time_t mtime;
+  long   nsec, slot;
+  HDR_ENTRY *entry, *old;
+
+  if(dop == NULL || dop->fp == NULL || dop->filePath == NULL ||\
+     !enabled())
+    return;
+  if(dop->fileData != FDF_BIN || dop->generic != NULL ||\
+     dop->blk != NULL || dop->flac != NULL || asspMsgNum != 0)
+    return;
+  if(fileIdent(dop, &size, &mtime, &nsec) < 0)
+    return;
+  entry = (HDR_ENTRY *)calloc(1, sizeof(HDR_ENTRY));
+  if(entry == NULL)
+    return;
+  initDObj(&(entry->hdr));
+  entry->path = strdup(dop->filePath);
+  if(entry->path == NULL || copyDObj(&(entry->hdr), dop) < 0) {
+    freeEntry(entry);
+    clrAsspMsg();                   /* caching is not essential */
+    return;
+  }
+  entry->size = size;
+  entry->mtime = mtime;
+  entry->mtimeNs = nsec;
+  old = NULL;
+  pthread_mutex_lock(&hdrLock);
+  if(hdrTableSize > 0) {
+    slot = slotIndex(entry->path);
+    old = hdrTable[slot];
+    hdrTable[slot] = entry;
+  }
+  else
+    old = entry;                         /* disabled in the meantime */
+  pthread_mutex_unlock(&hdrLock);
+  freeEntry(old);
+  return;
+}
+
+/***********************************************************************
+* is the cache switched on                                             *
+***********************************************************************/
+LOCAL int enabled(void)
+{
+  int on;
+
+  pthread_mutex_lock(&hdrLock);
+  on = (hdrTableSize > 0);
+  pthread_mutex_unlock(&hdrLock);
+  return(on);
+}
+
+/***********************************************************************
+* get size and modification time of the file opened in "dop"; the      *
+* nanoseconds tell apart files rewritten within the same second        *
+***********************************************************************/
+LOCAL int fileIdent(DOBJ *dop, off_t *size, time_t *mtime, long *nsec)
+{
+  struct stat st;
+
+  if(dop->fp == stdin || fstat(fileno(dop->fp), &st) != 0)
+    return(-1);
+  if(!S_ISREG(st.st_mode))
+    return(-1);
+  *size = st.st_size;
+  *mtime = st.st_mtime;
+#if defined(_WIN32)
+  *nsec = 0;                        /* whole seconds only */
+#elif defined(__APPLE__)
+  *nsec = (long)st.st_mtimespec.tv_nsec;
+#else
+  *nsec = (long)st.st_mtim.tv_nsec;
+#endif
+  return(0);
+}
+
+/***********************************************************************
+* FNV-1a hash of "path" reduced to a slot of the table                 *
+***********************************************************************/
+LOCAL long slotIndex(char *path)
+{
+  unsigned long hash;
+  unsigned char *cPtr;
+
+  hash = 2166136261UL;
+  for(cPtr = (unsigned char *)path; *cPtr != '\0'; cPtr++) {
+    hash ^= (unsigned long)(*cPtr);
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+  }
+  return((long)(hash % (unsigned long)hdrTableSize));
+}
+
+/***********************************************************************
+* return the memory of a cache entry                                   *
+***********************************************************************/
+LOCAL void freeEntry(HDR_ENTRY *entry)
+{
+  if(entry != NULL) {
+    clearDObj(&(entry->hdr));
+    if(entry->path != NULL)
+      free((void *)(entry->path));
+    free((void *)entry);
+  }
+  return;
+}
@@ -0,0 +1,47 @@
+/***********************************************************************
+*                                                                      *
+* This file is part of the Advanced Speech Signal Processor library.   *
+*                                                                      *
+* This library is free software: you can redistribute it and/or modify *
+* it under the terms of the GNU General Public License as published by *
+* the Free Software Foundation, either version 3 of the License, or    *
+* (at your option) any later version.                                  *
+*                                                                      *
+* This library is distributed in the hope that it will be useful,      *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+* GNU General Public License for more details.                         *
+*                                                                      *
+* You should have received a copy of the GNU General Public License    *
+* along with this library. If not, see <http://www.gnu.org/licenses/>. *
+*                                                                      *
+*----------------------------------------------------------------------*
+*                                                                      *
+* File:     hdrcache.h                                                 *
+* Contents: Prototypes for the in-process cache of parsed file headers.*
+*                                                                      *
+***********************************************************************/
+
+#ifndef _HDRCACHE_H
+#define _HDRCACHE_H
+
+#include <dlldef.h>   /* ASSP_EXTERN */
+#include <dataobj.h>  /* DOBJ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * prototypes of functions in hdrcache.c
+ */
+ASSP_EXTERN int  hdrCacheSize(long numEntries);
+ASSP_EXTERN long hdrCacheEntries(void);
+ASSP_EXTERN int  hdrCacheGet(DOBJ *dop);
+ASSP_EXTERN void hdrCachePut(DOBJ *dop);
+
+#ifdef __cplusplus
+} /* closing brace for extern "C" */
+#endif
+
+#endif /* _HDRCACHE_H */
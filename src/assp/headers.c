@@ -50,6 +50,8 @@
 #include <dataobj.h>    /* DOBJ DDESC fform_e fdata_e */
 #include <labelobj.h>   /* LBLHDR */
 #include <headers.h>    /* constants and structures */
+#include <blockio.h>    /* BLK_SSFF_ID blkEnable() blkScan() */
+#include <flacdec.h>    /* FLAC_MAGIC ID3_MAGIC flacHeader() */
 #include <aucheck.h>    /* auCapsFF() checkSound() */
 #include <ipds_lbl.h>   /* IPdS MIX and SAMPA formats */
 #include <esps_lbl.h>   /* ESPS xlabel format */
@@ -147,6 +149,7 @@ KDTAB KDT_SSFF[] = {
   {"lps"    , NULL, "dB", DT_FTLPS},
   {"css"    , NULL, "dB", DT_FTCSS},
   {"cep"    , NULL, NULL, DT_FTCEP},
+  {"mfcc"   , NULL, NULL, DT_MFCC},
   {"epg"    , NULL, NULL, DT_EPG},
   {NULL     , NULL, NULL, DT_UNDEF}
 };
@@ -212,6 +215,7 @@ fform_e guessFormat(FILE *fp, char *filePath, fdata_e *dataFormat)
 {
   char    buf[ONEkBYTE], *field[MAX_HDR_FIELDS], ident[NAME_MAX+1];
   int     n, i, asc, err;
+  long    offset;
   size_t  numBytes;
   fform_e fileFormat;
 
@@ -273,6 +277,24 @@ fform_e guessFormat(FILE *fp, char *filePath, fdata_e *dataFormat)
       fileFormat = FF_SSFF;
       *dataFormat = FDF_BIN;
     }
+    else if(strncmp(buf, FLAC_MAGIC, 4) == 0) {
+      fileFormat = FF_FLAC;
+      *dataFormat = FDF_BIN;
+    }
+    else if(strncmp(buf, ID3_MAGIC, 3) == 0) { /* tag in front of FLAC? */
+      offset = ID3_HDR_SIZE + (((long)(buf[6] & 0x7F) << 21) |\
+			       ((long)(buf[7] & 0x7F) << 14) |\
+			       ((long)(buf[8] & 0x7F) << 7) |\
+			       (long)(buf[9] & 0x7F));
+      if(buf[5] & 0x10)                          /* footer present */
+	offset += ID3_HDR_SIZE;
+      if(fseek(fp, offset, SEEK_SET) == 0 &&\
+	 fread(ident, 1, 4, fp) == 4 &&\
+	 strncmp(ident, FLAC_MAGIC, 4) == 0) {
+	fileFormat = FF_FLAC;
+	*dataFormat = FDF_BIN;
+      }
+    }
   }
   if(fileFormat == FF_UNDEF) {                  /* not identified yet */
     if((asc=isASCII(fp)) < 0) {                       /* ASC or BIN ? */
@@ -429,6 +451,8 @@ int getHeader(DOBJ *dop)
   case FF_WAVE:
   case FF_WAVE_X:
     return(getWAVhdr(dop));
+  case FF_FLAC:
+    return(flacHeader(dop));
   case FF_UWM:
     return(checkXRMB(dop)); /* no real header but identifyable */
   default:
@@ -2710,6 +2734,16 @@ LOCAL int getSSFFhdr(DOBJ *dop)
 	  return(-1);
 	}
 	dop->sampFreq = strtod(field[2], &rest);
+      }
+      else if(strcmp(field[0], BLK_SSFF_ID) == 0) {
+	if(strcmp(field[1], BLK_CODEC_NAME) != 0) {
+	  asspMsgNum = AEF_BAD_FORM;
+	  snprintf(applMessage, sizeof(applMessage), "(compression %s) in file %s",\
+		  field[1], dop->filePath);
+	  return(-1);
+	}
+	if(blkEnable(dop, 0) < 0)
+	  return(-1);
       } else if (n > 2) {
       	/* this is probably a generic variable 
       	 * if so than field[1] must be a valid SSFF size/type thingy as defined above 
@@ -2761,7 +2795,12 @@ LOCAL int getSSFFhdr(DOBJ *dop)
   }
   adjustTiming(dop);                 /* set startRecord and Time_Zero */
   setRecordSize(dop);
-  if(dop->recordSize > 0)
+  if(dop->blk != NULL) {              /* compressed: count the records */
+    dop->numRecords = blkScan(dop);
+    if(dop->numRecords < 0)
+      return(-1);
+  }
+  else if(dop->recordSize > 0)
     dop->numRecords = (fileSize - dop->headerSize) / (long)(dop->recordSize); 
   return(0);
 }
@@ -2819,6 +2858,11 @@ LOCAL int putSSFFhdr(DOBJ *dop)
   cPtr = &header[strlen(header)];
   snprintf(cPtr, sizeof(header) - strlen(header), "%s %.*f", SSFF_TIME_ID, nd, dop->Start_Time);
   strcat(header, dop->eol);
+  if(dop->blk != NULL) {
+    cPtr = &header[strlen(header)];
+    snprintf(cPtr, sizeof(header) - strlen(header), "%s %s", BLK_SSFF_ID, BLK_CODEC_NAME);
+    strcat(header, dop->eol);
+  }
   
   int prev_header_length = strlen(header);
   while(dd != NULL) {
@@ -74,6 +74,11 @@
 #define KSV_MIN_PRD 2.6544 /* at least 3 periods (1+(1-PDTOLT)*(2-PDTOLT)) */
 #define KSV_NUM_AMV 8      /* number of AMV values */
 
+/*
+ * export variables
+ */
+ASSP_TLS KSV_USAGE ksvUsage;
+
 /*
  * structures
  */
@@ -118,9 +123,12 @@ LOCAL int   numExtr[2];  /* current number of extrema of each type */
 LOCAL TWIN *twinBuf;     /* array for period twins linked to chains */
 LOCAL int   maxTwins;    /* size of period chain buffer */
 LOCAL int   lastUsed;    /* index of last used element in twinBuf */
+LOCAL int   firstFree;   /* index of first unused element in twinBuf */
+LOCAL int   numTwins;    /* number of elements in use in twinBuf */
 LOCAL int   aliveIndex;  /* index of last twin of alive period chain */
 LOCAL PRDS *ringBuf;     /* ring buffer with (summed) period durations */
 LOCAL int   ringLength;  /* size of period ring buffer at sampling rate */
+LOCAL int   ringDelay;   /* nominal length of ring before conversion */
 LOCAL long  ringBsn;     /* sample number of begin of ring */
 LOCAL int   ringHead;    /* corresponding index in ringBuf */
 LOCAL long  ringEsn;     /* end sample number of ring */
@@ -136,15 +144,30 @@ LOCAL int   minDurChain; /* minimum duration of a chain in samples */
 LOCAL int   minVoiced;   /* minimum number of voiced samples in frame */
 LOCAL int   VOICED;      /* flag for marking voiced regions */
 LOCAL DOBJ *workDOp;     /* data object with workspace */
+LOCAL long  blockRecs;   /* size of analysis block in workspace */
+/* state of push-mode analysis */
+LOCAL int   STREAMING;   /* ksvInit() called but not yet ksvFinish() */
+LOCAL long  streamSmpNr; /* number of samples pushed so far */
+LOCAL long  scanStart;   /* extremum search position in workspace */
+LOCAL DOBJ *streamDOp;   /* describes the pushed samples */
+LOCAL DOBJ *streamF0DOp; /* output object returned by ksvInit() */
+LOCAL DOBJ *streamPrdDOp;/* optional object for period markers */
 
 /*
  * prototypes of local functions
  */
 LOCAL int  setGlobals(DOBJ *f0DOp);
 LOCAL int  checkTags(DOBJ *prdDOp, DOBJ *smpDOp);
-LOCAL int  allocBufs(DOBJ *smpDOp);
+LOCAL int  allocBufs(DOBJ *smpDOp, long extraRecs);
 LOCAL void freeBufs(void);
+LOCAL int  streamOutBuf(long numSmps);
+LOCAL int  scanStream(long endSn);
+LOCAL void endStream(void);
 LOCAL int  ksvExtr(long *start, long end, long *sn, float *mag, int *type);
+LOCAL int  growExtr(void);
+LOCAL int  growTwins(void);
+LOCAL int  growRing(long minLength);
+LOCAL void relTwin(int i);
 LOCAL int  ksvTwin(long sn3, float a3, int type);
 LOCAL double ksvZCR(long bsn, int dur);
 LOCAL int  ksvAMV(long bsn, int dur, double amv[]);
@@ -509,6 +532,10 @@ DOBJ *computeKSV(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *f0DOp, DOBJ *prdDOp)
     setAsspMsg(AEB_BAD_ARGS, "computeKSV");
     return(NULL);
   }
+  if(STREAMING) {
+    setAsspMsg(AEB_BAD_CALL, "computeKSV: push-mode analysis active");
+    return(NULL);
+  }
   err = 0;
   FILE_IN = FILE_OUT = CREATED = FALSE;
   /* check input object */
@@ -563,7 +590,7 @@ DOBJ *computeKSV(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *f0DOp, DOBJ *prdDOp)
       return(f0DOp);                                   /* no analysis */
     }
   }
-  if(allocBufs(smpDOp) < 0) {
+  if(allocBufs(smpDOp, 0) < 0) {
     if(CREATED)
       freeDObj(f0DOp);
     return(NULL);
@@ -599,6 +626,7 @@ DOBJ *computeKSV(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *f0DOp, DOBJ *prdDOp)
     fprintf(traceFP, "  extrema buffer : %d per type\n", maxExtrema);
     fprintf(traceFP, "  twin buffer    : %d elements\n", maxTwins);
     fprintf(traceFP, "  ring buffer    : %d samples\n", ringLength);
+    fprintf(traceFP, "  ring delay     : %d samples\n", ringDelay);
     fprintf(traceFP, "  delay to output: %d samples\n", outputDelay);
     fprintf(traceFP, "  overlap        : %d samples\n", smpOverlap);
     fprintf(traceFP, "  audio buffer   : %ld records\n",\
@@ -703,6 +731,18 @@ DOBJ *computeKSV(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *f0DOp, DOBJ *prdDOp)
 	storeTag("EOF", temp, prdDOp);
     }
   }
+#ifndef WRASSP
+  if(TRACE['A']) {
+    fprintf(traceFP, "Peak buffer usage\n");
+    fprintf(traceFP, "  extrema        : %d of %d per type\n",\
+	    ksvUsage.maxExtrema, maxExtrema);
+    fprintf(traceFP, "  twins          : %d of %d elements\n",\
+	    ksvUsage.maxTwins, maxTwins);
+    fprintf(traceFP, "  ring           : %ld of %d samples\n",\
+	    ksvUsage.maxRing, ringLength);
+    fprintf(traceFP, "  extensions     : %ld\n", ksvUsage.numGrown);
+  }
+#endif
   freeBufs();
   if(err < 0) {
     if(smpDOp->filePath != NULL) {
@@ -719,6 +759,224 @@ DOBJ *computeKSV(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *f0DOp, DOBJ *prdDOp)
 
 /*DOC
 
+Function 'ksvInit'
+
+Starts a push-mode KSV F0 analysis of an audio signal of unknown length. 
+The audio object pointed to by "smpDOp" only serves to describe the 
+samples that will be passed to 'ksvPush' (sampling rate, data format, 
+number of channels); it need not contain data nor refer to a file. 
+The analysis parameters are taken from the structure pointed to by 
+"aoPtr" except for the analysis interval: the analysis always starts at 
+the first sample pushed and ends at the last one. If "prdDOp" is not a 
+NULL pointer, voicing and period markers will be generated as in 
+'computeKSV'.
+Returns a pointer to a newly created F0 data object which will receive 
+the analysis results, or NULL upon error. That object remains owned by 
+the calling function and should only be freed after 'ksvFinish'.
+
+Note:
+ - Only one KSV analysis can be active at a time; 'computeKSV' will 
+   refuse to run between 'ksvInit' and 'ksvFinish'.
+ - The results are identical to those of 'computeKSV' for the same 
+   samples held in memory.
+
+DOC*/
+
+DOBJ *ksvInit(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *prdDOp)
+{
+  DOBJ   *f0DOp;
+  KSV_GD *gd;
+
+  if(smpDOp == NULL || aoPtr == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "ksvInit");
+    return(NULL);
+  }
+  if(STREAMING) {
+    setAsspMsg(AEB_BAD_CALL, "ksvInit: push-mode analysis active");
+    return(NULL);
+  }
+  if(smpDOp->recordSize <= 0) {
+    setAsspMsg(AEB_BAD_CALL, "ksvInit: invalid audio object");
+    return(NULL);
+  }
+  if((f0DOp=createKSV(smpDOp, aoPtr)) == NULL)
+    return(NULL);
+  gd = (KSV_GD *)(f0DOp->generic);
+  gd->begFrameNr = f0DOp->startRecord = 0;
+  gd->endFrameNr = LONG_MAX / f0DOp->frameDur - 1;      /* open end */
+  gd->writeOpts = AFW_KEEP;
+  streamDOp = NULL;
+  if(setGlobals(f0DOp) < 0 ||
+     allocBufs(smpDOp, 2 * f0DOp->frameDur) < 0) {
+    freeDObj(f0DOp);
+    return(NULL);
+  }
+  if(prdDOp != NULL) {
+    if(checkTags(prdDOp, smpDOp) < 0) {
+      freeBufs();
+      freeDObj(f0DOp);
+      return(NULL);
+    }
+  }
+  workDOp->generic = f0DOp->generic;
+  workDOp->doFreeGeneric = (DOfreeFunc)NULL;
+  streamDOp = allocDObj();
+  if(streamDOp == NULL || copyDObj(streamDOp, smpDOp) < 0) {
+    freeBufs();
+    if(streamDOp != NULL)
+      streamDOp = freeDObj(streamDOp);
+    freeDObj(f0DOp);
+    return(NULL);
+  }
+  streamF0DOp = f0DOp;
+  streamPrdDOp = prdDOp;
+  streamSmpNr = scanStart = 0;
+  if(streamOutBuf(blockRecs) < 0) {
+    endStream();
+    freeDObj(f0DOp);
+    return(NULL);
+  }
+  STREAMING = TRUE;
+  return(f0DOp);
+}
+
+/*DOC
+
+Function 'ksvPush'
+
+Passes the next "numSmps" samples of the signal in the buffer pointed 
+to by "samples" to the push-mode analysis started by 'ksvInit'. The 
+samples should be stored as records in the format described by the 
+audio object given to 'ksvInit', in native byte order. 
+F0 values are computed as soon as the delay required by the algorithm 
+allows it. The data buffer of the F0 object returned by 'ksvInit' is 
+emptied at each call; upon return it holds the newly computed frames, 
+starting at frame number 'bufStartRec'.
+Returns the number of new frames or -1 upon error. In the latter case 
+the analysis is terminated.
+
+DOC*/
+
+long ksvPush(void *samples, long numSmps)
+{
+  long    n, endSn, scanSn, frameShift;
+  KSV_GD *gd;
+
+  if(!STREAMING) {
+    setAsspMsg(AEB_BAD_CALL, "ksvPush: no push-mode analysis active");
+    return(-1);
+  }
+  if(numSmps < 0 || (numSmps > 0 && samples == NULL)) {
+    setAsspMsg(AEB_BAD_ARGS, "ksvPush");
+    return(-1);
+  }
+  gd = (KSV_GD *)(streamF0DOp->generic);
+  frameShift = streamF0DOp->frameDur;
+  streamF0DOp->bufNumRecs = 0;         /* previous frames handed over */
+  if(streamOutBuf(numSmps) < 0) {
+    endStream();
+    return(-1);
+  }
+  streamDOp->dataBuffer = samples;         /* view on caller's buffer */
+  streamDOp->bufStartRec = streamSmpNr;
+  streamDOp->bufNumRecs = streamDOp->maxBufRecs = numSmps;
+  endSn = streamSmpNr + numSmps;
+  while(streamSmpNr < endSn) {
+    /* append as many samples as fit to the workspace */
+    n = workDOp->maxBufRecs - workDOp->bufNumRecs;
+    if(n > endSn - streamSmpNr)
+      n = endSn - streamSmpNr;
+    if(getSmpPtr(streamDOp, streamSmpNr, 0, n-1,\
+		 gd->channel, workDOp) == NULL) {
+      endStream();
+      return(-1);
+    }
+    streamSmpNr += n;
+    /* don't search past the earliest possible end of the interval */
+    scanSn = FRMNRtoSMPNR(SMPNRtoFRMNR(streamSmpNr, frameShift),\
+			  frameShift);
+    if(scanSn > streamSmpNr)
+      scanSn = streamSmpNr;
+    if(scanStream(scanSn) < 0) {
+      endStream();
+      return(-1);
+    }
+  }
+  streamDOp->dataBuffer = NULL;
+  streamDOp->bufNumRecs = streamDOp->maxBufRecs = 0;
+  /*
+   * No future extremum can lie before the search position minus the 
+   * minimum period length, so all frames that ksvConvert() would output 
+   * at that extremum may be output now.
+   */
+  n = workDOp->bufStartRec + scanStart - minPrdLen;
+  if(n > 0) {
+    if(ksvConvert(n, FALSE, streamF0DOp, streamPrdDOp) < 0) {
+      endStream();
+      return(-1);
+    }
+  }
+  if(streamF0DOp->bufNumRecs > 0)
+    streamF0DOp->numRecords = streamF0DOp->bufStartRec\
+                            + streamF0DOp->bufNumRecs;
+  return(streamF0DOp->bufNumRecs);
+}
+
+/*DOC
+
+Function 'ksvFinish'
+
+Terminates the push-mode analysis started by 'ksvInit'. The analysis 
+interval is closed at the last full frame of the samples pushed. The 
+remaining F0 values are computed and returned in the data buffer of the 
+F0 object as in 'ksvPush'; all internal memory is released.
+Returns the number of new frames or -1 upon error.
+
+DOC*/
+
+long ksvFinish(void)
+{
+  int     err;
+  long    frameShift, numZeros;
+  KSV_GD *gd;
+
+  if(!STREAMING) {
+    setAsspMsg(AEB_BAD_CALL, "ksvFinish: no push-mode analysis active");
+    return(-1);
+  }
+  gd = (KSV_GD *)(streamF0DOp->generic);
+  frameShift = streamF0DOp->frameDur;
+  streamF0DOp->bufNumRecs = 0;
+  gd->endFrameNr = SMPNRtoFRMNR(streamSmpNr, frameShift);
+  endSmpNr = FRMNRtoSMPNR(gd->endFrameNr, frameShift);
+  /* interval may end in the middle of the last frame: zero padding */
+  numZeros = endSmpNr - (workDOp->bufStartRec + workDOp->bufNumRecs);
+  if(numZeros > workDOp->maxBufRecs - workDOp->bufNumRecs)
+    numZeros = workDOp->maxBufRecs - workDOp->bufNumRecs;
+  if(numZeros > 0) {
+    memset((char *)(workDOp->dataBuffer) +\
+	   (size_t)(workDOp->bufNumRecs) * workDOp->recordSize,\
+	   0, (size_t)numZeros * workDOp->recordSize);
+    workDOp->bufNumRecs += numZeros;
+  }
+  err = streamOutBuf(0);
+  if(err >= 0)
+    err = scanStream(endSmpNr);
+  if(err >= 0)
+    err = ksvConvert(endSmpNr, TRUE, streamF0DOp, streamPrdDOp);
+  if(err >= 0 && streamPrdDOp != NULL)
+    err = storeTag("EOF", streamSmpNr, streamPrdDOp);
+  if(streamF0DOp->bufNumRecs > 0)
+    streamF0DOp->numRecords = streamF0DOp->bufStartRec\
+                            + streamF0DOp->bufNumRecs;
+  endStream();
+  if(err < 0)
+    return(-1);
+  return(streamF0DOp->bufNumRecs);
+}
+
+/*DOC
+
 Function 'verifyKSV'
 
 Verifies whether the analysis parameters of the F0 data object pointed 
@@ -845,6 +1103,22 @@ void freeKSV_GD(void *generic)
   return;
 }
 
+/*DOC
+
+Function 'initKSVusage'
+
+Clears the record of peak usage of the internal buffers of the KSV 
+analysis. The record accumulates over subsequent calls to computeKSV() 
+until this function is called again.
+
+DOC*/
+
+void initKSVusage(void)
+{
+  memset((void *)&ksvUsage, 0, sizeof(KSV_USAGE));
+  return;
+}
+
 /* ======================= private  functions ======================= */
 
 /***********************************************************************
@@ -870,6 +1144,7 @@ LOCAL int setGlobals(DOBJ *f0DOp)
   ringBsn = ringEsn = begSmpNr;
   ringHead = 0;
   lastUsed = aliveIndex = -1;
+  firstFree = numTwins = 0;
   VOICED = FALSE;
   /*
    * set dependent global constants; determine buffer sizes
@@ -909,7 +1184,7 @@ LOCAL int setGlobals(DOBJ *f0DOp)
   temp = SMPNRctFRMNR(maxLenTwin, frameShift);
   if(temp < 4)       /* some extra space in ring for inhibited chains */
     temp = 4;
-  ringLength = outputDelay + temp * frameShift;
+  ringLength = ringDelay = outputDelay + temp * frameShift;
   return(0);
 }
 /***********************************************************************
@@ -965,16 +1240,18 @@ LOCAL int checkTags(DOBJ *prdDOp, DOBJ *smpDOp)
   return(0);
 }
 /***********************************************************************
-* allocate memory for the global buffers, tables and workspace         *
+* allocate memory for the global buffers, tables and workspace; the    *
+* workspace gets "extraRecs" records beyond the analysis block size    *
 ***********************************************************************/
-LOCAL int allocBufs(DOBJ *smpDOp)
+LOCAL int allocBufs(DOBJ *smpDOp, long extraRecs)
 {
   int    i;
   long   numRecords;
   double dbli, minT, maxT, minC, maxC;
   DDESC *dd;
 
-  extrBuf[0] = (EXTR *)calloc(2*(size_t)maxExtrema, sizeof(EXTR));
+  extrBuf[0] = (EXTR *)calloc((size_t)maxExtrema, sizeof(EXTR));
+  extrBuf[1] = (EXTR *)calloc((size_t)maxExtrema, sizeof(EXTR));
   twinBuf = (TWIN *)calloc((size_t)maxTwins, sizeof(TWIN));
   ringBuf = (PRDS *)calloc((size_t)ringLength, sizeof(PRDS));
   minPdT = (int *)calloc((size_t)(maxPrdLen+1), sizeof(int));
@@ -982,15 +1259,22 @@ LOCAL int allocBufs(DOBJ *smpDOp)
   minPdC = (int *)calloc((size_t)(maxPrdLen+1), sizeof(int));
   maxPdC = (int *)calloc((size_t)(maxPrdLen+1), sizeof(int));
   workDOp = allocDObj();
-  if(extrBuf[0] == NULL || twinBuf == NULL || ringBuf == NULL ||
+  if(extrBuf[0] == NULL || extrBuf[1] == NULL ||
+     twinBuf == NULL || ringBuf == NULL ||
      minPdT == NULL || maxPdT == NULL || minPdC == NULL || maxPdC == NULL ||
      workDOp == NULL) {
     freeBufs();
     setAsspMsg(AEG_ERR_MEM, "KSV: allocBufs");
     return(-1);
   }
-  extrBuf[1] = &extrBuf[0][maxExtrema]; /* set pointer for second buf */
   numExtr[0] = numExtr[1] = 0;   /* other buffers cleared by calloc() */
+  ksvUsage.numCalls++;
+  if(maxExtrema > ksvUsage.extrSize)
+    ksvUsage.extrSize = maxExtrema;
+  if(maxTwins > ksvUsage.twinSize)
+    ksvUsage.twinSize = maxTwins;
+  if(ringLength > ksvUsage.ringSize)
+    ksvUsage.ringSize = ringLength;
   /* initialize tolerance tables */
   for(i = 0; i < minPrdLen; i++)
     minPdT[i] = maxPdT[i] = minPdC[i] = maxPdC[i] = minPrdLen;
@@ -1032,7 +1316,8 @@ LOCAL int allocBufs(DOBJ *smpDOp)
   }
   if(numRecords > endSmpNr - begSmpNr)
     numRecords = endSmpNr - begSmpNr;
-  if(allocDataBuf(workDOp, numRecords) == NULL) {
+  blockRecs = numRecords;
+  if(allocDataBuf(workDOp, numRecords + extraRecs) == NULL) {
     freeBufs();
     return(-1);
   }
@@ -1045,7 +1330,11 @@ LOCAL void freeBufs(void)
 {
   if(extrBuf[0] != NULL) {
     free((void *)(extrBuf[0]));
-    extrBuf[0] = extrBuf[1] = NULL;
+    extrBuf[0] = NULL;
+  }
+  if(extrBuf[1] != NULL) {
+    free((void *)(extrBuf[1]));
+    extrBuf[1] = NULL;
   }
   if(twinBuf != NULL) {
     free((void *)twinBuf);
@@ -1077,9 +1366,169 @@ LOCAL void freeBufs(void)
   return;
 }
 /***********************************************************************
+* ensure that the data buffer of the F0 object in push mode can hold   *
+* all frames resulting from "numSmps" new samples                      *
+***********************************************************************/
+LOCAL int streamOutBuf(long numSmps)
+{
+  long numFrames;
+
+  numFrames = (numSmps + ringDelay) / streamF0DOp->frameDur + 4;
+  if(streamF0DOp->maxBufRecs < numFrames) {
+    freeDataBuf(streamF0DOp);
+    if(allocDataBuf(streamF0DOp, numFrames) == NULL)
+      return(-1);
+  }
+  return(0);
+}
+/***********************************************************************
+* push mode: search extrema in the workspace up to sample "endSn" and  *
+* move on to the next analysis block when the current one is done and  *
+* followed by more samples; block boundaries, overlap and end of       *
+* search are the same as in computeKSV()                               *
+***********************************************************************/
+LOCAL int scanStream(long endSn)
+{
+  int    type;
+  long   end, smpNr, shift;
+  float  mag;
+  size_t recSize;
+
+  recSize = workDOp->recordSize;
+  while(TRUE) {
+    end = endSn - workDOp->bufStartRec;
+    if(end > blockRecs)
+      end = blockRecs;
+    while(ksvExtr(&scanStart, end, &smpNr, &mag, &type) > 0) {
+      if(ksvConvert(smpNr, FALSE, streamF0DOp, streamPrdDOp) < 0)
+	return(-1);
+      if(ksvTwin(smpNr, mag, type) < 0)
+	return(-1);
+    }
+    if(end < blockRecs ||                  /* block not yet complete */
+       streamSmpNr <= workDOp->bufStartRec + blockRecs) /* no data */
+      break;
+    shift = blockRecs - smpOverlap;       /* keep overlap as reloaded */
+    memmove(workDOp->dataBuffer,\
+	    (char *)(workDOp->dataBuffer) + (size_t)shift * recSize,\
+	    (size_t)(workDOp->bufNumRecs - shift) * recSize);
+    workDOp->bufStartRec += shift;
+    workDOp->bufNumRecs -= shift;
+    scanStart = smpOverlap;
+  }
+  return(0);
+}
+/***********************************************************************
+* release all memory of the push-mode analysis except the F0 object    *
+***********************************************************************/
+LOCAL void endStream(void)
+{
+  freeBufs();
+  if(streamDOp != NULL) {
+    streamDOp->dataBuffer = NULL;            /* belongs to the caller */
+    streamDOp->doFreeDataBuf = NULL;
+    streamDOp = freeDObj(streamDOp);
+  }
+  STREAMING = FALSE;
+  return;
+}
+/***********************************************************************
+* double the size of both extrema buffers; contents are preserved      *
+***********************************************************************/
+LOCAL int growExtr(void)
+{
+  int   n, newSize;
+  void *tmpPtr;
+
+  newSize = 2 * maxExtrema;
+  for(n = 0; n < 2; n++) {
+    tmpPtr = realloc((void *)extrBuf[n], (size_t)newSize * sizeof(EXTR));
+    if(tmpPtr == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "KSV: while trying to extend extrema buffer");
+      return(-1);
+    }
+    extrBuf[n] = (EXTR *)tmpPtr;
+  }
+  maxExtrema = newSize;
+  if(maxExtrema > ksvUsage.extrSize)
+    ksvUsage.extrSize = maxExtrema;
+  ksvUsage.numGrown++;
+  return(0);
+}
+/***********************************************************************
+* double the size of the twin buffer; new elements are marked unused   *
+* Note: only called when all elements are in use.                      *
+***********************************************************************/
+LOCAL int growTwins(void)
+{
+  int   newSize;
+  void *tmpPtr;
+
+  newSize = (maxTwins > 0) ? 2 * maxTwins : 16;
+  tmpPtr = realloc((void *)twinBuf, (size_t)newSize * sizeof(TWIN));
+  if(tmpPtr == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "KSV: while trying to extend twin buffer");
+    return(-1);
+  }
+  twinBuf = (TWIN *)tmpPtr;
+  memset((void *)&twinBuf[maxTwins], 0,\
+	 (size_t)(newSize - maxTwins) * sizeof(TWIN));
+  firstFree = maxTwins;
+  maxTwins = newSize;
+  if(maxTwins > ksvUsage.twinSize)
+    ksvUsage.twinSize = maxTwins;
+  ksvUsage.numGrown++;
+  return(0);
+}
+/***********************************************************************
+* extend the ring buffer to at least 'minLength' samples; the contents *
+* are copied in temporal order so that the ring head moves to index 0  *
+* Note: only the storage grows; the conversion delay is not affected.  *
+***********************************************************************/
+LOCAL int growRing(long minLength)
+{
+  int   j, k, newSize;
+  PRDS *newBuf;
+
+  newSize = 2 * ringLength;
+  while(newSize < minLength)
+    newSize *= 2;
+  newBuf = (PRDS *)calloc((size_t)newSize, sizeof(PRDS));
+  if(newBuf == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "KSV: while trying to extend ring buffer");
+    return(-1);
+  }
+  for(j = ringHead, k = 0; k < ringLength; k++, j++) {
+    j %= ringLength;                      /* wrap around if necessary */
+    newBuf[k] = ringBuf[j];
+  }
+  free((void *)ringBuf);
+  ringBuf = newBuf;
+  ringLength = newSize;
+  ringHead = 0;
+  if(ringLength > ksvUsage.ringSize)
+    ksvUsage.ringSize = ringLength;
+  ksvUsage.numGrown++;
+  return(0);
+}
+/***********************************************************************
+* release element i of the twin buffer                                 *
+***********************************************************************/
+LOCAL void relTwin(int i)
+{
+  if(twinBuf[i].flags != KSV_UNUSED)
+    numTwins--;
+  twinBuf[i].flags = KSV_UNUSED;            /* element no longer in use */
+  if(i < firstFree)             /* keep track of first unused element */
+    firstFree = i;
+  return;
+}
+/***********************************************************************
 * Extremum detector: Searches until either a generalized maximum or a  *
 * generalized minimum is found, or end-of-buffer is reached.           *
-* Returns 1 if extremum found or 0 if end-of-buffer reached.           *
+* Returns 1 if extremum found or 0 if end-of-buffer reached. In the    *
+* latter case "start" is set such that a later call with a larger      *
+* "end" resumes the search seamlessly (used in push mode).             *
 * Differences with respect to paper:                                   *
 * - initialization if start = 0 (only occurs at first read because     *
 *   of required overlap in next reads)                                 *
@@ -1137,6 +1586,7 @@ LOCAL int ksvExtr(long *start, register long end,\
       return(1);
     }
   }
+  *start = i - 1;                           /* position of nextSample */
   return(0); /* end-of-buffer reached */
 }
 /***********************************************************************
@@ -1192,15 +1642,22 @@ LOCAL int ksvTwin(long sn3, float a3, int type)
     }
     else i3 = 0;                    /* gap too large; insert as first */
   }
-  if(i3 >= maxExtrema) {
-    asspMsgNum = AEG_ERR_BUG;
-    snprintf(applMessage, sizeof(applMessage), "\nOverflow in extrema buffer %d at sample #%ld",\
-	    type, sn3);
-    return(-1);
+  if(i3 >= maxExtrema) {                  /* noisy input: extend buffer */
+#ifndef WRASSP
+    if(TRACE['x']) {
+      fprintf(traceFP, "extending extrema buffer %d at sample #%ld\n",\
+	      type, sn3);
+    }
+#endif
+    if(growExtr() < 0)
+      return(-1);
+    ePtr = &extrBuf[type][0];                        /* reset pointer */
   }
   ePtr[i3].sn = sn3;                            /* store new extremum */
   ePtr[i3].mag = a3;
   numExtr[type] = i3 + 1;   /* current number of extrema of this type */
+  if(numExtr[type] > ksvUsage.maxExtrema)
+    ksvUsage.maxExtrema = numExtr[type];
   /*
    * Pair new extremum with all older ones of same type and perform twin
    * tests.
@@ -1359,7 +1816,6 @@ LOCAL int ksvChain(long sn1, long sn2, long sn3, int type)
 {
   register int i, j, k, dur12, dur23;
   register TWIN *tPtr;
-  void *tmpPtr;
   int   APPEND, CURRENT, minDur, maxDur, diff, bestDiff, bestNdx;
   long  age;
   
@@ -1371,10 +1827,9 @@ LOCAL int ksvChain(long sn1, long sn2, long sn3, int type)
    * Check age of chains & release if too old; note last used element 
    * of twinBuf.
    */
-/*   j = lastUsed; */
-/*   for(tPtr = twinBuf, i = 0; i <= j; i++, tPtr++) { */
+  j = lastUsed;           /* no element in use beyond this one */
   lastUsed = -1;
-  for(tPtr = twinBuf, i = 0; i < maxTwins; i++, tPtr++) {
+  for(tPtr = twinBuf, i = 0; i <= j; i++, tPtr++) {
     if(tPtr->flags & KSV_IN_USE) {                    /* used element */
       lastUsed = i;                     /* keep track of last element */
       if(tPtr->flags & KSV_EOC) {                   /* end of a chain */
@@ -1446,27 +1901,23 @@ LOCAL int ksvChain(long sn1, long sn2, long sn3, int type)
    * it also gives the element i in the twin buffer that contains 
    * the predecessor.
    */
-  /* search an unused element */
-  for(tPtr = twinBuf, j = 0; j < maxTwins; j++, tPtr++) {
-    if(tPtr->flags == KSV_UNUSED) break;
-  }
-  if(j >= maxTwins) {                  /* should not but could happen */
-    j = maxTwins;                                   /* just make sure */
+  /* take the first unused element */
+  if(firstFree >= maxTwins) {          /* should not but could happen */
 #ifndef WRASSP
     if(TRACE['x']) {
-      fprintf(traceFP, "extending twin buffer at sample #%ld\n",\
-	      tPtr->sn3);
+      fprintf(traceFP, "extending twin buffer at sample #%ld\n", sn3);
     }
 #endif
-    tmpPtr = realloc((void *)twinBuf, (size_t)(maxTwins+1)*sizeof(TWIN));
-    if(tmpPtr == NULL) {
-      setAsspMsg(AEG_ERR_MEM, "while trying to extend twin buffer");
+    if(growTwins() < 0)
       return(-1);
-    }
-    twinBuf = (TWIN *)tmpPtr; /* no need to clear: will be filled out */
-    maxTwins++;
-    tPtr = &twinBuf[maxTwins-1];        /* set pointer to new element */
   }
+  j = firstFree;
+  tPtr = &twinBuf[j];
+  for(firstFree++; firstFree < maxTwins; firstFree++) {
+    if(twinBuf[firstFree].flags == KSV_UNUSED) break;
+  }
+  if(++numTwins > ksvUsage.maxTwins)
+    ksvUsage.maxTwins = numTwins;
   if(j > lastUsed) lastUsed = j;
   tPtr->dur12 = dur12;                                /* install twin */
   tPtr->dur23 = dur23;
@@ -1497,7 +1948,7 @@ LOCAL int ksvChain(long sn1, long sn2, long sn3, int type)
       /* Update and resets AFTER write, otherwise cannot detect gap! */
       aliveIndex = j;                  /* set alive index to new twin */
       tPtr->link = -1;                                  /* clear link */
-      twinBuf[i].flags = KSV_UNUSED;           /* release predecessor */
+      relTwin(i);                              /* release predecessor */
       CURRENT = TRUE;                         /* alive chain extended */
     }
     else {                           /* check 'birthready' conditions */
@@ -1598,9 +2049,13 @@ LOCAL int putChain(int i, int OVERWRITE)
     tPtr = &twinBuf[i];                                /* set pointer */
     esn = tPtr->sn3;                /* end sample number of next twin */
     if((int)(esn - ringBsn) > ringLength) {    /* should never happen */
-      asspMsgNum = AEG_ERR_BUG;
-      snprintf(applMessage, sizeof(applMessage), "\nOverflow in ring buffer at sample #%ld", esn);
-      return(-1);
+#ifndef WRASSP
+      if(TRACE['x']) {
+	fprintf(traceFP, "extending ring buffer at sample #%ld\n", esn);
+      }
+#endif
+      if(growRing(esn - ringBsn) < 0)
+	return(-1);
     }
     dur23 = tPtr->dur23;             /* duration of right-hand period */
     if(bsn > esn) {
@@ -1658,6 +2113,8 @@ LOCAL int putChain(int i, int OVERWRITE)
     /*         and even past ringEsn */
     if(esn > ringEsn)             /* update end sample number of ring */
       ringEsn = esn;
+    if(ringEsn - ringBsn > ksvUsage.maxRing)
+      ksvUsage.maxRing = ringEsn - ringBsn;
     i = tPtr->link;                               /* get next element */
   }
   return(0);
@@ -1670,7 +2127,7 @@ LOCAL void clrChain(register int i)
   if(i == aliveIndex)
     aliveIndex = -1;                             /* clear alive index */
   while(i >= 0) {                     /* continue until no more links */
-    twinBuf[i].flags = KSV_UNUSED;        /* element no longer in use */
+    relTwin(i);                           /* element no longer in use */
     if(i == lastUsed)                   /* keep track of last element */
       lastUsed--;
     i = twinBuf[i].link;                             /* get next link */
@@ -1700,7 +2157,7 @@ LOCAL int ksvConvert(long smpNr, int FINISH, DOBJ *f0DOp, DOBJ *tagDOp)
   else
     /* CONVERT = ((int)(smpNr - ringBsn) >= outputDelay) ? TRUE : FALSE; */
     /* NEW 190410: use ringLength rather than outputDelay */
-    CONVERT = (smpNr > (ringBsn + ringLength - frameShift));
+    CONVERT = (smpNr > (ringBsn + ringDelay - frameShift));
   TAGS_OUT = (tagDOp != NULL);
   tagSn = ringBsn;
   while(CONVERT) { /* convert and store one frame */
@@ -1763,7 +2220,7 @@ LOCAL int ksvConvert(long smpNr, int FINISH, DOBJ *f0DOp, DOBJ *tagDOp)
     if(FINISH)                    /* repeat conditions for converting */
       CONVERT = (ringBsn < endSmpNr);
     else
-      CONVERT = (smpNr > (ringBsn + ringLength - frameShift));
+      CONVERT = (smpNr > (ringBsn + ringDelay - frameShift));
   }
   if(ringEsn < ringBsn)
     ringEsn = ringBsn;
@@ -128,6 +128,7 @@ extern "C" {
 #define KSV_ASC_FORMAT "XASSP" /* alternative ASCII file format */
 #define KSV_DEF_DIGITS  2      /* digits precision (ASCII) */
 #define KSV_DEF_PRDEXT ".prd"  /* extension for period markers */
+#define KSV_UPD_CONTEXT ANA_UPD_ALL /* tracker state is unbounded */
 
 /*
  * option flags
@@ -171,6 +172,22 @@ typedef struct KSV_analysis_parameters {
   int     writeOpts;  /* options for writing data to file */
 } KSV_GD;
 
+/*
+ * peak usage of the internal buffers; these grow on demand so that
+ * noisy input no longer aborts the analysis with an overflow
+ * (counted per thread: concurrent analyses don't share them)
+ */
+typedef struct KSV_buffer_usage {
+  long    numCalls;   /* number of calls to computeKSV() */
+  int     maxExtrema; /* peak number of extrema of one type */
+  int     maxTwins;   /* peak number of twins in use */
+  long    maxRing;    /* peak fill of period ring buffer (samples) */
+  int     extrSize;   /* largest allocated size of extrema buffer */
+  int     twinSize;   /*   same for twin buffer */
+  long    ringSize;   /*   same for ring buffer */
+  long    numGrown;   /* number of buffer extensions */
+} KSV_USAGE;
+
 /*
  * prototypes of public functions in ksv.c
  */
@@ -181,8 +198,17 @@ ASSP_EXTERN DOBJ *createKSV(DOBJ *smpDOp, AOPTS *aoPtr);
 ASSP_EXTERN DOBJ *createPRD(DOBJ *smpDOp, AOPTS *aoPtr);
 ASSP_EXTERN DOBJ *computeKSV(DOBJ *smpDOp, AOPTS *aoPtr,\
 			     DOBJ *f0DOp, DOBJ *prdDOp);
+ASSP_EXTERN DOBJ *ksvInit(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *prdDOp);
+ASSP_EXTERN long  ksvPush(void *samples, long numSmps);
+ASSP_EXTERN long  ksvFinish(void);
 ASSP_EXTERN int   verifyKSV(DOBJ *f0DOp, DOBJ *smpDOp, AOPTS *aoPtr);
 ASSP_EXTERN void  freeKSV_GD(void *ptr);
+ASSP_EXTERN void  initKSVusage(void);
+
+/*
+ * public variables from ksv.c
+ */
+ASSP_EXTERN ASSP_TLS KSV_USAGE ksvUsage;
 
 #ifdef __cplusplus
 } /* closing brace for extern "C" */
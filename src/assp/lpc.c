@@ -51,7 +51,8 @@
 #include <stdlib.h>   /* abs() */
 #include <math.h>     /* fabs() log() exp() */
 
-#include <miscdefs.h> /* PI TWO_PI */
+#include <dlldef.h>   /* ASSP_TLS */
+#include <miscdefs.h> /* TRUE FALSE PI TWO_PI ODD() */
 #include <asspdsp.h>  /* TINYLIN MAXLPORDER MAXFORMANTS */
 #include <asspmess.h> /* message handler */
 
@@ -450,6 +451,179 @@ int lpc2pqp(double *lpc, double *pqp, int M, BAIRSTOW *tPtr)
 
 /*DOC
 
+Function 'lpc2pqpAE'
+
+Alternative to 'lpc2pqp' which finds all roots of the LP polynomial 
+simultaneously using the Aberth-Ehrlich method (see 'aberth') and then 
+combines them to PQ parameter pairs.
+
+Arguments
+  lpc[M+1]  array with LP filter coefficients (lpc[i] = A(i), i = 0 .. M)
+  pqp[M]    array with PQ coefficient pairs
+            (Pn = pqp[2*i] Qn = pqp[2*i + 1], i = 0 .. M/2-1)
+            input starting, output final estimates of roots
+  M         LP analysis order
+  tPtr      pointer to 'BAIRSTOW' structure with termination criteria
+  compat    if non-zero, the PQ pairs are returned in the order in 
+            which 'lpc2pqp' would normally find them, i.e. each pair 
+            takes the place of the starting value it is closest to; 
+            otherwise complex conjugate roots come first, sorted on 
+            decreasing Q, followed by the real roots paired on 
+            decreasing magnitude
+
+Returns:
+  Number of iterations for root-solving if no problems
+  -1 if error in function arguments or no convergence
+
+Note:
+ -   Unlike with 'lpc2pqp', the PQ parameters are left unchanged if 
+     root-solving fails.
+ -   For odd orders this function simply calls 'lpc2pqp'.
+
+DOC*/
+
+#define AE_OFF_AXIS 1.0e-3 /* imaginary part of real starting values */
+
+int lpc2pqpAE(double *lpc, double *pqp, int M, BAIRSTOW *tPtr, int compat)
+{
+  int    i, j, k, n, NF, numCC, numR, iter, bestK, bestJ;
+  int    ccUsed[MAXFORMANTS], rUsed[MAXLPORDER];
+  double P, Q, D, dist, minDist;
+  double zr[MAXLPORDER], zi[MAXLPORDER], t[6*MAXLPORDER];
+  double ccP[MAXFORMANTS], ccQ[MAXFORMANTS], rr[MAXLPORDER];
+  double out[MAXLPORDER];
+
+  if(M > MAXLPORDER || M < 2 || tPtr == NULL)
+    return(-1);
+  if(ODD(M))
+    return(lpc2pqp(lpc, pqp, M, tPtr));
+  NF = M / 2;
+/*
+ * convert PQ pairs to distinct starting values for the roots
+ */
+  for(i = n = 0; i < NF; i++, n += 2) {
+    P = pqp[n];
+    Q = pqp[n+1];
+    D = 0.25 * P * P - Q;
+    if(D < 0.0) {
+      zr[n] = zr[n+1] = -0.5 * P;
+      zi[n] = sqrt(-D);
+      zi[n+1] = -zi[n];
+    }
+    else {          /* off the axis or complex roots can't be reached */
+      zr[n] = -0.5 * P + sqrt(D);
+      zr[n+1] = -0.5 * P - sqrt(D);
+      zi[n] = AE_OFF_AXIS;
+      zi[n+1] = -AE_OFF_AXIS;
+    }
+  }
+  for(k = 1; k < M; k++) {
+    for(j = 0; j < k; j++) {
+      if(zr[k] == zr[j] && zi[k] == zi[j])
+	zr[k] += AE_OFF_AXIS * (double)k;
+    }
+  }
+/*
+ * solve roots
+ */
+  iter = aberth(lpc, zr, zi, M, t, tPtr);
+  if(iter < 0 || iter > tPtr->maxIter)
+    return(-1);
+  numCC = numR = 0;
+  for(k = 0; k < M; k++) {
+    D = sqrt(zr[k]*zr[k] + zi[k]*zi[k]) * tPtr->relPeps + tPtr->absPeps;
+    if(fabs(zi[k]) <= D)
+      rr[numR++] = zr[k];
+    else if(zi[k] > 0.0) {          /* one of complex conjugate pair */
+      ccP[numCC] = -2.0 * zr[k];
+      ccQ[numCC] = zr[k]*zr[k] + zi[k]*zi[k];
+      numCC++;
+    }
+  }
+  if(numR + 2 * numCC != M)                 /* pairs don't match up */
+    return(-1);
+  for(k = 0; k < numCC; k++)
+    ccUsed[k] = FALSE;
+  for(k = 0; k < numR; k++)
+    rUsed[k] = FALSE;
+/*
+ * combine roots to PQ pairs
+ */
+  if(compat) {
+    for(i = n = 0; i < NF; i++, n += 2) {
+      minDist = -1.0;
+      bestK = bestJ = -1;
+      for(k = 0; k < numCC; k++) {
+	if(!ccUsed[k]) {
+	  dist = fabs(ccP[k] - pqp[n]) + fabs(ccQ[k] - pqp[n+1]);
+	  if(minDist < 0.0 || dist < minDist) {
+	    minDist = dist;
+	    bestK = k;
+	    bestJ = -1;
+	  }
+	}
+      }
+      for(k = 0; k < numR; k++) {
+	if(rUsed[k])
+	  continue;
+	for(j = k + 1; j < numR; j++) {
+	  if(!rUsed[j]) {
+	    P = -(rr[k] + rr[j]);
+	    Q = rr[k] * rr[j];
+	    dist = fabs(P - pqp[n]) + fabs(Q - pqp[n+1]);
+	    if(minDist < 0.0 || dist < minDist) {
+	      minDist = dist;
+	      bestK = k;
+	      bestJ = j;
+	    }
+	  }
+	}
+      }
+      if(bestJ < 0) {
+	out[n] = ccP[bestK];
+	out[n+1] = ccQ[bestK];
+	ccUsed[bestK] = TRUE;
+      }
+      else {
+	out[n] = -(rr[bestK] + rr[bestJ]);
+	out[n+1] = rr[bestK] * rr[bestJ];
+	rUsed[bestK] = rUsed[bestJ] = TRUE;
+      }
+    }
+  }
+  else {
+    for(i = n = 0; i < numCC; i++, n += 2) {  /* decreasing Q (low BW) */
+      bestK = -1;
+      for(k = 0; k < numCC; k++) {
+	if(!ccUsed[k] && (bestK < 0 || ccQ[k] > ccQ[bestK]))
+	  bestK = k;
+      }
+      out[n] = ccP[bestK];
+      out[n+1] = ccQ[bestK];
+      ccUsed[bestK] = TRUE;
+    }
+    for(i = 0; i < numR; i++, n++) {    /* real roots decreasing |r| */
+      bestK = -1;
+      for(k = 0; k < numR; k++) {
+	if(!rUsed[k] && (bestK < 0 || fabs(rr[k]) > fabs(rr[bestK])))
+	  bestK = k;
+      }
+      out[n] = rr[bestK];
+      rUsed[bestK] = TRUE;
+    }
+    for(n = 2 * numCC; n < M; n += 2) {   /* convert to pairs in place */
+      P = -(out[n] + out[n+1]);
+      out[n+1] *= out[n];
+      out[n] = P;
+    }
+  }
+  for(n = 0; n < M; n++)
+    pqp[n] = out[n];
+  return(iter);
+}
+
+/*DOC
+
 Function 'ffb2pqp'
 
 Converts formant frequency and bandwidth pairs to PQ parameter pairs 
@@ -556,29 +730,40 @@ Returns:
   -1 if rounding error in LP recursion or failure in seekSLAzx()
   else total number of iterations for finding Pisarenko frequencies
 
+Note:
+ - The Pisarenko frequencies are normally bracketed on a fixed 
+   frequency grid and only if some lie too close together, searched 
+   order by order between those of the previous order.
+
 DOC*/
 
 /* local global array */
-LOCAL double slaTable[MAXFORMANTS+2][MAXFORMANTS+2];
+#define SLA_GRID 128               /* number of steps of frequency grid */
+LOCAL ASSP_TLS int    slaGridSet=FALSE;
+LOCAL ASSP_TLS double slaGrid[MAXFORMANTS+1][SLA_GRID+1];
 /* prototypes of support functions */
-LOCAL void setSLAtable(int nFreqs);
+LOCAL void setSLAgrid(void);
+LOCAL int  slaChebCoeffs(double func[], int order, double cheb[]);
+LOCAL int  scanSLAzeros(double func[], int order, double zero[],\
+			double eps);
 LOCAL int  findSLAzeros(double func[], int order, double zero[],\
 			double eps);
-LOCAL int  seekSLAzx(double func[], int degree, double xLo, double xHi,\
-		     double *ZX, double eps);
-LOCAL double slaFuncValue(double coeffs[], int degree, double arg);
+LOCAL int  seekSLAzx(double cheb[], int degree, double xLo, double xHi,\
+		     double fvLo, double fvHi, double *ZX, double eps);
+LOCAL double slaFuncValue(double cheb[], int degree, double arg);
 
 int lpSLA(double *atc, double *lpc, double *normPtr, int order,\
 	  double *pf, double sampFreq)
 {
-  static int oldM=0;
-  static int nFreqs=0;
-  static double oldSFR=0.0;
-  static double twoPiT, eps;
+  static ASSP_TLS int oldM=0;
+  static ASSP_TLS int nFreqs=0;
+  static ASSP_TLS double oldSFR=0.0;
+  static ASSP_TLS double twoPiT, eps;
   int    i, k, t, n, totIter;
   double tau, tauk, alfak, lambdak;
   double npk[MAXLPORDER+2], pk[MAXLPORDER+2], ppk[MAXLPORDER+2];
   double C_values[MAXFORMANTS+3];
+  double func[MAXLPORDER][MAXFORMANTS+2];
 
   if(order <= 0 || sampFreq <= 0.0) {               /* to allow reset */
     oldSFR = 0.0;
@@ -588,7 +773,8 @@ int lpSLA(double *atc, double *lpc, double *normPtr, int order,\
   if(order != oldM || sampFreq != oldSFR) {          /* re-initialize */
     if(pf != NULL) {
       nFreqs = order / 2;
-      setSLAtable(nFreqs);
+      if(!slaGridSet)                 /* kept across frames and files */
+	setSLAgrid();
       twoPiT = TWO_PI / sampFreq;
       /* from pf[i] = acos(zero[i]) / (2 * Pi / Fs) it follows: */
       /* zero[i] = cos(2 * Pi * pf[i] / Fs) */
@@ -647,12 +833,24 @@ int lpSLA(double *atc, double *lpc, double *normPtr, int order,\
     }
     if(EVEN(k))
       pk[t+1] = npk[t+1] = npk[t];               /* symmetry property */
-    if(pf != NULL) {
-/*    if(k == 2 || (k > 2 && k < order && EVEN(order) && ODD(k))) ) { */
+    if(pf != NULL && k > 1 && k < order) {
+      /*             ^        ^  because npk[] one order higher */
+      for(i = 0; i <= t; i++)        /* keep for search of PF's below */
+	func[k][i] = npk[i];
+    }
+  }
+  if(pf != NULL) {
+    /* The zeros of the highest order can mostly be bracketed directly */
+    /* on a frequency grid. Otherwise they are searched order by order */
+    /* between the zeros of the previous order. */
+/*  if(k == 2 || (k > 2 && k < order && EVEN(order) && ODD(k))) ) { */
 /* searching only for odd orders works in general but not always !!!  */ 
-      if(k > 1 && k < order) {
-        /* ^        ^  because npk[] one order higher */
-	n = findSLAzeros(npk, k, C_values, eps);
+    totIter = -1;
+    if(order > 3)
+      totIter = scanSLAzeros(func[order-1], order-1, C_values, eps);
+    if(totIter < 0) {
+      for(totIter = 0, k = 2; k < order; k++) {
+	n = findSLAzeros(func[k], k, C_values, eps);
 	if(n < 0)                                    /* search failed */
 	  return(-1);
 	totIter += n;
@@ -691,35 +889,97 @@ int lpSLA(double *atc, double *lpc, double *normPtr, int order,\
   return(totIter);
 }
 /***********************************************************************
-* initialize the global two-dimensional cosine array slaTable[i,j]     *
-* with coeff's from cos(i*x) = SUM(coeff * cos(x)^k) and k = 0...j     *
+* initialize the global two-dimensional cosine array slaGrid[j,g] with *
+* cos(j*x) at the grid points x = g*PI/SLA_GRID (j = 0...MAXFORMANTS)  *
 ***********************************************************************/
-LOCAL void setSLAtable(int nFreqs)
+LOCAL void setSLAgrid(void)
 {
-  int i, j;
+  int j, g;
 
-  for(i = 0; i <= nFreqs; i++) {                       /* clear table */
-    for(j = 0; j <= nFreqs; j++)
-      slaTable[i][j] = 0.0;
+  for(j = 0; j <= MAXFORMANTS; j++) {
+    for(g = 0; g <= SLA_GRID; g++)
+      slaGrid[j][g] = cos((double)(j * g) * PI / (double)SLA_GRID);
   }
-  slaTable[0][0] = 2.0;                       /* preliminary value !! */
-  slaTable[1][1] = 2.0;
-  for(i = 2; i <= nFreqs; i++) {
-    slaTable[i][0] = -slaTable[i-2][0];
-    for(j = 1; j <= i; j++)
-      slaTable[i][j] = 2.0 * slaTable[i-1][j-1] - slaTable[i-2][j];
-  }
-  slaTable[0][0] = 1.0;                          /* set correct value */
+  slaGridSet = TRUE;
   return;
 }
 /***********************************************************************
-* find zeros of function; returns summed number of iterations          *
+* convert function to coefficients of the Chebyshev polynomials T(j)   *
+* of cos(x), i.e. cos(j*x) = T(j)(cos(x)); returns the degree          *
+***********************************************************************/
+LOCAL int slaChebCoeffs(double func[], int order, double cheb[])
+{
+  int    i, degree;
+  double f[MAXFORMANTS+2];
+
+  degree = (order+1) / 2;
+  f[0] = func[0];
+  if(EVEN(order)) {          /* divide by (1-z) to remove zero at z=1 */
+    for(i = 1; i <= degree; i++)
+      f[i] = func[i] - f[i-1];
+  }
+  else {
+    for(i = 1; i <= degree; i++)
+      f[i] = func[i];
+  }
+  cheb[0] = f[degree];         /* weights 2*cos(j*x) for j > 0 and 1 */
+  for(i = 1; i < degree; i++)  /* for j = 0 as in Delsarte & Genin */
+    cheb[i] = 2.0 * f[degree-i];
+  cheb[degree] = 2.0;
+  return(degree);
+}
+/***********************************************************************
+* find zeros of function by scanning the frequency grid for changes of *
+* sign; returns summed number of iterations or -1 if not all zeros     *
+* could be bracketed (zeros too close) and a step-wise search is needed*
+***********************************************************************/
+LOCAL int scanSLAzeros(double func[], int order, double zero[],\
+		       double eps)
+{
+  int    i, j, g, degree, sumIter;
+  int    gridNr[MAXFORMANTS+2];
+  double cheb[MAXFORMANTS+2], fv[SLA_GRID+1];
+
+  degree = slaChebCoeffs(func, order, cheb);
+  if(degree > MAXFORMANTS)
+    return(-1);
+  for(g = 0; g <= SLA_GRID; g++)
+    fv[g] = cheb[0];
+  for(j = 1; j <= degree; j++) {   /* inner loop can be vectorized */
+    for(g = 0; g <= SLA_GRID; g++)
+      fv[g] += cheb[j] * slaGrid[j][g];
+  }
+  for(i = 0, g = 0; g < SLA_GRID; g++) {
+    if(SGN(fv[g]) != SGN(fv[g+1])) {
+      if(i >= degree)
+	return(-1);
+      gridNr[i++] = g;
+    }
+  }
+  if(i < degree)            /* even number of zeros in some intervals */
+    return(-1);
+  sumIter = 0;
+  zero[0] = 1.0;
+  for(i = 0; i < degree; i++) {
+    g = gridNr[i];
+    j = seekSLAzx(cheb, degree, slaGrid[1][g], slaGrid[1][g+1],\
+		  fv[g], fv[g+1], &zero[i+1], eps);
+    if(j < 0)
+      return(-1);
+    sumIter += j;
+  }
+  zero[degree+1] = -1.0;                           /* set upper bound */
+  return(sumIter);
+}
+/***********************************************************************
+* find zeros of function between the zeros of the function of the      *
+* previous order; returns summed number of iterations                  *
 ***********************************************************************/
 LOCAL int findSLAzeros(double func[], int order, double zero[],\
 		       double eps)
 {
   int    i, j, degree, sumIter;
-  double newZero, px[MAXFORMANTS+3];
+  double cheb[MAXFORMANTS+2], fv[MAXFORMANTS+3], newZero;
 
   sumIter = 0;
   if(order == 2) {               /* first time a true zero can be set */
@@ -728,19 +988,12 @@ LOCAL int findSLAzeros(double func[], int order, double zero[],\
     zero[2] = -1.0;
   }
   else {
-    degree = (order+1) / 2;
-    if(EVEN(order)) {        /* divide by (1-z) to remove zero at z=1 */
-      for(i = 1; i <= degree; i++)
-	func[i] -= func[i-1];
-    }
-    for(i = 0; i <= degree; i++)            /* substitution via table */
-      px[i] = slaTable[degree][i];
-    for(j = (degree-1); j >= 0; j--) {
-      for(i = 0; i <= degree; i++)
-        px[i] += (func[degree-j] * slaTable[j][i]);
-    }
+    degree = slaChebCoeffs(func, order, cheb);
+    for(i = 0; i <= degree; i++)
+      fv[i] = slaFuncValue(cheb, degree, zero[i]);
     for(i = degree; i > 0; i--) { /* search new zeros between old ones */
-      j = seekSLAzx(px, degree, zero[i-1], zero[i], &newZero, eps);
+      j = seekSLAzx(cheb, degree, zero[i-1], zero[i], fv[i-1], fv[i],\
+		    &newZero, eps);
       if(j < 0)
 	return(-1);
       zero[i] = newZero;
@@ -751,16 +1004,15 @@ LOCAL int findSLAzeros(double func[], int order, double zero[],\
   return(sumIter);
 }
 /***********************************************************************
-* search zero in function between xLo and xHi; return iterations       *
+* search zero in function between xLo and xHi with function values     *
+* fvLo and fvHi; return iterations                                     *
 ***********************************************************************/
-LOCAL int seekSLAzx(double func[], int degree, double xLo, double xHi,\
-		    double *ZX, double eps)
+LOCAL int seekSLAzx(double cheb[], int degree, double xLo, double xHi,\
+		    double fvLo, double fvHi, double *ZX, double eps)
 {
   int    fixBound, iterations;
-  double fvLo, fvHi, fvZX, oldZX;
+  double fvZX, oldZX;
 
-  fvLo = slaFuncValue(func, degree, xLo);
-  fvHi = slaFuncValue(func, degree, xHi);
   if(SGN(fvLo) == SGN(fvHi)) {
     setAsspMsg(AEG_ERR_BUG, "\nseekSLAzx: even number of zero crossings");
     return(-1);
@@ -769,7 +1021,7 @@ LOCAL int seekSLAzx(double func[], int degree, double xLo, double xHi,\
   iterations = 0;
   *ZX = (xLo + xHi) / 2.0;            /*  start with interval halving */
   do {
-    fvZX = slaFuncValue(func, degree, *ZX);
+    fvZX = slaFuncValue(cheb, degree, *ZX);
     if(SGN(fvLo) == SGN(fvZX)) {
       xLo = *ZX;
       fvLo = fvZX;
@@ -799,16 +1051,20 @@ LOCAL int seekSLAzx(double func[], int degree, double xLo, double xHi,\
   return(iterations);
 }
 /***********************************************************************
-* return value of function given by 'coeffs' at 'arg'                  *
+* return value at 'arg' of function given by the coefficients 'cheb'   *
+* of the Chebyshev polynomials (Clenshaw's recurrence)                 *
 ***********************************************************************/
-LOCAL double slaFuncValue(double coeffs[], int degree, double arg)
+LOCAL double slaFuncValue(double cheb[], int degree, double arg)
 {
   int    i;
-  double fVal;
+  double y, y1, y2;
 
-  for(fVal = 0.0, i = degree; i >= 0; i--)
-    fVal = coeffs[i] + arg * fVal;
-  return(fVal);
+  for(y1 = y2 = 0.0, i = degree; i > 0; i--) {
+    y = cheb[i] + 2.0 * arg * y1 - y2;
+    y2 = y1;
+    y1 = y;
+  }
+  return(cheb[0] + arg * y1 - y2);
 }
 
 #endif /* _LPC_C */
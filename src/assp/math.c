@@ -268,6 +268,121 @@ int bairstow(register double *c, register double *p, register double *q,\
 
 /*DOC
 
+Function 'aberth'
+
+Aberth-Ehrlich method for simultaneously finding all roots of a 
+normalized polynomial with real coefficients
+ m=M        M-m
+ SUM (c * X   )   with c = 1
+ m=0    m               0
+
+Arguments:
+  c[M+1]  array with coefficients of the polynomial
+  zr[M]   arrays with real and imaginary parts of the roots
+  zi[M]   input: distinct starting estimates; output: final estimates
+  M       order of the polynomial
+  t[6*M]  array for storage of temporary data
+  term    pointer to 'BAIRSTOW' structure with termination criteria; 
+          iteration stops when the correction of each root is less 
+          than 'relPeps' times its magnitude plus 'absPeps'
+
+Returns:
+  Number of iterations if no problems
+  -1 if error in function arguments
+
+Note:
+ - If the returned value exceeds the maximum number of iterations
+   defined in "term", the roots are not reliable.
+ - All roots are corrected in parallel (Jacobi-style) and the loops 
+   run over the roots in the innermost level so that the compiler can 
+   vectorize them.
+ - With starting estimates on the real axis only real roots can be 
+   found; complex roots need starting estimates off the real axis.
+
+See: Aberth, O. (1973), "Iteration methods for finding all zeros of a 
+       polynomial simultaneously," Math. Comp., Vol. 27, 339-344.
+
+DOC*/
+
+int aberth(double *c, double *zr, double *zi, int M, double *t,\
+	   BAIRSTOW *term)
+{
+  int    i, j, k, n, DONE;
+  double *pr, *pi, *dr, *di, *wr, *wi;
+  double xr, xi, ur, ui, sr, si, den;
+
+  if(c == NULL || zr == NULL || zi == NULL || M < 1 ||\
+     t == NULL || term == NULL)
+    return(-1);
+  pr = t;          /* polynomial values */
+  pi = t + M;
+  dr = t + 2 * M;  /* derivatives */
+  di = t + 3 * M;
+  wr = t + 4 * M;  /* corrections */
+  wi = t + 5 * M;
+  for(i = 0; i < term->maxIter; i++) {
+    /* evaluate polynomial and derivative at all roots (Horner) */
+    for(k = 0; k < M; k++) {
+      pr[k] = 1.0;
+      pi[k] = dr[k] = di[k] = 0.0;
+    }
+    for(n = 1; n <= M; n++) {
+      for(k = 0; k < M; k++) {
+	xr = dr[k] * zr[k] - di[k] * zi[k] + pr[k];
+	di[k] = dr[k] * zi[k] + di[k] * zr[k] + pi[k];
+	dr[k] = xr;
+	xr = pr[k] * zr[k] - pi[k] * zi[k] + c[n];
+	pi[k] = pr[k] * zi[k] + pi[k] * zr[k];
+	pr[k] = xr;
+      }
+    }
+    /* Aberth correction w = 1 / (p'/p - SUM(1/(z[k] - z[j]))) */
+    DONE = TRUE;
+    for(k = 0; k < M; k++) {
+      den = pr[k] * pr[k] + pi[k] * pi[k];
+      if(den == 0.0) {                                   /* exact root */
+	wr[k] = wi[k] = 0.0;
+	continue;
+      }
+      xr = (dr[k] * pr[k] + di[k] * pi[k]) / den;
+      xi = (di[k] * pr[k] - dr[k] * pi[k]) / den;
+      sr = si = 0.0;
+      for(j = 0; j < M; j++) {
+	if(j != k) {
+	  ur = zr[k] - zr[j];
+	  ui = zi[k] - zi[j];
+	  den = ur * ur + ui * ui;
+	  if(den > 0.0) {
+	    sr += ur / den;
+	    si -= ui / den;
+	  }
+	}
+      }
+      xr -= sr;
+      xi -= si;
+      den = xr * xr + xi * xi;
+      if(den == 0.0) {
+	wr[k] = wi[k] = 0.0;
+	continue;
+      }
+      wr[k] = xr / den;
+      wi[k] = -xi / den;
+      if(sqrt(wr[k] * wr[k] + wi[k] * wi[k]) >\
+	 sqrt(zr[k] * zr[k] + zi[k] * zi[k]) * term->relPeps + term->absPeps)
+	DONE = FALSE;
+    }
+    for(k = 0; k < M; k++) {
+      zr[k] -= wr[k];
+      zi[k] -= wi[k];
+    }
+    if(DONE)
+      break;
+  }
+  return(i+1);
+}
+
+/*DOC
+
 Function 'hasCCR'
                                     2
 Determines whether the polynomial  X + pX + q  has complex conjugate 
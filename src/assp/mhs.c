@@ -71,21 +71,25 @@ typedef struct MHS_pitch_candidate {
 
 /*
  * pitch tracking
+ * Each track keeps its candidate history in a ring of 'pipeLength' 
+ * entries taken from a pool which is allocated once in setGlobals(); 
+ * the tracks in use are listed in ascending order of their slot number 
+ * so that the frame loop only visits live tracks and no memory needs 
+ * to be allocated or returned while tracking.
  */
-typedef struct MHS_pitch_link {
-  struct MHS_pitch_link *prev;
-  struct MHS_pitch_link *next;
-  MHS_CAND cand;
-} MHS_LINK;
-
 typedef struct MHS_pitch_track {
-  MHS_LINK *chain;    /* pointer to youngest member of track */
+  MHS_CAND *ring;     /* candidate history (part of track pool) */
+  size_t    head;     /* ring index of youngest member of track */
+  size_t    numLinks; /* number of members in ring */
   double    duration; /* duration of track in ms */
   double    periods;  /* duration as estimated number of periods */
+  double    sumQQ;    /* sum of squared Q values of last few members */
   double    trackQ;   /* estimate based on last few Q values */
   int       status;   /* track status flags (see below) */
 } MHS_TRK;
 
+#define TRK_LAST(t) ((t)->ring[(t)->head]) /* youngest member of track */
+
 #define MHS_TRK_UNUSED  0x00 /* track status flags */
 #define MHS_TRK_IN_USE  0x01
 #define MHS_TRK_UPDATED 0x02
@@ -117,12 +121,18 @@ LOCAL double  sieveF0[MHS_MAXSIEVES];            /* list of sieve F0s */
 LOCAL double  minF0Diff; /* min. difference in F0 candidates (factor) */
 LOCAL double  maxDelta;  /* max. frame-to-frame change in F0 (factor) */
 LOCAL MHS_TRK track[MHS_MAXTRACKS];
+LOCAL MHS_CAND *trkPool=NULL;   /* ring space for all tracks (allocated) */
+LOCAL int     trkList[MHS_MAXTRACKS]; /* slot numbers of tracks in use */
+LOCAL int     numTracks;                   /* number of tracks in use */
+LOCAL int     activeTrk;       /* slot number of active track or -1 */
 LOCAL size_t  maxNumTQ;    /* maximum number of frames for Q of track */
 
 LOCAL size_t    pipeLength;               /* length of pipe in frames */
 LOCAL MHS_CAND *pipe=NULL;       /* delay line for output (allocated) */
+LOCAL size_t    pipeHead;          /* ring index of frame 'pipeBegFn' */
 LOCAL long      pipeBegFn, pipeEndFn;    /* valid frame range in pipe */
 LOCAL MHS_CAND  unv={0.0, 0};                       /* unvoiced frame */
+LOCAL DOBJ     *trackDOp=NULL;  /* push mode: object of pending tracks */
 
 /*
  * prototypes of local functions
@@ -133,17 +143,16 @@ LOCAL void freeGlobals(void);
 LOCAL double *getSpectrum(MHS_GD *gd);
 LOCAL int  findPeaks(double *linPower, MHS_PEAK *peak, MHS_GD *gd);
 LOCAL int  sievePeaks(MHS_PEAK *peak, int numPeaks, MHS_CAND *cand, MHS_GD *gd);
+LOCAL void addCand(MHS_CAND *cand, MHS_CAND *new);
 LOCAL int  trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop);
-LOCAL int  addLink(MHS_TRK *tPtr, MHS_CAND *cand);
+LOCAL int  newTrack(void);
+LOCAL void addLink(MHS_TRK *tPtr, MHS_CAND *cand);
 LOCAL int  pipeTrack(long frameNr, MHS_TRK *tPtr, DOBJ *dop);
-LOCAL void delTrack(MHS_TRK *tPtr);
+LOCAL void delTrack(int slot);
+LOCAL void clrTracks(void);
 LOCAL int  pipeFrame(long frameNr, MHS_CAND *cand, DOBJ *dop);
 LOCAL int  flushPipe(DOBJ *dop);
 LOCAL int  storeMHS(float val, long frameNr, DOBJ *dop);
-LOCAL int  insElement(void *array, size_t numElements, size_t elementSize,\
-		      size_t index, void *element);
-LOCAL int  rmvElement(void *array, size_t numElements, size_t elementSize,\
-		      size_t index, void *fill);
 
 /* ======================== public functions ======================== */
 
@@ -440,6 +449,10 @@ Note:
    (see createMHS() and e.g. verifyACF() for what needs to be done). 
    If there are incompatibilities it is probably easiest just to destroy 
    the data object.
+ - If the option AOPT_STREAM is set in the generic data structure of 
+   "pitDOp", frames still depending on the pitch tracking are kept 
+   pending and the tracking continues in the next call for the same 
+   object with "aoPtr" a NULL-pointer (see 'anaStreamOpen').
 
 DOC*/
 
@@ -519,10 +532,17 @@ DOBJ *computeMHS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *pitDOp)
   offZCR = (size_t)(gd->frameSize - lenZCR) / 2;
   offACF = (size_t)(gd->frameSize - lenACF + 1) / 2;
   /* set global values and allocate buffer space */
-  if(setGlobals(pitDOp) < 0) {
-    if(CREATED)
-      freeDObj(pitDOp);
-    return(NULL);
+  /* unless continuing the tracking of a push-mode analysis */
+  if(aoPtr != NULL || pitDOp != trackDOp) {
+    if(trackDOp != NULL) {           /* abandon pending push-mode data */
+      freeGlobals();
+      trackDOp = NULL;
+    }
+    if(setGlobals(pitDOp) < 0) {
+      if(CREATED)
+	freeDObj(pitDOp);
+      return(NULL);
+    }
   }
 #ifndef WRASSP
   if(TRACE['A']) {
@@ -643,8 +663,7 @@ DOBJ *computeMHS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *pitDOp)
     }
 #endif
     if(!VOICED) {
-      for(n = 0; n < MHS_MAXTRACKS; n++)  /* no valid tracks possible */
-	delTrack(&track[n]);
+      clrTracks();                       /* no valid tracks possible */
       if((err=pipeFrame(fn, &unv, pitDOp)) < 0)/* push unvoiced frame */
 	break;
       if((err=flushPipe(pitDOp)) < 0) /* no pending tracks: may flush */
@@ -654,11 +673,17 @@ DOBJ *computeMHS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *pitDOp)
       break;
   } /* END loop over frames */
   if(err >= 0) {
-    err = flushPipe(pitDOp);
+    if(!(gd->options & AOPT_STREAM))  /* no more frames will follow */
+      err = flushPipe(pitDOp);
     if(err >= 0 && FILE_OUT)
       err = asspFFlush(pitDOp, gd->writeOpts);
   }
-  freeGlobals();
+  if(err >= 0 && (gd->options & AOPT_STREAM))
+    trackDOp = pitDOp;            /* keep tracks and pipe for next call */
+  else {
+    freeGlobals();
+    trackDOp = NULL;
+  }
   if(err < 0) {
     if(CREATED)
       freeDObj(pitDOp);
@@ -717,7 +742,8 @@ LOCAL int setGlobals(DOBJ *dop)
   numFrames = gd->endFrameNr - gd->begFrameNr;
   temp = FRMNRtoTIME(numFrames, sampFreq, frameShift);
   temp *= 1000.0;                                            /* in ms */
-  if(numFrames <= 1 && temp < MHS_MINDURVS) {
+  if(numFrames <= 1 && temp < MHS_MINDURVS &&\
+     !(gd->options & AOPT_STREAM)) {
     setAsspMsg(AEG_ERR_BUG, "setGlobals: analysis range too short");
     return(-1);
   }
@@ -777,15 +803,12 @@ LOCAL int setGlobals(DOBJ *dop)
   temp /= 1000;                                         /* in seconds */
   pipeLength = TIMEctFRMNR(temp, sampFreq, frameShift);  /* in frames */
   pipeBegFn = pipeEndFn = gd->begFrameNr; 
+  pipeHead = 0;
 /*
  * allocate memory
  */
   fftBuf = logN = wfc = NULL;                   /* clear all pointers */
-  pipe = NULL;
-  for(n = 0; n < MHS_MAXTRACKS; n++) {
-    track[n].chain = NULL;
-    track[n].status = MHS_TRK_UNUSED;
-  }
+  pipe = trkPool = NULL;
 
   fftBuf = (double *)calloc((size_t)numFFT, sizeof(double));
   if(!(gd->options & MHS_OPT_POWER)) {
@@ -800,17 +823,25 @@ LOCAL int setGlobals(DOBJ *dop)
   if((ODD(gd->frameSize) && EVEN(frameShift)) ||
      (EVEN(gd->frameSize) && ODD(frameShift)) )
     wFlags = WF_ASYMMETRIC;  /* align window centre with frame centre */
-  wfc = makeWF(gd->winFunc, gd->frameSize, wFlags);
+  wfc = getWF(gd->winFunc, gd->frameSize, wFlags);
   pipe = (MHS_CAND *)calloc(pipeLength, sizeof(MHS_CAND));
+  /* a track never holds more members than there are frames in the pipe */
+  trkPool = (MHS_CAND *)calloc(MHS_MAXTRACKS * pipeLength, sizeof(MHS_CAND));
 /*
  * verify memory allocation
  */
   if(fftBuf == NULL || (!(gd->options & MHS_OPT_POWER) && logN == NULL) ||\
-     wfc == NULL || pipe == NULL) {
+     wfc == NULL || pipe == NULL || trkPool == NULL) {
     freeGlobals();
     setAsspMsg(AEG_ERR_MEM, "MHS: setGlobals");
     return(-1);
   }
+  for(n = 0; n < MHS_MAXTRACKS; n++) {
+    track[n].ring = &trkPool[n * pipeLength];
+    track[n].status = MHS_TRK_UNUSED;
+  }
+  numTracks = 0;
+  clrTracks();
   return(0);
 }
 /***********************************************************************
@@ -830,8 +861,16 @@ LOCAL void freeGlobals(void)
   }
   freeWF(wfc);
   wfc= NULL;
-  for(n = 0; n < MHS_MAXTRACKS; n++)
-    delTrack(&track[n]);
+  for(n = 0; n < MHS_MAXTRACKS; n++) {
+    track[n].ring = NULL;
+    track[n].status = MHS_TRK_UNUSED;
+  }
+  numTracks = 0;
+  activeTrk = -1;
+  if(trkPool != NULL) {
+    free((void *)trkPool);
+    trkPool = NULL;
+  }
   if(pipe != NULL) {
     free((void *)pipe);
     pipe = NULL;
@@ -1089,27 +1128,7 @@ LOCAL int sievePeaks(MHS_PEAK *peak, int numPeaks, MHS_CAND *cand,\
       if(new.F0 >= gd->minF0 && new.F0 <= gd->maxF0) {
 	new.Q = (int)myrint(MHS_Q_SCALE * (double)(2 * numPass) /\
 			    (double)(hiMesh + numTest));
-	for(i = 0; i < MHS_MAXCANDS; i++) {
-	  if(cand[i].Q <= 0)                     /* no more candidates */
-	    break;
-	  if(new.F0 < (cand[i].F0 * minF0Diff) &&
-	     new.F0 > (cand[i].F0 / minF0Diff) ) {      /* about equal */
-	    if(new.Q > cand[i].Q)              /* new candidate better */
-	      rmvElement(cand, MHS_MAXCANDS, sizeof(MHS_CAND), i, &unv);
-	    else {                            /* discard new candidate */
-	      new.F0 = 0.0;
-	      new.Q = 0;
-	    }
-	    break;
-	  }
-	}
-	if(new.Q > 0) {                              /* not discarded */
-	  for(i = 0; i < MHS_MAXCANDS; i++)   /* sort on decreasing Q */
-	    if(new.Q > cand[i].Q)
-	      break;
-	  if(i < MHS_MAXCANDS)
-	    insElement(cand, MHS_MAXCANDS, sizeof(MHS_CAND), i, &new);
-	}
+	addCand(cand, &new);
       }
     }
   }
@@ -1121,15 +1140,47 @@ LOCAL int sievePeaks(MHS_PEAK *peak, int numPeaks, MHS_CAND *cand,\
   return(i);                       /* return number of top candidates */
 }
 /***********************************************************************
+* merge a new candidate into the list of candidates sorted on          *
+* decreasing Q; a candidate with about equal F0 is replaced if the new *
+* one is better, otherwise the new candidate is discarded              *
+***********************************************************************/
+LOCAL void addCand(MHS_CAND *cand, MHS_CAND *new)
+{
+  int i, n, last;
+
+  last = MHS_MAXCANDS - 1;   /* candidate shifted out if none replaced */
+  for(i = 0; i < MHS_MAXCANDS; i++) {
+    if(cand[i].Q <= 0)                         /* no more candidates */
+      break;
+    if(new->F0 < (cand[i].F0 * minF0Diff) &&
+       new->F0 > (cand[i].F0 / minF0Diff) ) {          /* about equal */
+      if(new->Q <= cand[i].Q)                /* discard new candidate */
+	return;
+      last = i;                                 /* replace this one */
+      break;
+    }
+  }
+  for(n = 0; n < last; n++)                   /* sort on decreasing Q */
+    if(new->Q > cand[n].Q)
+      break;
+  if(n == last && new->Q <= cand[n].Q)            /* not among the best */
+    return;
+  for(i = last; i > n; i--)                  /* shift to create space */
+    cand[i] = cand[i-1];
+  cand[n] = *new;
+  return;
+}
+/***********************************************************************
 * perform - fairly simple - pitch tracking                             *
 ***********************************************************************/
 LOCAL int trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop)
 {
-  int     i, n, topQ, bestN, bestQ;
-  int     PUSHED, PENDING, active;
-  int     numCands, used[MHS_MAXCANDS];
-  double  bestTQ, prevF0, bestD, delta;
-  MHS_GD *gd=(MHS_GD *)(dop->generic);
+  int      i, n, tn, topQ, bestN, bestQ;
+  int      PUSHED, PENDING;
+  int      numCands, used[MHS_MAXCANDS];
+  double   bestTQ, prevF0, bestD, delta;
+  MHS_TRK *tPtr;
+  MHS_GD  *gd=(MHS_GD *)(dop->generic);
 
   topQ = (int)myrint(MHS_REL_TOPQ * (double)cand[0].Q);
   if(topQ < gd->minQval)
@@ -1140,22 +1191,18 @@ LOCAL int trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop)
       break;
   }
   if(numCands <= 0) {                                     /* UNVOICED */
-    for(n = 0; n < MHS_MAXTRACKS; n++)       /* can delete all tracks */
-      delTrack(&track[n]);
+    clrTracks();                             /* can delete all tracks */
     if(pipeFrame(frameNr, &unv, dop) < 0)   /* push an unvoiced frame */
       return(-1);
     return(flushPipe(dop));           /* no pending tracks: may flush */
   }
 
-  active = -1;
-  for(n = 0; n < MHS_MAXTRACKS; n++) {
-    track[n].status &= ~MHS_TRK_UPDATED;    /* clear update flags and */
-    if(track[n].status & MHS_TRK_ACTIVE)       /* check whether there */
-      active = n;                               /* is an active track */
-  }
+  for(i = 0; i < numTracks; i++)              /* clear update flags */
+    track[trkList[i]].status &= ~MHS_TRK_UPDATED;
   PUSHED = FALSE;          /* must know whether data have been pushed */
-  if(active >= 0) {                     /* give active track priority */
-    prevF0 = track[active].chain->cand.F0;
+  if(activeTrk >= 0) {                  /* give active track priority */
+    tPtr = &track[activeTrk];
+    prevF0 = TRK_LAST(tPtr).F0;
     bestD = prevF0 * maxDelta;     /* best candidate also a valid one */
     bestQ = 0;  /* give priority to matching candidate with highest Q */
     bestN = -1;                          /* haven't yet found a match */
@@ -1168,22 +1215,22 @@ LOCAL int trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop)
       }
     }
     if(bestN >= 0) {                      /* matching candidate found */
-      if(addLink(&track[active], &cand[bestN]) < 0)
-	return(-1);
+      addLink(tPtr, &cand[bestN]);
       if(pipeFrame(frameNr, &cand[bestN], dop) < 0)        /* push it */
 	return(-1);
       used[bestN] = TRUE;                   /* mark candidate as used */
       PUSHED = TRUE;                       /* and data pushed to pipe */
     }
-    else {                                     /* track not continued */
-      delTrack(&track[active]);                          /* remove it */
-      active = -1;
-    }
+    else                                       /* track not continued */
+      delTrack(activeTrk);                 /* remove it (no longer active) */
   }
   PENDING = FALSE;                               /* clear global flag */
-  for(i = 0; i < MHS_MAXTRACKS; i++) {  /* now check all other tracks */
-    if(i != active && (track[i].status & MHS_TRK_IN_USE)) {
-      prevF0 = track[i].chain->cand.F0;
+  i = 0;
+  while(i < numTracks) {                /* now check all other tracks */
+    tn = trkList[i];
+    if(tn != activeTrk) {
+      tPtr = &track[tn];
+      prevF0 = TRK_LAST(tPtr).F0;
       bestD = prevF0 * maxDelta;
       bestN = -1;
       for(n = 0; n < numCands; n++) {
@@ -1195,32 +1242,33 @@ LOCAL int trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop)
 	  }
 	}
       }
-      if(bestN >= 0) {
-	if(addLink(&track[i], &cand[bestN]) < 0)
-	  return(-1);
-	used[bestN] = TRUE;
-	if(!(track[i].status & MHS_TRK_PENDING) ) {/* check durations */
-	  if(track[i].duration >= MHS_MINDURVS &&
-	     track[i].periods >= MHS_MINPRDVS) {
-	    track[i].status |= MHS_TRK_PENDING;  /* mark as potential */
-	    PENDING = TRUE;                        /* set global flag */
-	  }
+      if(bestN < 0) {                                /* not continued */
+	delTrack(tn);            /* remove it; next track moves down to i */
+	continue;
+      }
+      addLink(tPtr, &cand[bestN]);
+      used[bestN] = TRUE;
+      if(!(tPtr->status & MHS_TRK_PENDING) ) {     /* check durations */
+	if(tPtr->duration >= MHS_MINDURVS &&
+	   tPtr->periods >= MHS_MINPRDVS) {
+	  tPtr->status |= MHS_TRK_PENDING;       /* mark as potential */
+	  PENDING = TRUE;                            /* set global flag */
 	}
-	else
-	  PENDING = TRUE;                           /* already marked */
       }
-      else                                           /* not continued */
-	delTrack(&track[i]);                             /* remove it */
+      else
+	PENDING = TRUE;                               /* already marked */
     }
+    i++;
   }
-  if(active < 0 && PENDING) { /* select new active track from pending */
+  if(activeTrk < 0 && PENDING) {/* select new active track from pending */
     bestTQ = 0.0;
     bestN = -1;
-    for(i = 0; i < MHS_MAXTRACKS; i++) {
-      if(track[i].status & MHS_TRK_PENDING) {
-	if(track[i].trackQ > bestTQ) {
-	  bestTQ = track[i].trackQ;
-	  bestN = i;
+    for(i = 0; i < numTracks; i++) {
+      tn = trkList[i];
+      if(track[tn].status & MHS_TRK_PENDING) {
+	if(track[tn].trackQ > bestTQ) {
+	  bestTQ = track[tn].trackQ;
+	  bestN = tn;
 	}
       }
     }
@@ -1230,7 +1278,7 @@ LOCAL int trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop)
       PUSHED = TRUE;
       track[bestN].status &= ~MHS_TRK_PENDING;  /* clear pending flag */
       track[bestN].status |= MHS_TRK_ACTIVE;       /* set active flag */
-      active = bestN;
+      activeTrk = bestN;
     }
     else {
       setAsspMsg(AEG_ERR_BUG, "trackPitch: didn't find pending track");
@@ -1239,13 +1287,9 @@ LOCAL int trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop)
   }
   for(n = 0; n < numCands; n++) {      /* finally, create a new track */
     if(!used[n]) {                       /* for each unused candidate */
-      for(i = 0; i < MHS_MAXTRACKS; i++) {
-	if(!(track[i].status & MHS_TRK_IN_USE) ) {
-	  if(addLink(&track[i], &cand[n]) < 0)
-	    return(-1);
-	  break;
-	}
-      }
+      if((tn=newTrack()) < 0)                  /* all tracks in use */
+	break;
+      addLink(&track[tn], &cand[n]);
     }
   }
   if(!PUSHED) {                           /* no track has pushed data */
@@ -1255,77 +1299,80 @@ LOCAL int trackPitch(long frameNr, MHS_CAND *cand, DOBJ *dop)
 
 #ifndef WRASSP
   if(TRACE['t']) {
-    if(active >= 0)
+    if(activeTrk >= 0) {
+      tPtr = &track[activeTrk];
       fprintf(traceFP, "* F0 = %.1f  Q = %i  TQ = %.1f  dur = %.1f\n",\
-	      track[active].chain->cand.F0, track[active].chain->cand.Q,\
-	      track[active].trackQ, track[active].duration);
-    for(i = 0; i < MHS_MAXTRACKS; i++) {
-      if(i != active && (track[i].status & MHS_TRK_IN_USE))
+	      TRK_LAST(tPtr).F0, TRK_LAST(tPtr).Q,\
+	      tPtr->trackQ, tPtr->duration);
+    }
+    for(i = 0; i < numTracks; i++) {
+      tPtr = &track[trkList[i]];
+      if(trkList[i] != activeTrk)
 	fprintf(traceFP, "  F0 = %.1f  Q = %i  TQ = %.1f  dur = %.1f\n",\
-		track[i].chain->cand.F0, track[i].chain->cand.Q,\
-		track[i].trackQ, track[i].duration);
+		TRK_LAST(tPtr).F0, TRK_LAST(tPtr).Q,\
+		tPtr->trackQ, tPtr->duration);
     }
   }
 #endif
   return(0);
 }
 /***********************************************************************
-* add a link to the chain and update track parameters and status       *
+* take the lowest free track slot into use; returns its number or -1   *
+* if all slots are occupied                                            *
 ***********************************************************************/
-LOCAL int addLink(MHS_TRK *tPtr, MHS_CAND *cand)
+LOCAL int newTrack(void)
 {
-  size_t    num;
-  double    sum, Q;
-  MHS_LINK *lPtr;
-
-  if(tPtr->status & MHS_TRK_IN_USE) {                 /* check length */
-    lPtr = tPtr->chain;
-    if(lPtr == NULL) {
-      setAsspMsg(AEG_ERR_BUG, "addLink: chain has no links");
-      return(-1);
-    }
-    for(num = 1; lPtr->prev != NULL; num++)            /* count links */
-      lPtr = lPtr->prev;             /* while rewinding to first link */
-    if(num >= pipeLength) {                      /* remove first link */
-      if(lPtr->next != NULL)             /* should always be the case */
-	lPtr->next->prev = NULL;                /* new begin of chain */
-      free((void *)lPtr);                            /* return memory */
-    }
-  }
-  lPtr = (MHS_LINK *)malloc(sizeof(MHS_LINK));
-  if(lPtr == NULL) {
-    setAsspMsg(AEG_ERR_MEM, "(addLink)");
+  int i, slot;
+
+  if(numTracks >= MHS_MAXTRACKS)
     return(-1);
-  }
-  lPtr->cand.F0 = cand->F0;
-  lPtr->cand.Q = cand->Q;
-  lPtr->next = NULL;                              /* new end of chain */
-  lPtr->prev = tPtr->chain;                  /* previous end of chain */
-  if(lPtr->prev != NULL)                          /* existing chain ? */
-    lPtr->prev->next = lPtr;                               /* link up */
-  tPtr->chain = lPtr;                /* chain points to the last link */
-  tPtr->duration = 0.0;
-  tPtr->periods = 0.0;
-  tPtr->trackQ = 0.0;
-  sum = 0.0;
-  num = 0;
-  while(lPtr != NULL) {               /* recalculate track parameters */
-    tPtr->periods += (winShift * lPtr->cand.F0); /* number of periods */
-    if(num < maxNumTQ) {
-/*      sum += (double)(lPtr->cand.Q); */                 /* sum Q values */
-      Q = (double)(lPtr->cand.Q);
-      sum += (Q * Q);                         /* sum squared Q values */
-    }
-    num++;                                        /* number of frames */
-    lPtr = lPtr->prev;
-  }
+  for(slot = 0; slot < numTracks; slot++) /* list in ascending order: */
+    if(trkList[slot] != slot)      /* first gap is lowest free slot */
+      break;
+  for(i = numTracks; i > slot; i--)
+    trkList[i] = trkList[i-1];
+  trkList[slot] = slot;
+  numTracks++;
+  track[slot].head = 0;
+  track[slot].numLinks = 0;
+  track[slot].duration = 0.0;
+  track[slot].periods = 0.0;
+  track[slot].sumQQ = 0.0;
+  track[slot].trackQ = 0.0;
+  track[slot].status = MHS_TRK_UNUSED;
+  return(slot);
+}
+/***********************************************************************
+* add a link to the chain and update track parameters and status       *
+* The oldest link is dropped when the chain is as long as the pipe.    *
+***********************************************************************/
+LOCAL void addLink(MHS_TRK *tPtr, MHS_CAND *cand)
+{
+  size_t num, ndx;
+  double Q;
+
+  if(tPtr->numLinks >= maxNumTQ) {   /* Q value drops out of estimate */
+    ndx = (tPtr->head + pipeLength - (maxNumTQ - 1)) % pipeLength;
+    Q = (double)(tPtr->ring[ndx].Q);
+    tPtr->sumQQ -= (Q * Q);
+  }
+  tPtr->head = (tPtr->head + 1) % pipeLength;
+  if(tPtr->numLinks >= pipeLength) {  /* overwrite first (oldest) link */
+    tPtr->periods -= (winShift * tPtr->ring[tPtr->head].F0);
+    tPtr->numLinks--;
+  }
+  tPtr->ring[tPtr->head] = *cand;
+  tPtr->numLinks++;
+  tPtr->periods += (winShift * cand->F0);        /* number of periods */
+  Q = (double)(cand->Q);
+  tPtr->sumQQ += (Q * Q);                   /* sum squared Q values */
+  num = tPtr->numLinks;                           /* number of frames */
   tPtr->duration = (winShift * 1000.0 * num);       /* duration in ms */
   if(num > maxNumTQ)
     num = maxNumTQ;
-/*  tPtr->trackQ = sum / (double)num; */               /* average Q value */
-  tPtr->trackQ = sqrt(sum/(double)num);            /* RMS of Q values */
+  tPtr->trackQ = sqrt(tPtr->sumQQ/(double)num);    /* RMS of Q values */
   tPtr->status |= (MHS_TRK_IN_USE | MHS_TRK_UPDATED);    /* set flags */
-  return(0);
+  return;
 }
 /***********************************************************************
 * push all candidate data of a track into the pipe                     *
@@ -1334,61 +1381,61 @@ LOCAL int addLink(MHS_TRK *tPtr, MHS_CAND *cand)
 ***********************************************************************/
 LOCAL int pipeTrack(long frameNr, MHS_TRK *tPtr, DOBJ *dop)
 {
-  MHS_LINK *lPtr;
+  size_t n, ndx;
 
-  if(!(tPtr->status & MHS_TRK_IN_USE) || tPtr->chain == NULL) {
+  if(!(tPtr->status & MHS_TRK_IN_USE) || tPtr->numLinks == 0) {
     setAsspMsg(AEG_ERR_BUG, "pipeTrack: invalid track");
     return(-1);
   }
-  lPtr = tPtr->chain;
-  while(lPtr->prev != NULL) { /* rewind: oldest value to be pushed first */
-    lPtr = lPtr->prev;
-    frameNr--;
-  }
-  while(lPtr != NULL) {
-    if(pipeFrame(frameNr, &(lPtr->cand), dop) < 0)
+  /* rewind: oldest value to be pushed first */
+  ndx = (tPtr->head + pipeLength - (tPtr->numLinks - 1)) % pipeLength;
+  frameNr -= (long)(tPtr->numLinks - 1);
+  for(n = 0; n < tPtr->numLinks; n++) {
+    if(pipeFrame(frameNr, &(tPtr->ring[ndx]), dop) < 0)
       return(-1);
-    lPtr = lPtr->next;
+    ndx = (ndx + 1) % pipeLength;
     frameNr++;
   }
-
-/*   int ndx, IGNORE = TRUE; */
-/*   while(lPtr != NULL) { */
-/*     if(IGNORE && frameNr >= pipeBegFn && frameNr < pipeEndFn) { */
-/*       ndx = (int)(frameNr - pipeBegFn); */
-/*       if(pipe[ndx].Q < lPtr->cand.Q) */
-/* 	IGNORE = FALSE; */
-/*     } */
-/*     else */
-/*       IGNORE = FALSE; */
-/*     if(!IGNORE) { */
-/*       if(pipeFrame(frameNr, &(lPtr->cand), dop) < 0) */
-/* 	return(-1); */
-/*     } */
-/*     lPtr = lPtr->next; */
-/*     frameNr++; */
-/*   } */
-
   return(0);
 }
 /***********************************************************************
-* delete a complete F0 track                                           *
+* delete a complete F0 track and return its slot                       *
 ***********************************************************************/
-LOCAL void delTrack(MHS_TRK *tPtr)
+LOCAL void delTrack(int slot)
 {
-  MHS_LINK *lPtr, *prev;
-
-  lPtr = tPtr->chain;
-  while(lPtr != NULL) {
-    prev = lPtr->prev;                      /* rewind to first link */
-    free((void *)lPtr);                     /* while deleting links */
-    lPtr = prev;
-  }
-  tPtr->chain = NULL;
-  tPtr->duration = 0.0;
-  tPtr->periods = 0.0;
-  tPtr->trackQ = 0.0;
-  tPtr->status = MHS_TRK_UNUSED;
+  int i;
+
+  for(i = 0; i < numTracks; i++)
+    if(trkList[i] == slot)
+      break;
+  if(i >= numTracks)                               /* not in use */
+    return;
+  for(numTracks--; i < numTracks; i++)
+    trkList[i] = trkList[i+1];
+  if(slot == activeTrk)
+    activeTrk = -1;
+  track[slot].numLinks = 0;
+  track[slot].duration = 0.0;
+  track[slot].periods = 0.0;
+  track[slot].sumQQ = 0.0;
+  track[slot].trackQ = 0.0;
+  track[slot].status = MHS_TRK_UNUSED;
+  return;
+}
+/***********************************************************************
+* delete all F0 tracks                                                 *
+***********************************************************************/
+LOCAL void clrTracks(void)
+{
+  int i, slot;
+
+  for(i = 0; i < numTracks; i++) {
+    slot = trkList[i];
+    track[slot].numLinks = 0;
+    track[slot].status = MHS_TRK_UNUSED;
+  }
+  numTracks = 0;
+  activeTrk = -1;
   return;
 }
 /***********************************************************************
@@ -1398,8 +1445,7 @@ LOCAL void delTrack(MHS_TRK *tPtr)
 ***********************************************************************/
 LOCAL int pipeFrame(long frameNr, MHS_CAND *cand, DOBJ *dop)
 {
-  size_t numBytes;
-  int    ndx;
+  int ndx;
 
   ndx = (int)(frameNr - pipeBegFn);
   if(ndx < 0) {
@@ -1411,13 +1457,13 @@ LOCAL int pipeFrame(long frameNr, MHS_CAND *cand, DOBJ *dop)
     return(-1);
   }
   if(ndx == pipeLength) {                              /* make place */
-    if(storeMHS((float)(pipe[0].F0), pipeBegFn, dop) < 0)
+    if(storeMHS((float)(pipe[pipeHead].F0), pipeBegFn, dop) < 0)
       return(-1);
     pipeBegFn++;
+    pipeHead = (pipeHead + 1) % pipeLength;
     ndx--;
-    numBytes = (pipeLength - 1) * sizeof(MHS_CAND);
-    memmove(pipe, &pipe[1], numBytes);
   }
+  ndx = (int)((pipeHead + ndx) % pipeLength);
   pipe[ndx].F0 = cand->F0;
   pipe[ndx].Q = cand->Q;
   if(pipeEndFn <= frameNr)
@@ -1429,11 +1475,10 @@ LOCAL int pipeFrame(long frameNr, MHS_CAND *cand, DOBJ *dop)
 ***********************************************************************/
 LOCAL int flushPipe(DOBJ *dop)
 {
-  int n;
-
-  for(n = 0; pipeBegFn < pipeEndFn; n++, pipeBegFn++) {
-    if(storeMHS((float)(pipe[n].F0), pipeBegFn, dop) < 0)
+  for( ; pipeBegFn < pipeEndFn; pipeBegFn++) {
+    if(storeMHS((float)(pipe[pipeHead].F0), pipeBegFn, dop) < 0)
       return(-1);
+    pipeHead = (pipeHead + 1) % pipeLength;
   }
   return(0);
 }
@@ -1470,49 +1515,3 @@ LOCAL int storeMHS(float val, long frameNr, DOBJ *dop)
   dop->bufNeedsSave = TRUE;
   return(0);
 }
-
-/***********************************************************************
-* insert an element in a linear array                                  *
-***********************************************************************/
-LOCAL int insElement(void *array, size_t numElements, size_t elementSize,\
-		     size_t index, void *element)
-{
-  char *srcPtr, *dstPtr;
-  size_t  numBytes;
-
-  if(index >= numElements || array == NULL ||\
-     element == NULL || elementSize == 0)
-    return(-1);
-  if(index < (numElements-1)) {     /* shift elements to create space */
-    srcPtr = (char *)array + index*elementSize;
-    dstPtr = srcPtr + elementSize;
-    numBytes = (numElements-1 - index)*elementSize;
-    memmove(dstPtr, srcPtr, numBytes);
-  }
-  dstPtr = (char *)array + index*elementSize;           /* insert new element */
-  memcpy(dstPtr, element, elementSize);
-  return(0);
-}
-/***********************************************************************
-* remove an element from a linear array and append 'fill' if non-NULL  *
-***********************************************************************/
-LOCAL int rmvElement(void *array, size_t numElements, size_t elementSize,\
-		     size_t index, void *fill)
-{
-  char   *srcPtr, *dstPtr;
-  size_t  numBytes;
-
-  if(index >= numElements || array == NULL || elementSize == 0)
-    return(-1);
-  if(index < (numElements-1)) {          /* move elements to fill gap */
-    dstPtr = (char *)array + index*elementSize;
-    srcPtr = dstPtr + elementSize;
-    numBytes = (numElements-1 - index)*elementSize;
-    memmove(dstPtr, srcPtr, numBytes);
-  }
-  if(fill != NULL) {                    /* set filler at end of array */
-    dstPtr = (char *)array + (numElements-1)*elementSize;
-    memcpy(dstPtr, fill, elementSize);
-  }
-  return(0);
-}
@@ -35,6 +35,7 @@
 #include <stddef.h>   /* size_t */
 #include <string.h>   /* strchr() strlen() strrchr() strcpy() strcat() */
 
+#include <dlldef.h>   /* ASSP_TLS */
 #include <misc.h>     /* prototypes PATH/NAME/SUFF_MAX EOS */
 
 /*DOC
@@ -102,7 +103,7 @@ char *myfilename(char *fullPath)
 
 char *mybasename(char *fullPath)
 {
-  static char result[NAME_MAX+1];
+  static ASSP_TLS char result[NAME_MAX+1];
   register char *cPtr;
   
   strcpy(result, "");
@@ -148,7 +149,7 @@ char *mybasename(char *fullPath)
 
 char *mybarename(char *fullPath)
 {
-  static char result[NAME_MAX+1];
+  static ASSP_TLS char result[NAME_MAX+1];
   register char *cPtr;
   
   strcpy(result, "");
@@ -200,7 +201,7 @@ char *mybarename(char *fullPath)
 int parsepath(char *fullPath, char **dirPath,\
 	      char **baseName, char **extension)
 {
-  static char path[PATH_MAX+1], base[NAME_MAX+1], ext[SUFF_MAX+1];
+  static ASSP_TLS char path[PATH_MAX+1], base[NAME_MAX+1], ext[SUFF_MAX+1];
   register char  *cPtr;
   size_t len;
 
@@ -43,11 +43,12 @@
 #include <asspmess.h>  /* error message handler */
 #include <assptime.h>  /* standard conversion macros */
 #include <asspana.h>   /* AOPTS anaTiming() (includes rfc.h) */
-#include <asspdsp.h>   /* makeWF() freeWF() mulSigWF() getACF() ... */
+#include <asspdsp.h>   /* getWF() freeWF() mulSigWF() getACF() ... */
 #include <asspfio.h>   /* asspFFlush() */
 #include <dataobj.h>   /* DOBJ DT_xxx getSmpCaps() getSmpFrame() */
 #include <headers.h>   /* KDTAB */
 #include <aucheck.h>   /* AUC_... checkSound() */
+#include <asspprof.h>  /* PROF_... */
 
 /*
  * local global arrays and variables
@@ -360,6 +361,7 @@ DOBJ *computeLP(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *lpDOp)
   double  *dPtr;
   LP_GD   *gd;
   LP_TYPE *lPtr;
+  PROF_DECL(t)
 
   if(smpDOp == NULL || (aoPtr == NULL && lpDOp == NULL)) {
     setAsspMsg(AEB_BAD_ARGS, "computeLP");
@@ -445,11 +447,13 @@ DOBJ *computeLP(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *lpDOp)
   /* loop over frames */
   err = 0;
   clrAsspMsg();
+  PROF_START(t);
   for(fn = gd->begFrameNr; fn < gd->endFrameNr; fn++) {
     if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, head, tail,\
 			gd->channel, (void *)frame, LP_PFORMAT)) < 0) {
       break;
     }
+    PROF_LAP(t, PRF_FRAME);
     dPtr = &frame[head];
     for(i = 0; i < frameSize; i++)
       rmsBuf[i] = *(dPtr++);
@@ -465,10 +469,12 @@ DOBJ *computeLP(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *lpDOp)
     preEmphasis(dPtr, gd->preEmph, frame[0], frameSize);
     if(gd->winFunc > WF_RECTANGLE)
       mulSigWF(dPtr, wfc, frameSize);
+    PROF_LAP(t, PRF_WINDOW);                     /* incl. RMS of frame */
     if(TRACE['N'])
       getMeanACF(dPtr, acf, frameSize, order);
     else
       getACF(dPtr, acf, frameSize, order);
+    PROF_LAP(t, PRF_TRANSFORM);
     if(asspDurbin(acf, lpc, rfc, &(data.gain), order) < 0) {
       bPtr = &applMessage[strlen(applMessage)];
       if(FILE_IN)
@@ -501,9 +507,12 @@ DOBJ *computeLP(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *lpDOp)
     default:      /* stored via mapping of 'lpc' or 'rfc' on 'lpData' */
       break;
     }
+    PROF_LAP(t, PRF_SOLVE);
     if((err=storeLP(&data, fn, lpDOp)) < 0) {
       break;
     }
+    PROF_LAP(t, PRF_STORE);
+    PROF_COUNT(PRC_FRAMES, 1);
   } /* END loop over frames */
   if(err >= 0 && FILE_OUT)
     err = asspFFlush(lpDOp, gd->writeOpts);
@@ -555,7 +564,7 @@ LOCAL int setGlobals(DOBJ *dop)
     if((ODD(frameSize) && EVEN(frameShift)) ||
        (EVEN(frameSize) && ODD(frameShift)) )
       wFlags = WF_ASYMMETRIC; /* align window centre and frame centre */
-    wfc = makeWF(gd->winFunc, frameSize, wFlags);
+    wfc = getWF(gd->winFunc, frameSize, wFlags);
     if(wfc == NULL) {
       setAsspMsg(AEG_ERR_MEM, "LP: setGlobals");
       return(-1);
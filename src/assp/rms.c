@@ -41,22 +41,27 @@
 #include <asspmess.h>  /* error message handler */
 #include <assptime.h>  /* standard conversion macros */
 #include <asspana.h>   /* AOPTS anaTiming() (includes rms.h) */
-#include <asspdsp.h>   /* makeWF() freeWF() mulSigWF() getRMS() */
+#include <asspdsp.h>   /* getWF() freeWF() mulSigWF() getRMS() */
 #include <asspfio.h>   /* asspFFlush() */
-#include <dataobj.h>   /* DOBJ getSmpCaps() getSmpFrame() */
+#include <dataobj.h>   /* DOBJ getSmpCaps() getSmpFrame() getSmpView() */
 #include <headers.h>   /* KDTAB */
 #include <aucheck.h>   /* checkSound() */
+#include <asspprof.h>  /* PROF_... */
 
 /*
  * local global variables and arrays
  */
 LOCAL double *frame=NULL; /* frame buffer (allocated) */
 LOCAL double *wfc=NULL;   /* window function coefficients (allocated) */
+LOCAL float  *fltFrame=NULL; /* single-precision frame (allocated) */
+LOCAL float  *fltWfc=NULL;   /* single-precision window (allocated) */
+LOCAL int16_t *i16Frame=NULL; /* frame of 16-bit samples (allocated) */
+LOCAL DOBJ   *smpCache=NULL; /* converted samples for getSmpView() */
 
 /*
  * prototypes of private functions
  */
-LOCAL int  setGlobals(DOBJ *dop);
+LOCAL int  setGlobals(DOBJ *dop, int I16_IN);
 LOCAL void freeGlobals(void);
 LOCAL int  storeRMS(float *vals, long frameNr, DOBJ *dop);
 
@@ -261,12 +266,13 @@ DOC*/
 
 DOBJ *computeRMS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *rmsDOp)
 {
-  int     FILE_IN, FILE_OUT, CREATED;
+  int     FILE_IN, FILE_OUT, CREATED, I16_IN;
   int     err, cn, numChans;
-  long    fn, frameSize, frameShift;
+  long    fn, n, frameSize, frameShift;
   float   rmsVal[RMS_O_CHANS];
-  double  wfGain, rmsAmp;
+  double  wfGain, rmsAmp, *dPtr;
   RMS_GD *gd;
+  PROF_DECL(t)
 
   if(smpDOp == NULL || (aoPtr == NULL && rmsDOp == NULL)) {
     setAsspMsg(AEB_BAD_ARGS, "computeRMS");
@@ -319,7 +325,9 @@ DOBJ *computeRMS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *rmsDOp)
     }
   }
   /* set global values and allocate local buffer space */
-  if(setGlobals(rmsDOp) < 0) {
+  I16_IN = (smpDOp->ddl.format == DF_INT16 &&\
+	    !(gd->options & RMS_OPT_FLOAT));
+  if(setGlobals(rmsDOp, I16_IN) < 0) {
     if(CREATED)
       freeDObj(rmsDOp);
     return(NULL);
@@ -329,6 +337,16 @@ DOBJ *computeRMS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *rmsDOp)
   else
     wfGain = 1.0;
   numChans = (int)(rmsDOp->ddl.numFields);
+  if(numChans == 1 && !I16_IN && !(gd->options & RMS_OPT_FLOAT)) {
+    smpCache = allocSmpCache(smpDOp, frameSize, frameShift, 0, 0,\
+			     RMS_PFORMAT);
+    if(smpCache == NULL) {
+      freeGlobals();
+      if(CREATED)
+	freeDObj(rmsDOp);
+      return(NULL);
+    }
+  }
   if(TRACE['A']) {
     fprintf(traceFP, "Analysis parameters\n");
     fprintf(traceFP, "  sample rate = %.1f Hz\n", rmsDOp->sampFreq);
@@ -338,6 +356,8 @@ DOBJ *computeRMS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *rmsDOp)
 	    wfSpecs(gd->winFunc)->entry->code);
     fprintf(traceFP, "  output coding = %s\n",\
 	    (gd->options & RMS_OPT_LINEAR) ? "linear":"dB");
+    fprintf(traceFP, "  processing precision = %s\n",\
+	    (gd->options & RMS_OPT_FLOAT) ? "single":"double");
     if(gd->channel < 1)
       fprintf(traceFP, "  number of channels = %d\n", numChans);
     else
@@ -348,22 +368,62 @@ DOBJ *computeRMS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *rmsDOp)
 	    FILE_IN ? "file" : "memory", FILE_OUT ? "file" : "memory");
   }
   /* loop over frames */
+  PROF_START(t);
   for(err = 0, fn = gd->begFrameNr; fn < gd->endFrameNr; fn++) {
     /* loop over channels */
     for(cn = 0; cn < numChans; cn++) {
-      if(gd->channel > 0) { /* single channel */
-        if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
-			    gd->channel, frame, RMS_PFORMAT)) < 0)
-          break;
+      if(gd->options & RMS_OPT_FLOAT) {
+	if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
+			    (gd->channel > 0) ? gd->channel : cn+1,\
+			    fltFrame, DF_REAL32)) < 0)
+	  break;
+	PROF_LAP(t, PRF_FRAME);
+	if(fltWfc != NULL) {
+	  for(n = 0; n < frameSize; n++)
+	    fltFrame[n] *= fltWfc[n];
+	}
+	rmsAmp = getRMSf(fltFrame, frameSize);
       }
-      else { /* possibly multi-channel */
-        if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
-			    cn+1, frame, RMS_PFORMAT)) < 0)
-          break;
+      else if(I16_IN) {     /* windowed directly from 16-bit samples */
+	if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
+			    (gd->channel > 0) ? gd->channel : cn+1,\
+			    i16Frame, DF_INT16)) < 0)
+	  break;
+	PROF_LAP(t, PRF_FRAME);
+	rmsAmp = getRMSI16(i16Frame, (gd->winFunc > WF_RECTANGLE) ?\
+			   wfc : NULL, frameSize);
+      }
+      else if(smpCache != NULL) {   /* single channel: view, no copy */
+	dPtr = (double *)getSmpView(smpDOp, fn, frameSize, frameShift,\
+				    0, 0, gd->channel, smpCache);
+	if(dPtr == NULL) {
+	  err = -1;
+	  break;
+	}
+	PROF_LAP(t, PRF_FRAME);
+	if(gd->winFunc > WF_RECTANGLE) {
+	  for(n = 0; n < frameSize; n++)
+	    frame[n] = dPtr[n] * wfc[n];
+	  dPtr = frame;
+	}
+	rmsAmp = getRMS(dPtr, frameSize);
+      }
+      else {
+	if(gd->channel > 0) { /* single channel */
+	  if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
+			      gd->channel, frame, RMS_PFORMAT)) < 0)
+	    break;
+	}
+	else { /* possibly multi-channel */
+	  if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, 0, 0,\
+			      cn+1, frame, RMS_PFORMAT)) < 0)
+	    break;
+	}
+	PROF_LAP(t, PRF_FRAME);
+	if(gd->winFunc > WF_RECTANGLE)
+	  mulSigWF(frame, wfc, frameSize);
+	rmsAmp = getRMS(frame, frameSize);
       }
-      if(gd->winFunc > WF_RECTANGLE)
-        mulSigWF(frame, wfc, frameSize);
-      rmsAmp = getRMS(frame, frameSize);
       if(gd->winFunc > WF_RECTANGLE)
         rmsAmp /= wfGain;
       if(!(gd->options & RMS_OPT_LINEAR)) {          /* convert to dB */
@@ -384,9 +444,12 @@ DOBJ *computeRMS(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *rmsDOp)
           rmsAmp = LINtodB(rmsAmp);
       }
       rmsVal[cn] = (float)rmsAmp;
+      PROF_LAP(t, PRF_TRANSFORM);         /* incl. fused windowing */
     } /* END loop over channels */
     if(err < 0) break;
     if((err=storeRMS(rmsVal, fn, rmsDOp)) < 0) break;
+    PROF_LAP(t, PRF_STORE);
+    PROF_COUNT(PRC_FRAMES, 1);
   } /* END loop over frames */
   if(err >= 0 && FILE_OUT)
     err = asspFFlush(rmsDOp, gd->writeOpts);
@@ -545,25 +608,58 @@ void freeRMS_GD(void *generic)
 
 /***********************************************************************
 * allocate memory for the frame buffer and the window coefficients     *
+* (in single precision with option RMS_OPT_FLOAT)                      *
 ***********************************************************************/
-LOCAL int setGlobals(DOBJ *dop)
+LOCAL int setGlobals(DOBJ *dop, int I16_IN)
 {
   int     wFlags;
+  long    n;
   RMS_GD *gd;
 
   frame = wfc = NULL;
+  fltFrame = fltWfc = NULL;
+  i16Frame = NULL;
+  smpCache = NULL;
   gd = (RMS_GD *)(dop->generic);
   if(gd->winFunc > WF_RECTANGLE) {
     wFlags = WF_PERIODIC;
     if((ODD(gd->frameSize) && EVEN(dop->frameDur)) ||
        (EVEN(gd->frameSize) && ODD(dop->frameDur)) )
       wFlags = WF_ASYMMETRIC; /* align window centre and frame centre */
-    wfc = makeWF(gd->winFunc, gd->frameSize, wFlags);
+    wfc = getWF(gd->winFunc, gd->frameSize, wFlags);
     if(wfc == NULL) {
       setAsspMsg(AEG_ERR_MEM, "RMS: setGlobals");
       return(-1);
     }
   }
+  if(gd->options & RMS_OPT_FLOAT) {
+    fltFrame = (float *)calloc((size_t)(gd->frameSize), sizeof(float));
+    if(fltFrame == NULL) {
+      freeGlobals();
+      setAsspMsg(AEG_ERR_MEM, "RMS: setGlobals");
+      return(-1);
+    }
+    if(wfc != NULL) {
+      fltWfc = (float *)malloc((size_t)(gd->frameSize) * sizeof(float));
+      if(fltWfc == NULL) {
+	freeGlobals();
+	setAsspMsg(AEG_ERR_MEM, "RMS: setGlobals");
+	return(-1);
+      }
+      for(n = 0; n < gd->frameSize; n++)
+	fltWfc[n] = (float)wfc[n];
+    }
+    return(0);
+  }
+  if(I16_IN) { /* no conversion: processed by 'getRMSI16' */
+    i16Frame = (int16_t *)calloc((size_t)(gd->frameSize), sizeof(int16_t));
+    if(i16Frame == NULL) {
+      freeGlobals();
+      setAsspMsg(AEG_ERR_MEM, "RMS: setGlobals");
+      return(-1);
+    }
+    return(0);
+  }
   frame = (double *)calloc((size_t)(gd->frameSize), sizeof(double));
   if(frame == NULL) {
     freeGlobals();
@@ -582,6 +678,15 @@ LOCAL void freeGlobals(void)
     free((void *)frame);
   freeWF(wfc);
   frame = wfc = NULL;
+  if(fltFrame != NULL)
+    free((void *)fltFrame);
+  if(fltWfc != NULL)
+    free((void *)fltWfc);
+  fltFrame = fltWfc = NULL;
+  if(i16Frame != NULL)
+    free((void *)i16Frame);
+  i16Frame = NULL;
+  smpCache = freeDObj(smpCache);
   return;
 }
 
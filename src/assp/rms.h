@@ -101,6 +101,7 @@ extern "C" {
  */
 #define RMS_OPT_NONE   0x0000
 #define RMS_OPT_LINEAR 0x0001 /* linear amplitude instead of dB */
+#define RMS_OPT_FLOAT  0x0002 /* single-precision processing */
 
 /*
  * fixed parameters
@@ -33,7 +33,9 @@
 #include <stdio.h>    /* FILE NULL etc. */
 #include <stdlib.h>   /* malloc() calloc() free() */
 #include <string.h>   /* str..() */
-#include <math.h>     /* sqrt() log10() */
+#include <math.h>     /* sqrt() log10() log10f() */
+#include <float.h>    /* FLT_MIN */
+#include <inttypes.h> /* uint8_t */
 
 #include <miscdefs.h> /* TRUE FALSE LOCAL */
 #include <misc.h>     /* strnxcmp() */
@@ -42,11 +44,12 @@
 #include <assptime.h> /* standard conversion macros */
 #include <spectra.h>  /* processing parameters & SPECT functions */
 #include <asspana.h>  /* AOPTS anaTiming() */
-#include <asspdsp.h>  /* makeWF() freeWF() mulSigWF() [r]fft() etc. */
+#include <asspdsp.h>  /* getWF() freeWF() mulSigWF() [r]fft() etc. */
 #include <asspfio.h>  /* asspFFlush() */
-#include <dataobj.h>  /* DOBJ getSmpCaps() getSmpFrame() */
+#include <dataobj.h>  /* DOBJ getSmpCaps() getSmpFrame() getSmpView() */
 #include <headers.h>  /* KDTAB */
 #include <aucheck.h>  /* checkSound() */
+#include <asspprof.h> /* PROF_... */
 
 /*
  * table relating available spectrum types as string with data type
@@ -57,15 +60,34 @@ SPECT_TYPE spectType[] = {
   {"LPS", DT_FTLPS, ".lps"},
   {"CSS", DT_FTCSS, ".css"},
   {"CEP", DT_FTCEP, ".cep"},
+  {"MFCC", DT_MFCC, ".mfc"},
   { NULL, DT_UNDEF, NULL}
 };
 
+/*
+ * DFT spectra in single precision may be computed in blocks of frames
+ */
+#define BLOCK_MODE(gd) (((gd)->spType == DT_FTPOW ||\
+			 (gd)->spType == DT_FTAMP ||\
+			 (gd)->spType == DT_FTSQR) &&\
+			((gd)->options & (SPECT_OPT_FLOAT | SPECT_OPT_QUANT)))
+
 /*
  * prototypes of private functions
  */
 LOCAL int  allocBufs(SPECT_GD *gd, long frameShift);
 LOCAL void freeBufs(SPECT_GD *gd);
 LOCAL int  storeSPECT(long frameNr, DOBJ *dop);
+LOCAL void *getRecord(long frameNr, DOBJ *dop);
+LOCAL int  i16FTSpectrum(DOBJ *dop);
+LOCAL void ftSpectrum(SPECT_GD *gd);
+LOCAL int  blockFTSpectra(DOBJ *smpDOp, DOBJ *dop, int FILE_IN);
+LOCAL int  makeMelBank(SPECT_GD *gd);
+LOCAL int  storeMFCC(long frameNr, DOBJ *dop);
+LOCAL int  flushMFCC(DOBJ *dop);
+LOCAL int  putMFCC(long frameNr, DOBJ *dop);
+LOCAL double *histFrame(SPECT_GD *gd, long frameNr);
+LOCAL void getDelta(SPECT_GD *gd, long frameNr, double *delta);
 LOCAL void lpInvLinAmp(double *c, double msqr, long N);
 LOCAL void lpInvLinPow(double *c, double msqr, long N);
 LOCAL void lpInvPower(double *c, double msqr, long N);
@@ -113,6 +135,11 @@ dtype_e getSPECTtype(char *str, char *suffix)
       if(suffix != NULL)
 	strcpy(suffix, ".cep");
     }
+    else if(strnxcmp(str, "MFCC", 2) == 0) {
+      spType = DT_MFCC;
+      if(suffix != NULL)
+	strcpy(suffix, ".mfc");
+    }
     /* the following are not supported by 'spectrum' */
     else if(strnxcmp(str, "FTAMP", 4) == 0) {
       spType = DT_FTAMP;
@@ -177,6 +204,9 @@ int setSPECTdefaults(AOPTS *aoPtr)
   case DT_FTCEP:
     setCEPdefaults(aoPtr);
     break;
+  case DT_MFCC:
+    setMFCCdefaults(aoPtr);
+    break;
   default:
     setAsspMsg(AEG_ERR_BUG, "setSPECTdefaults: invalid default type");
     return(-1);
@@ -293,6 +323,42 @@ int setCEPdefaults(AOPTS *aoPtr)
 
 /*DOC
 
+Function 'setMFCCdefaults'
+
+Sets the items in the analysis options structure specific for the 
+analysis of mel frequency cepstral coefficients to their default values.
+Unlike for the other spectrum types, this includes the frame shift and 
+the window function, for which the customary values in speech 
+recognition differ from those of the spectral analyses.
+Returns 0 upon success and -1 upon error.
+
+Note:
+ - This function may modify option flags.
+
+DOC*/
+
+int setMFCCdefaults(AOPTS *aoPtr)
+{
+  if(aoPtr == NULL) {
+    setAsspMsg(AEB_BAD_ARGS, "setMFCCdefaults");
+    return(-1);
+  }
+  aoPtr->msSize = MFCC_DEF_SIZE;
+  aoPtr->msShift = MFCC_DEF_SHIFT;
+  aoPtr->preEmph = MFCC_DEF_PREEMPH;
+  aoPtr->order = MFCC_DEF_CEPS;
+  aoPtr->numFilters = MFCC_DEF_FILTERS;
+  aoPtr->minF = 0.0;
+  aoPtr->maxF = 0.0;                               /* Nyquist rate */
+  strcpy(aoPtr->winFunc, MFCC_DEF_WINDOW);
+  aoPtr->options &= ~(SPECT_OPT_LIN_AMP | SPECT_OPT_LIN_POW | LPS_OPT_DEEMPH |\
+		      AOPT_USE_ENBW | AOPT_EFFECTIVE |\
+		      MFCC_OPT_DELTA | MFCC_OPT_DDELTA);
+  return(0);
+}
+
+/*DOC
+
 Function 'createSPECT'
 
 Allocates memory for a data object to hold spectral/cepstral coefficients 
@@ -355,10 +421,18 @@ DOBJ *createSPECT(DOBJ *smpDOp, AOPTS *aoPtr)
   if(N <= 0)
     aoPtr->FFTLen = 0;                     /* else keep rounded value */
   clrAsspMsg();                               /* ignore warnings here */
+  if(spType == DT_MFCC) {    /* window size is set independently of FFT */
+    while(numFFT < tPtr->frameSize)
+      numFFT *= 2;
+  }
   if(spType != DT_FTLPS && tPtr->frameSize > numFFT) {
     setAsspMsg(AEG_ERR_APPL, "createSPECT: frame size exceeds FFT length");
     return(NULL);
   }
+  if((aoPtr->options & SPECT_OPT_QUANT) && spType != DT_FTPOW) {
+    setAsspMsg(AEG_ERR_APPL, "createSPECT: can only quantize DFT levels");
+    return(NULL);
+  }
   if((gd=(SPECT_GD *)malloc(sizeof(SPECT_GD))) == NULL) {
     setAsspMsg(AEG_ERR_MEM, "(createSPECT)");
     return(NULL);
@@ -411,6 +485,14 @@ DOBJ *createSPECT(DOBJ *smpDOp, AOPTS *aoPtr)
   gd->fftBuf = NULL;
   gd->wfc = NULL;
   gd->acf = NULL;
+  gd->block = NULL;
+  gd->fltBuf = NULL;
+  gd->fltWfc = NULL;
+  gd->i16Frame = NULL;
+  gd->smpCache = NULL;
+  gd->melFirst = gd->melLen = NULL;
+  gd->melWgt = gd->melLog = gd->dctTab = gd->hist = NULL;
+  gd->histBeg = gd->histEnd = -1;
   /* determine correction factor for computed spectra so as to get    */ 
   /* the 'true' levels independent of window function, window size    */
   /* and number of FFT points                                         */
@@ -426,6 +508,7 @@ DOBJ *createSPECT(DOBJ *smpDOp, AOPTS *aoPtr)
     gd->corrFac = 1.0 / fac;
     break;
   case DT_FTSQR:
+  case DT_MFCC:          /* mel band energies from linear power spectrum */
     fac *= ((double)gd->frameSize / (double)gd->numFFT);
     gd->corrFac = 1.0 / (fac * fac);
     break;
@@ -456,6 +539,55 @@ DOBJ *createSPECT(DOBJ *smpDOp, AOPTS *aoPtr)
   gd->maxF = aoPtr->maxF;
   gd->minF = aoPtr->minF;
   gd->numLevels = aoPtr->numLevels;
+  if(gd->options & SPECT_OPT_QUANT) {
+    if(gd->range <= 0.0)
+      gd->range = SONA_DEF_RANGE;
+    if(gd->numLevels <= 0)
+      gd->numLevels = SONA_DEF_LEVELS;
+    else if(gd->numLevels < 2 || gd->numLevels > SONA_MAX_LEVELS) {
+      freeSPECT_GD((void *)gd);
+      setAsspMsg(AEG_ERR_APPL, "createSPECT: invalid number of levels");
+      return(NULL);
+    }
+    /* highest level for a full-scale sinusoid, lowered by the gain */
+    if(smpDOp->ddl.format == DF_REAL32 || smpDOp->ddl.format == DF_REAL64)
+      gd->topLevel = 0.0;
+    else
+      gd->topLevel = LINtodB(pow(2.0, (double)(smpDOp->ddl.numBits - 1)));
+    gd->topLevel -= gd->gain;
+  }
+  else
+    gd->topLevel = 0.0;
+  gd->numFilters = gd->numDeltas = 0;
+  if(spType == DT_MFCC) {
+    gd->order = (aoPtr->order < 1) ? MFCC_DEF_CEPS : aoPtr->order;
+    if(aoPtr->numFilters < 1)
+      gd->numFilters = MFCC_DEF_FILTERS;
+    else
+      gd->numFilters = aoPtr->numFilters;
+    if(gd->order > gd->numFilters) {
+      freeSPECT_GD((void *)gd);
+      setAsspMsg(AEG_ERR_APPL, "createSPECT: more MFCCs than mel filters");
+      return(NULL);
+    }
+    if(gd->maxF <= 0.0)
+      gd->maxF = tPtr->sampFreq / 2.0;
+    if(gd->minF < 0.0 || gd->minF >= gd->maxF ||\
+       gd->maxF > tPtr->sampFreq / 2.0) {
+      freeSPECT_GD((void *)gd);
+      setAsspMsg(AEG_ERR_APPL, "createSPECT: invalid mel frequency range");
+      return(NULL);
+    }
+    if(gd->options & MFCC_OPT_DDELTA)
+      gd->numDeltas = 2;
+    else if(gd->options & MFCC_OPT_DELTA)
+      gd->numDeltas = 1;
+    if((long)(gd->order * (gd->numDeltas + 1)) > gd->numFFT) {
+      freeSPECT_GD((void *)gd);
+      setAsspMsg(AEG_ERR_APPL, "createSPECT: too many MFCCs for FFT length");
+      return(NULL);
+    }
+  }
   gd->accuracy = aoPtr->accuracy;
   gd->precision = aoPtr->precision;
 
@@ -483,12 +615,20 @@ DOBJ *createSPECT(DOBJ *smpDOp, AOPTS *aoPtr)
   dd = &(dop->ddl);                 /* set pointer to data descriptor */
   dd->type = spType;
   dd->coding = DC_LIN;
-  if(gd->options & SPECT_OPT_DOUBLE)
+  if(gd->options & SPECT_OPT_QUANT)
+    dd->format = SONA_DFORMAT;
+  else if(gd->options & SPECT_OPT_DOUBLE)
     dd->format = DF_REAL64;
   else
     dd->format = SPECT_DFORMAT;
-  dd->numFields = gd->numFFT / 2 + 1;
-  dd->numBits = smpDOp->ddl.numBits;              /* for auto-scaling */
+  if(spType == DT_MFCC)
+    dd->numFields = gd->order * (gd->numDeltas + 1);
+  else
+    dd->numFields = gd->numFFT / 2 + 1;
+  if(gd->options & SPECT_OPT_QUANT)
+    dd->numBits = 8;
+  else
+    dd->numBits = smpDOp->ddl.numBits;            /* for auto-scaling */
   if(dop->fileFormat == FF_SSFF) {
     entry = dtype2entry(dd->type, KDT_SSFF);   /* search SSFF keyword */
     if(entry != NULL && entry->keyword != NULL) {
@@ -507,7 +647,8 @@ DOBJ *createSPECT(DOBJ *smpDOp, AOPTS *aoPtr)
   else { /* fall through to raw ASCII */
     strcpy(dop->sepChars, "\t");                    /* between fields */
     strcpy(dd->sepChars, " ");                        /* within field */
-    if(gd->options & SPECT_OPT_LIN_AMP || gd->options & SPECT_OPT_LIN_POW) {
+    if(gd->options & SPECT_OPT_LIN_AMP || gd->options & SPECT_OPT_LIN_POW ||
+       spType == DT_MFCC) {
       if(dd->format == DF_REAL64)
 	strcpy(dd->ascFormat, "%+.14e");
       else
@@ -553,16 +694,24 @@ Note:
    analysis structure pointed to by "aoPtr". If parameter changes occur 
    between calls, the output object should best be destroyed and then 
    recreated.
+ - For DFT spectra the option flag 'SPECT_OPT_FLOAT' selects processing 
+   in single precision in blocks of up to SPECT_BLK_FRAMES frames, e.g. 
+   for sonagrams. The flag 'SPECT_OPT_QUANT' implies this and converts 
+   the dB levels of a DFT power spectrum to 'numLevels' (default 256) 
+   unsigned 8-bit levels spanning 'range' dB (default 70) with the top 
+   level at the level of a full-scale sinusoid minus 'gain'.
 
 DOC*/
 
 DOBJ *computeSPECT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *spectDOp)
 {
   char *bPtr;
-  int   FILE_IN, FILE_OUT, CREATED;
+  int   FILE_IN, FILE_OUT, CREATED, I16_IN;
   int   err;
   long  fn, frameSize, frameShift, head;
+  double *dPtr;
   SPECT_GD *gd;
+  PROF_DECL(t)
 
   if(smpDOp == NULL || (aoPtr == NULL && spectDOp == NULL)) {
     setAsspMsg(AEB_BAD_ARGS, "computeSPECT");
@@ -639,6 +788,12 @@ DOBJ *computeSPECT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *spectDOp)
 		frameSize2bandwidth(frameSize, gd->winFunc,\
 				    spectDOp->sampFreq, gd->numFFT));
 	fprintf(traceFP, "  pre-emphasis = %.7f\n", gd->preEmph);
+	if(BLOCK_MODE(gd))
+	  fprintf(traceFP, "  block mode = %d frames (single precision)\n",\
+		  SPECT_BLK_FRAMES);
+	if(gd->options & SPECT_OPT_QUANT)
+	  fprintf(traceFP, "  quantization = %d levels over %.1f to %.1f dB\n",\
+		  gd->numLevels, gd->topLevel - gd->range, gd->topLevel);
       }
       else if(gd->spType == DT_FTLPS) {
 	fprintf(traceFP, "  spectrum type = LPS\n");
@@ -651,6 +806,16 @@ DOBJ *computeSPECT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *spectDOp)
 	fprintf(traceFP, "  spectrum type = CSS\n");
 	fprintf(traceFP, "  # lags = %d\n", gd->order);
       }
+      else if(gd->spType == DT_MFCC) {
+	fprintf(traceFP, "  spectrum type = MFCC\n");
+	fprintf(traceFP, "  # coefficients = %d\n", gd->order);
+	fprintf(traceFP, "  # mel filters = %d\n", gd->numFilters);
+	fprintf(traceFP, "  mel filter range = %.1f to %.1f Hz\n",\
+		gd->minF, gd->maxF);
+	fprintf(traceFP, "  pre-emphasis = %.7f\n", gd->preEmph);
+	fprintf(traceFP, "  deltas = %s\n", (gd->numDeltas == 2) ?\
+		"delta + delta-delta" : (gd->numDeltas == 1) ? "delta" : "none");
+      }
       else
 	fprintf(traceFP, "  spectrum type = CEP\n");
       fprintf(traceFP, "  processing mode = %s-to-%s\n",\
@@ -676,11 +841,45 @@ DOBJ *computeSPECT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *spectDOp)
   /* loop over frames */
   err = 0;
   clrAsspMsg();
-  for(fn = gd->begFrameNr; fn < gd->endFrameNr; fn++) {
-    if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, head, 0,\
-			gd->channel, gd->frame, SPECT_PFORMAT)) < 0) {
-      break;
+  if(gd->numDeltas > 0 &&\
+     (aoPtr != NULL || gd->histBeg < 0 || gd->histEnd != gd->begFrameNr))
+    gd->histBeg = gd->histEnd = gd->begFrameNr;    /* fresh MFCC history */
+  if(BLOCK_MODE(gd)) {
+    err = blockFTSpectra(smpDOp, spectDOp, FILE_IN);
+    PROF_COUNT(PRC_FRAMES, gd->endFrameNr - gd->begFrameNr);
+    fn = gd->endFrameNr;                /* skip frame-by-frame loop */
+  }
+  else
+    fn = gd->begFrameNr;
+  I16_IN = (smpDOp->ddl.format == DF_INT16 && gd->i16Frame != NULL);
+  if(!I16_IN && fn < gd->endFrameNr) {
+    if(gd->smpCache == NULL) {
+      gd->smpCache = allocSmpCache(smpDOp, frameSize, frameShift, head,\
+				   0, SPECT_PFORMAT);
+      if(gd->smpCache == NULL)
+	err = -1;
+    }
+    else
+      gd->smpCache->bufNumRecs = 0;       /* input may have changed */
+  }
+  PROF_START(t);
+  for( ; err >= 0 && fn < gd->endFrameNr; fn++) {
+    if(I16_IN) {                     /* processed by 'i16FTSpectrum' */
+      if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, head, 0,\
+			  gd->channel, gd->i16Frame, DF_INT16)) < 0)
+	break;
+    }
+    else {     /* the spectrum functions modify the frame: copy view */
+      if((dPtr=(double *)getSmpView(smpDOp, fn, frameSize, frameShift,\
+				    head, 0, gd->channel,\
+				    gd->smpCache)) == NULL) {
+	err = -1;
+	break;
+      }
+      memcpy((void *)(gd->frame), (void *)dPtr,\
+	     (size_t)(head + frameSize) * sizeof(double));
     }
+    PROF_LAP(t, PRF_FRAME);
     switch(gd->spType) {
     case DT_FTLPS:
       err = getLPSpectrum(spectDOp);
@@ -704,12 +903,29 @@ DOBJ *computeSPECT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *spectDOp)
     case DT_FTCEP:
       err = getCepstrum(spectDOp);
       break;
+    case DT_MFCC:
+      err = getMFCC(spectDOp);
+      break;
     default:
-      err = getFTSpectrum(spectDOp);
+      if(I16_IN)
+	err = i16FTSpectrum(spectDOp);
+      else
+	err = getFTSpectrum(spectDOp);
       break;
     }
-    if((err=storeSPECT(fn, spectDOp)) < 0) break;
+    PROF_START(t);            /* the spectrum functions time themselves */
+    if(gd->numDeltas > 0)
+      err = storeMFCC(fn, spectDOp);     /* delayed by regression window */
+    else
+      err = storeSPECT(fn, spectDOp);
+    if(err < 0) break;
+    PROF_LAP(t, PRF_STORE);
+    PROF_COUNT(PRC_FRAMES, 1);
   }       /* END LOOP OVER FRAMES */
+  if(err >= 0 && gd->numDeltas > 0 && !(gd->options & AOPT_STREAM)) {
+    err = flushMFCC(spectDOp);                 /* no more frames follow */
+    gd->histBeg = -1;
+  }
   if(err >= 0 && FILE_OUT)
     err = asspFFlush(spectDOp, gd->writeOpts);
   if(err < 0) {
@@ -743,6 +959,7 @@ void freeSPECT_GD(void *generic)
 /*DOC
 
 Functions 'getFTSpectrum' 'getLPSpectrum' 'getCSSpectrum' 'getCepstrum'
+          'getMFCC'
 
 Compute a single spectrum/cepstrum given the values in the SPECT data 
 object pointed to by "dop". These are low-level functions but still 
@@ -757,12 +974,12 @@ DOC*/
 ***********************************************************************/
 int getFTSpectrum(DOBJ *dop)
 {
-  register long n, N, HN, L;
+  register long n, L;
   register double *dPtr;
   register SPECT_GD *gd=(SPECT_GD *)(dop->generic);
+  PROF_DECL(t)
 
-  N = gd->numFFT;
-  HN = N/2 +1;                       /* include value at Nyquist rate */
+  PROF_START(t);
   L = gd->frameSize;
   dPtr = gd->frame;
   if(gd->preEmph != 0.0) {        /* leading value is in frame buffer */
@@ -773,25 +990,8 @@ int getFTSpectrum(DOBJ *dop)
     mulSigWF(dPtr, gd->wfc, L);
   for(n = 0; n < L; n++)                  /* copy frame to FFT buffer */
     gd->fftBuf[n] = *(dPtr++);
-  while(n < N)                                     /* pad with zeroes */
-    gd->fftBuf[n++] = 0.0;
-  dPtr = gd->fftBuf;
-  rfft(dPtr, N, FFT_FORWARD);
-  if(gd->spType == DT_FTAMP) {           /* linear amplitude spectrum */
-    rfftLinAmp(dPtr, dPtr, N);
-    for(n = 0; n < HN; n++)             /* correction for window etc. */
-      *(dPtr++) *= gd->corrFac;                   /* 'corrFac' linear */
-  }
-  else if(gd->spType == DT_FTSQR) {          /* linear power spectrum */
-    rfftLinPow(dPtr, dPtr, N);
-    for(n = 0; n < HN; n++)
-      *(dPtr++) *= gd->corrFac;          /* 'corrFac' already squared */
-  }
-  else {                                      /* power spectrum in dB */
-    rfftPower(dPtr, dPtr, N);
-    for(n = 0; n < HN; n++)
-      *(dPtr++) += gd->corrFac;            /* 'corrFac' already in dB */
-  }
+  PROF_LAP(t, PRF_WINDOW);
+  ftSpectrum(gd);
   return(0);
 }
 /***********************************************************************
@@ -804,7 +1004,9 @@ int getLPSpectrum(DOBJ *dop)
   int    err=0;
   double sqerr;
   SPECT_GD *gd=(SPECT_GD *)(dop->generic);
+  PROF_DECL(t)
 
+  PROF_START(t);
   N = gd->numFFT;
   HN = N/2 +1;                       /* include value at Nyquist rate */
   L = gd->frameSize;
@@ -815,7 +1017,9 @@ int getLPSpectrum(DOBJ *dop)
   }
   if(gd->wfc != NULL)
     mulSigWF(dPtr, gd->wfc, L);
+  PROF_LAP(t, PRF_WINDOW);
   getACF(dPtr, gd->acf, L, (long)gd->order);
+  PROF_LAP(t, PRF_TRANSFORM);
   err = asspDurbin(gd->acf, gd->fftBuf, NULL, &sqerr, gd->order);
   if(sqerr <= 0.0) {
     for(n = 0; n < HN; n++)
@@ -842,6 +1046,7 @@ int getLPSpectrum(DOBJ *dop)
     else                                      /* power spectrum in dB */
       lpInvPower(gd->fftBuf, sqerr, N);
   }
+  PROF_LAP(t, PRF_SOLVE);
   return(err);
 }
 /***********************************************************************
@@ -853,12 +1058,15 @@ int getCSSpectrum(DOBJ *dop)
   register double *buf;
   SPECT_GD *gd=(SPECT_GD *)(dop->generic);
   double norm, val;
+  PROF_DECL(t)
   
+  PROF_START(t);
   N = gd->numFFT;
   L = gd->frameSize;
   buf = gd->fftBuf;
   if(gd->wfc != NULL)
     mulSigWF(gd->frame, gd->wfc, L);
+  PROF_LAP(t, PRF_WINDOW);
   for(n = 0; n < L; n++) {                  /* copy to complex buffer */
     buf[2*n] = gd->frame[n];
     buf[2*n +1] = 0.0;                  /* set imaginary part to zero */
@@ -920,6 +1128,7 @@ int getCSSpectrum(DOBJ *dop)
       val = dBtoSQR(val);
     *(buf++) = val;
   }
+  PROF_LAP(t, PRF_TRANSFORM);
   return(0);
 }
 /***********************************************************************
@@ -933,12 +1142,15 @@ int getCepstrum(DOBJ *dop)
   register double *buf;
   SPECT_GD *gd=(SPECT_GD *)(dop->generic);
   double val, norm;
+  PROF_DECL(t)
   
+  PROF_START(t);
   N = gd->numFFT;
   L = gd->frameSize;
   buf = gd->fftBuf;
   if(gd->wfc != NULL)
     mulSigWF(gd->frame, gd->wfc, L);
+  PROF_LAP(t, PRF_WINDOW);
   for(n = 0; n < L; n++) {                  /* copy to complex buffer */
     buf[2*n] = gd->frame[n];
     buf[2*n +1] = 0.0;                  /* set imaginary part to zero */
@@ -959,6 +1171,68 @@ int getCepstrum(DOBJ *dop)
       val *= val;
     *(buf++) = val;
   }
+  PROF_LAP(t, PRF_TRANSFORM);
+  return(0);
+}
+
+/***********************************************************************
+* calculate mel frequency cepstral coefficients (static ones only)     *
+***********************************************************************/
+int getMFCC(DOBJ *dop)
+{
+  register long n, k, N, HN, L;
+  register double *dPtr, *wPtr, *c;
+  int    i, j, M;
+  double sum, power;
+  SPECT_GD *gd=(SPECT_GD *)(dop->generic);
+  PROF_DECL(t)
+
+  PROF_START(t);
+  N = gd->numFFT;
+  HN = N / 2;
+  L = gd->frameSize;
+  M = gd->numFilters;
+  dPtr = gd->frame;
+  if(gd->preEmph != 0.0) {        /* leading value is in frame buffer */
+    dPtr++;
+    preEmphasis(dPtr, gd->preEmph, *(gd->frame), L);
+  }
+  if(gd->wfc != NULL)
+    mulSigWF(dPtr, gd->wfc, L);
+  for(n = 0; n < L; n++)                  /* copy frame to FFT buffer */
+    gd->fftBuf[n] = *(dPtr++);
+  PROF_LAP(t, PRF_WINDOW);
+  while(n < N)                                     /* pad with zeroes */
+    gd->fftBuf[n++] = 0.0;
+  c = gd->fftBuf;
+  rfft(c, N, FFT_FORWARD);
+  PROF_LAP(t, PRF_TRANSFORM);
+  /* apply the filter bank directly to the FFT coefficients */
+  wPtr = gd->melWgt;
+  for(j = 0; j < M; j++) {
+    sum = 0.0;
+    for(n = 0, k = gd->melFirst[j]; n < gd->melLen[j]; n++, k++) {
+      if(k == 0)                               /* DC component; Im = 0 */
+	power = c[0] * c[0];
+      else if(k == HN)                     /* Fs/2 component; Im = 0 */
+	power = c[N-1] * c[N-1];
+      else
+	power = c[2*k-1] * c[2*k-1] + c[2*k] * c[2*k];
+      sum += (*(wPtr++) * power);
+    }
+    sum *= gd->corrFac;                 /* correction for window etc. */
+    if(sum < MFCC_MIN_POW)
+      sum = MFCC_MIN_POW;
+    gd->melLog[j] = log(sum);
+  }
+  for(i = 0; i < gd->order; i++) {        /* DCT-II into FFT buffer */
+    dPtr = &(gd->dctTab[i * M]);
+    sum = 0.0;
+    for(j = 0; j < M; j++)
+      sum += (dPtr[j] * gd->melLog[j]);
+    c[i] = sum;
+  }
+  PROF_LAP(t, PRF_SOLVE);
   return(0);
 }
 
@@ -970,9 +1244,14 @@ int getCepstrum(DOBJ *dop)
 LOCAL int allocBufs(SPECT_GD *gd, long frameShift)
 {
   int    wFlags=0;
-  size_t frameSize;
+  size_t frameSize, n;
 
   gd->frame = gd->fftBuf = gd->wfc = gd->acf = NULL;
+  gd->block = gd->fltBuf = gd->fltWfc = NULL;
+  gd->i16Frame = NULL;
+  gd->smpCache = NULL;
+  gd->melFirst = gd->melLen = NULL;
+  gd->melWgt = gd->melLog = gd->dctTab = gd->hist = NULL;
   frameSize = (size_t)(gd->frameSize);
   if(gd->preEmph != 0.0)                 /* space for leading element */
     frameSize++;
@@ -995,7 +1274,7 @@ LOCAL int allocBufs(SPECT_GD *gd, long frameShift)
 	 (EVEN(gd->frameSize) && ODD(frameShift)) )
 	wFlags = WF_ASYMMETRIC;     /* align window and frame centres */
     }
-    gd->wfc = makeWF(gd->winFunc, gd->frameSize, wFlags);
+    gd->wfc = getWF(gd->winFunc, gd->frameSize, wFlags);
     if(gd->wfc == NULL) {
       freeBufs(gd);
       setAsspMsg(AEG_ERR_MEM, "(SPECT: allocBufs)");
@@ -1010,6 +1289,41 @@ LOCAL int allocBufs(SPECT_GD *gd, long frameShift)
       return(-1);
     }
   }
+  if(gd->spType == DT_MFCC) {
+    if(makeMelBank(gd) < 0) {
+      freeBufs(gd);
+      return(-1);
+    }
+  }
+  if(BLOCK_MODE(gd)) {
+    n = frameSize + (size_t)((SPECT_BLK_FRAMES - 1) * frameShift);
+    gd->block = (float *)calloc(n, sizeof(float));
+    gd->fltBuf = (float *)calloc((size_t)gd->numFFT, sizeof(float));
+    if(gd->block == NULL || gd->fltBuf == NULL) {
+      freeBufs(gd);
+      setAsspMsg(AEG_ERR_MEM, "(SPECT: allocBufs)");
+      return(-1);
+    }
+    if(gd->wfc != NULL) {
+      gd->fltWfc = (float *)malloc((size_t)gd->frameSize * sizeof(float));
+      if(gd->fltWfc == NULL) {
+	freeBufs(gd);
+	setAsspMsg(AEG_ERR_MEM, "(SPECT: allocBufs)");
+	return(-1);
+      }
+      for(n = 0; n < (size_t)gd->frameSize; n++)
+	gd->fltWfc[n] = (float)(gd->wfc[n]);
+    }
+  }
+  else if(gd->spType == DT_FTPOW || gd->spType == DT_FTAMP ||\
+	  gd->spType == DT_FTSQR) {        /* for 16-bit input samples */
+    gd->i16Frame = (int16_t *)calloc(frameSize, sizeof(int16_t));
+    if(gd->i16Frame == NULL) {
+      freeBufs(gd);
+      setAsspMsg(AEG_ERR_MEM, "(SPECT: allocBufs)");
+      return(-1);
+    }
+  }
   return(0);
 }
 
@@ -1026,7 +1340,33 @@ LOCAL void freeBufs(SPECT_GD *gd)
     freeWF(gd->wfc);
     if(gd->acf != NULL)
       free((void *)(gd->acf));
+    if(gd->block != NULL)
+      free((void *)(gd->block));
+    if(gd->fltBuf != NULL)
+      free((void *)(gd->fltBuf));
+    if(gd->fltWfc != NULL)
+      free((void *)(gd->fltWfc));
+    if(gd->i16Frame != NULL)
+      free((void *)(gd->i16Frame));
+    gd->smpCache = freeDObj(gd->smpCache);
     gd->frame = gd->fftBuf = gd->wfc = gd->acf = NULL;
+    gd->block = gd->fltBuf = gd->fltWfc = NULL;
+    gd->i16Frame = NULL;
+    if(gd->melFirst != NULL)
+      free((void *)(gd->melFirst));
+    if(gd->melLen != NULL)
+      free((void *)(gd->melLen));
+    if(gd->melWgt != NULL)
+      free((void *)(gd->melWgt));
+    if(gd->melLog != NULL)
+      free((void *)(gd->melLog));
+    if(gd->dctTab != NULL)
+      free((void *)(gd->dctTab));
+    if(gd->hist != NULL)
+      free((void *)(gd->hist));
+    gd->melFirst = gd->melLen = NULL;
+    gd->melWgt = gd->melLog = gd->dctTab = gd->hist = NULL;
+    gd->histBeg = -1;
   }
   return;
 }
@@ -1037,50 +1377,444 @@ LOCAL void freeBufs(SPECT_GD *gd)
 ***********************************************************************/
 LOCAL int storeSPECT(long frameNr, DOBJ *dop)
 {
-  register long      ndx, n, N;
+  register long      n, N;
   register float    *fPtr;
   register double   *sPtr, *dPtr;
-  int       FILE_OUT;
+  void     *rPtr;
+  SPECT_GD *gd;
+
+  gd = (SPECT_GD *)dop->generic;
+  if((rPtr=getRecord(frameNr, dop)) == NULL)
+    return(-1);
+  N = dop->ddl.numFields;
+  sPtr = gd->fftBuf;
+  if(dop->ddl.format == DF_REAL64) {
+    dPtr = (double *)rPtr;
+    for(n = 0; n < N; n++)
+      *(dPtr++) = *(sPtr++);
+  }
+  else {
+    fPtr = (float *)rPtr;
+    for(n = 0; n < N; n++)
+      *(fPtr++) = (float)(*(sPtr++));
+  }
+  return(0);
+}
+
+/***********************************************************************
+* return pointer to the record for frame "frameNr" in the data buffer  *
+* of "dop", writing the buffer to file if it is full; returns NULL     *
+* upon error                                                           *
+***********************************************************************/
+LOCAL void *getRecord(long frameNr, DOBJ *dop)
+{
+  long      ndx;
   SPECT_GD *gd;
 
-  FILE_OUT = (dop->fp != NULL);
   gd = (SPECT_GD *)dop->generic;
   if(dop->bufNumRecs <= 0) {
     dop->bufNumRecs = 0;
     dop->bufStartRec = frameNr;
   }
   else if(frameNr >= (dop->bufStartRec + dop->maxBufRecs)) {
-    if(FILE_OUT) {
+    if(dop->fp != NULL) {
       if(asspFFlush(dop, gd->writeOpts) < 0)
-	return(-1);
+	return(NULL);
     }
     else {
-      setAsspMsg(AEG_ERR_BUG, "storeSPECT: buffer overflow");
-      return(-1);
+      setAsspMsg(AEG_ERR_BUG, "SPECT: buffer overflow");
+      return(NULL);
     }
   }
-  N = dop->ddl.numFields;
-  sPtr = gd->fftBuf;
   ndx = frameNr - dop->bufStartRec;
-  if(dop->ddl.format == DF_REAL64) {
-    dPtr = (double *)(dop->dataBuffer);
-    dPtr = &dPtr[ndx*N];
-    for(n = 0; n < N; n++)
-      *(dPtr++) = *(sPtr++);
-  }
-  else {
-    fPtr = (float *)(dop->dataBuffer);
-    fPtr = &fPtr[ndx*N];
-    for(n = 0; n < N; n++)
-      *(fPtr++) = (float)(*(sPtr++));
-  }
   if(ndx >= dop->bufNumRecs)
     dop->bufNumRecs = ndx + 1;
   dop->bufNeedsSave = TRUE;
+  return((void *)((char *)dop->dataBuffer + ndx * dop->recordSize));
+}
+
+/***********************************************************************
+* calculate unsmoothed spectrum from the frame of 16-bit samples; the  *
+* conversion, pre-emphasis and windowing are done in one pass          *
+***********************************************************************/
+LOCAL int i16FTSpectrum(DOBJ *dop)
+{
+  int16_t  *sPtr;
+  double    tap;
+  SPECT_GD *gd=(SPECT_GD *)(dop->generic);
+  PROF_DECL(t)
+
+  PROF_START(t);
+  sPtr = gd->i16Frame;
+  tap = 0.0;
+  if(gd->preEmph != 0.0) {        /* leading value is in frame buffer */
+    tap = (double)(*sPtr);
+    sPtr++;
+  }
+  emphWinI16(sPtr, gd->preEmph, tap, gd->wfc, gd->fftBuf, gd->frameSize);
+  PROF_LAP(t, PRF_WINDOW);
+  ftSpectrum(gd);
+  return(0);
+}
+
+/***********************************************************************
+* pad the windowed frame in the FFT buffer with zeroes and convert it  *
+* to the type of spectrum required                                     *
+***********************************************************************/
+LOCAL void ftSpectrum(SPECT_GD *gd)
+{
+  register long n, N, HN;
+  register double *dPtr;
+  PROF_DECL(t)
+
+  PROF_START(t);
+  N = gd->numFFT;
+  HN = N/2 +1;                       /* include value at Nyquist rate */
+  for(n = gd->frameSize; n < N; n++)               /* pad with zeroes */
+    gd->fftBuf[n] = 0.0;
+  dPtr = gd->fftBuf;
+  rfft(dPtr, N, FFT_FORWARD);
+  PROF_LAP(t, PRF_TRANSFORM);
+  if(gd->spType == DT_FTAMP) {           /* linear amplitude spectrum */
+    rfftLinAmp(dPtr, dPtr, N);
+    for(n = 0; n < HN; n++)             /* correction for window etc. */
+      *(dPtr++) *= gd->corrFac;                   /* 'corrFac' linear */
+  }
+  else if(gd->spType == DT_FTSQR) {          /* linear power spectrum */
+    rfftLinPow(dPtr, dPtr, N);
+    for(n = 0; n < HN; n++)
+      *(dPtr++) *= gd->corrFac;          /* 'corrFac' already squared */
+  }
+  else {                                      /* power spectrum in dB */
+    rfftPower(dPtr, dPtr, N);
+    for(n = 0; n < HN; n++)
+      *(dPtr++) += gd->corrFac;            /* 'corrFac' already in dB */
+  }
+  PROF_LAP(t, PRF_SOLVE);                         /* level conversion */
+  return;
+}
+
+/***********************************************************************
+* compute DFT spectra in single precision for blocks of frames; the    *
+* samples of a block are fetched in one go and pre-emphasis/windowing, *
+* FFT and level conversion/quantization are done in one pass per frame *
+***********************************************************************/
+LOCAL int blockFTSpectra(DOBJ *smpDOp, DOBJ *dop, int FILE_IN)
+{
+  register long   n;
+  register float *sPtr, *fPtr, *wPtr;
+  long     fn, k, numBlk, maxBlk, N, HN, L, head, shift;
+  float    u, corr, power, bottom, scale, maxLevel, level;
+  void    *rPtr;
+  double  *dPtr;
+  uint8_t *uPtr;
+  SPECT_GD *gd;
+
+  gd = (SPECT_GD *)dop->generic;
+  N = gd->numFFT;
+  HN = N / 2;
+  L = gd->frameSize;
+  shift = dop->frameDur;
+  head = (gd->preEmph != 0.0) ? 1 : 0;
+  u = (float)(gd->preEmph);
+  corr = (float)(gd->corrFac);
+  maxLevel = (float)(gd->numLevels - 1);
+  bottom = (float)(gd->topLevel - gd->range);
+  scale = (gd->range > 0.0) ? (float)((double)maxLevel / gd->range) : 0.0F;
+  maxBlk = SPECT_BLK_FRAMES;
+  if(FILE_IN) {                   /* block has to fit in input buffer */
+    k = 1 + (smpDOp->maxBufRecs - head - L) / shift;
+    if(k < maxBlk)
+      maxBlk = (k < 1) ? 1 : k;
+  }
+  for(fn = gd->begFrameNr; fn < gd->endFrameNr; fn += numBlk) {
+    numBlk = gd->endFrameNr - fn;
+    if(numBlk > maxBlk)
+      numBlk = maxBlk;
+    if(getSmpFrame(smpDOp, fn, L, shift, head, (numBlk - 1) * shift,\
+		   gd->channel, (void *)(gd->block), DF_REAL32) < 0)
+      return(-1);
+    for(k = 0; k < numBlk; k++) {
+      sPtr = &(gd->block[k * shift + head]);      /* start of frame k */
+      fPtr = gd->fltBuf;
+      wPtr = gd->fltWfc;
+      if(head) {          /* leading value is at sPtr[-1] in any case */
+	if(wPtr != NULL)
+	  for(n = 0; n < L; n++)
+	    fPtr[n] = (sPtr[n] + u * sPtr[n-1]) * wPtr[n];
+	else
+	  for(n = 0; n < L; n++)
+	    fPtr[n] = sPtr[n] + u * sPtr[n-1];
+      }
+      else if(wPtr != NULL) {
+	for(n = 0; n < L; n++)
+	  fPtr[n] = sPtr[n] * wPtr[n];
+      }
+      else {
+	for(n = 0; n < L; n++)
+	  fPtr[n] = sPtr[n];
+      }
+      for(n = L; n < N; n++)                       /* pad with zeroes */
+	fPtr[n] = 0.0F;
+      if(rfftf(fPtr, N, FFT_FORWARD) < 0) {
+	setAsspMsg(AEG_ERR_MEM, "(SPECT: blockFTSpectra)");
+	return(-1);
+      }
+      /* in-place conversion as in rfftLinAmp() etc.; note that the */
+      /* Nyquist component at fPtr[N-1] is read before overwriting  */
+      if(gd->spType == DT_FTAMP) {
+	fPtr[0] = (float)fabs(fPtr[0]) * corr;
+	for(n = 1; n < HN; n++)
+	  fPtr[n] = (float)sqrt(fPtr[2*n-1] * fPtr[2*n-1] +\
+				fPtr[2*n] * fPtr[2*n]) * corr;
+	fPtr[HN] = (float)fabs(fPtr[N-1]) * corr;
+      }
+      else if(gd->spType == DT_FTSQR) {
+	fPtr[0] = fPtr[0] * fPtr[0] * corr;
+	for(n = 1; n < HN; n++)
+	  fPtr[n] = (fPtr[2*n-1] * fPtr[2*n-1] +\
+		     fPtr[2*n] * fPtr[2*n]) * corr;
+	fPtr[HN] = fPtr[N-1] * fPtr[N-1] * corr;
+      }
+      else {
+	power = fPtr[0] * fPtr[0];
+	fPtr[0] = (power <= FLT_MIN) ?\
+	  (float)TINYPdB : 10.0F * log10f(power) + corr;
+	for(n = 1; n < HN; n++) {
+	  power = fPtr[2*n-1] * fPtr[2*n-1] + fPtr[2*n] * fPtr[2*n];
+	  fPtr[n] = (power <= FLT_MIN) ?\
+	    (float)TINYPdB : 10.0F * log10f(power) + corr;
+	}
+	power = fPtr[N-1] * fPtr[N-1];
+	fPtr[HN] = (power <= FLT_MIN) ?\
+	  (float)TINYPdB : 10.0F * log10f(power) + corr;
+      }
+      if((rPtr=getRecord(fn + k, dop)) == NULL)
+	return(-1);
+      switch(dop->ddl.format) {
+      case DF_UINT8:
+	uPtr = (uint8_t *)rPtr;
+	for(n = 0; n <= HN; n++) {
+	  level = (fPtr[n] - bottom) * scale + 0.5F;
+	  if(level < 0.0F)
+	    level = 0.0F;
+	  else if(level > maxLevel)
+	    level = maxLevel;
+	  *(uPtr++) = (uint8_t)level;
+	}
+	break;
+      case DF_REAL64:
+	dPtr = (double *)rPtr;
+	for(n = 0; n <= HN; n++)
+	  *(dPtr++) = (double)fPtr[n];
+	break;
+      default:
+	memcpy(rPtr, (void *)fPtr, (size_t)(HN + 1) * sizeof(float));
+	break;
+      }
+    }
+  }
+  return(0);
+}
+
+/***********************************************************************
+* set up the mel filter bank (triangular filters equally spaced on the *
+* mel scale, stored sparsely as first bin, number of bins and weights),*
+* the DCT table and the history for the delta coefficients             *
+***********************************************************************/
+LOCAL int makeMelBank(SPECT_GD *gd)
+{
+  long   k, kLo, kHi, HN, numWgt;
+  int    i, j, M, pass;
+  double melLo, melStep, lo, mid, hi, mel, norm;
+
+  M = gd->numFilters;
+  HN = gd->numFFT / 2;
+  gd->melFirst = (long *)calloc((size_t)M, sizeof(long));
+  gd->melLen = (long *)calloc((size_t)M, sizeof(long));
+  gd->melLog = (double *)calloc((size_t)M, sizeof(double));
+  gd->dctTab = (double *)calloc((size_t)(gd->order * M), sizeof(double));
+  if(gd->melFirst == NULL || gd->melLen == NULL || gd->melLog == NULL ||\
+     gd->dctTab == NULL) {
+    setAsspMsg(AEG_ERR_MEM, "(SPECT: makeMelBank)");
+    return(-1);
+  }
+  melLo = hz2mel(gd->minF);
+  melStep = (hz2mel(gd->maxF) - melLo) / (double)(M + 1);
+  /* first pass: determine bin ranges; second pass: store weights */
+  for(pass = 0; pass < 2; pass++) {
+    for(numWgt = 0, j = 0; j < M; j++) {
+      lo = melLo + (double)j * melStep;
+      mid = lo + melStep;
+      hi = mid + melStep;
+      kLo = (long)floor(mel2hz(lo) / gd->binWidth) + 1;  /* exclusive */
+      kHi = (long)ceil(mel2hz(hi) / gd->binWidth) - 1;   /*   limits  */
+      if(kLo < 0)
+	kLo = 0;
+      if(kHi > HN)
+	kHi = HN;
+      if(pass == 0) {
+	if(kHi < kLo) {
+	  setAsspMsg(AEG_ERR_APPL,\
+		     "SPECT: empty mel filter; increase FFT length");
+	  return(-1);
+	}
+	gd->melFirst[j] = kLo;
+	gd->melLen[j] = kHi - kLo + 1;
+	numWgt += gd->melLen[j];
+      }
+      else {
+	for(k = kLo; k <= kHi; k++) {
+	  mel = hz2mel((double)k * gd->binWidth);
+	  if(mel <= mid)
+	    gd->melWgt[numWgt++] = (mel - lo) / melStep;
+	  else
+	    gd->melWgt[numWgt++] = (hi - mel) / melStep;
+	}
+      }
+    }
+    if(pass == 0) {
+      gd->melWgt = (double *)calloc((size_t)numWgt, sizeof(double));
+      if(gd->melWgt == NULL) {
+	setAsspMsg(AEG_ERR_MEM, "(SPECT: makeMelBank)");
+	return(-1);
+      }
+    }
+  }
+  norm = sqrt(2.0 / (double)M);
+  for(i = 0; i < gd->order; i++)
+    for(j = 0; j < M; j++)
+      gd->dctTab[i * M + j] = norm *\
+	cos(PI * (double)i * ((double)j + 0.5) / (double)M);
+  if(gd->numDeltas > 0) {
+    k = 2 * gd->numDeltas * MFCC_DELTA_WIN + 1;
+    gd->hist = (double *)calloc((size_t)(k * gd->order), sizeof(double));
+    if(gd->hist == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "(SPECT: makeMelBank)");
+      return(-1);
+    }
+  }
+  gd->histBeg = -1;
+  return(0);
+}
+
+/***********************************************************************
+* enter the static MFCCs in 'fftBuf' of "dop" in the history and store *
+* the frame whose regression window has just been completed, if any    *
+***********************************************************************/
+LOCAL int storeMFCC(long frameNr, DOBJ *dop)
+{
+  long      t;
+  SPECT_GD *gd=(SPECT_GD *)(dop->generic);
 
+  gd->histEnd = frameNr + 1;
+  memcpy((void *)histFrame(gd, frameNr), (void *)(gd->fftBuf),\
+	 (size_t)(gd->order) * sizeof(double));
+  t = frameNr - gd->numDeltas * MFCC_DELTA_WIN;
+  if(t < gd->histBeg)
+    return(0);
+  return(putMFCC(t, dop));
+}
+
+/***********************************************************************
+* store the frames still pending in the MFCC history of "dop" at the   *
+* end of the analysis; their regression windows are completed by       *
+* repeating the last frame                                             *
+***********************************************************************/
+LOCAL int flushMFCC(DOBJ *dop)
+{
+  long      t;
+  SPECT_GD *gd=(SPECT_GD *)(dop->generic);
+
+  if(gd->histBeg < 0)
+    return(0);
+  t = gd->histEnd - gd->numDeltas * MFCC_DELTA_WIN;
+  if(t < gd->histBeg)
+    t = gd->histBeg;
+  for( ; t < gd->histEnd; t++) {
+    if(putMFCC(t, dop) < 0)
+      return(-1);
+  }
   return(0);
 }
 
+/***********************************************************************
+* assemble the static MFCCs of frame "frameNr" and their derivatives   *
+* in 'fftBuf' of "dop" and store them                                  *
+***********************************************************************/
+LOCAL int putMFCC(long frameNr, DOBJ *dop)
+{
+  register int i;
+  int       K, n;
+  double   *out;
+  SPECT_GD *gd=(SPECT_GD *)(dop->generic);
+
+  K = gd->order;
+  out = gd->fftBuf;
+  memcpy((void *)out, (void *)histFrame(gd, frameNr),\
+	 (size_t)K * sizeof(double));
+  getDelta(gd, frameNr, &out[K]);
+  if(gd->numDeltas > 1) {             /* regression over the deltas */
+    for(i = 0; i < K; i++)
+      out[2*K+i] = 0.0;
+    for(n = 1; n <= MFCC_DELTA_WIN; n++) {       /* melLog as scratch */
+      getDelta(gd, frameNr + n, gd->melLog);
+      for(i = 0; i < K; i++)
+	out[2*K+i] += ((double)n * gd->melLog[i]);
+      getDelta(gd, frameNr - n, gd->melLog);
+      for(i = 0; i < K; i++)
+	out[2*K+i] -= ((double)n * gd->melLog[i]);
+    }
+    for(i = 0; i < K; i++)
+      out[2*K+i] /= MFCC_DELTA_NORM;
+  }
+  return(storeSPECT(frameNr, dop));
+}
+
+/***********************************************************************
+* return pointer to the static MFCCs of frame "frameNr" in the history *
+* buffer; frames outside the analysed range are replaced by the first  *
+* resp. last one                                                       *
+***********************************************************************/
+LOCAL double *histFrame(SPECT_GD *gd, long frameNr)
+{
+  long W;
+
+  if(frameNr >= gd->histEnd)
+    frameNr = gd->histEnd - 1;
+  if(frameNr < gd->histBeg)
+    frameNr = gd->histBeg;
+  W = 2 * gd->numDeltas * MFCC_DELTA_WIN + 1;
+  return(&(gd->hist[((frameNr - gd->histBeg) % W) * gd->order]));
+}
+
+/***********************************************************************
+* compute the regression coefficients (deltas) of the static MFCCs for *
+* frame "frameNr" and store them in "delta"                            *
+***********************************************************************/
+LOCAL void getDelta(SPECT_GD *gd, long frameNr, double *delta)
+{
+  register int i;
+  int     n;
+  double *next, *prev;
+
+  if(frameNr >= gd->histEnd)
+    frameNr = gd->histEnd - 1;
+  if(frameNr < gd->histBeg)
+    frameNr = gd->histBeg;
+  for(i = 0; i < gd->order; i++)
+    delta[i] = 0.0;
+  for(n = 1; n <= MFCC_DELTA_WIN; n++) {
+    next = histFrame(gd, frameNr + n);
+    prev = histFrame(gd, frameNr - n);
+    for(i = 0; i < gd->order; i++)
+      delta[i] += ((double)n * (next[i] - prev[i]));
+  }
+  for(i = 0; i < gd->order; i++)
+    delta[i] /= MFCC_DELTA_NORM;
+  return;
+}
+
 /***********************************************************************
 * In-place conversion of the output from 'rfft' in array pointed to by *
 * "c" with length given by "N" to inverse LP spectrum. "msqr" should   *
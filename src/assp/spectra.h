@@ -103,16 +103,30 @@ extern "C" {
 #define CEP_DEF_SIZE      0.0    /* window size defined by resolution */
 #define CEP_DEF_PREEMPH   0.0    /* no pre-emphasis */
 
+#define MFCC_DEF_SIZE     25.0   /* window size in ms */
+#define MFCC_DEF_SHIFT    10.0   /* frame shift in ms */
+#define MFCC_DEF_WINDOW  "HAMMING"
+#define MFCC_DEF_PREEMPH  -0.97  /* pre-emphasis */
+#define MFCC_DEF_CEPS     13     /* number of coefficients incl. c0 */
+#define MFCC_DEF_FILTERS  26     /* number of mel filters */
+#define MFCC_DEF_SUFFIX  ".mfc"  /* file name extension */
+
+#define SONA_DEF_RANGE    70.0   /* dB range of quantized levels */
+#define SONA_DEF_LEVELS   256    /* number of quantized levels */
+
 /*
- * option flags (some preliminary for sonagramm; not accessed in spectrum.c)
+ * option flags (COLOUR preliminary for sonagram; not accessed in spectra.c)
  */
 #define SPECT_OPT_NONE    0x000000
 #define SPECT_OPT_LIN_AMP 0x000001 /* linear amplitude (default dB) */
 #define SPECT_OPT_LIN_POW 0x000002 /* linear power */
 #define SPECT_OPT_DOUBLE  0x000004 /* keep output in double precision */
+#define SPECT_OPT_FLOAT   0x000008 /* single-precision block processing */
 #define SPECT_OPT_QUANT   0x000010 /* quantize spectral levels */
 #define SPECT_OPT_COLOUR  0x000020 /* colour- rather than grey-scale */
 #define LPS_OPT_DEEMPH    0x001000 /* de-emphasize LP smoothed spectrum */
+#define MFCC_OPT_DELTA    0x002000 /* append delta coefficients */
+#define MFCC_OPT_DDELTA   0x004000 /* append delta-delta coefficients too */
 
 /*
  * fixed parameters
@@ -120,6 +134,13 @@ extern "C" {
 #define SPECT_MIN_RES 0.01      /* lowest spectral resolution */
 #define CSS_MIN_LAGS  1         /* minimum number of lags (excl. 0) */
 #define SPECT_DFORMAT DF_REAL32 /* file data format */
+#define SONA_DFORMAT  DF_UINT8  /* file data format quantized levels */
+#define SONA_MAX_LEVELS 256     /* maximum number of quantized levels */
+#define SPECT_BLK_FRAMES 32     /* frames per block in DFT block mode */
+#define MFCC_DELTA_WIN 2        /* half width of delta regression window */
+#define MFCC_DELTA_NORM (MFCC_DELTA_WIN*(MFCC_DELTA_WIN+1)*\
+			 (2*MFCC_DELTA_WIN+1)/3.0) /* 2 * sum(n^2) */
+#define MFCC_MIN_POW 1.0E-20    /* floor for mel band energies */
 
 /*
  * parameters determining audio format capabilities of spectral analysis
@@ -153,11 +174,27 @@ typedef struct SPECT_analysis_parameters {
   double *wfc;        /* window function coefficients (allocated) */
   double *acf;        /* autocorrelation coefficients (allocated) */
   double  corrFac;    /* correction factor for spectral levels */
-  double  gain;       /* PRELIMINARY (for sonagram/section) */
-  double  range;      /* PRELIMINARY (for sonagram/section) */
+  double  gain;       /* in dB (for quantized levels) */
+  double  range;      /* in dB (for quantized levels) */
   double  maxF;       /* PRELIMINARY (for sonagram/section) */
   double  minF;       /* PRELIMINARY (for sonagram/section) */
-  int     numLevels;  /* PRELIMINARY (for sonagram) */
+  int     numLevels;  /* number of quantized levels */
+  double  topLevel;   /* dB level mapped to highest quantized level */
+  float  *block;      /* sample block for DFT block mode (allocated) */
+  float  *fltBuf;     /* single-precision FFT buffer (allocated) */
+  float  *fltWfc;     /* single-precision window function (allocated) */
+  int16_t *i16Frame;  /* frame of 16-bit samples for DFT (allocated) */
+  DOBJ   *smpCache;   /* converted samples for getSmpView() (allocated) */
+  int     numFilters; /* number of mel filters */
+  int     numDeltas;  /* 0, 1 (delta) or 2 (delta-delta) */
+  long   *melFirst;   /* first FFT bin of each mel filter (allocated) */
+  long   *melLen;     /* number of bins of each mel filter (allocated) */
+  double *melWgt;     /* filter weights, concatenated (allocated) */
+  double *melLog;     /* log mel band energies (allocated) */
+  double *dctTab;     /* DCT coefficients (allocated) */
+  double *hist;       /* ring of static MFCCs for deltas (allocated) */
+  long    histBeg;    /* first frame in delta history (< 0: none) */
+  long    histEnd;    /* frame after last one stored in history */
   int     order;      /* LP order / number of cepstral coefficients */
   int     channel;    /* selected channel */
   int     writeOpts;  /* options for writing data to file */
@@ -186,6 +223,7 @@ ASSP_EXTERN int   setDFTdefaults(AOPTS *aoPtr);
 ASSP_EXTERN int   setLPSdefaults(AOPTS *aoPtr);
 ASSP_EXTERN int   setCSSdefaults(AOPTS *aoPtr);
 ASSP_EXTERN int   setCEPdefaults(AOPTS *aoPtr);
+ASSP_EXTERN int   setMFCCdefaults(AOPTS *aoPtr);
 ASSP_EXTERN DOBJ *createSPECT(DOBJ *smpDOp, AOPTS *aoPtr);
 ASSP_EXTERN DOBJ *computeSPECT(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *spectDOp);
 ASSP_EXTERN void  freeSPECT_GD(void *ptr);
@@ -193,6 +231,7 @@ ASSP_EXTERN int   getFTSpectrum(DOBJ *dop);
 ASSP_EXTERN int   getLPSpectrum(DOBJ *dop);
 ASSP_EXTERN int   getCSSpectrum(DOBJ *dop);
 ASSP_EXTERN int   getCepstrum(DOBJ *dop);
+ASSP_EXTERN int   getMFCC(DOBJ *dop);
 
 #ifdef __cplusplus
 } /* closing brace for extern "C" */
@@ -45,6 +45,7 @@
 #include <string.h>    /* strncmp() strcpy() */
 #include <ctype.h>     /* islower() toupper() */
 #include <math.h>      /* sin() cos() exp() pow() ceil() floor() */
+#include <pthread.h>   /* pthread_mutex_lock() pthread_mutex_unlock() */
 
 #include <miscdefs.h>  /* LOCAL EOS PI EVEN() */
 #include <misc.h>      /* strxcmp() */
@@ -111,6 +112,29 @@ WFLIST wfAlphaList[] = { /* parametric window functions */
   {NULL, NULL, WF_NONE}
 };
 
+/*
+ * cache of window functions shared by the analyses (see 'getWF()')
+ */
+#define WF_CACHE_SIZE 16   /* maximum number of cached windows */
+#define WF_NO_ALPHA (-1.0) /* key of non-parametric windows */
+
+typedef struct window_cache_entry {
+  wfunc_e type;
+  double  alpha;
+  long    N;
+  int     flags;
+  long    refCount;        /* number of users of the coefficients */
+  unsigned long lastUse;   /* for replacement of unused entries */
+  double *wf;              /* coefficients; NULL if entry is empty */
+} WFCACHE;
+
+LOCAL WFCACHE wfCache[WF_CACHE_SIZE];
+LOCAL unsigned long wfCacheClock=0;
+LOCAL pthread_mutex_t wfCacheLock=PTHREAD_MUTEX_INITIALIZER;
+
+LOCAL double *cachedWF(wfunc_e type, double alpha, long N, int flags);
+LOCAL WFCACHE *findWF(wfunc_e type, double alpha, long N, int flags);
+
 /*DOC
 
 Function 'wfType'
@@ -291,7 +315,7 @@ DOC*/
 
 WFDATA *wfSpecs(wfunc_e type)
 {
-  static WFDATA specs;
+  static ASSP_TLS WFDATA specs;
   WFLIST *wPtr;
 
   wPtr = wfListEntry(wfLongList, NULL, NULL, type);
@@ -1090,20 +1114,103 @@ double *makeWF_A(wfunc_e type, double alpha, long N, int flags)
 
 /*DOC
 
+Function 'getWF'
+
+Returns a pointer to "N" window coefficients of the window function of 
+type "type" as computed by 'makeWF()' (see there for the settings of 
+"flags"). Unlike 'makeWF()', this function does not necessarily compute 
+the coefficients: they are taken from a cache if a window with the same 
+type, length and flags has been requested before. The coefficients are 
+therefore shared with other users (in other threads as well) and may 
+NOT be modified. They must be released by means of 'freeWF()'; windows 
+which are no longer used are kept in the cache for later requests.
+The function returns a NULL pointer under the same conditions as 
+'makeWF()'.
+
+DOC*/
+
+double *getWF(wfunc_e type, long N, int flags)
+{
+  return(cachedWF(type, WF_NO_ALPHA, N, flags));
+}
+
+/*DOC
+
+Function 'getWF_A'
+
+As 'getWF()' but for the parametric window function of type "type" 
+with parameter value "alpha" (see 'makeWF_A()').
+
+DOC*/
+
+double *getWF_A(wfunc_e type, double alpha, long N, int flags)
+{
+  if(alpha < 0.0) {
+    setAsspMsg(AEB_BAD_ARGS, "getWF_A: alpha < 0");
+    return(NULL);
+  }
+  return(cachedWF(type, alpha, N, flags));
+}
+
+/*DOC
+
 Function 'freeWF'
 
-Frees the memory allocated for window coefficients by "makeWF()".
+Frees the memory allocated for window coefficients by "makeWF()" or 
+releases the coefficients obtained by 'getWF()' or 'getWF_A()'.
 
 DOC*/
 
 void freeWF(double *w)
 {
-  if(w != NULL) free((void *)w);
+  int i;
+
+  if(w == NULL)
+    return;
+  pthread_mutex_lock(&wfCacheLock);
+  for(i = 0; i < WF_CACHE_SIZE; i++) {
+    if(wfCache[i].wf == w) {
+      if(wfCache[i].refCount > 0)
+	wfCache[i].refCount--;
+      pthread_mutex_unlock(&wfCacheLock);
+      return;
+    }
+  }
+  pthread_mutex_unlock(&wfCacheLock);
+  free((void *)w);                                   /* not from cache */
   return;
 }
 
 /*DOC
 
+Function 'clearWFcache'
+
+Frees all window coefficients in the cache of 'getWF()' which are 
+currently not in use. Returns the number of windows still in use.
+
+DOC*/
+
+int clearWFcache(void)
+{
+  int i, numUsed;
+
+  pthread_mutex_lock(&wfCacheLock);
+  for(numUsed = i = 0; i < WF_CACHE_SIZE; i++) {
+    if(wfCache[i].wf != NULL) {
+      if(wfCache[i].refCount > 0)
+	numUsed++;
+      else {
+	free((void *)(wfCache[i].wf));
+	wfCache[i].wf = NULL;
+      }
+    }
+  }
+  pthread_mutex_unlock(&wfCacheLock);
+  return(numUsed);
+}
+
+/*DOC
+
 Function 'mulSigWF'
 
 Performs an in-place multiplication of the signal in "s" with the "N" window 
@@ -1353,3 +1460,82 @@ double frameSize2bandwidth(long frameSize, wfunc_e type,\
   bandwidth = enbw * sampFreq / (double)frameSize;
   return(bandwidth);
 }
+
+/* ======================= private  functions ======================= */
+
+/***********************************************************************
+* return window coefficients from the cache; compute and enter them if *
+* not yet available (alpha equal to WF_NO_ALPHA: non-parametric window)*
+***********************************************************************/
+LOCAL double *cachedWF(wfunc_e type, double alpha, long N, int flags)
+{
+  int      i;
+  double  *wf;
+  WFCACHE *ePtr, *slot;
+
+  pthread_mutex_lock(&wfCacheLock);
+  ePtr = findWF(type, alpha, N, flags);
+  if(ePtr != NULL) {
+    ePtr->refCount++;
+    ePtr->lastUse = ++wfCacheClock;
+    pthread_mutex_unlock(&wfCacheLock);
+    return(ePtr->wf);
+  }
+  pthread_mutex_unlock(&wfCacheLock);
+  /* don't block other threads while computing (Bessel functions etc.) */
+  if(alpha == WF_NO_ALPHA)
+    wf = makeWF(type, N, flags);
+  else
+    wf = makeWF_A(type, alpha, N, flags);
+  if(wf == NULL)
+    return(NULL);
+  pthread_mutex_lock(&wfCacheLock);
+  ePtr = findWF(type, alpha, N, flags);
+  if(ePtr != NULL) {                      /* entered by another thread */
+    ePtr->refCount++;
+    ePtr->lastUse = ++wfCacheClock;
+    pthread_mutex_unlock(&wfCacheLock);
+    free((void *)wf);
+    return(ePtr->wf);
+  }
+  slot = NULL;         /* empty entry or least recently used free one */
+  for(i = 0; i < WF_CACHE_SIZE; i++) {
+    ePtr = &wfCache[i];
+    if(ePtr->wf == NULL) {
+      slot = ePtr;
+      break;
+    }
+    if(ePtr->refCount <= 0 &&\
+       (slot == NULL || ePtr->lastUse < slot->lastUse))
+      slot = ePtr;
+  }
+  if(slot != NULL) {      /* otherwise caller gets a private copy only */
+    if(slot->wf != NULL)
+      free((void *)(slot->wf));
+    slot->type = type;
+    slot->alpha = alpha;
+    slot->N = N;
+    slot->flags = flags;
+    slot->refCount = 1;
+    slot->lastUse = ++wfCacheClock;
+    slot->wf = wf;
+  }
+  pthread_mutex_unlock(&wfCacheLock);
+  return(wf);
+}
+
+/***********************************************************************
+* look up window in the cache; the cache must be locked by the caller  *
+***********************************************************************/
+LOCAL WFCACHE *findWF(wfunc_e type, double alpha, long N, int flags)
+{
+  int i;
+
+  for(i = 0; i < WF_CACHE_SIZE; i++) {
+    if(wfCache[i].wf != NULL && wfCache[i].type == type &&\
+       wfCache[i].alpha == alpha && wfCache[i].N == N &&\
+       wfCache[i].flags == flags)
+      return(&wfCache[i]);
+  }
+  return(NULL);
+}
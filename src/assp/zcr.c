@@ -43,19 +43,23 @@
 #include <asspana.h>   /* AOPTS anaTiming() (includes zcr.h) */
 #include <asspdsp.h>   /* getZCR() */
 #include <asspfio.h>   /* asspFFlush() */
-#include <dataobj.h>   /* DOBJ getSmpCaps() getSmpFrame() */
+#include <dataobj.h>   /* DOBJ getSmpCaps() getSmpFrame() getSmpView() */
 #include <headers.h>   /* KDTAB */
 #include <aucheck.h>   /* checkSound() */
+#include <asspprof.h>  /* PROF_... */
 
 /*
  * local global variables and arrays
  */
 LOCAL double *frame=NULL; /* frame buffer (allocated) */
+LOCAL float  *fltFrame=NULL; /* single-precision frame (allocated) */
+LOCAL int16_t *i16Frame=NULL; /* frame of 16-bit samples (allocated) */
+LOCAL DOBJ   *smpCache=NULL; /* converted samples for getSmpView() */
 
 /*
  * prototypes of private functions
  */
-LOCAL int  setGlobals(DOBJ *dop);
+LOCAL int  setGlobals(DOBJ *dop, int I16_IN);
 LOCAL void freeGlobals(void);
 LOCAL int  storeZCR(float *vals, long frameNr, DOBJ *dop);
 
@@ -224,11 +228,13 @@ DOC*/
 
 DOBJ *computeZCR(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *zcrDOp)
 {
-  int     FILE_IN, FILE_OUT, CREATED;
+  int     FILE_IN, FILE_OUT, CREATED, I16_IN;
   int     err, cn, numChans;
   long    fn, frameSize, frameShift, numSamples;
   float   zxRate[ZCR_O_CHANS];
+  double *dPtr;
   ZCR_GD *gd;
+  PROF_DECL(t)
 
   if(smpDOp == NULL || (aoPtr == NULL && zcrDOp == NULL)) {
     setAsspMsg(AEB_BAD_ARGS, "computeZCR");
@@ -266,7 +272,9 @@ DOBJ *computeZCR(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *zcrDOp)
   else
     gd->writeOpts = AFW_KEEP;
 
-  if(setGlobals(zcrDOp) < 0) {
+  I16_IN = (smpDOp->ddl.format == DF_INT16 &&\
+	    !(gd->options & ZCR_OPT_FLOAT));
+  if(setGlobals(zcrDOp, I16_IN) < 0) {
     if(CREATED)
       freeDObj(zcrDOp);
     return(NULL);
@@ -287,11 +295,23 @@ DOBJ *computeZCR(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *zcrDOp)
     }
   }
   numChans = (int)(zcrDOp->ddl.numFields);
+  if(numChans == 1 && !I16_IN && !(gd->options & ZCR_OPT_FLOAT)) {
+    smpCache = allocSmpCache(smpDOp, frameSize, frameShift, ZCR_HEAD,\
+			     ZCR_TAIL, ZCR_PFORMAT);
+    if(smpCache == NULL) {
+      freeGlobals();
+      if(CREATED)
+	freeDObj(zcrDOp);
+      return(NULL);
+    }
+  }
   if(TRACE['A']) {
     fprintf(traceFP, "Analysis parameters\n");
     fprintf(traceFP, "  sample rate = %.1f Hz\n", zcrDOp->sampFreq);
     fprintf(traceFP, "  window size = %ld samples\n", frameSize);
     fprintf(traceFP, "  window shift = %ld samples\n", frameShift);
+    fprintf(traceFP, "  processing precision = %s\n",\
+	    (gd->options & ZCR_OPT_FLOAT) ? "single":"double");
     if(gd->channel < 1)
       fprintf(traceFP, "  number of channels = %d\n", numChans);
     else
@@ -302,9 +322,44 @@ DOBJ *computeZCR(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *zcrDOp)
 	    FILE_IN ? "file" : "memory", FILE_OUT ? "file" : "memory");
   }
   /* loop over frames */
+  PROF_START(t);
   for(err = 0, fn = gd->begFrameNr; fn < gd->endFrameNr; fn++) {
     /* loop over channels */
     for(cn = 0; cn < numChans; cn++) {
+      if(gd->options & ZCR_OPT_FLOAT) {
+	if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, ZCR_HEAD,\
+			    ZCR_TAIL, (gd->channel > 0) ? gd->channel : cn+1,\
+			    fltFrame, DF_REAL32)) < 0)
+	  break;
+	PROF_LAP(t, PRF_FRAME);
+	zxRate[cn] = (float)getZCRf(fltFrame, numSamples, smpDOp->sampFreq);
+	PROF_LAP(t, PRF_TRANSFORM);
+	continue;
+      }
+      if(smpCache != NULL) {        /* single channel: view, no copy */
+	dPtr = (double *)getSmpView(smpDOp, fn, frameSize, frameShift,\
+				    ZCR_HEAD, ZCR_TAIL, gd->channel,\
+				    smpCache);
+	if(dPtr == NULL) {
+	  err = -1;
+	  break;
+	}
+	PROF_LAP(t, PRF_FRAME);
+	zxRate[cn] = (float)getZCR(dPtr, numSamples, smpDOp->sampFreq);
+	PROF_LAP(t, PRF_TRANSFORM);
+	continue;
+      }
+      if(I16_IN) {        /* crossings detected on the 16-bit samples */
+	if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, ZCR_HEAD,\
+			    ZCR_TAIL, (gd->channel > 0) ? gd->channel : cn+1,\
+			    i16Frame, DF_INT16)) < 0)
+	  break;
+	PROF_LAP(t, PRF_FRAME);
+	zxRate[cn] = (float)getZCRI16(i16Frame, numSamples,\
+				      smpDOp->sampFreq);
+	PROF_LAP(t, PRF_TRANSFORM);
+	continue;
+      }
       if(gd->channel > 0) { /* single channel */
         if((err=getSmpFrame(smpDOp, fn, frameSize, frameShift, ZCR_HEAD,\
 			    ZCR_TAIL, gd->channel, frame, ZCR_PFORMAT)) < 0)
@@ -315,10 +370,14 @@ DOBJ *computeZCR(DOBJ *smpDOp, AOPTS *aoPtr, DOBJ *zcrDOp)
 			    ZCR_TAIL, cn+1, frame, ZCR_PFORMAT)) < 0)
 	  break;
       }
+      PROF_LAP(t, PRF_FRAME);
       zxRate[cn] = (float)getZCR(frame, numSamples, smpDOp->sampFreq);
+      PROF_LAP(t, PRF_TRANSFORM);
     } /* END loop over channels */
     if(err < 0) break;
     if((err=storeZCR(zxRate, fn, zcrDOp)) < 0) break;
+    PROF_LAP(t, PRF_STORE);
+    PROF_COUNT(PRC_FRAMES, 1);
   } /* END loop over frames */
   if(err >= 0 && FILE_OUT)
     err = asspFFlush(zcrDOp, gd->writeOpts);
@@ -471,16 +530,36 @@ void freeZCR_GD(void *generic)
 /* ======================= private  functions ======================= */
 
 /***********************************************************************
-* allocate memory for the frame buffer                                 *
+* allocate memory for the frame buffer (in single precision with       *
+* option ZCR_OPT_FLOAT)                                                *
 ***********************************************************************/
-LOCAL int setGlobals(DOBJ *dop)
+LOCAL int setGlobals(DOBJ *dop, int I16_IN)
 {
   size_t  bufSize;
   ZCR_GD *gd;
 
   frame = NULL;
+  fltFrame = NULL;
+  i16Frame = NULL;
+  smpCache = NULL;
   gd = (ZCR_GD *)(dop->generic);
   bufSize = (size_t)(gd->frameSize + ZCR_HEAD + ZCR_TAIL);
+  if(gd->options & ZCR_OPT_FLOAT) {
+    fltFrame = (float *)calloc(bufSize, sizeof(float));
+    if(fltFrame == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "ZCR: setGlobals");
+      return(-1);
+    }
+    return(0);
+  }
+  if(I16_IN) { /* no conversion: processed by 'getZCRI16' */
+    i16Frame = (int16_t *)calloc(bufSize, sizeof(int16_t));
+    if(i16Frame == NULL) {
+      setAsspMsg(AEG_ERR_MEM, "ZCR: setGlobals");
+      return(-1);
+    }
+    return(0);
+  }
   frame = (double *)calloc(bufSize, sizeof(double));
   if(frame == NULL) {
     setAsspMsg(AEG_ERR_MEM, "ZCR: setGlobals");
@@ -498,6 +577,15 @@ LOCAL void freeGlobals(void)
     free((void *)frame);
     frame = NULL;
   }
+  if(fltFrame != NULL) {
+    free((void *)fltFrame);
+    fltFrame = NULL;
+  }
+  if(i16Frame != NULL) {
+    free((void *)i16Frame);
+    i16Frame = NULL;
+  }
+  smpCache = freeDObj(smpCache);
   return;
 }
 
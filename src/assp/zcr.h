@@ -97,6 +97,7 @@ extern "C" {
  */
 #define ZCR_OPT_NONE  0x0000
 /* #define ZCR_OPT_RM_DC 0x0001  problematic */
+#define ZCR_OPT_FLOAT 0x0002 /* single-precision processing */
 
 /*
  * fixed parameters
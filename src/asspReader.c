@@ -0,0 +1,215 @@
+#include "wrassp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>               /* ceil */
+#include <dataobj.h>
+#include <asspfio.h>
+#include <asspmess.h>
+
+/*
+ * Chunked reading of long signal/parameter files (asspReader() in R).
+ * The file is opened once and its header parsed once; each call of
+ * readerNext_() loads the next records into a data buffer which is
+ * reused as long as the chunk size does not change, so memory use does
+ * not depend on the length of the file. The file is opened with
+ * AFO_ASYNC so that the next chunk is read ahead in the background.
+ * The reader lives in an external pointer and is closed by
+ * readerClose_() or, at the latest, by the garbage collector.
+ */
+
+typedef struct asspReader {
+    DOBJ           *dop;
+    char           *path;       /* freed on close (not by freeDObj) */
+    long            nextRec;    /* absolute number of next record */
+} ASSP_READER;
+
+static void
+closeReader(ASSP_READER * rdr)
+{
+    if (rdr == NULL)
+        return;
+    if (rdr->dop != NULL)
+        asspFClose(rdr->dop, AFC_FREE);
+    free(rdr->path);
+    free(rdr);
+}
+
+static void
+readerFinalizer(SEXP ptr)
+{
+    closeReader((ASSP_READER *) R_ExternalPtrAddr(ptr));
+    R_ClearExternalPtr(ptr);
+}
+
+/*
+ * This function returns the reader in "ptr" or raises an error if
+ * "ptr" is not a reader or has been closed.
+ */
+static ASSP_READER *
+getReader(SEXP ptr)
+{
+    ASSP_READER    *rdr;
+
+    if (TYPEOF(ptr) != EXTPTRSXP
+        || R_ExternalPtrTag(ptr) != install("AsspReader"))
+        error("Argument is not an AsspReader.");
+    rdr = (ASSP_READER *) R_ExternalPtrAddr(ptr);
+    if (rdr == NULL)
+        error("The AsspReader has been closed.");
+    return rdr;
+}
+
+/*
+ * This function opens the file "fname" for chunked reading and
+ * returns the reader as an external pointer.
+ */
+SEXP
+readerOpen_(SEXP fname)
+{
+    SEXP            ptr;
+    ASSP_READER    *rdr;
+    const char     *name;
+
+    if (!isString(fname) || length(fname) != 1)
+        error("fname must be a single file name.");
+    name = translateChar(STRING_ELT(fname, 0));
+    headerCacheOption();
+    rdr = (ASSP_READER *) calloc(1, sizeof(ASSP_READER));
+    if (rdr == NULL)
+        error("Out of memory.");
+    rdr->path = strdup(name);
+    if (rdr->path == NULL) {
+        free(rdr);
+        error("Out of memory.");
+    }
+    rdr->dop = asspFOpen(rdr->path, AFO_READ | AFO_ASYNC, (DOBJ *) NULL);
+    if (rdr->dop == NULL) {
+        free(rdr->path);
+        free(rdr);
+        error("%s (%s)", getAsspMsg(asspMsgNum), name);
+    }
+    if (rdr->dop->fileData != FDF_BIN || rdr->dop->recordSize < 1) {
+        closeReader(rdr);
+        error("Chunked reading requires binary data (%s).", name);
+    }
+    rdr->nextRec = rdr->dop->startRecord;
+
+    PROTECT(ptr = R_MakeExternalPtr(rdr, install("AsspReader"),
+                                    R_NilValue));
+    R_RegisterCFinalizerEx(ptr, readerFinalizer, TRUE);
+    UNPROTECT(1);
+    return ptr;
+}
+
+/*
+ * This function returns the next "n" records (fewer at the end of the
+ * file) as an AsspDataObj, or NULL if all records have been read.
+ */
+SEXP
+readerNext_(SEXP ptr, SEXP n)
+{
+    ASSP_READER    *rdr;
+    DOBJ           *dop;
+    long            numRecs,
+                    eofRec;
+    SEXP            ans;
+
+    rdr = getReader(ptr);
+    dop = rdr->dop;
+    numRecs = (long) asReal(n);
+    if (!R_FINITE(asReal(n)) || numRecs < 1)
+        error("n must be a positive number of records.");
+    eofRec = dop->startRecord + dop->numRecords;
+    if (rdr->nextRec >= eofRec)
+        return R_NilValue;
+
+    if (dop->dataBuffer != NULL && dop->maxBufRecs != numRecs)
+        freeDataBuf(dop);
+    if (dop->dataBuffer == NULL && allocDataBuf(dop, numRecs) == NULL)
+        error("%s", getAsspMsg(asspMsgNum));
+    dop->bufStartRec = rdr->nextRec;
+    if (asspFFill(dop) < 0)
+        error("%s (%s)", getAsspMsg(asspMsgNum), rdr->path);
+    rdr->nextRec += dop->bufNumRecs;
+    PROTECT(ans = dobj2AsspDataObj(dop));
+    UNPROTECT(1);
+    return ans;
+}
+
+/*
+ * This function positions the reader at "pos", given in seconds, or
+ * as a record number (counted from 1 as in the startRecord attribute
+ * of an AsspDataObj) if "samples" is TRUE. No data are read.
+ * Returns the record number of the new position.
+ */
+SEXP
+readerSeek_(SEXP ptr, SEXP pos, SEXP samples)
+{
+    ASSP_READER    *rdr;
+    DOBJ           *dop;
+    double          p;
+    long            rec;
+
+    rdr = getReader(ptr);
+    dop = rdr->dop;
+    p = asReal(pos);
+    if (!R_FINITE(p))
+        error("Invalid position.");
+    if (asLogical(samples) == TRUE)
+        rec = (long) p - 1;
+    else
+        rec = (long) ceil(p * dop->dataRate) + dop->startRecord;
+    if (rec < dop->startRecord)
+        rec = dop->startRecord;
+    if (rec > dop->startRecord + dop->numRecords)
+        rec = dop->startRecord + dop->numRecords;
+    rdr->nextRec = rec;
+    return ScalarReal((double) (rec + 1));
+}
+
+/*
+ * This function closes the reader.
+ */
+SEXP
+readerClose_(SEXP ptr)
+{
+    if (TYPEOF(ptr) == EXTPTRSXP
+        && R_ExternalPtrTag(ptr) == install("AsspReader")) {
+        closeReader((ASSP_READER *) R_ExternalPtrAddr(ptr));
+        R_ClearExternalPtr(ptr);
+    }
+    return R_NilValue;
+}
+
+/*
+ * This function returns a list with the file path, sample rate, number
+ * of records and the record number of the next record of the reader
+ * (NULL if it has been closed).
+ */
+SEXP
+readerInfo_(SEXP ptr)
+{
+    ASSP_READER    *rdr;
+    SEXP            ans,
+                    names;
+
+    if (TYPEOF(ptr) != EXTPTRSXP
+        || R_ExternalPtrTag(ptr) != install("AsspReader"))
+        error("Argument is not an AsspReader.");
+    rdr = (ASSP_READER *) R_ExternalPtrAddr(ptr);
+    if (rdr == NULL)
+        return R_NilValue;
+    PROTECT(ans = allocVector(VECSXP, 4));
+    SET_VECTOR_ELT(ans, 0, mkString(rdr->path));
+    SET_VECTOR_ELT(ans, 1, ScalarReal(rdr->dop->dataRate));
+    SET_VECTOR_ELT(ans, 2, ScalarReal((double) rdr->dop->numRecords));
+    SET_VECTOR_ELT(ans, 3, ScalarReal((double) (rdr->nextRec + 1)));
+    PROTECT(names = allocVector(STRSXP, 4));
+    SET_STRING_ELT(names, 0, mkChar("filePath"));
+    SET_STRING_ELT(names, 1, mkChar("sampleRate"));
+    SET_STRING_ELT(names, 2, mkChar("numRecords"));
+    SET_STRING_ELT(names, 3, mkChar("nextRecord"));
+    setAttrib(ans, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return ans;
+}
@@ -0,0 +1,36 @@
+#include "wrassp.h"
+#include <blockio.h>            /* BLK_MAX_BYTES */
+
+/*
+ * Block-compressed SSFF output (see assp/blockio.c). It is switched on
+ * by setting the R option 'wrassp.compressSSFF' to TRUE (or to the
+ * number of records per block). Such files are read transparently by
+ * wrassp but not by programs using an older version of libassp.
+ */
+
+/*
+ * This function returns the number of records per block requested by
+ * the option 'wrassp.compressSSFF' (0 for the default block size of
+ * TRUE), or -1 if SSFF output is not to be compressed. Numbers beyond
+ * BLK_MAX_BYTES (the limit for records of one byte) raise an error.
+ */
+long
+compressOption(void)
+{
+    SEXP            el;
+
+    el = GetOption1(install("wrassp.compressSSFF"));
+    if (TYPEOF(el) == LGLSXP && length(el) >= 1
+        && LOGICAL(el)[0] == TRUE)
+        return 0;
+    if ((TYPEOF(el) == REALSXP || TYPEOF(el) == INTSXP)
+        && length(el) >= 1) {
+        double          n = asReal(el);
+        if (R_FINITE(n) && n > BLK_MAX_BYTES)
+            error("wrassp.compressSSFF: at most %ld records per block.",
+                  BLK_MAX_BYTES);
+        if (R_FINITE(n) && n >= 1)
+            return (long) n;
+    }
+    return -1;
+}
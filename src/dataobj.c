@@ -4,6 +4,7 @@
 #include <asspfio.h>
 #include <asspmess.h>
 #include <headers.h>            /* KDTAB */
+#include <blockio.h>            /* blkEnable() */
 
 /*
  * This was the original reading function that did not allow for
@@ -90,6 +91,7 @@ getDObj2(SEXP args)
     /*
      * open the file
      */
+    headerCacheOption();
     data = asspFOpen(fName, AFO_READ, (DOBJ *) NULL);
     if (data == NULL)
         error("%s (%s)", getAsspMsg(asspMsgNum), fName);
@@ -462,7 +464,7 @@ getDObjTrackData(DOBJ * data, DDESC * desc)
             {
                 i8Ptr = (int8_t *) & bPtr[desc->offset];
                 for (n = 0; n < desc->numFields; n++) {
-                    Ians[m + n * data->bufNumRecs] = (int) u8Ptr[n];
+                    Ians[m + n * data->bufNumRecs] = (int) i8Ptr[n];
                 }
             }
             break;
@@ -860,6 +862,12 @@ sexp2dobj(SEXP rdobj)
 SEXP writeDObj_(SEXP data, SEXP fname)
 {
     DOBJ           *dop = sexp2dobj(data);
+    long            blockRecs = compressOption();
+    if (blockRecs >= 0 && dop->fileFormat == FF_SSFF
+        && blkEnable(dop, blockRecs) < 0) {
+        freeDObj(dop);
+        error("%s", getAsspMsg(asspMsgNum));
+    }
     dop = asspFOpen(strdup(CHAR(STRING_ELT(fname, 0))), AFO_WRITE, dop);
     if (dop == NULL) {
         freeDObj(dop);
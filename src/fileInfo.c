@@ -0,0 +1,221 @@
+#include "wrassp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <asspfio.h>
+#include <asspmess.h>
+
+/*
+ * Header-only metadata query for many files (asspFileInfo() in R).
+ * The files are opened with asspFOpen(), which reads their headers but
+ * no data, by up to 'numThreads' threads; the results are converted to
+ * R vectors afterwards by the calling thread.
+ */
+
+typedef struct fileInfoJob {
+    pthread_mutex_t lock;
+    int             next;       /* index of the next file to open */
+    int             numFiles;
+    char          **paths;
+    DOBJ          **dobjs;      /* header of each file or NULL */
+    char          **messages;   /* error message of each failed open */
+} FILE_INFO_JOB;
+
+static void    *
+fileInfoWorker(void *arg)
+{
+    FILE_INFO_JOB  *job = (FILE_INFO_JOB *) arg;
+    DOBJ           *dop;
+    int             i;
+
+    for (;;) {
+        pthread_mutex_lock(&(job->lock));
+        i = job->next++;
+        pthread_mutex_unlock(&(job->lock));
+        if (i >= job->numFiles)
+            break;
+        dop = asspFOpen(job->paths[i], AFO_READ, (DOBJ *) NULL);
+        if (dop == NULL) {
+            job->messages[i] = strdup(getAsspMsg(asspMsgNum));
+            continue;
+        }
+        asspFClose(dop, AFC_KEEP);
+        job->dobjs[i] = dop;
+    }
+    return NULL;
+}
+
+/*
+ * This function returns the header information of the files "files"
+ * as a named list of vectors, one element per file: fileFormat and
+ * dataFormat (codes), sampleRate, origFreq, startTime, startRecord,
+ * numRecords, numFields (over all tracks), tracks and trackFormats
+ * (comma-separated) and error (NA if the header could be read).
+ */
+SEXP
+fileInfo_(SEXP files, SEXP threads)
+{
+    SEXP            ans,
+                    names,
+                    fileFormat,
+                    dataFormat,
+                    sampleRate,
+                    origFreq,
+                    startTime,
+                    startRecord,
+                    numRecords,
+                    numFields,
+                    tracks,
+                    trackFormats,
+                    errors;
+    FILE_INFO_JOB   job;
+    pthread_t      *tid;
+    DOBJ           *dop;
+    DDESC          *desc;
+    char           *buf;
+    const char     *str;
+    size_t          len;
+    int             i,
+                    n,
+                    fields,
+                    numThreads;
+    static const char *colNames[] = {
+        "fileFormat", "dataFormat", "sampleRate", "origFreq",
+        "startTime", "startRecord", "numRecords", "numFields",
+        "tracks", "trackFormats", "error"
+    };
+
+    if (!isString(files))
+        error("files must be a character vector.");
+    numThreads = asInteger(threads);
+    if (numThreads == NA_INTEGER || numThreads < 1)
+        error("numThreads must be a positive integer.");
+    headerCacheOption();
+
+    job.numFiles = length(files);
+    job.next = 0;
+    job.paths = (char **) R_alloc(job.numFiles + 1, sizeof(char *));
+    job.dobjs = (DOBJ **) R_alloc(job.numFiles + 1, sizeof(DOBJ *));
+    job.messages = (char **) R_alloc(job.numFiles + 1, sizeof(char *));
+    for (i = 0; i < job.numFiles; i++) {
+        str = translateChar(STRING_ELT(files, i));
+        job.paths[i] = R_alloc(strlen(str) + 1, sizeof(char));
+        strcpy(job.paths[i], str);
+        job.dobjs[i] = NULL;
+        job.messages[i] = NULL;
+    }
+
+    /*
+     * open the files in parallel; the calling thread takes part
+     */
+    if (numThreads > job.numFiles)
+        numThreads = job.numFiles;
+    pthread_mutex_init(&(job.lock), NULL);
+    tid = NULL;
+    n = 0;
+    if (numThreads > 1) {
+        tid = (pthread_t *) R_alloc(numThreads - 1, sizeof(pthread_t));
+        for (n = 0; n < numThreads - 1; n++)
+            if (pthread_create(&tid[n], NULL, fileInfoWorker,
+                               (void *) &job) != 0)
+                break;
+    }
+    fileInfoWorker((void *) &job);
+    for (i = 0; i < n; i++)
+        pthread_join(tid[i], NULL);
+    pthread_mutex_destroy(&(job.lock));
+
+    /*
+     * convert to R
+     */
+    n = job.numFiles;
+    PROTECT(fileFormat = allocVector(INTSXP, n));
+    PROTECT(dataFormat = allocVector(INTSXP, n));
+    PROTECT(sampleRate = allocVector(REALSXP, n));
+    PROTECT(origFreq = allocVector(REALSXP, n));
+    PROTECT(startTime = allocVector(REALSXP, n));
+    PROTECT(startRecord = allocVector(REALSXP, n));
+    PROTECT(numRecords = allocVector(REALSXP, n));
+    PROTECT(numFields = allocVector(INTSXP, n));
+    PROTECT(tracks = allocVector(STRSXP, n));
+    PROTECT(trackFormats = allocVector(STRSXP, n));
+    PROTECT(errors = allocVector(STRSXP, n));
+    for (i = 0; i < n; i++) {
+        dop = job.dobjs[i];
+        if (dop == NULL) {
+            INTEGER(fileFormat)[i] = NA_INTEGER;
+            INTEGER(dataFormat)[i] = NA_INTEGER;
+            REAL(sampleRate)[i] = NA_REAL;
+            REAL(origFreq)[i] = NA_REAL;
+            REAL(startTime)[i] = NA_REAL;
+            REAL(startRecord)[i] = NA_REAL;
+            REAL(numRecords)[i] = NA_REAL;
+            INTEGER(numFields)[i] = NA_INTEGER;
+            SET_STRING_ELT(tracks, i, NA_STRING);
+            SET_STRING_ELT(trackFormats, i, NA_STRING);
+            SET_STRING_ELT(errors, i,
+                           mkChar(job.messages[i] !=
+                                  NULL ? job.messages[i] : ""));
+            free(job.messages[i]);
+            continue;
+        }
+        INTEGER(fileFormat)[i] = (int) dop->fileFormat;
+        INTEGER(dataFormat)[i] = (int) dop->fileData;
+        REAL(sampleRate)[i] = dop->dataRate;
+        REAL(origFreq)[i] =
+            (dop->fileFormat == FF_SSFF) ? dop->sampFreq : 0.0;
+        REAL(startTime)[i] = dop->Start_Time;
+        REAL(startRecord)[i] = (double) (dop->startRecord + 1);
+        REAL(numRecords)[i] = (double) dop->numRecords;
+
+        /*
+         * the tracks: identifiers and formats as comma-separated lists
+         */
+        len = 1;
+        fields = 0;
+        for (desc = &(dop->ddl); desc != NULL; desc = desc->next) {
+            len += (desc->ident != NULL ? strlen(desc->ident) : 0) + 8;
+            fields += (int) desc->numFields;
+        }
+        INTEGER(numFields)[i] = fields;
+        buf = R_alloc(len, sizeof(char));
+        buf[0] = '\0';
+        for (desc = &(dop->ddl); desc != NULL; desc = desc->next) {
+            if (desc != &(dop->ddl))
+                strcat(buf, ",");
+            if (desc->ident != NULL)
+                strcat(buf, desc->ident);
+        }
+        SET_STRING_ELT(tracks, i, mkChar(buf));
+        buf[0] = '\0';
+        for (desc = &(dop->ddl); desc != NULL; desc = desc->next) {
+            if (desc != &(dop->ddl))
+                strcat(buf, ",");
+            str = asspDF2ssffString(desc->format);
+            if (str != NULL)
+                strcat(buf, str);
+        }
+        SET_STRING_ELT(trackFormats, i, mkChar(buf));
+        SET_STRING_ELT(errors, i, NA_STRING);
+        freeDObj(dop);
+    }
+
+    PROTECT(ans = allocVector(VECSXP, 11));
+    SET_VECTOR_ELT(ans, 0, fileFormat);
+    SET_VECTOR_ELT(ans, 1, dataFormat);
+    SET_VECTOR_ELT(ans, 2, sampleRate);
+    SET_VECTOR_ELT(ans, 3, origFreq);
+    SET_VECTOR_ELT(ans, 4, startTime);
+    SET_VECTOR_ELT(ans, 5, startRecord);
+    SET_VECTOR_ELT(ans, 6, numRecords);
+    SET_VECTOR_ELT(ans, 7, numFields);
+    SET_VECTOR_ELT(ans, 8, tracks);
+    SET_VECTOR_ELT(ans, 9, trackFormats);
+    SET_VECTOR_ELT(ans, 10, errors);
+    PROTECT(names = allocVector(STRSXP, 11));
+    for (i = 0; i < 11; i++)
+        SET_STRING_ELT(names, i, mkChar(colNames[i]));
+    setAttrib(ans, R_NamesSymbol, names);
+    UNPROTECT(13);
+    return ans;
+}
@@ -0,0 +1,28 @@
+#include "wrassp.h"
+#include <flacdec.h>
+
+/*
+ * FLAC input is decoded by libassp (see assp/flacdec.c). To find the
+ * frame holding a given sample in a file without seek table, the
+ * decoder bisects the file down to a span of FLAC_SCAN_BYTES bytes,
+ * unless the sample is within FLAC_NEAR_BLOCKS blocks of a known frame.
+ */
+
+/*
+ * This function sets these limits to "numBytes" and "numBlocks"
+ * (negative values restore the defaults). It only serves the tests,
+ * which can thus cover the bisection with a short file.
+ */
+SEXP
+flacSearchLimits_(SEXP numBytes, SEXP numBlocks)
+{
+    double          b,
+                    n;
+
+    b = asReal(numBytes);
+    n = asReal(numBlocks);
+    if (!R_FINITE(b) || !R_FINITE(n))
+        error("numBytes and numBlocks must be numbers.");
+    flacSearchLimits((long) b, (long) n);
+    return R_NilValue;
+}
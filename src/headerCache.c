@@ -0,0 +1,38 @@
+#include "wrassp.h"
+#include <asspmess.h>
+#include <hdrcache.h>
+
+/*
+ * In-process cache of parsed file headers (see assp/hdrcache.c). It is
+ * switched on by setting the R option 'wrassp.headerCache' to TRUE (or
+ * to the number of slots) and saves the format detection and header
+ * parsing when the same files are opened again, e.g. by several
+ * analyses and read.AsspDataObj(). Files are identified by path, size
+ * and modification time.
+ */
+#define HEADER_CACHE_SLOTS 4096 /* number of slots for TRUE */
+
+/*
+ * This function sizes the header cache according to the option
+ * 'wrassp.headerCache'; the cache is switched off (and emptied) if the
+ * option is unset, FALSE or not a positive number.
+ */
+void
+headerCacheOption(void)
+{
+    SEXP            el;
+    long            numSlots = 0;
+
+    el = GetOption1(install("wrassp.headerCache"));
+    if (TYPEOF(el) == LGLSXP && length(el) >= 1
+        && LOGICAL(el)[0] == TRUE)
+        numSlots = HEADER_CACHE_SLOTS;
+    else if ((TYPEOF(el) == REALSXP || TYPEOF(el) == INTSXP)
+             && length(el) >= 1) {
+        double          n = asReal(el);
+        if (R_FINITE(n) && n >= 1)
+            numSlots = (long) n;
+    }
+    if (hdrCacheSize(numSlots) < 0)
+        warning("%s", getAsspMsg(asspMsgNum));
+}
@@ -12,6 +12,8 @@
 #include <filter.h>
 #include <ksv.h>
 #include <ctype.h>              /* tolower() */
+#include <asspprof.h>           /* profReset() */
+#include <blockio.h>            /* blkEnable() */
 
 /*
  * This list is used to map gender option values from R to the appropriate 
@@ -81,6 +83,8 @@ W_OPT           acfanaOptions[] = {
     ,
     {"outputDirectory", WO_OUTPUTDIR}
     ,
+    {"updateRange", WO_UPDATERANGE}
+    ,
     {"progressBar", WO_PBAR}
     ,
     {NULL, WO_NONE}
@@ -180,6 +184,8 @@ W_OPT           f0_ksvOptions[] = {
     ,
     {"outputDirectory", WO_OUTPUTDIR}
     ,
+    {"updateRange", WO_UPDATERANGE}
+    ,
     {NULL, WO_NONE}
 };
 
@@ -254,6 +260,12 @@ W_OPT           forestOptions[] = {
     ,
     {"preemphasis", WO_PREEMPH}
     ,
+    {"silenceThreshold", WO_THRESHOLD}
+    ,
+    {"numThreads", WO_NUMTHREADS}
+    ,
+    {"rootSolver", WO_FMT_ROOTSOLVER}
+    ,
     {"explicitExt", WO_OUTPUTEXT}
     ,                           /* DON'T FORGET EXTENSION!!! */
     {"progressBar", WO_PBAR}
@@ -318,6 +330,8 @@ W_OPT           rmsanaOptions[] = {
     ,
     {"linear", WO_RMS_OPT_LINEAR}
     ,
+    {"singlePrecision", WO_SINGLEPREC}
+    ,
     {"explicitExt", WO_OUTPUTEXT}
     ,                           /* DON'T FORGET EXTENSION!!! */
     {"window", WO_WINFUNC}
@@ -328,6 +342,8 @@ W_OPT           rmsanaOptions[] = {
     ,
     {"outputDirectory", WO_OUTPUTDIR}
     ,
+    {"updateRange", WO_UPDATERANGE}
+    ,
     {NULL, WO_NONE}
 };
 
@@ -360,6 +376,14 @@ W_OPT           spectrumOptions[] = {
      */
     {"bandwidth", WO_BANDWIDTH}
     ,
+    {"quantize", WO_SPECT_OPT_QUANT}
+    ,
+    {"singlePrecision", WO_SINGLEPREC}
+    ,
+    {"gain", WO_GAIN}
+    ,
+    {"range", WO_RANGE}
+    ,
 
     /*
      * LP smoothed spectrum 
@@ -393,6 +417,47 @@ W_OPT           spectrumOptions[] = {
     {NULL, WO_NONE}
 };
 
+/*
+ * MFCC option list
+ */
+W_OPT           mfccOptions[] = {
+    {"beginTime", WO_BEGINTIME}
+    ,
+    {"centerTime", WO_CENTRETIME}
+    ,
+    {"endTime", WO_ENDTIME}
+    ,
+    {"windowSize", WO_MSSIZE}
+    ,
+    {"windowShift", WO_MSSHIFT}
+    ,
+    {"window", WO_WINFUNC}
+    ,
+    {"fftLength", WO_FFTLEN}
+    ,
+    {"preemphasis", WO_PREEMPH}
+    ,
+    {"numCeps", WO_ORDER}
+    ,
+    {"numFilters", WO_NUMFILTERS}
+    ,
+    {"minF", WO_MINF}
+    ,
+    {"maxF", WO_MAXF}
+    ,
+    {"deltas", WO_MFCC_DELTAS}
+    ,
+    {"explicitExt", WO_OUTPUTEXT}
+    ,                           /* DON'T FORGET EXTENSION!!! */
+    {"progressBar", WO_PBAR}
+    ,
+    {"toFile", WO_TOFILE}
+    ,
+    {"outputDirectory", WO_OUTPUTDIR}
+    ,
+    {NULL, WO_NONE}
+};
+
 /*
  * ZCRANA option list
  */
@@ -407,6 +472,8 @@ W_OPT           zcranaOptions[] = {
     ,
     {"windowSize", WO_MSSIZE}
     ,
+    {"singlePrecision", WO_SINGLEPREC}
+    ,
     {"explicitExt", WO_OUTPUTEXT}
     ,                           /* DON'T FORGET EXTENSION!!! */
     /*
@@ -421,6 +488,8 @@ W_OPT           zcranaOptions[] = {
     ,
     {"outputDirectory", WO_OUTPUTDIR}
     ,
+    {"updateRange", WO_UPDATERANGE}
+    ,
     {NULL, WO_NONE}
 };
 
@@ -451,6 +520,10 @@ A_F_LIST        funclist[] = {
      FMT_MINOR,
      FMT_DEF_SUFFIX, AF_FOREST}
     ,
+    {"mfcc", setMFCCanaDefaults, computeSPECT, mfccOptions, SPECT_MAJOR,
+     SPECT_MINOR,
+     MFCC_DEF_SUFFIX, AF_MFCC}
+    ,
     {"mhspitch", setMHSdefaults, computeMHS, f0_mhsOptions, MHS_MAJOR,
      MHS_MINOR,
      MHS_DEF_SUFFIX, AF_MHS_PITCH}
@@ -474,6 +547,62 @@ A_F_LIST        funclist[] = {
     {NULL, NULL, NULL, 0, 0, AF_NONE}
 };
 
+/*
+ * This function closes the output file "*dopp" (if any) after its data
+ * have been written in the background and records the file "path" in
+ * the result cache under "key" (if not empty). Returns -1 if writing
+ * failed, 0 otherwise.
+ */
+static int
+closeOutput(DOBJ ** dopp, const char *path, const char *cacheDir,
+            const char *key)
+{
+    int             err;
+
+    if (*dopp == NULL)
+        return 0;
+    err = asspFClose(*dopp, AFC_FREE);
+    *dopp = NULL;
+    if (err == 0 && key[0] != EOS)
+        resultCacheStoreFile(cacheDir, key, path);
+    return err;
+}
+
+/*
+ * R code evaluated while an output file is still open (e.g. updating
+ * the progress bar) may raise an error or be interrupted; the output
+ * file is then closed by the cleanup function as the error unwinds
+ */
+typedef struct pendingEval {
+    SEXP            call,
+                    env;
+    int             done;
+    DOBJ          **dopp;       /* output still being written */
+    const char     *path,
+                   *cacheDir,
+                   *key;
+} PENDING_EVAL;
+
+static SEXP
+evalPending(void *data)
+{
+    PENDING_EVAL   *pe = (PENDING_EVAL *) data;
+    SEXP            ans;
+
+    ans = eval(pe->call, pe->env);
+    pe->done = 1;
+    return ans;
+}
+
+static void
+closePending(void *data)
+{
+    PENDING_EVAL   *pe = (PENDING_EVAL *) data;
+
+    if (!pe->done)
+        closeOutput(pe->dopp, pe->path, pe->cacheDir, pe->key);
+}
+
 /*
  * This function performs an analysis routine. The intput to this function 
  * is an SEXP object containing a list of input files, the name of the
@@ -506,12 +635,26 @@ performAssp(SEXP args)
     LP_TYPE        *lPtr = NULL;
     SPECT_TYPE     *sPtr = NULL;
     DOBJ           *inPtr,
-                   *outPtr;
+                   *outPtr,
+                   *pendPtr = NULL;
     char           *dPath,
                    *bPath,
                    *oExt,
                     outName[PATH_MAX + 1],
-                   *outDir = NULL;
+                   *outDir = NULL,
+                   *cacheDir = NULL,
+                    cacheKey[RESULT_KEY_LEN + 1],
+                    pendName[PATH_MAX + 1],
+                    pendKey[RESULT_KEY_LEN + 1];
+    int             cached,
+                    profile,
+                    update = 0,
+                    numThreads = 1;
+    long            optFlag,
+                    blockRecs;
+    PENDING_EVAL    pendEval;
+    double          updBeg = 0.0,
+                    updEnd = 0.0;
 
     args = CDR(args);           /* skip function name */
 
@@ -726,6 +869,9 @@ performAssp(SEXP args)
         case WO_NUMFORMANTS:
             opt->numFormants = INTEGER(el)[0];
             break;
+        case WO_NUMFILTERS:
+            opt->numFilters = INTEGER(el)[0];
+            break;
         case WO_PRECISION:
             opt->precision = INTEGER(el)[0];
             break;
@@ -796,6 +942,17 @@ performAssp(SEXP args)
             else
                 opt->options &= ~FMT_OPT_INS_ESTS;
             break;
+        case WO_FMT_ROOTSOLVER:
+            opt->options &= ~(FMT_OPT_ROOTS_AE | FMT_OPT_AE_SORTED);
+            if (strcmp(CHAR(STRING_ELT(el, 0)), "aberth") == 0)
+                opt->options |= FMT_OPT_ROOTS_AE;
+            else if (strcmp(CHAR(STRING_ELT(el, 0)), "aberth-sorted") == 0)
+                opt->options |= (FMT_OPT_ROOTS_AE | FMT_OPT_AE_SORTED);
+            else if (strcmp(CHAR(STRING_ELT(el, 0)), "bairstow") != 0)
+                error("Invalid root solver %s (must be \"bairstow\", "
+                      "\"aberth\" or \"aberth-sorted\").",
+                      CHAR(STRING_ELT(el, 0)));
+            break;
         case WO_VOIAC1PP:      /* VOICING thresholds */
             opt->voiAC1 = REAL(el)[0];
             break;
@@ -892,6 +1049,9 @@ performAssp(SEXP args)
                 case DT_FTCEP:
                     setCEPdefaults(opt);
                     break;
+                case DT_MFCC:
+                    setMFCCdefaults(opt);
+                    break;
                 default:
                     setAsspMsg(AEG_ERR_BUG,
                                "setSPECTdefaults: invalid default type");
@@ -956,6 +1116,49 @@ performAssp(SEXP args)
             else
                 opt->options &= ~LPS_OPT_DEEMPH;
             break;
+        case WO_SPECT_OPT_QUANT:
+            if (INTEGER(el)[0])
+                opt->options |= SPECT_OPT_QUANT;
+            else
+                opt->options &= ~SPECT_OPT_QUANT;
+            break;
+        case WO_SINGLEPREC:
+            switch (anaFunc->funcNum) {
+            case AF_RMSANA:
+                optFlag = RMS_OPT_FLOAT;
+                break;
+            case AF_SPECTRUM:
+                optFlag = SPECT_OPT_FLOAT;
+                break;
+            case AF_ZCRANA:
+                optFlag = ZCR_OPT_FLOAT;
+                break;
+            default:
+                optFlag = 0;
+                break;
+            }
+            if (INTEGER(el)[0])
+                opt->options |= optFlag;
+            else
+                opt->options &= ~optFlag;
+            break;
+        case WO_MFCC_DELTAS:
+            opt->options &= ~(MFCC_OPT_DELTA | MFCC_OPT_DDELTA);
+            switch (INTEGER(el)[0]) {
+            case 0:
+                break;
+            case 1:
+                opt->options |= MFCC_OPT_DELTA;
+                break;
+            case 2:
+                opt->options |= (MFCC_OPT_DELTA | MFCC_OPT_DDELTA);
+                break;
+            default:
+                error("Bad value for option deltas (%i), must be 0, 1 or 2.",
+                      INTEGER(el)[0]);
+                break;
+            }
+            break;
         case WO_OUTPUTEXT:
             if (TYPEOF(el) == NILSXP) {
                 expExt = 0;
@@ -1027,6 +1230,24 @@ performAssp(SEXP args)
         case WO_PBAR:
             pBar = el;
             break;
+        case WO_UPDATERANGE:
+            if (el == R_NilValue) {
+                update = 0;
+                break;
+            }
+            if (!isReal(el) || length(el) != 2 || REAL(el)[0] < 0.0
+                || REAL(el)[1] < REAL(el)[0])
+                error("updateRange must be a numeric vector c(begin, end) "
+                      "with 0 <= begin <= end.");
+            updBeg = REAL(el)[0];
+            updEnd = REAL(el)[1];
+            update = 1;
+            break;
+        case WO_NUMTHREADS:
+            numThreads = asInteger(el);
+            if (numThreads == NA_INTEGER || numThreads < 1)
+                error("numThreads must be a positive integer.");
+            break;
         default:
             break;
         }
@@ -1089,41 +1310,41 @@ performAssp(SEXP args)
      * if toFile is false but there are multiple inputs set toFile to true 
      */
     toFile = toFile || length(inputs) != 1;
+    if (update && !toFile)
+        error("updateRange can only be used with toFile=TRUE.");
 
     /*
-     * iterate over input files 
+     * result cache is used if option 'wrassp.cacheDir' is set; an
+     * update changes the output file in place, so skip the cache then
      */
-    for (i = 0; i < length(inputs); i++) {
-        /*
-         * get inpput name and open
-         */
-        name = strdup(CHAR(STRING_ELT(inputs, i)));
-        inPtr = asspFOpen(strdup(name), AFO_READ, (DOBJ *) NULL);
-        if (inPtr == NULL)
-            error("%s (%s)", getAsspMsg(asspMsgNum), strdup(name));
+    if (!update)
+        cacheDir = resultCacheDir();
 
-        /*
-         * run the function (as pointed to in the descriptor) to generate
-         * the output object 
-         */
-        outPtr = (anaFunc->compProc) (inPtr, opt, (DOBJ *) NULL);
-        if (outPtr == NULL) {
-            asspFClose(inPtr, AFC_FREE);
-            error("%s (%s)", getAsspMsg(asspMsgNum), strdup(name));
-        }
+    /*
+     * stage timers and I/O counters are recorded if option
+     * 'wrassp.profile' is TRUE 
+     */
+    profile = profileRequested();
+    profReset(profile);
 
-        /*
-         * input data object no longer needed 
-         */
-        asspFClose(inPtr, AFC_FREE);
+    /*
+     * parsed file headers are cached if option 'wrassp.headerCache' is
+     * set
+     */
+    headerCacheOption();
 
+    /*
+     * SSFF output is written in compressed blocks if option
+     * 'wrassp.compressSSFF' is set
+     */
+    blockRecs = compressOption();
 
+    /*
+     * iterate over input files 
+     */
+    for (i = 0; i < length(inputs); i++) {
+        name = strdup(CHAR(STRING_ELT(inputs, i)));
         if (toFile) {
-            /*
-             * in toFile mode, all DOBJs are written to file we will later 
-             * return the number of successful analyses 
-             */
-
             /*
              * parse the input path to get directory (dPath), base file
              * name (bPath) and original extension (oExt) 
@@ -1151,29 +1372,127 @@ performAssp(SEXP args)
                     strcat(ext, oExt);
                     break;
                 default:
+                    closeOutput(&pendPtr, pendName, cacheDir, pendKey);
                     error("Extension handling failed (performAssp).");
                     break;
                 }
             }
             strcat(outName, ext);
+        }
 
+        /*
+         * look up the result in the cache (if enabled)
+         */
+        cached = 0;
+        if (cacheDir != NULL &&
+            resultCacheKey(anaFunc, opt, name, toFile ? outName : NULL,
+                           blockRecs, cacheKey) == 0) {
+            if (toFile) {
+                cached = resultCacheCheckFile(cacheDir, cacheKey, outName);
+            } else {
+                PROTECT(res = resultCacheLoad(cacheDir, cacheKey));
+                cached = (res != R_NilValue);
+                if (!cached)
+                    UNPROTECT(1);
+            }
+        } else {
+            cacheKey[0] = EOS;
+        }
+
+        if (!cached) {
             /*
-             * out put name is complete, use it to open the file for the
-             * output object, then write and close and free 
+             * open input
              */
-            outPtr = asspFOpen(outName, AFO_WRITE, outPtr);
+            inPtr = asspFOpen(strdup(name), AFO_READ | AFO_ASYNC, (DOBJ *) NULL);
+            if (inPtr == NULL) {
+                closeOutput(&pendPtr, pendName, cacheDir, pendKey);
+                error("%s (%s)", getAsspMsg(asspMsgNum), strdup(name));
+            }
+
+            /*
+             * in update mode, recompute only the frames affected by
+             * the change in the existing output file; if that fails,
+             * recompute the whole file
+             */
+            if (update) {
+                outPtr = asspFOpen(outName, AFO_UPDATE, (DOBJ *) NULL);
+                if (outPtr != NULL) {
+                    if (updateFile(anaFunc, inPtr, opt, outPtr, updBeg,
+                                   updEnd) >= 0) {
+                        asspFClose(inPtr, AFC_FREE);
+                        cached = 1;
+                    } else {
+                        /* the warning may be turned into an error */
+                        closeOutput(&pendPtr, pendName, cacheDir, pendKey);
+                        warning("%s (%s); analysing whole file",
+                                getAsspMsg(asspMsgNum), outName);
+                    }
+                    asspFClose(outPtr, AFC_FREE);
+                }
+            }
+        }
+        if (!cached) {
+            /*
+             * run the function (as pointed to in the descriptor) to
+             * generate the output object 
+             */
+            if (anaFunc->funcNum == AF_FOREST && numThreads > 1)
+                outPtr = computeFMTpar(inPtr, opt, (DOBJ *) NULL,
+                                       numThreads);
+            else
+                outPtr = (anaFunc->compProc) (inPtr, opt, (DOBJ *) NULL);
             if (outPtr == NULL) {
-                asspFClose(outPtr, AFC_FREE);
-                error("%s (%s)", getAsspMsg(asspMsgNum), strdup(outName));
+                asspFClose(inPtr, AFC_FREE);
+                closeOutput(&pendPtr, pendName, cacheDir, pendKey);
+                error("%s (%s)", getAsspMsg(asspMsgNum), strdup(name));
             }
-            if (asspFFlush(outPtr, 0) == -1) {
+
+            /*
+             * input data object no longer needed 
+             */
+            asspFClose(inPtr, AFC_FREE);
+
+            if (toFile) {
+                /*
+                 * in toFile mode, all DOBJs are written to file we will
+                 * later return the number of successful analyses; the
+                 * output of the previous input has been written in the
+                 * background while this one was analysed, so close it
+                 * now; then use the output name to open the file for
+                 * the output object and hand its data over to the
+                 * background writer 
+                 */
+                if (closeOutput(&pendPtr, pendName, cacheDir, pendKey) < 0) {
+                    asspFClose(outPtr, AFC_FREE);
+                    error("%s (%s)", getAsspMsg(asspMsgNum),
+                          strdup(pendName));
+                }
+                strcpy(pendName, outName);
+                strcpy(pendKey, cacheKey);
+                if (blockRecs >= 0 && outPtr->fileFormat == FF_SSFF
+                    && blkEnable(outPtr, blockRecs) < 0) {
+                    asspFClose(outPtr, AFC_FREE);
+                    error("%s (%s)", getAsspMsg(asspMsgNum),
+                          strdup(outName));
+                }
+                outPtr = asspFOpen(pendName, AFO_WRITE | AFO_ASYNC, outPtr);
+                if (outPtr == NULL) {
+                    asspFClose(outPtr, AFC_FREE);
+                    error("%s (%s)", getAsspMsg(asspMsgNum),
+                          strdup(outName));
+                }
+                if (asspFFlush(outPtr, 0) == -1) {
+                    asspFClose(outPtr, AFC_FREE);
+                    error("%s (%s)", getAsspMsg(asspMsgNum),
+                          strdup(outName));
+                }
+                pendPtr = outPtr;
+            } else {
+                PROTECT(res = dobj2AsspDataObj(outPtr));
                 asspFClose(outPtr, AFC_FREE);
-                error("%s (%s)", getAsspMsg(asspMsgNum), strdup(outName));
+                if (cacheKey[0] != EOS)
+                    resultCacheStore(cacheDir, cacheKey, res);
             }
-            asspFClose(outPtr, AFC_FREE);
-        } else {
-            PROTECT(res = dobj2AsspDataObj(outPtr));
-            asspFClose(outPtr, AFC_FREE);
         }
 
         free((char *) name);
@@ -1184,7 +1503,15 @@ performAssp(SEXP args)
         if (pBar != R_NilValue) {
             PROTECT(R_fcall3 = lang4(install("setTxtProgressBar"), pBar, newVal, R_NilValue));
             INTEGER(newVal)[0] = i + 1;
-            eval(R_fcall3, utilsPackage);
+            pendEval.call = R_fcall3;
+            pendEval.env = utilsPackage;
+            pendEval.done = 0;
+            pendEval.dopp = &pendPtr;
+            pendEval.path = pendName;
+            pendEval.cacheDir = cacheDir;
+            pendEval.key = pendKey;
+            R_ExecWithCleanup(evalPending, &pendEval, closePending,
+                              &pendEval);
             UNPROTECT(1);
         }
         
@@ -1193,7 +1520,10 @@ performAssp(SEXP args)
         
     }// end of for loop
     
+    if (closeOutput(&pendPtr, pendName, cacheDir, pendKey) < 0)
+        error("%s (%s)", getAsspMsg(asspMsgNum), strdup(pendName));
     free((void *) outDir);
+    free((void *) cacheDir);
     if (toFile) {
         /*
          * in toFile mode, the number of successful analyses is returned
@@ -1201,6 +1531,12 @@ performAssp(SEXP args)
         PROTECT(res = allocVector(INTSXP, 1));
         INTEGER(res)[0] = i;
     }
+    if (profile) {
+        PROTECT(res);
+        setAttrib(res, install("profile"), profileAttrib());
+        UNPROTECT(1);
+        profReset(FALSE);
+    }
     /*
      * for the progress bar, five SEXPs were protected
      */
@@ -1271,3 +1607,42 @@ computeF0(DOBJ * inpDOp, AOPTS * anaOpts, DOBJ * outDOp)
 {
     return computeKSV(inpDOp, anaOpts, outDOp, (DOBJ *) NULL);
 }
+
+/*
+ * This function recomputes the part of the analysis in the output file
+ * "outDOp" (opened for update) that is affected by a change of the
+ * input signal between "begTime" and "endTime". Only analyses with a
+ * verification function can be updated. Returns the number of frames
+ * written or -1 upon error.
+ */
+long
+updateFile(A_F_LIST * anaFunc, DOBJ * inpDOp, AOPTS * anaOpts,
+           DOBJ * outDOp, double begTime, double endTime)
+{
+    switch (anaFunc->funcNum) {
+    case AF_ACFANA:
+        return anaUpdate(inpDOp, anaOpts, outDOp, createACF, verifyACF,
+                         computeACF, begTime, endTime, 0.0);
+    case AF_KSV_PITCH:
+        return anaUpdate(inpDOp, anaOpts, outDOp, createKSV, verifyKSV,
+                         computeF0, begTime, endTime, KSV_UPD_CONTEXT);
+    case AF_RMSANA:
+        return anaUpdate(inpDOp, anaOpts, outDOp, createRMS, verifyRMS,
+                         computeRMS, begTime, endTime, 0.0);
+    case AF_ZCRANA:
+        return anaUpdate(inpDOp, anaOpts, outDOp, createZCR, verifyZCR,
+                         computeZCR, begTime, endTime, 0.0);
+    default:
+        setAsspMsg(AEG_ERR_APPL, "updateFile: analysis can't be updated");
+        return (-1);
+    }
+}
+
+int
+setMFCCanaDefaults(AOPTS * anaOpts)
+{
+    if (setSPECTdefaults(anaOpts) < 0)
+        return (-1);
+    strcpy(anaOpts->type, "MFCC");
+    return setMFCCdefaults(anaOpts);
+}
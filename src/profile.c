@@ -0,0 +1,81 @@
+#include "wrassp.h"
+#include <asspprof.h>
+
+/*
+ * Per-call profiling of the analyses. It is switched on by setting the
+ * R option 'wrassp.profile' to TRUE; the result of the call then gets
+ * an attribute "profile" with the time spent in the stages of the frame
+ * loop and the file I/O, and the I/O counters (see assp/asspprof.h).
+ * The timers and counters are only compiled in if ASSP_PROFILE is
+ * defined (see Makevars).
+ */
+
+/*
+ * This function returns 1 if profiling is requested by the option
+ * 'wrassp.profile' and available, 0 otherwise.
+ */
+int
+profileRequested(void)
+{
+    SEXP            el;
+
+    el = GetOption1(install("wrassp.profile"));
+    if (TYPEOF(el) != LGLSXP || length(el) < 1
+        || LOGICAL(el)[0] != TRUE)
+        return 0;
+#ifdef ASSP_PROFILE
+    return 1;
+#else
+    warning("wrassp was compiled without ASSP_PROFILE; "
+            "option wrassp.profile ignored.");
+    return 0;
+#endif
+}
+
+/*
+ * This function returns the profiling data of the calling thread as a
+ * list with the named numeric vectors "seconds" and "calls" (per stage)
+ * and "counts" (per counter).
+ */
+SEXP
+profileAttrib(void)
+{
+    SEXP            ans,
+                    names,
+                    sec,
+                    calls,
+                    counts,
+                    stageNames,
+                    countNames;
+    int             i;
+
+    PROTECT(sec = allocVector(REALSXP, PRF_NUM_TIMERS));
+    PROTECT(calls = allocVector(REALSXP, PRF_NUM_TIMERS));
+    PROTECT(stageNames = allocVector(STRSXP, PRF_NUM_TIMERS));
+    for (i = 0; i < PRF_NUM_TIMERS; i++) {
+        REAL(sec)[i] = asspProf.sec[i];
+        REAL(calls)[i] = asspProf.calls[i];
+        SET_STRING_ELT(stageNames, i, mkChar(prfTimerName[i]));
+    }
+    setAttrib(sec, R_NamesSymbol, stageNames);
+    setAttrib(calls, R_NamesSymbol, stageNames);
+    PROTECT(counts = allocVector(REALSXP, PRC_NUM_COUNTERS));
+    PROTECT(countNames = allocVector(STRSXP, PRC_NUM_COUNTERS));
+    for (i = 0; i < PRC_NUM_COUNTERS; i++) {
+        REAL(counts)[i] = asspProf.count[i];
+        SET_STRING_ELT(countNames, i, mkChar(prfCounterName[i]));
+    }
+    setAttrib(counts, R_NamesSymbol, countNames);
+
+    PROTECT(ans = allocVector(VECSXP, 3));
+    SET_VECTOR_ELT(ans, 0, sec);
+    SET_VECTOR_ELT(ans, 1, calls);
+    SET_VECTOR_ELT(ans, 2, counts);
+    PROTECT(names = allocVector(STRSXP, 3));
+    SET_STRING_ELT(names, 0, mkChar("seconds"));
+    SET_STRING_ELT(names, 1, mkChar("calls"));
+    SET_STRING_ELT(names, 2, mkChar("counts"));
+    setAttrib(ans, R_NamesSymbol, names);
+    UNPROTECT(7);
+    return ans;
+}
@@ -0,0 +1,286 @@
+#include "wrassp.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <miscdefs.h>           /* DIR_SEP_CHR DIR_SEP_STR */
+#include <mylimits.h>           /* PATH_MAX */
+#include <asspana.h>
+
+/*
+ * Opt-in cache of analysis results. It is switched on by setting the R
+ * option 'wrassp.cacheDir' to an existing directory. Results are
+ * identified by a key hashed from the wrassp version, the function name
+ * and version, the fully resolved analysis options, the input path and
+ * the size and modification time (in nanoseconds where the file system
+ * provides them) of the input file.
+ * For results written to file, the cache directory holds a small record
+ * per output file with the key and the size and modification time of
+ * the output; the analysis is skipped if the output is still the one
+ * described by the record. Results returned to R are stored in the
+ * cache directory as .rds files named after the key.
+ */
+
+#define CACHE_FORMAT "wrassp result cache 2"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME  1099511628211ULL
+
+static unsigned long long
+fnv1a(unsigned long long hash, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *) data;
+
+    while (len-- > 0) {
+        hash ^= (unsigned long long) (*p++);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static unsigned long long
+fnv1aStr(unsigned long long hash, const char *str)
+{
+    /*
+     * include the terminating zero to separate consecutive strings
+     */
+    return fnv1a(hash, str, strlen(str) + 1);
+}
+
+/*
+ * modification time of a file in nanoseconds; only whole seconds on
+ * Windows
+ */
+static long long
+fileTime(const struct stat *st)
+{
+#if defined(_WIN32)
+    return (long long) st->st_mtime * 1000000000LL;
+#elif defined(__APPLE__)
+    return (long long) st->st_mtimespec.tv_sec * 1000000000LL
+        + (long long) st->st_mtimespec.tv_nsec;
+#else
+    return (long long) st->st_mtim.tv_sec * 1000000000LL
+        + (long long) st->st_mtim.tv_nsec;
+#endif
+}
+
+/*
+ * version of the installed wrassp package, so that results of older
+ * analysis code are not served after an update
+ */
+static const char *
+packageVersion(void)
+{
+    static char     version[32] = "";
+    SEXP            s,
+                    call,
+                    res;
+    int             err = 0;
+
+    if (version[0] == '\0') {
+        PROTECT(s = mkString("wrassp")); // not in lang2 call (rchk)
+        PROTECT(call = lang2(install("getNamespaceVersion"), s));
+        res = R_tryEvalSilent(call, R_BaseEnv, &err);
+        if (!err && isString(res) && length(res) > 0)
+            snprintf(version, sizeof(version), "%s",
+                     CHAR(STRING_ELT(res, 0)));
+        else
+            strcpy(version, "unknown");
+        UNPROTECT(2);
+    }
+    return version;
+}
+
+/*
+ * This function returns the cache directory (with trailing separator)
+ * if the result cache is switched on and NULL otherwise. The returned
+ * string must be freed by the caller.
+ */
+char           *
+resultCacheDir(void)
+{
+    SEXP            el;
+    const char     *dir;
+    char           *res;
+    struct stat     st;
+    size_t          len;
+
+    el = GetOption1(install("wrassp.cacheDir"));
+    if (TYPEOF(el) != STRSXP || length(el) < 1
+        || STRING_ELT(el, 0) == NA_STRING)
+        return NULL;
+    dir = translateChar(STRING_ELT(el, 0));
+    len = strlen(dir);
+    if (len == 0)
+        return NULL;
+    if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        warning("wrassp.cacheDir '%s' is not a directory; cache not used.",
+                dir);
+        return NULL;
+    }
+    res = malloc(len + 2);
+    strcpy(res, dir);
+    if (res[len - 1] != DIR_SEP_CHR)
+        strcat(res, DIR_SEP_STR);
+    return res;
+}
+
+/*
+ * This function computes the cache key for analysing the file "inPath"
+ * with the function "anaFunc" and the options "opt". For results
+ * written to file, "outPath" is the path of the output file, otherwise
+ * it is NULL. "blockRecs" is the setting for compressed SSFF output
+ * as returned by compressOption(); it only counts for file output. The
+ * key is stored as hex string in "key" (at least RESULT_KEY_LEN + 1
+ * characters). Returns -1 if the input file can not be examined, 0
+ * otherwise.
+ */
+int
+resultCacheKey(A_F_LIST * anaFunc, AOPTS * opt, const char *inPath,
+               const char *outPath, long blockRecs, char *key)
+{
+    struct stat     st;
+    unsigned long long hash;
+    long long       num;
+
+    if (stat(inPath, &st) != 0)
+        return -1;
+    hash = fnv1aStr(FNV_OFFSET, CACHE_FORMAT);
+    hash = fnv1aStr(hash, packageVersion());
+    hash = fnv1aStr(hash, anaFunc->fName);
+    hash = fnv1a(hash, &(anaFunc->major), sizeof(int));
+    hash = fnv1a(hash, &(anaFunc->minor), sizeof(int));
+    /*
+     * all items of the options structure are cleared by the set
+     * defaults function so the padding bytes are well defined
+     */
+    hash = fnv1a(hash, opt, sizeof(AOPTS));
+    hash = fnv1aStr(hash, inPath);
+    num = (long long) st.st_size;
+    hash = fnv1a(hash, &num, sizeof(num));
+    num = fileTime(&st);
+    hash = fnv1a(hash, &num, sizeof(num));
+    hash = fnv1aStr(hash, outPath == NULL ? "" : outPath);
+    if (outPath != NULL) {
+        num = (long long) blockRecs;
+        hash = fnv1a(hash, &num, sizeof(num));
+    }
+    snprintf(key, RESULT_KEY_LEN + 1, "%016llx", hash);
+    return 0;
+}
+
+/*
+ * path of the record for output file "outPath"
+ */
+static void
+recordPath(const char *dir, const char *outPath, char *path)
+{
+    snprintf(path, PATH_MAX + 1, "%s%016llx.key", dir,
+             fnv1aStr(FNV_OFFSET, outPath));
+}
+
+/*
+ * This function checks whether output file "outPath" was produced by
+ * the analysis identified by "key" and has not been changed since.
+ * Returns 1 if so, 0 otherwise.
+ */
+int
+resultCacheCheckFile(const char *dir, const char *key, const char *outPath)
+{
+    char            path[PATH_MAX + 1],
+                    recKey[RESULT_KEY_LEN + 1];
+    long long       size,
+                    mtime;
+    struct stat     st;
+    FILE           *fp;
+    int             n;
+
+    recordPath(dir, outPath, path);
+    if ((fp = fopen(path, "r")) == NULL)
+        return 0;
+    n = fscanf(fp, "%16s %lld %lld", recKey, &size, &mtime);
+    fclose(fp);
+    if (n != 3 || strcmp(recKey, key) != 0)
+        return 0;
+    if (stat(outPath, &st) != 0)
+        return 0;
+    return ((long long) st.st_size == size
+            && fileTime(&st) == mtime);
+}
+
+/*
+ * This function records that output file "outPath" was produced by the
+ * analysis identified by "key". Failures are silently ignored: the
+ * result will simply be recomputed next time.
+ */
+void
+resultCacheStoreFile(const char *dir, const char *key, const char *outPath)
+{
+    char            path[PATH_MAX + 1];
+    struct stat     st;
+    FILE           *fp;
+
+    if (stat(outPath, &st) != 0)
+        return;
+    recordPath(dir, outPath, path);
+    if ((fp = fopen(path, "w")) == NULL)
+        return;
+    fprintf(fp, "%s %lld %lld\n", key, (long long) st.st_size,
+            fileTime(&st));
+    fclose(fp);
+}
+
+/*
+ * This function returns the AsspDataObj cached under "key" or
+ * R_NilValue if there is none (or it can not be read).
+ */
+SEXP
+resultCacheLoad(const char *dir, const char *key)
+{
+    char            path[PATH_MAX + 1];
+    struct stat     st;
+    SEXP            s,
+                    call,
+                    res;
+    int             err = 0;
+
+    snprintf(path, PATH_MAX + 1, "%s%s.rds", dir, key);
+    if (stat(path, &st) != 0)
+        return R_NilValue;
+    PROTECT(s = mkString(path)); // not in lang2 call (rchk)
+    PROTECT(call = lang2(install("readRDS"), s));
+    res = R_tryEvalSilent(call, R_BaseEnv, &err);
+    UNPROTECT(2);
+    if (err || !inherits(res, WRASSP_CLASS))
+        return R_NilValue;
+    return res;
+}
+
+/*
+ * This function stores the AsspDataObj "res" in the cache under "key".
+ * The object is written to a temporary file first so that concurrent
+ * readers never see an incomplete file. Failures are silently ignored.
+ */
+void
+resultCacheStore(const char *dir, const char *key, SEXP res)
+{
+    char            path[PATH_MAX + 1],
+                    tmpPath[PATH_MAX + 1];
+    SEXP            s,
+                    call;
+    int             err = 0;
+
+    snprintf(path, PATH_MAX + 1, "%s%s.rds", dir, key);
+    snprintf(tmpPath, PATH_MAX + 1, "%s%s.tmp", dir, key);
+    PROTECT(s = mkString(tmpPath)); // not in lang3 call (rchk)
+    PROTECT(call = lang3(install("saveRDS"), res, s));
+    R_tryEvalSilent(call, R_BaseEnv, &err);
+    UNPROTECT(2);
+    if (err) {
+        remove(tmpPath);
+        return;
+    }
+    remove(path);               /* rename() won't replace on Windows */
+    if (rename(tmpPath, path) != 0)
+        remove(tmpPath);
+}
@@ -20,6 +20,7 @@ typedef enum AsspFuncs {
     AF_AFFILTER,
     AF_KSV_PITCH,               /* f0ana */
     AF_FOREST,
+    AF_MFCC,
     AF_MHS_PITCH,
     AF_RFCANA,
     AF_RMSANA,
@@ -63,6 +64,7 @@ typedef enum wrassp_option_number {
     WO_INCREMENT,
     WO_NUMLEVELS,
     WO_NUMFORMANTS,
+    WO_NUMFILTERS,
     WO_PRECISION,
     WO_ACCURACY,
     WO_ALPHA,
@@ -111,6 +113,18 @@ typedef enum wrassp_option_number {
      * options specific to spectrum 
      */
     WO_LPS_OPT_DEEMPH,          /* omit de-emphasis */
+    WO_SPECT_OPT_QUANT,         /* quantize DFT levels */
+    WO_MFCC_DELTAS,             /* number of MFCC derivatives */
+
+    /*
+     * options specific to forest
+     */
+    WO_FMT_ROOTSOLVER,          /* polynomial root solver */
+
+    /*
+     * options shared by dftSpectrum, rmsana and zcrana
+     */
+    WO_SINGLEPREC,              /* single-precision processing */
 
     /*
      * general wrassp options 
@@ -118,6 +132,8 @@ typedef enum wrassp_option_number {
     WO_OUTPUTDIR,
     WO_OUTPUTEXT,
     WO_TOFILE,
+    WO_UPDATERANGE,             /* changed interval for in-place update */
+    WO_NUMTHREADS,              /* threads for segment-parallel analysis */
     WO_PBAR                     /* R Textual Progress Bar */
 } ASSP_OPT_NUM;
 
@@ -175,6 +191,7 @@ extern W_OPT    affilterOptions[];
 extern W_OPT    f0_ksvOptions[];
 extern W_OPT    f0_mhsOptions[];
 extern W_OPT    forestOptions[];
+extern W_OPT    mfccOptions[];
 extern W_OPT    rmsanaOptions[];
 extern W_OPT    rfcanaOptions[];
 extern W_OPT    spectrumOptions[];
@@ -201,7 +218,43 @@ int             addTrackData(DOBJ * dop, DDESC * ddl, SEXP rdobj);
 DOBJ           *computeFilter(DOBJ * inpDOp, AOPTS * anaopts,
                               DOBJ * outDOp);
 DOBJ           *computeF0(DOBJ * inpDOp, AOPTS * anaOpts, DOBJ * outDOp);
+int             setMFCCanaDefaults(AOPTS * anaOpts);
+long            updateFile(A_F_LIST * anaFunc, DOBJ * inpDOp,
+                           AOPTS * anaOpts, DOBJ * outDOp, double begTime,
+                           double endTime);
+
+/*
+ * result cache (resultCache.c)
+ */
+#define RESULT_KEY_LEN 16       /* hex digits of the cache key */
+char           *resultCacheDir(void);
+int             resultCacheKey(A_F_LIST * anaFunc, AOPTS * opt,
+                               const char *inPath, const char *outPath,
+                               long blockRecs, char *key);
+int             resultCacheCheckFile(const char *dir, const char *key,
+                                     const char *outPath);
+void            resultCacheStoreFile(const char *dir, const char *key,
+                                     const char *outPath);
+SEXP            resultCacheLoad(const char *dir, const char *key);
+void            resultCacheStore(const char *dir, const char *key,
+                                 SEXP res);
 DOBJ           *sexp2dobj(SEXP rdobj);
 
+/*
+ * profiling (profile.c)
+ */
+int             profileRequested(void);
+SEXP            profileAttrib(void);
+
+/*
+ * header cache (headerCache.c)
+ */
+void            headerCacheOption(void);
+
+/*
+ * compressed SSFF output (compressSSFF.c)
+ */
+long            compressOption(void);
+
 
 #endif                          // _WRASSP
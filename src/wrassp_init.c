@@ -21,6 +21,13 @@ extern SEXP AsspLpTypes_(void);
 extern SEXP AsspSpectTypes_(void);
 extern SEXP AsspWindowTypes_(void);
 extern SEXP writeDObj_(SEXP, SEXP);
+extern SEXP fileInfo_(SEXP, SEXP);
+extern SEXP readerOpen_(SEXP);
+extern SEXP readerNext_(SEXP, SEXP);
+extern SEXP readerSeek_(SEXP, SEXP, SEXP);
+extern SEXP readerClose_(SEXP);
+extern SEXP readerInfo_(SEXP);
+extern SEXP flacSearchLimits_(SEXP, SEXP);
 
 /* .External calls */
 extern SEXP getDObj2(SEXP);
@@ -37,6 +44,13 @@ static const R_CallMethodDef CallEntries[] = {
   {"AsspSpectTypes_",  (DL_FUNC) &AsspSpectTypes_,  0},
   {"AsspWindowTypes_", (DL_FUNC) &AsspWindowTypes_, 0},
   {"writeDObj_",       (DL_FUNC) &writeDObj_,       2},
+  {"fileInfo_",        (DL_FUNC) &fileInfo_,        2},
+  {"readerOpen_",      (DL_FUNC) &readerOpen_,      1},
+  {"readerNext_",      (DL_FUNC) &readerNext_,      2},
+  {"readerSeek_",      (DL_FUNC) &readerSeek_,      3},
+  {"readerClose_",     (DL_FUNC) &readerClose_,     1},
+  {"readerInfo_",      (DL_FUNC) &readerInfo_,      1},
+  {"flacSearchLimits_", (DL_FUNC) &flacSearchLimits_, 2},
   {NULL, NULL, 0}
 };
 